@@ -0,0 +1,57 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Offline phase of SPDZ2k. Record the requirement with a dry run of the
+// program (RuntimeConfig.spdz2k_requirement_path=/tmp/req), then start two
+// terminals:
+// clang-format off
+// > bazel run //examples/cpp:spdz2k_preprocess -- --requirement=/tmp/req.0 --output=/tmp/store.0
+// > bazel run //examples/cpp:spdz2k_preprocess -- --requirement=/tmp/req.1 --output=/tmp/store.1 --rank=1
+// clang-format on
+// and load them online with RuntimeConfig.spdz2k_preprocess_path=/tmp/store
+
+#include "examples/cpp/utils.h"
+#include "spdlog/spdlog.h"
+
+#include "libspu/mpc/spdz2k/beaver/beaver_store.h"
+#include "libspu/mpc/spdz2k/beaver/beaver_tfp.h"
+
+llvm::cl::opt<std::string> Requirement(
+    "requirement", llvm::cl::init("requirement.0"),
+    llvm::cl::desc("requirement saved by the dry run of this party"));
+llvm::cl::opt<std::string> Output(
+    "output", llvm::cl::init("store.0"),
+    llvm::cl::desc("preprocessing store of this party"));
+llvm::cl::opt<uint32_t> StatSecurity(
+    "s", llvm::cl::init(64), llvm::cl::desc("statistical security parameter"));
+
+int main(int argc, char** argv) {
+  llvm::cl::ParseCommandLineOptions(argc, argv);
+
+  auto lctx = MakeLink(Parties.getValue(), Rank.getValue());
+  const auto req = spu::mpc::spdz2k::LoadRequirement(Requirement.getValue());
+
+  spu::mpc::spdz2k::BeaverTfpUnsafe beaver(lctx);
+  spu::mpc::spdz2k::Preprocess(lctx, &beaver, req, StatSecurity.getValue(),
+                               Output.getValue());
+  size_t num_trunc = 0;
+  for (const auto& [bits, size] : req.trunc) {
+    num_trunc += size;
+  }
+  spdlog::info(
+      "saved {} mul, {} dot, {} trunc and {} coin correlations to {}",
+      req.mul, req.dot.size(), num_trunc, req.coin, Output.getValue());
+
+  return 0;
+}
@@ -66,4 +66,12 @@ std::filesystem::path CompilationContext::getPrettyPrintDir() const {
       ->GetPrettyPrintDir();
 }
 
+void CompilationContext::enableCompileCacheWithDir(std::string_view dir,
+                                                   std::string_view version,
+                                                   int64_t max_bytes) {
+  cache_ = std::make_unique<CompileCache>(std::filesystem::path(dir),
+                                          max_bytes);
+  cache_version_ = version;
+}
+
 } // namespace spu::compiler
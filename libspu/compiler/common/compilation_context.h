@@ -22,6 +22,8 @@
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/Pass/PassManager.h"
 
+#include "libspu/compiler/common/compile_cache.h"
+
 namespace mlir {
 class PassManager;
 }
@@ -51,6 +53,18 @@ class CompilationContext {
 
   std::filesystem::path getPrettyPrintDir() const;
 
+  /// Enable the on disk compile cache in dir, `version` is the version of the
+  /// compiler which is part of cache keys.
+  /// If dir does not exist, this api will create new folder
+  void enableCompileCacheWithDir(
+      std::string_view dir, std::string_view version,
+      int64_t max_bytes = CompileCache::kDefaultMaxBytes);
+
+  /// Compile cache, nullptr if disabled.
+  const CompileCache *getCompileCache() const { return cache_.get(); }
+
+  std::string getCompileCacheVersion() const { return cache_version_; }
+
 private:
   std::unique_ptr<mlir::PassManager::IRPrinterConfig>
   getIRPrinterConfig() const;
@@ -59,6 +73,9 @@ class CompilationContext {
   std::unique_ptr<mlir::PassManager::IRPrinterConfig> pp_config_;
 
   std::string input_vis_;
+
+  std::unique_ptr<CompileCache> cache_;
+  std::string cache_version_;
 };
 
 } // namespace spu::compiler
@@ -0,0 +1,280 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libspu/compiler/common/compile_cache.h"
+
+#include <dlfcn.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "fmt/format.h"
+#include "llvm/Config/llvm-config.h"
+#include "spdlog/spdlog.h"
+#include "yacl/crypto/base/hash/hash_utils.h"
+
+#include "libspu/core/prelude.h"
+
+namespace spu::compiler {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// Bump when the layout of cached entries changes.
+constexpr char kCacheFormat[] = "pphlo-cache-v2";
+
+constexpr char kCodeExt[] = ".pphlo";
+constexpr char kMetaExt[] = ".meta";
+
+std::string sha256Hex(const std::string &buf) {
+  std::string hex;
+  for (auto byte : yacl::crypto::Sha256(buf)) {
+    hex += fmt::format("{:02x}", static_cast<uint8_t>(byte));
+  }
+  return hex;
+}
+
+// Leading lines of the metadata, binds a module file to its key.
+std::string metaHeader(const std::string &key, const std::string &code) {
+  return fmt::format("key: {}\ncode_sha256: {}\n", key, sha256Hex(code));
+}
+
+std::optional<std::string> readFile(const fs::path &path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return std::nullopt;
+  }
+  std::stringstream ss;
+  ss << in.rdbuf();
+  if (in.bad()) {
+    return std::nullopt;
+  }
+  return ss.str();
+}
+
+// Write to a temporary file of this process and rename it into place, rename
+// within a filesystem is atomic.
+bool writeFileAtomic(const fs::path &path, const std::string &content) {
+  static std::atomic<int64_t> counter{0};
+  auto tmp = path;
+  tmp += fmt::format(".tmp.{}.{}.{}", ::getpid(),
+                     std::hash<std::thread::id>()(std::this_thread::get_id()),
+                     counter++);
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    out.write(content.data(), static_cast<std::streamsize>(content.size()));
+    if (!out) {
+      std::error_code ec;
+      fs::remove(tmp, ec);
+      return false;
+    }
+  }
+  std::error_code ec;
+  fs::rename(tmp, path, ec);
+  if (ec) {
+    fs::remove(tmp, ec);
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+CompileCache::CompileCache(std::filesystem::path dir, int64_t max_bytes)
+    : dir_(std::move(dir)), max_bytes_(max_bytes) {
+  SPU_ENFORCE(max_bytes_ > 0, "invalid cache size {}", max_bytes_);
+  std::error_code ec;
+  fs::create_directories(dir_, ec);
+  SPU_ENFORCE(!ec, "failed to create compile cache dir {}, {}", dir_.string(),
+              ec.message());
+}
+
+std::string CompileCache::makeKey(const std::string &serialized_ir,
+                                  const std::string &ir_type,
+                                  const std::string &options,
+                                  const std::string &version) {
+  // Length prefixed fields, so different splits never collide.
+  std::string buf;
+  for (const auto *field : {&serialized_ir, &ir_type, &options, &version}) {
+    buf += fmt::format("{}:", field->size());
+    buf += *field;
+  }
+  buf += kCacheFormat;
+  buf += buildFingerprint();
+
+  return sha256Hex(buf);
+}
+
+const std::string &CompileCache::buildFingerprint() {
+  static const std::string fingerprint = [] {
+    auto fp = fmt::format("cxx={};llvm={}", __VERSION__, LLVM_VERSION_STRING);
+    // The release version alone misses local and nightly rebuilds, so bind
+    // keys to the binary which holds this compiler as well.
+    Dl_info info;
+    if (::dladdr(reinterpret_cast<void *>(&CompileCache::buildFingerprint),
+                 &info) == 0 ||
+        info.dli_fname == nullptr) {
+      SPDLOG_WARN("failed to locate compiler binary for compile cache keys");
+      return fp;
+    }
+    const fs::path binary(info.dli_fname);
+    std::error_code size_ec;
+    std::error_code time_ec;
+    const auto size = fs::file_size(binary, size_ec);
+    const auto mtime = fs::last_write_time(binary, time_ec);
+    if (size_ec || time_ec) {
+      SPDLOG_WARN("failed to stat compiler binary {}", binary.string());
+      return fp;
+    }
+    fp += fmt::format(";binary_size={};binary_mtime={}", size,
+                      mtime.time_since_epoch().count());
+    return fp;
+  }();
+  return fingerprint;
+}
+
+std::filesystem::path CompileCache::entryPath(const std::string &key,
+                                              const char *ext) const {
+  SPU_ENFORCE(key.size() > 2, "invalid cache key {}", key);
+  return dir_ / key.substr(0, 2) / (key + ext);
+}
+
+void CompileCache::remove(const std::string &key) const {
+  std::error_code ec;
+  fs::remove(entryPath(key, kCodeExt), ec);
+  fs::remove(entryPath(key, kMetaExt), ec);
+}
+
+std::optional<std::string> CompileCache::lookup(const std::string &key) const {
+  const auto path = entryPath(key, kCodeExt);
+  auto code = readFile(path);
+  if (!code.has_value()) {
+    stats().misses++;
+    return std::nullopt;
+  }
+
+  // A module without matching metadata is damaged or half evicted, drop it
+  // and compile again.
+  const auto meta = readFile(entryPath(key, kMetaExt));
+  if (!meta.has_value() || meta->rfind(metaHeader(key, *code), 0) != 0) {
+    SPDLOG_WARN("dropping invalid compile cache entry {}", key);
+    remove(key);
+    stats().misses++;
+    return std::nullopt;
+  }
+
+  // Refresh the entry for LRU eviction, the entry may be evicted by another
+  // process meanwhile which is fine as the content is already read.
+  std::error_code ec;
+  fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+  stats().hits++;
+  return code;
+}
+
+void CompileCache::store(const std::string &key, const std::string &code,
+                         const std::string &info) const {
+  std::error_code ec;
+  fs::create_directories(entryPath(key, kCodeExt).parent_path(), ec);
+  if (ec) {
+    SPDLOG_WARN("failed to create compile cache entry dir, {}", ec.message());
+    return;
+  }
+
+  // Metadata goes first, a visible module always has its metadata.
+  if (!writeFileAtomic(entryPath(key, kMetaExt),
+                       metaHeader(key, code) + info) ||
+      !writeFileAtomic(entryPath(key, kCodeExt), code)) {
+    SPDLOG_WARN("failed to write compile cache entry {}", key);
+    return;
+  }
+  stats().stores++;
+
+  evict();
+}
+
+void CompileCache::evict() const {
+  struct Entry {
+    fs::path path;
+    fs::file_time_type mtime;
+    int64_t bytes;
+  };
+
+  std::vector<Entry> entries;
+  int64_t total = 0;
+  std::error_code ec;
+  for (fs::recursive_directory_iterator iter(dir_, ec), end;
+       !ec && iter != end; iter.increment(ec)) {
+    // Entries may be removed by other processes at any time.
+    std::error_code entry_ec;
+    if (!iter->is_regular_file(entry_ec) ||
+        iter->path().extension() != kCodeExt) {
+      continue;
+    }
+    Entry entry{iter->path(), iter->last_write_time(entry_ec), 0};
+    const auto bytes = iter->file_size(entry_ec);
+    if (entry_ec) {
+      continue;
+    }
+    entry.bytes = static_cast<int64_t>(bytes);
+
+    auto meta = entry.path;
+    meta.replace_extension(kMetaExt);
+    const auto meta_bytes = fs::file_size(meta, entry_ec);
+    if (!entry_ec) {
+      entry.bytes += static_cast<int64_t>(meta_bytes);
+    }
+
+    total += entry.bytes;
+    entries.push_back(std::move(entry));
+  }
+
+  if (total <= max_bytes_) {
+    return;
+  }
+
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry &a, const Entry &b) { return a.mtime < b.mtime; });
+  for (const auto &entry : entries) {
+    if (total <= max_bytes_) {
+      break;
+    }
+    auto meta = entry.path;
+    meta.replace_extension(kMetaExt);
+    // Module first, so a visible module always has its metadata.
+    if (fs::remove(entry.path, ec)) {
+      stats().evictions++;
+    }
+    fs::remove(meta, ec);
+    total -= entry.bytes;
+  }
+}
+
+CompileCache::Stats &CompileCache::stats() {
+  static Stats stats;
+  return stats;
+}
+
+std::string CompileCache::statsString() {
+  const auto &s = stats();
+  return fmt::format("hits={}, misses={}, stores={}, evictions={}",
+                     s.hits.load(), s.misses.load(), s.stores.load(),
+                     s.evictions.load());
+}
+
+} // namespace spu::compiler
@@ -0,0 +1,87 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+namespace spu::compiler {
+
+/// A content addressed, on disk cache of compiled pphlo modules, shared by
+/// all processes which point to the same directory.
+///
+/// Layout:
+///   <dir>/<key[0:2]>/<key>.pphlo  compiled module
+///   <dir>/<key[0:2]>/<key>.meta   key, module digest and source info
+/// A module is only served if its metadata records the same key and digest,
+/// so truncated or foreign files are dropped as misses. Entries are written
+/// to a unique temporary file and renamed into place, so readers never
+/// observe a partial entry. Entries are evicted in least recently used order
+/// (file modification time, refreshed on hit) once the cache grows beyond
+/// `max_bytes`.
+class CompileCache {
+public:
+  struct Stats {
+    std::atomic<int64_t> hits{0};
+    std::atomic<int64_t> misses{0};
+    std::atomic<int64_t> stores{0};
+    std::atomic<int64_t> evictions{0};
+  };
+
+  static constexpr int64_t kDefaultMaxBytes = 1LL << 30;
+
+  explicit CompileCache(std::filesystem::path dir,
+                        int64_t max_bytes = kDefaultMaxBytes);
+
+  /// Key of a compilation, covers everything the compiled module depends on.
+  static std::string makeKey(const std::string &serialized_ir,
+                             const std::string &ir_type,
+                             const std::string &options,
+                             const std::string &version);
+
+  /// Identity of the compiler binary: toolchain, llvm version and the
+  /// shared object or executable it is linked into. Any rebuild changes it.
+  static const std::string &buildFingerprint();
+
+  std::optional<std::string> lookup(const std::string &key) const;
+
+  /// `info` is free form text kept in the metadata for inspection.
+  void store(const std::string &key, const std::string &code,
+             const std::string &info) const;
+
+  /// Remove least recently used entries until the cache fits `max_bytes`.
+  void evict() const;
+
+  const std::filesystem::path &dir() const { return dir_; }
+
+  /// Statistics of all caches in this process.
+  static Stats &stats();
+
+  static std::string statsString();
+
+private:
+  std::filesystem::path entryPath(const std::string &key,
+                                  const char *ext) const;
+
+  void remove(const std::string &key) const;
+
+  std::filesystem::path dir_;
+  int64_t max_bytes_;
+};
+
+} // namespace spu::compiler
@@ -0,0 +1,154 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libspu/compiler/common/compile_cache.h"
+
+#include <chrono>
+#include <fstream>
+
+#include "gtest/gtest.h"
+
+namespace spu::compiler {
+
+class CompileCacheTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    dir_ = std::filesystem::temp_directory_path() /
+           ("spu_compile_cache_test_" +
+            std::to_string(
+                std::chrono::steady_clock::now().time_since_epoch().count()));
+  }
+
+  void TearDown() override { std::filesystem::remove_all(dir_); }
+
+  std::filesystem::path entry(const std::string &key, const char *ext) const {
+    return dir_ / key.substr(0, 2) / (key + ext);
+  }
+
+  int64_t dirBytes() const {
+    int64_t bytes = 0;
+    for (const auto &entry :
+         std::filesystem::recursive_directory_iterator(dir_)) {
+      bytes += entry.is_regular_file() ? entry.file_size() : 0;
+    }
+    return bytes;
+  }
+
+  std::filesystem::path dir_;
+};
+
+TEST_F(CompileCacheTest, Key) {
+  auto key = CompileCache::makeKey("ir", "hlo", "opts", "0.1");
+  EXPECT_EQ(key.size(), 64);
+  EXPECT_EQ(key, CompileCache::makeKey("ir", "hlo", "opts", "0.1"));
+
+  EXPECT_NE(key, CompileCache::makeKey("ir2", "hlo", "opts", "0.1"));
+  EXPECT_NE(key, CompileCache::makeKey("ir", "mhlo", "opts", "0.1"));
+  EXPECT_NE(key, CompileCache::makeKey("ir", "hlo", "opts2", "0.1"));
+  EXPECT_NE(key, CompileCache::makeKey("ir", "hlo", "opts", "0.2"));
+  // Fields are not simply concatenated.
+  EXPECT_NE(CompileCache::makeKey("a", "bc", "", ""),
+            CompileCache::makeKey("ab", "c", "", ""));
+
+  // Binary size and modification time are part of the fingerprint.
+  EXPECT_NE(CompileCache::buildFingerprint().find("binary_mtime="),
+            std::string::npos);
+}
+
+TEST_F(CompileCacheTest, StoreLookup) {
+  CompileCache cache(dir_);
+  auto key = CompileCache::makeKey("ir", "hlo", "", "");
+
+  const auto misses = CompileCache::stats().misses.load();
+  EXPECT_FALSE(cache.lookup(key).has_value());
+  EXPECT_EQ(CompileCache::stats().misses.load(), misses + 1);
+
+  cache.store(key, "module", "meta");
+
+  // Another instance shares the same directory.
+  CompileCache other(dir_);
+  const auto hits = CompileCache::stats().hits.load();
+  auto code = other.lookup(key);
+  ASSERT_TRUE(code.has_value());
+  EXPECT_EQ(*code, "module");
+  EXPECT_EQ(CompileCache::stats().hits.load(), hits + 1);
+
+  // No temporary file is left behind.
+  int64_t files = 0;
+  for (const auto &entry :
+       std::filesystem::recursive_directory_iterator(dir_)) {
+    files += entry.is_regular_file() ? 1 : 0;
+  }
+  EXPECT_EQ(files, 2);
+}
+
+TEST_F(CompileCacheTest, InvalidEntry) {
+  CompileCache cache(dir_);
+  auto key = CompileCache::makeKey("ir", "hlo", "", "");
+  cache.store(key, "module", "info");
+  ASSERT_TRUE(cache.lookup(key).has_value());
+
+  // Module does not match the digest in its metadata.
+  {
+    std::ofstream out(entry(key, ".pphlo"), std::ios::trunc);
+    out << "modul";
+  }
+  EXPECT_FALSE(cache.lookup(key).has_value());
+  EXPECT_FALSE(std::filesystem::exists(entry(key, ".pphlo")));
+  EXPECT_FALSE(std::filesystem::exists(entry(key, ".meta")));
+
+  // Module without metadata.
+  cache.store(key, "module", "info");
+  std::filesystem::remove(entry(key, ".meta"));
+  EXPECT_FALSE(cache.lookup(key).has_value());
+
+  cache.store(key, "module", "info");
+  EXPECT_EQ(cache.lookup(key), "module");
+}
+
+TEST_F(CompileCacheTest, Evict) {
+  using std::chrono::hours;
+  const std::string code(100, 'x');
+
+  std::vector<std::string> keys;
+  for (int i = 0; i < 3; ++i) {
+    keys.push_back(CompileCache::makeKey(std::to_string(i), "hlo", "", ""));
+  }
+
+  CompileCache(dir_).store(keys[0], code, "info");
+  CompileCache(dir_).store(keys[1], code, "info");
+  // Room for the two entries stored so far, all entries have the same size.
+  CompileCache cache(dir_, dirBytes());
+
+  // Pin modification times, so the order does not depend on the resolution
+  // of the file system clock.
+  const auto now = std::filesystem::file_time_type::clock::now();
+  std::filesystem::last_write_time(entry(keys[0], ".pphlo"), now - hours(2));
+  std::filesystem::last_write_time(entry(keys[1], ".pphlo"), now - hours(1));
+
+  // Refresh the first entry, so the second one is the least recently used.
+  EXPECT_TRUE(cache.lookup(keys[0]).has_value());
+  EXPECT_GT(std::filesystem::last_write_time(entry(keys[0], ".pphlo")),
+            now - hours(1));
+
+  const auto evictions = CompileCache::stats().evictions.load();
+  cache.store(keys[2], code, "info");
+  EXPECT_EQ(CompileCache::stats().evictions.load(), evictions + 1);
+
+  EXPECT_TRUE(cache.lookup(keys[0]).has_value());
+  EXPECT_FALSE(cache.lookup(keys[1]).has_value());
+  EXPECT_TRUE(cache.lookup(keys[2]).has_value());
+}
+
+} // namespace spu::compiler
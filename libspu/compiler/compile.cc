@@ -23,14 +23,18 @@
 #include "spdlog/spdlog.h"
 
 #include "libspu/compiler/codegen/codegen.h"
+#include "libspu/compiler/common/compilation_context.h"
 #include "libspu/compiler/core/core.h"
 #include "libspu/compiler/front_end/fe.h"
 #include "libspu/core/prelude.h"
 
 namespace spu::compiler {
 
-std::string compile(CompilationContext *ctx, const std::string &serialized_ir,
-                    const std::string &ir_type) {
+namespace {
+
+std::string compileImpl(CompilationContext *ctx,
+                        const std::string &serialized_ir,
+                        const std::string &ir_type) {
   // Call front end
   FE fe(ctx);
   auto mlir_module = fe.doit(serialized_ir, ir_type);
@@ -45,4 +49,33 @@ std::string compile(CompilationContext *ctx, const std::string &serialized_ir,
   return codegen.doit(mlir_module.get());
 }
 
+} // namespace
+
+std::string compile(CompilationContext *ctx, const std::string &serialized_ir,
+                    const std::string &ir_type) {
+  const auto *cache = ctx->getCompileCache();
+  // IR dumps need a real compilation.
+  if (cache == nullptr || ctx->hasPrettyPrintEnabled()) {
+    return compileImpl(ctx, serialized_ir, ir_type);
+  }
+
+  const auto version = ctx->getCompileCacheVersion();
+  const auto key =
+      CompileCache::makeKey(serialized_ir, ir_type,
+                            ctx->getInputVisibilityString(), version);
+  if (auto code = cache->lookup(key)) {
+    SPDLOG_DEBUG("compile cache hit {}, {}", key, CompileCache::statsString());
+    return *code;
+  }
+
+  auto code = compileImpl(ctx, serialized_ir, ir_type);
+  cache->store(key, code,
+               fmt::format("ir_type: {}\nversion: {}\nbuild: {}\n"
+                           "ir_bytes: {}\ncode_bytes: {}\n",
+                           ir_type, version, CompileCache::buildFingerprint(),
+                           serialized_ir.size(), code.size()));
+  SPDLOG_DEBUG("compile cache miss {}, {}", key, CompileCache::statsString());
+  return code;
+}
+
 } // namespace spu::compiler
@@ -19,6 +19,7 @@
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Transforms/Passes.h"
+#include "spdlog/spdlog.h"
 
 #include "libspu/compiler/common/compilation_context.h"
 #include "libspu/compiler/passes/passes.h"
@@ -39,17 +40,31 @@ void Core::doit(mlir::ModuleOp module) {
   if (ret.failed()) {
     SPU_THROW("Run core pipeline failed");
   }
+
+  module.walk([](mlir::func::FuncOp func) {
+    auto naive =
+        func->getAttrOfType<mlir::IntegerAttr>("pphlo.naive_peak_bytes");
+    auto planned =
+        func->getAttrOfType<mlir::IntegerAttr>("pphlo.planned_peak_bytes");
+    if (naive && planned) {
+      SPDLOG_DEBUG("memory plan of @{}: naive peak {} bytes, planned peak {} "
+                   "bytes",
+                   func.getSymName().str(), naive.getInt(), planned.getInt());
+    }
+  });
 }
 
 void Core::buildPipeline(mlir::PassManager *pm) {
   // lowering
   auto &optPM = pm->nest<mlir::func::FuncOp>();
   optPM.addPass(mlir::pphlo::createOptimizeMaxPoolingPass());
+  optPM.addPass(mlir::pphlo::createFuseNNPatternsPass());
   optPM.addPass(mlir::pphlo::createDecomposeComparisonPass());
   optPM.addPass(mlir::pphlo::createDecomposeMinMaxPass());
   optPM.addPass(mlir::pphlo::createOptimizeSqrtPlusEps());
   optPM.addPass(mlir::pphlo::createRewriteDivSqrtPatterns());
   optPM.addPass(mlir::pphlo::createExpandSecretGatherPass());
+  optPM.addPass(mlir::pphlo::createOptimizeSecretBranchesPass());
 
   optPM.addPass(mlir::createCSEPass());
 
@@ -60,8 +75,16 @@ void Core::buildPipeline(mlir::PassManager *pm) {
 
   optPM.addPass(mlir::pphlo::createOptimizeSelectPass());
 
+  optPM.addPass(mlir::pphlo::createUnrollWhileLoopsPass());
+  optPM.addPass(mlir::pphlo::createRebalanceChainsPass());
+  optPM.addPass(mlir::pphlo::createBatchSecretOpsPass());
+  optPM.addPass(mlir::pphlo::createInferValidBitsPass());
+
   optPM.addPass(mlir::createLoopInvariantCodeMotionPass());
   optPM.addPass(mlir::createCSEPass());
+
+  // Must be the last one, slots depend on the final op order.
+  optPM.addPass(mlir::pphlo::createPlanMemoryPass());
 }
 
 } // namespace spu::compiler
@@ -0,0 +1,252 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/TypeSwitch.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/TopologicalSortUtils.h"
+
+#include "libspu/compiler/passes/cost_model.h"
+#include "libspu/compiler/passes/pass_details.h"
+#include "libspu/compiler/passes/passes.h"
+#include "libspu/dialect/pphlo_ops.h"
+#include "libspu/dialect/pphlo_types.h"
+
+namespace mlir::pphlo {
+
+namespace {
+
+// Number of online rounds of one op, zero means the op is local (or its
+// cost is unknown) and is never batched.
+int64_t estimateRounds(Operation *op) {
+  return llvm::TypeSwitch<Operation *, int64_t>(op)
+      .Case<LessOp, GreaterOp, LessEqualOp, GreaterEqualOp, EqualOp,
+            NotEqualOp, MulOp, DivOp, PowOp, ReciprocalOp, RsqrtOp, SqrtOp,
+            ExpOp, Expm1Op, LogOp, Log1pOp, LogisticOp, TanhOp, GeluOp>(
+          [](Operation *op) {
+            return CostModel::getDefault().estimate(op).rounds;
+          })
+      .Default([](auto) { return 0; });
+}
+
+std::string typeToString(Type t) {
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  os << t;
+  return os.str();
+}
+
+DenseIntElementsAttr ConvertDimensions(OpBuilder *builder,
+                                       llvm::ArrayRef<int64_t> dims) {
+  return DenseIntElementsAttr::get(
+      RankedTensorType::get({static_cast<int64_t>(dims.size())},
+                            builder->getIntegerType(64)),
+      dims);
+}
+
+// Idea here:
+//   %0 = less(%a, %b)
+//   %1 = less(%c, %d)     // independent of %0
+// into
+//   %l = concatenate(reshape(%a), reshape(%c))
+//   %r = concatenate(reshape(%b), reshape(%d))
+//   %t = less(%l, %r)
+//   %0 = reshape(slice(%t))
+//   %1 = reshape(slice(%t))
+// Rational:
+// Each secret comparison/multiplication/approximation pays its rounds no
+// matter how many elements it processes. Ops that sit at the same position of
+// the critical path (in rounds estimated by CostModel) are independent of
+// each other, merging them into one kernel call pays these rounds only once.
+struct BatchSecretOps : public BatchSecretOpsBase<BatchSecretOps> {
+  void runOnOperation() override {
+    llvm::SmallVector<Block *> blocks;
+    getOperation().walk([&](Block *block) { blocks.push_back(block); });
+
+    for (auto *block : blocks) {
+      if (batchBlock(block)) {
+        // Users of a merged op may now appear before the batched op.
+        (void)sortTopologically(block);
+      }
+    }
+  }
+
+private:
+  bool isCandidate(Operation *op) const {
+    if (op->getNumResults() != 1 || op->getNumOperands() == 0) {
+      return false;
+    }
+
+    TypeTools tools;
+    auto result_type = op->getResultTypes()[0].dyn_cast<RankedTensorType>();
+    if (!result_type || !result_type.hasStaticShape() ||
+        tools.getTypeVisibility(result_type) != Visibility::VIS_SECRET) {
+      return false;
+    }
+
+    const auto numel = result_type.getNumElements();
+    if (numel == 0 || numel > max_batch_numel_) {
+      return false;
+    }
+
+    return llvm::all_of(op->getOperandTypes(), [&](Type t) {
+      auto rt = t.dyn_cast<RankedTensorType>();
+      return rt && rt.hasStaticShape() && rt.getNumElements() == numel;
+    });
+  }
+
+  bool batchBlock(Block *block) {
+    // Estimated rounds until the results of an op are available.
+    llvm::DenseMap<Operation *, int64_t> ready;
+    std::map<std::pair<int64_t, std::string>, size_t> group_index;
+    std::vector<llvm::SmallVector<Operation *>> groups;
+
+    for (auto &op : *block) {
+      int64_t start = 0;
+      // Also look into nested regions, values may be captured implicitly.
+      op.walk([&](Operation *nested) {
+        for (auto operand : nested->getOperands()) {
+          auto *def = operand.getDefiningOp();
+          if (def != nullptr && def->getBlock() == block) {
+            start = std::max(start, ready.lookup(def));
+          }
+        }
+      });
+
+      const int64_t rounds = estimateRounds(&op);
+      ready[&op] = start + rounds;
+
+      if (rounds == 0 || !isCandidate(&op)) {
+        continue;
+      }
+
+      std::string signature = op.getName().getStringRef().str();
+      for (auto t : op.getOperandTypes()) {
+        signature += "," + typeToString(getElementTypeOrSelf(t));
+      }
+      signature += "->" + typeToString(getElementTypeOrSelf(op.getResult(0)));
+
+      auto key = std::make_pair(start, std::move(signature));
+      auto iter = group_index.find(key);
+      if (iter == group_index.end()) {
+        iter = group_index.emplace(std::move(key), groups.size()).first;
+        groups.emplace_back();
+      }
+      groups[iter->second].push_back(&op);
+    }
+
+    bool changed = false;
+    for (const auto &group : groups) {
+      // Greedily pack members into batches bounded by max_batch_numel_.
+      llvm::SmallVector<Operation *> batch;
+      int64_t batch_numel = 0;
+      auto flush = [&]() {
+        if (batch.size() > 1) {
+          rewriteBatch(batch);
+          changed = true;
+        }
+        batch.clear();
+        batch_numel = 0;
+      };
+
+      for (auto *op : group) {
+        auto numel =
+            op->getResultTypes()[0].cast<RankedTensorType>().getNumElements();
+        if (batch_numel + numel > max_batch_numel_) {
+          flush();
+        }
+        batch.push_back(op);
+        batch_numel += numel;
+      }
+      flush();
+    }
+
+    return changed;
+  }
+
+  static Value flatten(OpBuilder *builder, Location loc, Value v) {
+    auto type = v.getType().cast<RankedTensorType>();
+    if (type.getRank() == 1) {
+      return v;
+    }
+    return builder->create<ReshapeOp>(
+        loc,
+        RankedTensorType::get({type.getNumElements()}, type.getElementType()),
+        v);
+  }
+
+  static void rewriteBatch(llvm::ArrayRef<Operation *> ops) {
+    auto *first = ops.front();
+    // Members are visited in block order, every operand is defined before the
+    // last one.
+    OpBuilder builder(ops.back());
+
+    llvm::SmallVector<Location> locs;
+    int64_t total = 0;
+    for (auto *op : ops) {
+      locs.push_back(op->getLoc());
+      total +=
+          op->getResultTypes()[0].cast<RankedTensorType>().getNumElements();
+    }
+    auto loc = builder.getFusedLoc(locs);
+
+    llvm::SmallVector<Value> operands;
+    for (unsigned idx = 0; idx < first->getNumOperands(); ++idx) {
+      llvm::SmallVector<Value> flat;
+      for (auto *op : ops) {
+        flat.push_back(flatten(&builder, op->getLoc(), op->getOperand(idx)));
+      }
+      auto el_type = getElementTypeOrSelf(first->getOperand(idx));
+      operands.push_back(builder.create<ConcatenateOp>(
+          loc, RankedTensorType::get({total}, el_type), flat,
+          builder.getI64IntegerAttr(0)));
+    }
+
+    auto result_el_type = getElementTypeOrSelf(first->getResult(0));
+    OperationState state(loc, first->getName());
+    state.addOperands(operands);
+    state.addTypes(RankedTensorType::get({total}, result_el_type));
+    state.addAttributes(first->getAttrs());
+    auto *batched = builder.create(state);
+
+    int64_t offset = 0;
+    for (auto *op : ops) {
+      auto result_type = op->getResultTypes()[0].cast<RankedTensorType>();
+      const auto numel = result_type.getNumElements();
+      Value piece = builder.create<SliceOp>(
+          op->getLoc(), RankedTensorType::get({numel}, result_el_type),
+          batched->getResult(0), ConvertDimensions(&builder, {offset}),
+          ConvertDimensions(&builder, {offset + numel}),
+          ConvertDimensions(&builder, {1}));
+      if (result_type.getRank() != 1) {
+        piece = builder.create<ReshapeOp>(op->getLoc(), result_type, piece);
+      }
+      op->getResult(0).replaceAllUsesWith(piece);
+      op->erase();
+      offset += numel;
+    }
+  }
+};
+
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> createBatchSecretOpsPass() {
+  return std::make_unique<BatchSecretOps>();
+}
+
+} // namespace mlir::pphlo
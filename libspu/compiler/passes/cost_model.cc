@@ -0,0 +1,445 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libspu/compiler/passes/cost_model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+#include "google/protobuf/util/json_util.h"
+#include "llvm/ADT/TypeSwitch.h"
+#include "llvm/Support/Format.h"
+
+#include "libspu/core/prelude.h"
+#include "libspu/dialect/pphlo_ops.h"
+#include "libspu/dialect/pphlo_types.h"
+#include "libspu/mpc/tools/complexity.pb.h"
+
+namespace mlir::pphlo {
+
+namespace {
+
+struct BuiltinEntry {
+  const char *protocol;
+  const char *kernel;
+  const char *latency;
+  const char *comm;
+};
+
+// Snapshot of docs/reference/complexity.json, regenerate with
+// `bazel run //libspu/mpc/tools:complexity`.
+constexpr BuiltinEntry kBuiltinTable[] = {
+    {"SEMI2K", "a2b", "(log(K)+1)*log(N)", "(2*log(K)+1)*2*K*(N-1)*(N-1)"},
+    {"SEMI2K", "b2a", "1", "K*(N-1)"},
+    {"SEMI2K", "a2p", "1", "K*(N-1)"},
+    {"SEMI2K", "b2p", "1", "K*(N-1)"},
+    {"SEMI2K", "add_bb", "log(K)+1", "log(K)*K*2+K"},
+    {"SEMI2K", "add_aa", "0", "0"},
+    {"SEMI2K", "add_ap", "0", "0"},
+    {"SEMI2K", "mul_aa", "1", "K*2*(N-1)"},
+    {"SEMI2K", "mul_ap", "0", "0"},
+    {"SEMI2K", "mmul_aa", "1", "K*2*(N-1)*m*n"},
+    {"SEMI2K", "mmul_ap", "0", "0"},
+    {"SEMI2K", "trunc_a", "1", "K*(N-1)"},
+    {"SEMI2K", "xor_bb", "0", "0"},
+    {"SEMI2K", "xor_bp", "0", "0"},
+    {"SEMI2K", "and_bb", "1", "K*2*(N-1)"},
+    {"SEMI2K", "and_bp", "0", "0"},
+    {"ABY3", "a2b", "log(K)+1+1", "log(K)*K+K*2"},
+    {"ABY3", "b2a", "TODO", "TODO"},
+    {"ABY3", "a2p", "1", "K"},
+    {"ABY3", "b2p", "1", "K"},
+    {"ABY3", "add_bb", "log(K)+1", "log(K)*K*2+K"},
+    {"ABY3", "add_aa", "0", "0"},
+    {"ABY3", "add_ap", "0", "0"},
+    {"ABY3", "mul_aa", "1", "K"},
+    {"ABY3", "mul_ap", "0", "0"},
+    {"ABY3", "mmul_aa", "1", "K*m*n"},
+    {"ABY3", "mmul_ap", "0", "0"},
+    {"ABY3", "trunc_a", "3", "4*K"},
+    {"ABY3", "xor_bb", "0", "0"},
+    {"ABY3", "xor_bp", "0", "0"},
+    {"ABY3", "and_bb", "1", "K"},
+    {"ABY3", "and_bp", "0", "0"},
+};
+
+std::string toUpper(std::string_view str) {
+  std::string ret(str);
+  std::transform(ret.begin(), ret.end(), ret.begin(),
+                 [](unsigned char c) { return std::toupper(c); });
+  return ret;
+}
+
+int64_t getNumel(Type t) {
+  if (auto rt = t.dyn_cast<RankedTensorType>()) {
+    return rt.hasStaticShape() ? rt.getNumElements() : 0;
+  }
+  return 1;
+}
+
+OpCost scale(OpCost cost, int64_t times) {
+  cost.rounds *= times;
+  cost.bytes *= times;
+  cost.flops *= times;
+  return cost;
+}
+
+} // namespace
+
+CostModel::CostModel(std::string protocol, size_t field_bits,
+                     size_t num_parties)
+    : protocol_(std::move(protocol)),
+      params_({{"K", field_bits}, {"N", num_parties}}) {}
+
+void CostModel::addEntry(const std::string &kernel, std::string_view latency,
+                         std::string_view comm) {
+  auto parse = [](std::string_view expr) -> spu::ce::CExpr {
+    if (expr.empty() || expr == "TODO") {
+      return nullptr;
+    }
+    return spu::ce::Parse(expr);
+  };
+  entries_[kernel] = Entry{parse(latency), parse(comm)};
+}
+
+CostModel CostModel::create(std::string_view protocol, size_t field_bits,
+                            size_t num_parties) {
+  CostModel model(toUpper(protocol), field_bits, num_parties);
+  for (const auto &entry : kBuiltinTable) {
+    if (model.protocol_ == entry.protocol) {
+      model.addEntry(entry.kernel, entry.latency, entry.comm);
+    }
+  }
+  SPU_ENFORCE(!model.entries_.empty(), "no builtin complexity table for {}",
+              protocol);
+  return model;
+}
+
+CostModel CostModel::fromJson(std::string_view json, std::string_view protocol,
+                              size_t field_bits, size_t num_parties) {
+  spu::mpc::internal::ComplexityReport report;
+  SPU_ENFORCE(google::protobuf::util::JsonStringToMessage(
+                  std::string(json), &report)
+                  .ok(),
+              "invalid complexity report");
+
+  CostModel model(toUpper(protocol), field_bits, num_parties);
+  for (const auto &single : report.reports()) {
+    if (toUpper(single.protocol()) != model.protocol_) {
+      continue;
+    }
+    for (const auto &entry : single.entries()) {
+      model.addEntry(entry.kernel(), entry.latency(), entry.comm());
+    }
+  }
+  SPU_ENFORCE(!model.entries_.empty(), "protocol {} not found in report",
+              protocol);
+  return model;
+}
+
+const CostModel &CostModel::getDefault() {
+  static const CostModel model = create("SEMI2K", 64, 2);
+  return model;
+}
+
+OpCost CostModel::kernelCost(std::string_view kernel, int64_t numel, int64_t m,
+                             int64_t n) const {
+  auto params = params_;
+  params["m"] = m;
+  params["n"] = n;
+  const bool is_mmul = kernel.rfind("mmul", 0) == 0;
+  const auto k = static_cast<int64_t>(params_.at("K"));
+
+  OpCost cost;
+  cost.flops = is_mmul ? m * n : numel;
+
+  // Unknown kernels (or kernels without formula) are assumed to be one round
+  // and one ring element per element.
+  auto itr = entries_.find(kernel);
+  if (itr == entries_.end() || itr->second.latency == nullptr) {
+    cost.rounds = 1;
+  } else {
+    cost.rounds = static_cast<int64_t>(itr->second.latency->eval(params));
+  }
+
+  int64_t bits = 0;
+  if (itr == entries_.end() || itr->second.comm == nullptr) {
+    bits = k * (is_mmul ? m * n : numel);
+  } else {
+    // matmul formulas already cover the whole shape.
+    bits = static_cast<int64_t>(itr->second.comm->eval(params)) *
+           (is_mmul ? 1 : numel);
+  }
+  cost.bytes = (bits + 7) / 8;
+
+  return cost;
+}
+
+OpCost CostModel::estimate(Operation *op) const {
+  TypeTools tools;
+  auto is_secret = [&](Type t) {
+    return tools.getTypeVisibility(t) == Visibility::VIS_SECRET;
+  };
+  auto is_fxp = [&](Type t) {
+    return tools.getExpressedType(t).isa<FloatType>();
+  };
+
+  const bool any_secret = llvm::any_of(op->getOperandTypes(), is_secret) ||
+                          llvm::any_of(op->getResultTypes(), is_secret);
+  const int64_t numel = op->getNumResults() > 0
+                            ? getNumel(op->getResultTypes()[0])
+                            : (op->getNumOperands() > 0
+                                   ? getNumel(op->getOperandTypes()[0])
+                                   : 0);
+
+  OpCost cost;
+  cost.flops = numel;
+
+  // All public ops are evaluated locally in plaintext.
+  if (!any_secret) {
+    return cost;
+  }
+
+  // Local ops keep the elementwise flops, kernels account their own.
+  cost.flops = 0;
+  auto call = [&](std::string_view kernel, int64_t times = 1) {
+    cost += scale(kernelCost(kernel, numel), times);
+  };
+
+  // Truncation follows a fxp x fxp multiplication.
+  auto needs_trunc = [&](Operation *mul) {
+    return llvm::all_of(mul->getOperandTypes(), is_fxp) &&
+           is_fxp(mul->getResultTypes()[0]);
+  };
+
+  // The following decompositions follow the default HAL lowering, nonlinear
+  // approximations are coarse counts of multiplications and comparisons.
+  llvm::TypeSwitch<Operation *>(op)
+      .Case<MulOp>([&](MulOp mul) {
+        const bool ss = is_secret(mul.getLhs().getType()) &&
+                        is_secret(mul.getRhs().getType());
+        call(ss ? "mul_aa" : "mul_ap");
+        if (needs_trunc(op)) {
+          call("trunc_a");
+        }
+      })
+      .Case<DotOp, DotGeneralOp>([&](auto dot) {
+        auto lhs = dot.getLhs().getType().template cast<RankedTensorType>();
+        auto rhs = dot.getRhs().getType().template cast<RankedTensorType>();
+        const bool ss = is_secret(lhs) && is_secret(rhs);
+
+        int64_t batch = 1;
+        int64_t m = lhs.getRank() == 1 ? 1 : lhs.getShape().front();
+        int64_t n = rhs.getRank() == 1 ? 1 : rhs.getShape().back();
+        int64_t k = lhs.getShape().back();
+        if constexpr (std::is_same_v<decltype(dot), DotGeneralOp>) {
+          auto dims = dot.getDotDimensionNumbers();
+          k = 1;
+          for (auto d : dims.getLhsContractingDimensions()) {
+            k *= lhs.getShape()[d];
+          }
+          for (auto d : dims.getLhsBatchingDimensions()) {
+            batch *= lhs.getShape()[d];
+          }
+          m = lhs.getNumElements() / (k * batch);
+          n = rhs.getNumElements() / (k * batch);
+        }
+
+        cost += scale(kernelCost(ss ? "mmul_aa" : "mmul_ap", 0, m, n), batch);
+        cost.flops = 2 * batch * m * n * k;
+        if (needs_trunc(op)) {
+          call("trunc_a");
+        }
+      })
+      .Case<AddOp, SubtractOp>([&](Operation *) {
+        call(llvm::all_of(op->getOperandTypes(), is_secret) ? "add_aa"
+                                                             : "add_ap");
+      })
+      .Case<LessOp, GreaterOp, LessEqualOp, GreaterEqualOp>(
+          [&](Operation *) { call("a2b"); })
+      .Case<EqualOp, NotEqualOp>([&](Operation *) {
+        // xor then a log(K) depth and tree.
+        call("a2b");
+        call("and_bb", static_cast<int64_t>(std::log2(params_.at("K"))));
+      })
+      .Case<SelectOp>([&](Operation *) {
+        call("b2a");
+        call("mul_aa");
+      })
+      .Case<MaxOp, MinOp, AbsOp, SignOp>([&](Operation *) {
+        call("a2b");
+        call("b2a");
+        call("mul_aa");
+      })
+      .Case<AndOp, OrOp>([&](Operation *) { call("and_bb"); })
+      .Case<ConvertOp>([&](ConvertOp convert) {
+        // fxp -> int truncates.
+        if (is_fxp(convert.getOperand().getType()) &&
+            !is_fxp(convert.getType())) {
+          call("trunc_a");
+        }
+      })
+      .Case<FloorOp, CeilOp, RoundOp>([&](Operation *) { call("trunc_a"); })
+      .Case<ReciprocalOp, DivOp>([&](Operation *) {
+        // goldschmidt: normalize by highest one bit, then iterations.
+        call("a2b", 2);
+        call("mul_aa", 8);
+        call("trunc_a", 8);
+      })
+      .Case<RsqrtOp, SqrtOp>([&](Operation *) {
+        call("a2b", 2);
+        call("mul_aa", 6);
+        call("trunc_a", 6);
+      })
+      .Case<LogOp, Log1pOp>([&](Operation *) {
+        call("a2b", 2);
+        call("mul_aa", 12);
+        call("trunc_a", 12);
+      })
+      .Case<ExpOp, Expm1Op, TanhOp>([&](Operation *) {
+        call("mul_aa", 8);
+        call("trunc_a", 8);
+      })
+      .Case<LogisticOp>([&](Operation *) {
+        call("a2b");
+        call("mul_aa", 10);
+        call("trunc_a", 10);
+      })
+      .Case<PowOp>([&](Operation *) {
+        // exp(y * log(x))
+        call("a2b", 2);
+        call("mul_aa", 21);
+        call("trunc_a", 21);
+      })
+      .Case<SoftmaxOp>([&](SoftmaxOp softmax) {
+        // max tree, clip, exp, then one reciprocal per row.
+        auto type = softmax.getType().cast<RankedTensorType>();
+        const int64_t depth = llvm::Log2_64_Ceil(
+            std::max<int64_t>(type.getShape()[softmax.getAxis()], 1));
+        call("a2b", depth + 1);
+        call("b2a", depth + 1);
+        call("mul_aa", depth + 10);
+        call("trunc_a", 10);
+      })
+      .Case<LayerNormOp>([&](Operation *) {
+        call("a2b", 2);
+        call("mul_aa", 8);
+        call("trunc_a", 8);
+      })
+      .Case<GeluOp>([&](Operation *) {
+        // one batched comparison, selects and two polynomials.
+        call("a2b", 3);
+        call("b2a", 3);
+        call("mul_aa", 10);
+        call("trunc_a", 7);
+      })
+      .Default([&](Operation *) {});
+
+  if (cost.flops == 0) {
+    cost.flops = numel;
+  }
+  return cost;
+}
+
+ProgramCost::ProgramCost(Operation *root)
+    : ProgramCost(root, CostModel::getDefault()) {}
+
+ProgramCost::ProgramCost(Operation *root, const CostModel &model) {
+  for (auto &region : root->getRegions()) {
+    for (auto &block : region) {
+      critical_rounds_ =
+          std::max(critical_rounds_, analyzeBlock(&block, model, 1, 1));
+    }
+  }
+}
+
+int64_t ProgramCost::analyzeBlock(Block *block, const CostModel &model,
+                                  int64_t round_times, int64_t elem_times) {
+  // Estimated rounds until the results of an op are available.
+  llvm::DenseMap<Operation *, int64_t> ready;
+  int64_t critical = 0;
+
+  for (auto &op : *block) {
+    OpCost cost = model.estimate(&op);
+    cost.rounds *= round_times;
+    cost.bytes *= elem_times;
+    cost.flops *= elem_times;
+
+    costs_[&op] = cost;
+    total_ += cost;
+    auto &kind = per_kind_[op.getName().getStringRef().str()];
+    kind.first += 1;
+    kind.second += cost;
+
+    // Nested regions are counted once since trip counts are unknown
+    // statically, except reductions which evaluate the body on a log depth
+    // tree over all reduced elements.
+    int64_t nested_round_times = round_times;
+    int64_t nested_elem_times = elem_times;
+    if (auto reduce = llvm::dyn_cast<ReduceOp>(&op)) {
+      const int64_t in = getNumel(reduce->getOperandTypes()[0]);
+      const int64_t out =
+          std::max<int64_t>(getNumel(reduce->getResultTypes()[0]), 1);
+      nested_round_times *= static_cast<int64_t>(
+          std::ceil(std::log2(std::max<double>(1.0 * in / out, 1.0))));
+      nested_elem_times *= std::max<int64_t>(in - out, 1);
+    }
+    int64_t nested_rounds = 0;
+    for (auto &region : op.getRegions()) {
+      for (auto &nested : region) {
+        nested_rounds =
+            std::max(nested_rounds, analyzeBlock(&nested, model,
+                                                 nested_round_times,
+                                                 nested_elem_times));
+      }
+    }
+
+    int64_t start = 0;
+    op.walk([&](Operation *nested) {
+      for (auto operand : nested->getOperands()) {
+        auto *def = operand.getDefiningOp();
+        if (def != nullptr && def->getBlock() == block) {
+          start = std::max(start, ready.lookup(def));
+        }
+      }
+    });
+    ready[&op] = start + cost.rounds + nested_rounds;
+    critical = std::max(critical, ready[&op]);
+  }
+
+  return critical;
+}
+
+void ProgramCost::print(llvm::raw_ostream &os) const {
+  os << llvm::format("%-32s %8s %12s %16s %16s\n", "op", "count", "rounds",
+                     "bytes", "flops");
+  for (const auto &[name, kind] : per_kind_) {
+    if (kind.second.rounds == 0 && kind.second.bytes == 0) {
+      continue;
+    }
+    os << llvm::format("%-32s %8ld %12ld %16ld %16ld\n", name.c_str(),
+                       static_cast<long>(kind.first),
+                       static_cast<long>(kind.second.rounds),
+                       static_cast<long>(kind.second.bytes),
+                       static_cast<long>(kind.second.flops));
+  }
+  os << llvm::format("%-32s %8s %12ld %16ld %16ld\n", "total", "",
+                     static_cast<long>(total_.rounds),
+                     static_cast<long>(total_.bytes),
+                     static_cast<long>(total_.flops));
+  os << "critical path rounds: " << critical_rounds_ << "\n";
+}
+
+} // namespace mlir::pphlo
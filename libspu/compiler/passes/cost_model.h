@@ -0,0 +1,125 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/IR/Operation.h"
+
+#include "libspu/mpc/utils/cexpr.h"
+
+namespace mlir::pphlo {
+
+// Estimated online cost of an op (or a kernel call).
+struct OpCost {
+  // number of communication rounds.
+  int64_t rounds = 0;
+  // bytes sent by one party.
+  int64_t bytes = 0;
+  // local ring operations.
+  int64_t flops = 0;
+
+  OpCost &operator+=(const OpCost &other) {
+    rounds += other.rounds;
+    bytes += other.bytes;
+    flops += other.flops;
+    return *this;
+  }
+};
+
+// A protocol aware cost model, built from the per kernel complexity formulas
+// reported by mpc kernels (see libspu/mpc/tools/complexity).
+//
+// Each pphlo op is decomposed into the mpc kernels HAL would dispatch to,
+// formulas are evaluated with K (field bits), N (number of parties) and the
+// matmul shape (m, n).
+class CostModel {
+public:
+  // Build from the builtin complexity table, protocol is the name of
+  // ProtocolKind, i.e. "SEMI2K" or "ABY3".
+  static CostModel create(std::string_view protocol, size_t field_bits,
+                          size_t num_parties);
+
+  // Build from a json serialized ComplexityReport, as dumped by
+  // `complexity --out=<file>`.
+  static CostModel fromJson(std::string_view json, std::string_view protocol,
+                            size_t field_bits, size_t num_parties);
+
+  // Semi2k over FM64 with 2 parties.
+  static const CostModel &getDefault();
+
+  // Cost of calling `kernel` on `numel` elements, m/n are only used by
+  // matmul kernels.
+  OpCost kernelCost(std::string_view kernel, int64_t numel, int64_t m = 0,
+                    int64_t n = 0) const;
+
+  // Cost of a single pphlo op, nested regions are not included.
+  OpCost estimate(Operation *op) const;
+
+  const std::string &protocol() const { return protocol_; }
+
+private:
+  struct Entry {
+    // nullptr if the kernel reports no formula.
+    spu::ce::CExpr latency;
+    spu::ce::CExpr comm;
+  };
+
+  CostModel(std::string protocol, size_t field_bits, size_t num_parties);
+
+  void addEntry(const std::string &kernel, std::string_view latency,
+                std::string_view comm);
+
+  std::string protocol_;
+  spu::ce::Params params_;
+  std::map<std::string, Entry, std::less<>> entries_;
+};
+
+// Cost of a whole function/module. Usable as an mlir analysis, i.e.
+// `getAnalysis<ProgramCost>()` with the default cost model.
+class ProgramCost {
+public:
+  explicit ProgramCost(Operation *root);
+  ProgramCost(Operation *root, const CostModel &model);
+
+  // Sum over all ops.
+  const OpCost &total() const { return total_; }
+
+  // Rounds along the critical path, ops without dependency overlap.
+  int64_t criticalPathRounds() const { return critical_rounds_; }
+
+  OpCost lookup(Operation *op) const { return costs_.lookup(op); }
+
+  // Print a per op kind report.
+  void print(llvm::raw_ostream &os) const;
+
+private:
+  // Returns the critical path rounds of the block, rounds/bytes of nested
+  // ops are multiplied by round_times/elem_times.
+  int64_t analyzeBlock(Block *block, const CostModel &model,
+                       int64_t round_times, int64_t elem_times);
+
+  llvm::DenseMap<Operation *, OpCost> costs_;
+  std::map<std::string, std::pair<int64_t, OpCost>> per_kind_;
+  OpCost total_;
+  int64_t critical_rounds_ = 0;
+};
+
+} // namespace mlir::pphlo
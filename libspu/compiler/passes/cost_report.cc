@@ -0,0 +1,83 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fstream>
+#include <optional>
+#include <sstream>
+
+#include "llvm/Support/Format.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Pass/Pass.h"
+
+#include "libspu/compiler/passes/cost_model.h"
+#include "libspu/compiler/passes/pass_details.h"
+#include "libspu/compiler/passes/passes.h"
+
+namespace mlir::pphlo {
+
+namespace {
+
+// Print estimated rounds/bytes/flops of each function, IR is not modified.
+struct CostReport : public CostReportBase<CostReport> {
+  void runOnOperation() override {
+    std::optional<CostModel> model;
+    try {
+      if (complexity_json_.empty()) {
+        model = CostModel::create(protocol_, field_bits_, num_parties_);
+      } else {
+        std::ifstream in(complexity_json_);
+        if (!in) {
+          getOperation().emitError("can not open ") << complexity_json_;
+          return signalPassFailure();
+        }
+        std::stringstream json;
+        json << in.rdbuf();
+        model = CostModel::fromJson(json.str(), protocol_, field_bits_,
+                                    num_parties_);
+      }
+    } catch (const std::exception &e) {
+      getOperation().emitError(e.what());
+      return signalPassFailure();
+    }
+
+    auto &os = llvm::outs();
+    getOperation().walk([&](func::FuncOp func) {
+      ProgramCost cost(func, *model);
+      os << "cost report of @" << func.getSymName() << " ("
+         << model->protocol() << ", K=" << field_bits_
+         << ", N=" << num_parties_ << ")\n";
+      cost.print(os);
+
+      // Latency of rounds on the critical path plus the transfer time.
+      const double seconds =
+          cost.criticalPathRounds() * rtt_ms_ / 1000.0 +
+          static_cast<double>(cost.total().bytes) * 8 /
+              (bandwidth_mbps_ * 1000 * 1000);
+      os << llvm::format("estimated online time: %.3f s (rtt %.1f ms, %.1f "
+                         "Mbps)\n",
+                         seconds, static_cast<double>(rtt_ms_),
+                         static_cast<double>(bandwidth_mbps_));
+    });
+
+    markAllAnalysesPreserved();
+  }
+};
+
+} // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>> createCostReportPass() {
+  return std::make_unique<CostReport>();
+}
+
+} // namespace mlir::pphlo
@@ -621,6 +621,127 @@ struct GatherConverter : public OpRewritePattern<GatherOp> {
   }
 };
 
+// Rewrites a row lookup gather, i.e. embedding lookup
+//   result[i, ...] = operand[clamp(indices[i]), ...]
+// into a one-hot matrix product
+//   onehot = equal(broadcast(clamp(indices)), iota)     : m x n
+//   result = reshape(dot(onehot, reshape(operand)))     : (m x n) * (n x d)
+// All equality tests are done in one batch, and all rows are fetched by a
+// single matmul, instead of a while loop of per-index dynamic slices.
+struct GatherToOneHotDot : public OpRewritePattern<GatherOp> {
+  explicit GatherToOneHotDot(MLIRContext *context)
+      : OpRewritePattern(context, /*benefit=*/2) {}
+
+  LogicalResult matchAndRewrite(GatherOp op,
+                                PatternRewriter &rewriter) const override {
+    TypeTools type_tool;
+    if (type_tool.getTypeVisibility(op.getStartIndices().getType()) !=
+        Visibility::VIS_SECRET) {
+      return failure();
+    }
+
+    if (GatherIsBroadcast(op)) {
+      return failure();
+    }
+
+    const auto &dim_numbers = op.getDimensionNumbers();
+    auto operand = op.getOperand();
+    auto start_indices = op.getStartIndices();
+    const auto operand_shape = operand.getType().getShape();
+    const auto indices_shape = start_indices.getType().getShape();
+    auto result_type = op->getResultTypes()[0].dyn_cast<RankedTensorType>();
+    if (!result_type) {
+      return failure();
+    }
+    const auto result_shape = result_type.getShape();
+    const auto operand_rank = static_cast<int64_t>(operand_shape.size());
+
+    // Only indexing into the leading dimension and taking full rows.
+    if (dim_numbers.getStartIndexMap().size() != 1 ||
+        dim_numbers.getStartIndexMap()[0] != 0 ||
+        dim_numbers.getCollapsedSliceDims().size() != 1 ||
+        dim_numbers.getCollapsedSliceDims()[0] != 0) {
+      return failure();
+    }
+    auto slice_sizes = llvm::to_vector(op.getSliceSizes().getValues<int64_t>());
+    if (slice_sizes[0] != 1 ||
+        !std::equal(slice_sizes.begin() + 1, slice_sizes.end(),
+                    operand_shape.begin() + 1)) {
+      return failure();
+    }
+
+    // Indices are either scalars, or index vectors of size 1 in the last dim.
+    const auto index_vector_dim = dim_numbers.getIndexVectorDim();
+    const auto indices_rank = static_cast<int64_t>(indices_shape.size());
+    if (index_vector_dim != indices_rank &&
+        !(index_vector_dim == indices_rank - 1 &&
+          indices_shape[index_vector_dim] == 1)) {
+      return failure();
+    }
+
+    // Offset dims must be the trailing dims of result.
+    const int64_t batch_rank =
+        static_cast<int64_t>(result_shape.size()) - (operand_rank - 1);
+    const auto offset_dims = dim_numbers.getOffsetDims();
+    for (int64_t idx = 0; idx < static_cast<int64_t>(offset_dims.size());
+         ++idx) {
+      if (offset_dims[idx] != batch_rank + idx) {
+        return failure();
+      }
+    }
+
+    const int64_t n = operand_shape[0];
+    const int64_t m = start_indices.getType().getNumElements();
+    const int64_t d = operand.getType().getNumElements() / n;
+
+    auto loc = op->getLoc();
+    auto index_type = start_indices.getType().getElementType();
+    auto index_expressed_type = type_tool.getExpressedType(index_type);
+
+    // Clamp indices into [0, n - 1], same as xla gather semantic.
+    auto flat_indices = rewriter.create<ReshapeOp>(
+        loc, RankedTensorType::get({m}, index_type), start_indices);
+    auto lower = rewriter.create<ConstantOp>(
+        loc, rewriter.getZeroAttr(
+                 RankedTensorType::get({m}, index_expressed_type)));
+    auto upper = rewriter.create<ConstantOp>(
+        loc, DenseElementsAttr::get(
+                 RankedTensorType::get({m}, index_expressed_type),
+                 rewriter.getIntegerAttr(index_expressed_type, n - 1)));
+    auto clamped = rewriter.create<ClampOp>(
+        loc, flat_indices.getType(), lower, flat_indices, upper);
+
+    // One batched equality against all positions.
+    auto broadcasted = rewriter.create<BroadcastOp>(
+        loc, RankedTensorType::get({m, n}, index_type), clamped,
+        ConvertDimensions(&rewriter, {0}));
+    auto iota = rewriter.create<IotaOp>(
+        loc,
+        RankedTensorType::get({m, n}, type_tool.getTypeWithVisibility(
+                                          index_expressed_type,
+                                          Visibility::VIS_PUBLIC)),
+        rewriter.getI64IntegerAttr(1));
+    auto onehot = rewriter.create<EqualOp>(
+        loc,
+        RankedTensorType::get(
+            {m, n}, type_tool.getTypeWithVisibility(rewriter.getI1Type(),
+                                                    Visibility::VIS_SECRET)),
+        broadcasted, iota);
+
+    // Fetch all rows with a single matmul.
+    auto flat_operand = rewriter.create<ReshapeOp>(
+        loc, RankedTensorType::get({n, d}, operand.getType().getElementType()),
+        operand);
+    auto dot = rewriter.create<DotOp>(
+        loc, RankedTensorType::get({m, d}, result_type.getElementType()),
+        onehot, flat_operand);
+
+    rewriter.replaceOpWithNewOp<ReshapeOp>(op, result_type, dot);
+
+    return success();
+  }
+};
+
 struct ExpandSecretGather : public ExpandSecretGatherBase<ExpandSecretGather> {
   void runOnOperation() override {
     RewritePatternSet patterns(&getContext());
@@ -631,7 +752,7 @@ struct ExpandSecretGather : public ExpandSecretGatherBase<ExpandSecretGather> {
 private:
   static void populateOwningPatterns(RewritePatternSet *patterns,
                                      MLIRContext *ctx) {
-    patterns->insert<GatherConverter>(ctx);
+    patterns->insert<GatherToOneHotDot, GatherConverter>(ctx);
   }
 };
 } // namespace
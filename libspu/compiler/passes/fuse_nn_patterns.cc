@@ -0,0 +1,550 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+#include <limits>
+#include <optional>
+
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+#include "libspu/compiler/passes/pass_details.h"
+#include "libspu/compiler/passes/passes.h"
+#include "libspu/dialect/pphlo_ops.h"
+#include "libspu/dialect/pphlo_types.h"
+
+namespace mlir::pphlo {
+
+namespace {
+
+bool isFxpTensor(Type t) {
+  TypeTools tools;
+  return tools.getExpressedType(t).isa<FloatType>();
+}
+
+bool isClose(double v, double expected) {
+  return std::abs(v - expected) <= 1e-4 * std::max(1.0, std::abs(expected));
+}
+
+std::vector<int64_t> dropUnitDims(llvm::ArrayRef<int64_t> shape) {
+  std::vector<int64_t> ret;
+  for (auto s : shape) {
+    if (s != 1) {
+      ret.push_back(s);
+    }
+  }
+  return ret;
+}
+
+// Skip reshapes which only insert or remove unit dims (keepdims).
+Value skipUnitReshape(Value v) {
+  while (auto reshape = v.getDefiningOp<ReshapeOp>()) {
+    auto from = reshape.getOperand().getType().cast<RankedTensorType>();
+    auto to = reshape.getType().cast<RankedTensorType>();
+    if (dropUnitDims(from.getShape()) != dropUnitDims(to.getShape())) {
+      break;
+    }
+    v = reshape.getOperand();
+  }
+  return v;
+}
+
+// Value of a splat constant, possibly broadcasted/reshaped/converted.
+std::optional<double> getSplatValue(Value v) {
+  while (true) {
+    if (auto op = v.getDefiningOp<BroadcastOp>()) {
+      v = op.getOperand();
+    } else if (auto op = v.getDefiningOp<ReshapeOp>()) {
+      v = op.getOperand();
+    } else if (auto op = v.getDefiningOp<ConvertOp>()) {
+      v = op.getOperand();
+    } else {
+      break;
+    }
+  }
+
+  auto c = v.getDefiningOp<ConstantOp>();
+  if (!c) {
+    return std::nullopt;
+  }
+  if (auto attr = c.getValue().dyn_cast<DenseFPElementsAttr>()) {
+    if (attr.isSplat()) {
+      return attr.getSplatValue<APFloat>().convertToDouble();
+    }
+  }
+  if (auto attr = c.getValue().dyn_cast<DenseIntElementsAttr>()) {
+    if (attr.isSplat()) {
+      return static_cast<double>(attr.getSplatValue<APInt>().getSExtValue());
+    }
+  }
+  return std::nullopt;
+}
+
+bool isSplat(Value v, double expected) {
+  auto value = getSplatValue(v);
+  return value.has_value() && isClose(*value, expected);
+}
+
+// Returns the reduced input and the reduced axis of a single dimension
+// reduction `v = reduce(input, init) { OpT }`.
+template <typename OpT>
+std::optional<std::pair<Value, int64_t>> matchReduce(Value v) {
+  if (!v) {
+    return std::nullopt;
+  }
+  auto reduce = skipUnitReshape(v).getDefiningOp<ReduceOp>();
+  if (!reduce || reduce.getInputs().size() != 1 ||
+      reduce.getDimensions().getNumElements() != 1) {
+    return std::nullopt;
+  }
+
+  auto &block = reduce.getBody().front();
+  if (block.getOperations().size() != 2) {
+    return std::nullopt;
+  }
+  auto body = dyn_cast<OpT>(block.front());
+  if (!body || body->getOperand(0) != block.getArgument(0) ||
+      body->getOperand(1) != block.getArgument(1)) {
+    return std::nullopt;
+  }
+
+  auto init = getSplatValue(reduce.getInitValues()[0]);
+  if (!init.has_value()) {
+    return std::nullopt;
+  }
+  if constexpr (std::is_same_v<OpT, AddOp>) {
+    if (*init != 0) {
+      return std::nullopt;
+    }
+  } else {
+    if (*init > std::numeric_limits<float>::lowest()) {
+      return std::nullopt;
+    }
+  }
+
+  return std::make_pair(reduce.getInputs()[0],
+                        *reduce.getDimensions().getValues<int64_t>().begin());
+}
+
+// mean(input) along an axis, i.e. reduce_add(input) * (1/n) or
+// reduce_add(input) / n.
+std::optional<std::pair<Value, int64_t>> matchMean(Value v) {
+  if (!v) {
+    return std::nullopt;
+  }
+  v = skipUnitReshape(v);
+  Value sum;
+  double scale = 0;
+  if (auto mul = v.getDefiningOp<MulOp>()) {
+    for (auto [lhs, rhs] : {std::make_pair(mul.getLhs(), mul.getRhs()),
+                            std::make_pair(mul.getRhs(), mul.getLhs())}) {
+      if (auto c = getSplatValue(rhs)) {
+        sum = lhs;
+        scale = *c;
+        break;
+      }
+    }
+  } else if (auto div = v.getDefiningOp<DivOp>()) {
+    if (auto c = getSplatValue(div.getRhs()); c.has_value() && *c != 0) {
+      sum = div.getLhs();
+      scale = 1.0 / *c;
+    }
+  }
+  if (!sum) {
+    return std::nullopt;
+  }
+
+  auto reduced = matchReduce<AddOp>(sum);
+  if (!reduced.has_value()) {
+    return std::nullopt;
+  }
+  auto type = reduced->first.getType().cast<RankedTensorType>();
+  if (!isClose(scale, 1.0 / type.getShape()[reduced->second])) {
+    return std::nullopt;
+  }
+  return reduced;
+}
+
+// Returns the per-row value of `v = broadcast(row)`, where row is the
+// reduction of a tensor of the same shape of `v` along `axis`.
+Value matchRowBroadcast(Value v, int64_t axis) {
+  auto broadcast = v.getDefiningOp<BroadcastOp>();
+  if (!broadcast) {
+    return {};
+  }
+
+  auto from = broadcast.getOperand().getType().cast<RankedTensorType>();
+  auto to = broadcast.getType().cast<RankedTensorType>();
+  auto dims = llvm::to_vector(
+      broadcast.getBroadcastDimensions().getValues<int64_t>());
+  llvm::SmallVector<bool> covered(to.getRank(), false);
+  for (int64_t idx = 0; idx < from.getRank(); ++idx) {
+    const int64_t dim = dims[idx];
+    if (dim == axis) {
+      // keepdims
+      if (from.getShape()[idx] != 1) {
+        return {};
+      }
+    } else if (from.getShape()[idx] != to.getShape()[dim]) {
+      return {};
+    }
+    covered[dim] = true;
+  }
+  for (int64_t dim = 0; dim < to.getRank(); ++dim) {
+    if (dim != axis && !covered[dim]) {
+      return {};
+    }
+  }
+  return skipUnitReshape(broadcast.getOperand());
+}
+
+// Collect factors of a multiplication tree.
+void collectFactors(Value v, llvm::SmallVectorImpl<Value> &factors,
+                    int64_t depth = 0) {
+  auto mul = v.getDefiningOp<MulOp>();
+  if (!mul || depth > 4) {
+    factors.push_back(v);
+    return;
+  }
+  collectFactors(mul.getLhs(), factors, depth + 1);
+  collectFactors(mul.getRhs(), factors, depth + 1);
+}
+
+// Idea here:
+//   %m = reduce_max(%x)
+//   %e = exp(%x - broadcast(%m))
+//   %s = reduce_add(%e)
+//   %0 = %e / broadcast(%s)
+// into
+//   %0 = softmax(%x)
+// Rational:
+// The fused kernel shares the max subtraction and computes the reciprocal of
+// the row sum only once per row instead of dividing every element.
+struct SoftmaxFusion : public OpRewritePattern<DivOp> {
+  explicit SoftmaxFusion(MLIRContext *context)
+      : OpRewritePattern<DivOp>(context) {}
+
+  LogicalResult matchAndRewrite(DivOp op,
+                                PatternRewriter &rewriter) const override {
+    auto exp = op.getLhs().getDefiningOp<ExpOp>();
+    if (!exp) {
+      return failure();
+    }
+
+    auto broadcast = op.getRhs().getDefiningOp<BroadcastOp>();
+    if (!broadcast) {
+      return failure();
+    }
+    auto sum = matchReduce<AddOp>(skipUnitReshape(broadcast.getOperand()));
+    if (!sum.has_value() || sum->first != exp.getResult()) {
+      return failure();
+    }
+    const int64_t axis = sum->second;
+    if (!matchRowBroadcast(op.getRhs(), axis)) {
+      return failure();
+    }
+
+    auto sub = exp.getOperand().getDefiningOp<SubtractOp>();
+    if (!sub) {
+      return failure();
+    }
+    Value x = sub.getLhs();
+    auto max = matchReduce<MaxOp>(matchRowBroadcast(sub.getRhs(), axis));
+    if (!max.has_value() || max->first != x || max->second != axis) {
+      return failure();
+    }
+
+    if (x.getType() != op.getType() || !isFxpTensor(x.getType())) {
+      return failure();
+    }
+
+    rewriter.replaceOpWithNewOp<SoftmaxOp>(op, op.getType(), x,
+                                           rewriter.getI64IntegerAttr(axis));
+    return success();
+  }
+};
+
+// Idea here:
+//   %m = mean(%x)
+//   %c = %x - broadcast(%m)
+//   %v = mean(%c * %c)   or   mean(%x * %x) - %m * %m
+//   %0 = %c * broadcast(rsqrt(%v + eps))   or   %c / broadcast(sqrt(...))
+// into
+//   %0 = layer_norm(%x)
+// Rational:
+// The fused kernel computes the rsqrt once per row on the reduced shape.
+template <typename OpT>
+struct LayerNormFusion : public OpRewritePattern<OpT> {
+  explicit LayerNormFusion(MLIRContext *context)
+      : OpRewritePattern<OpT>(context) {}
+
+  LogicalResult matchAndRewrite(OpT op,
+                                PatternRewriter &rewriter) const override {
+    auto matched = match(op.getLhs(), op.getRhs());
+    if (std::is_same_v<OpT, MulOp> && !matched.has_value()) {
+      matched = match(op.getRhs(), op.getLhs());
+    }
+    if (!matched.has_value() || matched->x.getType() != op.getType() ||
+        !isFxpTensor(op.getType())) {
+      return failure();
+    }
+
+    rewriter.replaceOpWithNewOp<LayerNormOp>(
+        op, op.getType(), matched->x,
+        rewriter.getI64IntegerAttr(matched->axis),
+        rewriter.getF64FloatAttr(matched->epsilon));
+    return success();
+  }
+
+private:
+  struct Matched {
+    Value x;
+    int64_t axis;
+    double epsilon;
+  };
+
+  // Returns x and the axis if v = x - broadcast(mean(x)).
+  static std::optional<std::pair<Value, int64_t>> matchCentered(Value v) {
+    auto sub = v.getDefiningOp<SubtractOp>();
+    if (!sub) {
+      return std::nullopt;
+    }
+    auto broadcast = sub.getRhs().getDefiningOp<BroadcastOp>();
+    if (!broadcast) {
+      return std::nullopt;
+    }
+    auto mean = matchMean(broadcast.getOperand());
+    if (!mean.has_value() || mean->first != sub.getLhs() ||
+        !matchRowBroadcast(sub.getRhs(), mean->second)) {
+      return std::nullopt;
+    }
+    return mean;
+  }
+
+  static std::optional<Matched> match(Value centered, Value scale) {
+    auto c = matchCentered(centered);
+    if (!c.has_value()) {
+      return std::nullopt;
+    }
+    auto [x, axis] = *c;
+
+    auto row = matchRowBroadcast(scale, axis);
+    if (!row) {
+      return std::nullopt;
+    }
+    Value denom;
+    if constexpr (std::is_same_v<OpT, MulOp>) {
+      if (auto rsqrt = row.getDefiningOp<RsqrtOp>()) {
+        denom = rsqrt.getOperand();
+      }
+    } else {
+      if (auto sqrt = row.getDefiningOp<SqrtOp>()) {
+        denom = sqrt.getOperand();
+      }
+    }
+    if (!denom) {
+      return std::nullopt;
+    }
+
+    auto add = skipUnitReshape(denom).getDefiningOp<AddOp>();
+    if (!add) {
+      return std::nullopt;
+    }
+    Value var = add.getLhs();
+    auto epsilon = getSplatValue(add.getRhs());
+    if (!epsilon.has_value()) {
+      var = add.getRhs();
+      epsilon = getSplatValue(add.getLhs());
+    }
+    if (!epsilon.has_value() || !matchVariance(var, x, axis)) {
+      return std::nullopt;
+    }
+
+    return Matched{x, axis, *epsilon};
+  }
+
+  static bool isMeanOf(Value v, Value x, int64_t axis) {
+    auto mean = matchMean(v);
+    return mean.has_value() && mean->first == x && mean->second == axis;
+  }
+
+  static bool matchVariance(Value var, Value x, int64_t axis) {
+    var = skipUnitReshape(var);
+    // var may be clamped at zero to guard against rounding errors.
+    if (auto max = var.getDefiningOp<MaxOp>()) {
+      if (isSplat(max.getRhs(), 0)) {
+        var = skipUnitReshape(max.getLhs());
+      } else if (isSplat(max.getLhs(), 0)) {
+        var = skipUnitReshape(max.getRhs());
+      }
+    }
+
+    // mean((x - mean(x))^2)
+    if (auto mean = matchMean(var)) {
+      auto square = mean->first.getDefiningOp<MulOp>();
+      if (!square || mean->second != axis) {
+        return false;
+      }
+      auto lhs = matchCentered(square.getLhs());
+      auto rhs = matchCentered(square.getRhs());
+      return lhs.has_value() && rhs.has_value() && lhs->first == x &&
+             rhs->first == x && lhs->second == axis && rhs->second == axis;
+    }
+
+    // mean(x^2) - mean(x)^2
+    if (auto sub = var.getDefiningOp<SubtractOp>()) {
+      auto mean2 = matchMean(sub.getLhs());
+      auto square = skipUnitReshape(sub.getRhs()).getDefiningOp<MulOp>();
+      if (!mean2.has_value() || !square || mean2->second != axis) {
+        return false;
+      }
+      auto x2 = mean2->first.getDefiningOp<MulOp>();
+      return x2 && x2.getLhs() == x && x2.getRhs() == x &&
+             isMeanOf(square.getLhs(), x, axis) &&
+             isMeanOf(square.getRhs(), x, axis);
+    }
+
+    return false;
+  }
+};
+
+// Idea here:
+//   %0 = 0.5 * %x * (1 + tanh(sqrt(2/pi) * (%x + 0.044715 * %x^3)))
+// into
+//   %0 = gelu(%x)
+// Rational:
+// The fused kernel replaces the tanh approximation and the cubic polynomial
+// with a piecewise polynomial.
+struct GeluFusion : public OpRewritePattern<MulOp> {
+  explicit GeluFusion(MLIRContext *context)
+      : OpRewritePattern<MulOp>(context) {}
+
+  LogicalResult matchAndRewrite(MulOp op,
+                                PatternRewriter &rewriter) const override {
+    // Factors are {0.5, x, 1 + tanh(...)} in any order.
+    llvm::SmallVector<Value> factors;
+    collectFactors(op.getResult(), factors);
+    if (factors.size() != 3) {
+      return failure();
+    }
+
+    Value half;
+    TanhOp tanh;
+    Value x;
+    for (auto f : factors) {
+      if (!half && isSplat(f, 0.5)) {
+        half = f;
+      } else if (auto t = matchOnePlusTanh(f); !tanh && t) {
+        tanh = t;
+      } else {
+        x = f;
+      }
+    }
+    if (!half || !tanh || !x || x.getType() != op.getType() ||
+        !isFxpTensor(x.getType()) || !matchInner(tanh.getOperand(), x)) {
+      return failure();
+    }
+
+    rewriter.replaceOpWithNewOp<GeluOp>(op, op.getType(), x);
+    return success();
+  }
+
+private:
+  // 1 + tanh(...)
+  static TanhOp matchOnePlusTanh(Value v) {
+    auto add = v.getDefiningOp<AddOp>();
+    if (!add) {
+      return {};
+    }
+    if (auto tanh = add.getRhs().getDefiningOp<TanhOp>();
+        tanh && isSplat(add.getLhs(), 1.0)) {
+      return tanh;
+    }
+    if (auto tanh = add.getLhs().getDefiningOp<TanhOp>();
+        tanh && isSplat(add.getRhs(), 1.0)) {
+      return tanh;
+    }
+    return {};
+  }
+
+  // sqrt(2/pi) * (x + 0.044715 * x^3)
+  static bool matchInner(Value v, Value x) {
+    llvm::SmallVector<Value> factors;
+    collectFactors(v, factors);
+    if (factors.size() != 2) {
+      return false;
+    }
+    for (int idx = 0; idx < 2; ++idx) {
+      if (isSplat(factors[idx], std::sqrt(2.0 / M_PI)) &&
+          matchPoly(factors[1 - idx], x)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // x + 0.044715 * x^3
+  static bool matchPoly(Value v, Value x) {
+    auto add = v.getDefiningOp<AddOp>();
+    if (!add) {
+      return false;
+    }
+    return (add.getLhs() == x && matchCubic(add.getRhs(), x)) ||
+           (add.getRhs() == x && matchCubic(add.getLhs(), x));
+  }
+
+  static bool matchCubic(Value v, Value x) {
+    llvm::SmallVector<Value> factors;
+    collectFactors(v, factors);
+    bool has_coeff = false;
+    int64_t degree = 0;
+    for (auto f : factors) {
+      if (f == x) {
+        degree += 1;
+      } else if (auto pow = f.getDefiningOp<PowOp>();
+                 pow && pow.getLhs() == x && isSplat(pow.getRhs(), 3)) {
+        degree += 3;
+      } else if (!has_coeff && isSplat(f, 0.044715)) {
+        has_coeff = true;
+      } else {
+        return false;
+      }
+    }
+    return has_coeff && degree == 3;
+  }
+};
+
+struct FuseNNPatterns : public FuseNNPatternsBase<FuseNNPatterns> {
+  void runOnOperation() override {
+    RewritePatternSet patterns(&getContext());
+    populateOwningPatterns(&patterns, &getContext());
+    (void)applyPatternsAndFoldGreedily(getOperation(), std::move(patterns));
+  }
+
+private:
+  static void populateOwningPatterns(RewritePatternSet *patterns,
+                                     MLIRContext *ctx) {
+    patterns->insert<SoftmaxFusion, LayerNormFusion<MulOp>,
+                     LayerNormFusion<DivOp>, GeluFusion>(ctx);
+  }
+};
+
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> createFuseNNPatternsPass() {
+  return std::make_unique<FuseNNPatterns>();
+}
+
+} // namespace mlir::pphlo
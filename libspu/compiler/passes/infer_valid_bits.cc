@@ -0,0 +1,247 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <optional>
+
+#include "llvm/ADT/TypeSwitch.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/Pass/Pass.h"
+
+#include "libspu/compiler/passes/pass_details.h"
+#include "libspu/compiler/passes/passes.h"
+#include "libspu/dialect/pphlo_ops.h"
+#include "libspu/dialect/pphlo_types.h"
+
+namespace mlir::pphlo {
+
+namespace {
+
+// Unknown width, i.e. the value may take the whole ring.
+constexpr int64_t kUnknown = 0;
+
+int64_t add(int64_t lhs, int64_t rhs) {
+  return (lhs == kUnknown || rhs == kUnknown) ? kUnknown : lhs + rhs;
+}
+
+int64_t merge(int64_t lhs, int64_t rhs) {
+  return (lhs == kUnknown || rhs == kUnknown) ? kUnknown
+                                              : std::max(lhs, rhs);
+}
+
+// Number of signed bits to represent v.
+int64_t signedBits(const APInt &v, bool is_unsigned) {
+  if (!is_unsigned && v.isNegative()) {
+    return (~v).getActiveBits() + 1;
+  }
+  return v.getActiveBits() + 1;
+}
+
+std::optional<IntegerType> getIntType(Type t) {
+  TypeTools tools;
+  if (auto it = tools.getExpressedType(t).dyn_cast<IntegerType>()) {
+    return it;
+  }
+  return std::nullopt;
+}
+
+// Width implied by the element type, valid for program inputs only since
+// arithmetic in the ring never wraps at the type width.
+int64_t widthOfType(Type t) {
+  auto it = getIntType(t);
+  if (!it.has_value()) {
+    return kUnknown;
+  }
+  if (it->getWidth() == 1 || it->isUnsigned()) {
+    return it->getWidth() + 1;
+  }
+  return it->getWidth();
+}
+
+// Idea here:
+//   %0 = convert(%a: i8)
+//   %1 = convert(%b: i8)
+//   %2 = add(%0, %1)                 // fits in 9 bits
+//   %3 = less(%2, %c: i8)            // msb(%2 - %c), fits in 10 bits
+// into
+//   %3 = less(%2, %c) {pphlo.valid_bits = 10}
+// Rational:
+// Comparisons are evaluated as msb(lhs - rhs), the carry circuit of msb costs
+// log(k) rounds and O(k) bits over the whole ring. When the difference is
+// known to be narrow (values from small integer inputs, boolean masks, loop
+// counters...), the runtime only needs to run it over the lowest bits.
+//
+// The widths of program inputs are taken from their declared types, which
+// only holds when parties are semi-honest: a malicious party may feed shares
+// of any value. The runtime ignores the hint under malicious protocols.
+struct InferValidBits : public InferValidBitsBase<InferValidBits> {
+  void runOnOperation() override {
+    auto func = getOperation();
+    widths_.clear();
+
+    // Inputs of entry functions are encoded by their own dtype.
+    if (func.isPublic()) {
+      for (auto arg : func.getArguments()) {
+        widths_[arg] = widthOfType(arg.getType());
+      }
+    }
+
+    func.walk<WalkOrder::PreOrder>([&](Operation *op) {
+      if (op->getNumResults() == 1) {
+        widths_[op->getResult(0)] = infer(op);
+      }
+      annotate(op);
+    });
+  }
+
+private:
+  int64_t widthOf(Value v) const {
+    auto iter = widths_.find(v);
+    if (iter != widths_.end() && iter->second != kUnknown) {
+      return iter->second;
+    }
+    // Booleans are always 0/1.
+    auto it = getIntType(v.getType());
+    if (it.has_value() && it->getWidth() == 1) {
+      return 2;
+    }
+    return kUnknown;
+  }
+
+  int64_t mergeOperands(Operation *op) const {
+    int64_t w = 1;
+    for (auto operand : op->getOperands()) {
+      w = merge(w, widthOf(operand));
+    }
+    return w;
+  }
+
+  static std::optional<int64_t> constantShift(Value v) {
+    auto c = v.getDefiningOp<ConstantOp>();
+    if (!c) {
+      return std::nullopt;
+    }
+    auto attr = c.getValue().dyn_cast<DenseIntElementsAttr>();
+    if (!attr) {
+      return std::nullopt;
+    }
+    int64_t bits = 0;
+    for (const auto &v : attr.getValues<APInt>()) {
+      bits = std::max<int64_t>(bits, v.getZExtValue());
+    }
+    return bits;
+  }
+
+  int64_t infer(Operation *op) const {
+    if (!getIntType(op->getResult(0).getType()).has_value()) {
+      return kUnknown;
+    }
+
+    return llvm::TypeSwitch<Operation *, int64_t>(op)
+        .Case<ConstantOp>([](ConstantOp op) {
+          auto attr = op.getValue().dyn_cast<DenseIntElementsAttr>();
+          if (!attr) {
+            return kUnknown;
+          }
+          const bool is_unsigned =
+              attr.getElementType().isUnsignedInteger() ||
+              attr.getElementType().isInteger(1);
+          int64_t w = 1;
+          for (const auto &v : attr.getValues<APInt>()) {
+            w = std::max(w, signedBits(v, is_unsigned));
+          }
+          return w;
+        })
+        .Case<IotaOp>([](IotaOp op) {
+          auto type = op.getType().cast<RankedTensorType>();
+          const int64_t n = type.getShape()[op.getIotaDimension()];
+          return signedBits(APInt(64, std::max<int64_t>(n - 1, 0)),
+                            /*is_unsigned*/ true);
+        })
+        .Case<ConvertOp>([&](ConvertOp op) {
+          // int -> int convert keeps the value.
+          if (getIntType(op.getOperand().getType()).has_value()) {
+            return widthOf(op.getOperand());
+          }
+          return kUnknown;
+        })
+        .Case<AddOp, SubtractOp>([&](Operation *op) {
+          return add(mergeOperands(op), 1);
+        })
+        .Case<NegOp, AbsOp>(
+            [&](Operation *op) { return add(widthOf(op->getOperand(0)), 1); })
+        .Case<MulOp>([&](MulOp op) {
+          return add(widthOf(op.getLhs()), widthOf(op.getRhs()));
+        })
+        .Case<DotOp>([&](DotOp op) {
+          auto type = op.getLhs().getType().cast<RankedTensorType>();
+          const int64_t k = type.getShape().back();
+          const int64_t acc = llvm::Log2_64_Ceil(std::max<int64_t>(k, 1));
+          return add(add(widthOf(op.getLhs()), widthOf(op.getRhs())), acc);
+        })
+        .Case<ShiftLeftOp>([&](ShiftLeftOp op) {
+          auto bits = constantShift(op.getRhs());
+          return bits.has_value() ? add(widthOf(op.getLhs()), *bits)
+                                  : kUnknown;
+        })
+        .Case<ShiftRightArithmeticOp>(
+            [&](ShiftRightArithmeticOp op) { return widthOf(op.getLhs()); })
+        .Case<AndOp, OrOp, XorOp, MaxOp, MinOp, ClampOp, ConcatenateOp>(
+            [&](Operation *op) { return mergeOperands(op); })
+        .Case<SelectOp>([&](SelectOp op) {
+          return merge(widthOf(op.getOnTrue()), widthOf(op.getOnFalse()));
+        })
+        .Case<NotOp, ReshapeOp, BroadcastOp, TransposeOp, SliceOp,
+              ReverseOp, DynamicSliceOp, PreferAOp>(
+            [&](Operation *op) { return widthOf(op->getOperand(0)); })
+        .Case<EqualOp, NotEqualOp, LessOp, GreaterOp, LessEqualOp,
+              GreaterEqualOp, SignOp>([](auto) { return 2; })
+        .Default([&](Operation *op) { return widthOf(op->getResult(0)); });
+  }
+
+  void annotate(Operation *op) const {
+    if (!isa<LessOp, GreaterOp, LessEqualOp, GreaterEqualOp>(op)) {
+      return;
+    }
+
+    TypeTools tools;
+    auto lhs = op->getOperand(0);
+    auto rhs = op->getOperand(1);
+    auto type = getIntType(lhs.getType());
+    if (!type.has_value() ||
+        (tools.getTypeVisibility(lhs.getType()) != Visibility::VIS_SECRET &&
+         tools.getTypeVisibility(rhs.getType()) != Visibility::VIS_SECRET)) {
+      return;
+    }
+
+    // Width of lhs - rhs.
+    const int64_t w = add(merge(widthOf(lhs), widthOf(rhs)), 1);
+    if (w == kUnknown || w >= static_cast<int64_t>(type->getWidth())) {
+      return;
+    }
+
+    OpBuilder builder(op);
+    op->setAttr("pphlo.valid_bits", builder.getI64IntegerAttr(w));
+  }
+
+  llvm::DenseMap<Value, int64_t> widths_;
+};
+
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> createInferValidBitsPass() {
+  return std::make_unique<InferValidBits>();
+}
+
+} // namespace mlir::pphlo
@@ -0,0 +1,344 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "llvm/ADT/DenseSet.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+
+#include "libspu/compiler/passes/cost_model.h"
+#include "libspu/compiler/passes/pass_details.h"
+#include "libspu/compiler/passes/passes.h"
+#include "libspu/dialect/pphlo_ops.h"
+#include "libspu/dialect/pphlo_types.h"
+
+namespace mlir::pphlo {
+
+namespace {
+
+// Returns true if `other` has the same structure of `base`, i.e. it only
+// differs in values of constants. Constants of base which hold a different
+// value in other are added to `diffs`.
+bool isSameModuloConstants(Block &base, Block &other,
+                           llvm::DenseSet<Operation *> *diffs) {
+  if (base.getOperations().size() != other.getOperations().size()) {
+    return false;
+  }
+
+  llvm::DenseMap<Value, Value> mapping;
+  for (auto lhs_it = base.begin(), rhs_it = other.begin();
+       lhs_it != base.end(); ++lhs_it, ++rhs_it) {
+    auto &lhs = *lhs_it;
+    auto &rhs = *rhs_it;
+    if (lhs.getName() != rhs.getName() || lhs.getNumRegions() != 0 ||
+        rhs.getNumRegions() != 0 ||
+        lhs.getNumOperands() != rhs.getNumOperands() ||
+        lhs.getResultTypes() != rhs.getResultTypes()) {
+      return false;
+    }
+
+    for (unsigned idx = 0; idx < lhs.getNumOperands(); ++idx) {
+      auto x = lhs.getOperand(idx);
+      auto iter = mapping.find(x);
+      auto expected = iter == mapping.end() ? x : iter->second;
+      if (expected != rhs.getOperand(idx)) {
+        return false;
+      }
+    }
+
+    if (lhs.getAttrDictionary() != rhs.getAttrDictionary()) {
+      auto c = dyn_cast<ConstantOp>(lhs);
+      if (!c || c.getValue().getType() !=
+                    cast<ConstantOp>(rhs).getValue().getType()) {
+        return false;
+      }
+      diffs->insert(&lhs);
+    }
+
+    for (unsigned idx = 0; idx < lhs.getNumResults(); ++idx) {
+      mapping[lhs.getResult(idx)] = rhs.getResult(idx);
+    }
+  }
+  return true;
+}
+
+// Idea here:
+//   %r = case(%secret_index) {
+//     branch0: mul(%x, 0.5) + %y
+//     branch1: mul(%x, 2.0) + %y
+//   }
+// into
+//   %c = mux(%secret_index, 0.5, 2.0)
+//   %r = mul(%x, %c) + %y
+// and for branches that cannot be merged, ops which do not depend on the
+// branch are hoisted before the case/if op, where CSE dedups them.
+// Rational:
+// With a secret predicate every branch is evaluated and the results are
+// muxed. Branches of decision trees and piecewise functions are often the same
+// computation over different constants, muxing the constants only costs one
+// select per constant instead of running all branches.
+// A muxed constant turns into a secret, so only constants feeding
+// add/sub/mul/select are merged (a secret shift amount, divisor or exponent
+// is far more expensive than a public one), and only when the cost model
+// says the merged code is cheaper than evaluating every branch.
+struct OptimizeSecretBranches
+    : public OptimizeSecretBranchesBase<OptimizeSecretBranches> {
+  void runOnOperation() override {
+    llvm::SmallVector<Operation *> ops;
+    getOperation().walk([&](Operation *op) {
+      if (isa<IfOp, CaseOp>(op) && isSecret(op->getOperand(0))) {
+        ops.push_back(op);
+      }
+    });
+
+    for (auto *op : ops) {
+      if (!tryMerge(op)) {
+        hoist(op);
+      }
+    }
+  }
+
+private:
+  static bool isSecret(Value v) {
+    TypeTools tools;
+    return tools.getTypeVisibility(v.getType()) == Visibility::VIS_SECRET;
+  }
+
+  static Type toSecret(Type t) {
+    TypeTools tools;
+    return tools.getTypeWithVisibility(t, Visibility::VIS_SECRET);
+  }
+
+  // Muxed constants must only feed secret values, through ops which stay
+  // cheap with a secret operand.
+  static bool canMux(Operation *op, ConstantOp c) {
+    for (auto &use : c->getUses()) {
+      auto *user = use.getOwner();
+      if (user->hasTrait<OpTrait::IsTerminator>()) {
+        if (!isSecret(op->getResult(use.getOperandNumber()))) {
+          return false;
+        }
+        continue;
+      }
+      const bool elementwise =
+          isa<AddOp, SubtractOp, MulOp>(user) ||
+          (isa<SelectOp>(user) && use.getOperandNumber() != 0);
+      if (!elementwise || !llvm::all_of(user->getResults(), [](Value v) {
+            return isSecret(v);
+          })) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Communication of evaluating every branch of `op` and muxing the results.
+  static int64_t branchesCost(Operation *op) {
+    const auto &model = CostModel::getDefault();
+    int64_t bytes = 0;
+    for (auto &region : op->getRegions()) {
+      region.walk([&](Operation *nested) {
+        bytes += model.estimate(nested).bytes;
+      });
+    }
+    for (auto ret : op->getResults()) {
+      const auto numel =
+          ret.getType().cast<RankedTensorType>().getNumElements();
+      const int64_t mux = model.kernelCost("b2a", numel).bytes +
+                          model.kernelCost("mul_aa", numel).bytes;
+      bytes += mux * static_cast<int64_t>(op->getNumRegions() - 1);
+    }
+    return bytes;
+  }
+
+  static bool tryMerge(Operation *op) {
+    auto &base = op->getRegion(0).front();
+    llvm::DenseSet<Operation *> diffs;
+    for (unsigned idx = 1; idx < op->getNumRegions(); ++idx) {
+      if (!isSameModuloConstants(base, op->getRegion(idx).front(), &diffs)) {
+        return false;
+      }
+    }
+    for (auto *c : diffs) {
+      if (!canMux(op, cast<ConstantOp>(c))) {
+        return false;
+      }
+    }
+
+    OpBuilder builder(op);
+    auto *prev = op->getPrevNode();
+    llvm::DenseMap<Value, Value> mapping;
+    for (auto &nested : base) {
+      if (!diffs.contains(&nested)) {
+        continue;
+      }
+      // The constant at the same position of every branch.
+      const auto pos = std::distance(base.begin(), nested.getIterator());
+      llvm::SmallVector<ConstantOp> all;
+      for (auto &region : op->getRegions()) {
+        all.push_back(
+            cast<ConstantOp>(*std::next(region.front().begin(), pos)));
+      }
+      mapping[nested.getResult(0)] = buildMux(&builder, op, all);
+    }
+
+    for (auto &nested : base.without_terminator()) {
+      if (diffs.contains(&nested)) {
+        continue;
+      }
+      auto *cloned = builder.clone(nested);
+      for (auto &operand : cloned->getOpOperands()) {
+        auto iter = mapping.find(operand.get());
+        if (iter != mapping.end()) {
+          operand.set(iter->second);
+        }
+      }
+      for (unsigned idx = 0; idx < nested.getNumResults(); ++idx) {
+        mapping[nested.getResult(idx)] = cloned->getResult(idx);
+      }
+    }
+
+    // Ops built for the merged form, i.e. muxes and the body with secret
+    // operands.
+    llvm::SmallVector<Operation *> built;
+    for (auto *it = prev ? prev->getNextNode() : &op->getBlock()->front();
+         it != op; it = it->getNextNode()) {
+      built.push_back(it);
+    }
+
+    const auto &model = CostModel::getDefault();
+    int64_t merged_cost = 0;
+    for (auto *it : built) {
+      merged_cost += model.estimate(it).bytes;
+    }
+    if (merged_cost >= branchesCost(op)) {
+      for (auto *it : llvm::reverse(built)) {
+        it->erase();
+      }
+      return false;
+    }
+
+    llvm::SmallVector<Value> results;
+    for (auto ret : base.getTerminator()->getOperands()) {
+      auto iter = mapping.find(ret);
+      results.push_back(iter == mapping.end() ? ret : iter->second);
+    }
+    op->replaceAllUsesWith(results);
+    op->erase();
+    return true;
+  }
+
+  // Select the constant of the taken branch.
+  static Value buildMux(OpBuilder *builder, Operation *op,
+                        llvm::ArrayRef<ConstantOp> all) {
+    auto loc = all.front()->getLoc();
+    auto type = all.front().getType().cast<RankedTensorType>();
+    auto sec_type = toSecret(type);
+
+    auto clone = [&](ConstantOp c) {
+      return builder->clone(*c.getOperation())->getResult(0);
+    };
+    auto broadcastPred = [&](Value pred) -> Value {
+      if (type.getRank() == 0) {
+        return pred;
+      }
+      auto pred_type = RankedTensorType::get(
+          type.getShape(), getElementTypeOrSelf(pred.getType()));
+      return builder->create<BroadcastOp>(
+          loc, pred_type, pred,
+          DenseIntElementsAttr::get(
+              RankedTensorType::get({0}, builder->getIntegerType(64)),
+              llvm::ArrayRef<int64_t>{}));
+    };
+
+    if (auto if_op = dyn_cast<IfOp>(op)) {
+      return builder->create<SelectOp>(
+          loc, sec_type, broadcastPred(if_op.getCondition()),
+          clone(all.front()), clone(all.back()));
+    }
+
+    // Out of range indices take the last branch, so
+    //   mux = c_last + sum_b (index == b) * (c_b - c_last)
+    auto index = cast<CaseOp>(op).getIndex();
+    auto index_type = index.getType().cast<RankedTensorType>();
+    TypeTools tools;
+    auto index_el_type = tools.getExpressedType(index_type.getElementType());
+    auto eq_type = RankedTensorType::get(
+        index_type.getShape(),
+        tools.getTypeWithVisibility(builder->getI1Type(),
+                                    Visibility::VIS_SECRET));
+
+    Value last = clone(all.back());
+    Value zero = builder->create<ConstantOp>(
+        loc, builder->getZeroAttr(all.front().getValue().getType()));
+    Value ret = last;
+    for (int64_t idx = 0; idx + 1 < static_cast<int64_t>(all.size()); ++idx) {
+      auto b = builder->create<ConstantOp>(
+          loc, DenseElementsAttr::get(
+                   RankedTensorType::get(index_type.getShape(), index_el_type),
+                   builder->getIntegerAttr(index_el_type, idx)));
+      auto eq = builder->create<EqualOp>(loc, eq_type, index, b);
+      auto diff =
+          builder->create<SubtractOp>(loc, type, clone(all[idx]), last);
+      auto selected = builder->create<SelectOp>(loc, sec_type,
+                                                broadcastPred(eq), diff, zero);
+      ret = builder->create<AddOp>(loc, sec_type, ret, selected);
+    }
+    return ret;
+  }
+
+  // Move ops which only depend on values defined outside of `op` before it.
+  // Operands are checked against the regions as they are, ops consuming other
+  // branch local values stay in the branch even if those get hoisted.
+  static void hoist(Operation *op) {
+    auto isOutside = [&](Value v) {
+      return !op->isAncestor(v.getParentRegion()->getParentOp());
+    };
+
+    llvm::SmallVector<Operation *> invariants;
+    for (auto &region : op->getRegions()) {
+      for (auto &nested : region.front().without_terminator()) {
+        if (!isMemoryEffectFree(&nested)) {
+          continue;
+        }
+        bool invariant = true;
+        nested.walk([&](Operation *inner) {
+          for (auto operand : inner->getOperands()) {
+            // Values defined inside `nested` itself are fine.
+            if (!nested.isAncestor(operand.getParentRegion()->getParentOp()) &&
+                !isOutside(operand)) {
+              invariant = false;
+            }
+          }
+        });
+        if (invariant) {
+          invariants.push_back(&nested);
+        }
+      }
+    }
+
+    for (auto *nested : invariants) {
+      nested->moveBefore(op);
+    }
+  }
+};
+
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+createOptimizeSecretBranchesPass() {
+  return std::make_unique<OptimizeSecretBranches>();
+}
+
+} // namespace mlir::pphlo
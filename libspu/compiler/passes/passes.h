@@ -57,6 +57,9 @@ std::unique_ptr<OperationPass<func::FuncOp>> createLowerMixedTypeOpPass();
 // Optimize MaxPooling layer
 std::unique_ptr<OperationPass<func::FuncOp>> createOptimizeMaxPoolingPass();
 
+// Fuse softmax/layer-norm/gelu into dedicated ops
+std::unique_ptr<OperationPass<func::FuncOp>> createFuseNNPatternsPass();
+
 // Optimize SelectOp
 std::unique_ptr<OperationPass<func::FuncOp>> createOptimizeSelectPass();
 
@@ -68,6 +71,29 @@ std::unique_ptr<OperationPass<func::FuncOp>> createExpandSecretGatherPass();
 // Rewrite x/sqrt(x+eps) -> x*rsqrt(x+eps)
 std::unique_ptr<OperationPass<func::FuncOp>> createRewriteDivSqrtPatterns();
 
+// Mux constants of secret branches which only differ in constants, hoist
+// branch invariant ops otherwise
+std::unique_ptr<OperationPass<func::FuncOp>>
+createOptimizeSecretBranchesPass();
+
+// Unroll while loops with a static trip count, iterations are batched later
+std::unique_ptr<OperationPass<func::FuncOp>> createUnrollWhileLoopsPass();
+
+// Rebuild chains of secret mul/and/or as trees of logarithmic depth
+std::unique_ptr<OperationPass<func::FuncOp>> createRebalanceChainsPass();
+
+// Merge independent secret ops of the same kind into one batched op
+std::unique_ptr<OperationPass<func::FuncOp>> createBatchSecretOpsPass();
+
+// Infer bit width of integers, attach pphlo.valid_bits to comparisons
+std::unique_ptr<OperationPass<func::FuncOp>> createInferValidBitsPass();
+
+// Assign reusable buffer slots to values, attach them as `pphlo.slots`
+std::unique_ptr<OperationPass<func::FuncOp>> createPlanMemoryPass();
+
+// Print estimated online rounds, bytes and flops of each function
+std::unique_ptr<OperationPass<ModuleOp>> createCostReportPass();
+
 } // namespace pphlo
 
 } // namespace mlir
@@ -0,0 +1,147 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "mlir/IR/Builders.h"
+#include "mlir/Pass/Pass.h"
+
+#include "libspu/compiler/passes/pass_details.h"
+#include "libspu/compiler/passes/passes.h"
+#include "libspu/dialect/pphlo_ops.h"
+
+namespace mlir::pphlo {
+
+namespace {
+
+// Idea here:
+//   %0 = op(%arg0)        // slot 0
+//   %1 = op(%0)           // slot 1
+//   %2 = op(%1)           // slot 0, %0 is dead
+// Rational:
+// SymbolScope keeps every value until the scope exits, so the peak memory
+// grows with the program length. Values with disjoint lifetimes are assigned
+// to the same slot (interval coloring), the executor releases the previous
+// occupant of a slot before the slot is reused, which bounds the live values
+// of a block by its slots.
+//
+// Results of each op are annotated with `pphlo.slots`, the entry function
+// gets the naive (keep everything) and planned peak bytes for reporting.
+struct PlanMemory : public PlanMemoryBase<PlanMemory> {
+  void runOnOperation() override {
+    auto func = getOperation();
+
+    int64_t naive = 0;
+    int64_t planned = 0;
+    func.walk([&](Block *block) { planBlock(block, &naive, &planned); });
+
+    OpBuilder builder(func);
+    func->setAttr("pphlo.naive_peak_bytes", builder.getI64IntegerAttr(naive));
+    func->setAttr("pphlo.planned_peak_bytes",
+                  builder.getI64IntegerAttr(planned));
+  }
+
+private:
+  int64_t bytesOf(Type type) const {
+    auto rt = type.dyn_cast<RankedTensorType>();
+    if (!rt || !rt.hasStaticShape()) {
+      return 0;
+    }
+    return rt.getNumElements() * element_bytes_;
+  }
+
+  void planBlock(Block *block, int64_t *naive, int64_t *planned) const {
+    llvm::DenseMap<Operation *, int64_t> index;
+    for (auto &op : *block) {
+      index[&op] = static_cast<int64_t>(index.size());
+    }
+
+    // Position of the last op in this block which uses a value, uses inside
+    // nested regions are accounted to the op holding the region.
+    llvm::DenseMap<Value, int64_t> last_use;
+    for (auto &op : *block) {
+      const int64_t pos = index[&op];
+      for (auto result : op.getResults()) {
+        last_use[result] = pos;
+      }
+      op.walk([&](Operation *nested) {
+        for (auto operand : nested->getOperands()) {
+          auto *def = operand.getDefiningOp();
+          if (def != nullptr && def->getBlock() == block) {
+            last_use[operand] = std::max(last_use[operand], pos);
+          }
+        }
+      });
+    }
+
+    std::vector<int64_t> sizes;
+    // Position of the last use of the current occupant.
+    std::vector<int64_t> busy_until;
+
+    OpBuilder builder(block->getParentOp());
+    for (auto &op : *block) {
+      if (op.getNumResults() == 0) {
+        continue;
+      }
+      const int64_t pos = index[&op];
+
+      llvm::SmallVector<Attribute> slots;
+      for (auto result : op.getResults()) {
+        const int64_t bytes = bytesOf(result.getType());
+        *naive += bytes;
+
+        // Best fit among dead slots, otherwise grow the largest one.
+        int64_t slot = -1;
+        for (int64_t idx = 0; idx < static_cast<int64_t>(sizes.size());
+             ++idx) {
+          if (busy_until[idx] >= pos) {
+            continue;
+          }
+          if (slot == -1) {
+            slot = idx;
+            continue;
+          }
+          const bool fits = sizes[idx] >= bytes;
+          const bool best_fits = sizes[slot] >= bytes;
+          if ((fits && (!best_fits || sizes[idx] < sizes[slot])) ||
+              (!fits && !best_fits && sizes[idx] > sizes[slot])) {
+            slot = idx;
+          }
+        }
+        if (slot == -1) {
+          slot = static_cast<int64_t>(sizes.size());
+          sizes.push_back(0);
+          busy_until.push_back(0);
+        }
+
+        sizes[slot] = std::max(sizes[slot], bytes);
+        busy_until[slot] = last_use[result];
+        slots.push_back(builder.getI64IntegerAttr(slot));
+      }
+      op.setAttr("pphlo.slots", builder.getArrayAttr(slots));
+    }
+
+    *planned += std::accumulate(sizes.begin(), sizes.end(), int64_t{0});
+  }
+};
+
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> createPlanMemoryPass() {
+  return std::make_unique<PlanMemory>();
+}
+
+} // namespace mlir::pphlo
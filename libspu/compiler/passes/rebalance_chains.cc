@@ -0,0 +1,212 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <functional>
+
+#include "mlir/IR/Builders.h"
+#include "mlir/Pass/Pass.h"
+
+#include "libspu/compiler/passes/cost_model.h"
+#include "libspu/compiler/passes/pass_details.h"
+#include "libspu/compiler/passes/passes.h"
+#include "libspu/dialect/pphlo_ops.h"
+#include "libspu/dialect/pphlo_types.h"
+
+namespace mlir::pphlo {
+
+namespace {
+
+bool isSecret(Type t) {
+  TypeTools tools;
+  return tools.getTypeVisibility(t) == Visibility::VIS_SECRET;
+}
+
+// Idea here:
+//   %0 = mul(%a, %b)
+//   %1 = mul(%0, %c)
+//   %2 = mul(%1, %d)
+// into
+//   %0 = mul(%a, %b)
+//   %1 = mul(%c, %d)
+//   %2 = mul(%0, %1)
+// Rational:
+// Each link of a chain of secret multiplications (and/or) is one protocol
+// round after the other. The op is associative and commutative, so the chain
+// is rebuilt as a tree which combines the earliest available operands first
+// (public operands are free to combine), the depth drops from O(n) to
+// O(log n). Ops at the same level of the tree are later merged into one
+// kernel call by BatchSecretOps.
+//
+// Fixed-point products are truncated in a different order, which only
+// changes rounding errors.
+struct RebalanceChains : public RebalanceChainsBase<RebalanceChains> {
+  void runOnOperation() override {
+    getOperation().walk([&](Block *block) { rebalanceBlock(block); });
+  }
+
+private:
+  // Estimated rounds until the results of an op are available.
+  llvm::DenseMap<Value, int64_t> ready_;
+
+  static bool isChainOp(Operation *op) {
+    return isa<MulOp, AndOp, OrOp>(op);
+  }
+
+  // Inner links of a chain have exactly one use, which is the next link.
+  static bool isInnerLink(Operation *op) {
+    if (!op->hasOneUse()) {
+      return false;
+    }
+    auto *user = *op->getUsers().begin();
+    return user->getName() == op->getName() &&
+           user->getBlock() == op->getBlock() &&
+           getElementTypeOrSelf(user->getResult(0).getType()) ==
+               getElementTypeOrSelf(op->getResult(0).getType());
+  }
+
+  int64_t readyOf(Value v) const { return ready_.lookup(v); }
+
+  void rebalanceBlock(Block *block) {
+    ready_.clear();
+    const auto &model = CostModel::getDefault();
+
+    for (auto &op : llvm::make_early_inc_range(*block)) {
+      int64_t start = 0;
+      for (auto operand : op.getOperands()) {
+        start = std::max(start, readyOf(operand));
+      }
+      const int64_t rounds =
+          op.getNumRegions() == 0 ? model.estimate(&op).rounds : 0;
+      for (auto result : op.getResults()) {
+        ready_[result] = start + rounds;
+      }
+
+      if (isChainOp(&op) && !isInnerLink(&op) &&
+          isSecret(op.getResult(0).getType())) {
+        rebalance(&op, model);
+      }
+    }
+  }
+
+  void rebalance(Operation *root, const CostModel &model) {
+    TypeTools tools;
+    const auto expressed = tools.getExpressedType(root->getResult(0).getType());
+
+    // Collect leaves from left to right, inner links are erased afterwards.
+    llvm::SmallVector<Value> leaves;
+    llvm::SmallVector<Operation *> links;
+    std::function<void(Operation *)> collect = [&](Operation *link) {
+      links.push_back(link);
+      for (auto operand : link->getOperands()) {
+        auto *def = operand.getDefiningOp();
+        if (def != nullptr && def->getName() == root->getName() &&
+            isInnerLink(def)) {
+          collect(def);
+        } else {
+          leaves.push_back(operand);
+        }
+      }
+    };
+    collect(root);
+
+    // Rounds of a link with two secret operands, a public operand is assumed
+    // to be (almost) free.
+    int64_t link_rounds = 0;
+    for (auto *link : links) {
+      link_rounds = std::max(link_rounds, model.estimate(link).rounds);
+    }
+
+    // Mixed int/fxp operands need casts of their own, leave them alone.
+    if (leaves.size() < 3 ||
+        llvm::any_of(leaves, [&](Value v) {
+          return tools.getExpressedType(v.getType()) != expressed;
+        })) {
+      return;
+    }
+
+    // Repeatedly combine the two earliest available operands.
+    struct Node {
+      Value value;
+      int64_t ready;
+    };
+    llvm::SmallVector<Node> nodes;
+    for (auto leaf : leaves) {
+      // Public operands combine locally.
+      nodes.push_back({leaf, isSecret(leaf.getType()) ? readyOf(leaf) : -1});
+    }
+    auto earliest = [](const Node &a, const Node &b) {
+      return a.ready < b.ready;
+    };
+    // Ready time of combining lhs and rhs, -1 for public results.
+    auto combine = [&](const Node &lhs, const Node &rhs) -> int64_t {
+      if (lhs.ready < 0 && rhs.ready < 0) {
+        return -1;
+      }
+      const int64_t start = std::max<int64_t>({lhs.ready, rhs.ready, 0});
+      return (lhs.ready >= 0 && rhs.ready >= 0) ? start + link_rounds : start;
+    };
+
+    // Dry run for the depth of the balanced tree.
+    {
+      auto sim = nodes;
+      while (sim.size() > 1) {
+        std::stable_sort(sim.begin(), sim.end(), earliest);
+        const int64_t ready = combine(sim[0], sim[1]);
+        sim.erase(sim.begin(), sim.begin() + 2);
+        sim.push_back({Value(), ready});
+      }
+      if (sim.front().ready >= readyOf(root->getResult(0))) {
+        return;
+      }
+    }
+
+    OpBuilder builder(root);
+    const auto shape =
+        root->getResult(0).getType().cast<RankedTensorType>().getShape();
+    while (nodes.size() > 1) {
+      std::stable_sort(nodes.begin(), nodes.end(), earliest);
+      const auto lhs = nodes[0];
+      const auto rhs = nodes[1];
+      const int64_t ready = combine(lhs, rhs);
+      const bool secret = ready >= 0;
+
+      auto type = RankedTensorType::get(
+          shape, secret ? tools.toMPCType<SecretType>(expressed)
+                        : tools.toMPCType<PublicType>(expressed));
+      OperationState state(root->getLoc(), root->getName());
+      state.addOperands({lhs.value, rhs.value});
+      state.addTypes(type);
+      auto *combined = builder.create(state);
+
+      ready_[combined->getResult(0)] = std::max<int64_t>(ready, 0);
+      nodes.erase(nodes.begin(), nodes.begin() + 2);
+      nodes.push_back({combined->getResult(0), ready});
+    }
+
+    root->getResult(0).replaceAllUsesWith(nodes.front().value);
+    // Links are collected from the root, users go first.
+    for (auto *link : links) {
+      link->erase();
+    }
+  }
+};
+
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> createRebalanceChainsPass() {
+  return std::make_unique<RebalanceChains>();
+}
+
+} // namespace mlir::pphlo
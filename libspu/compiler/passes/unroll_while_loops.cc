@@ -0,0 +1,236 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <optional>
+
+#include "llvm/ADT/DenseSet.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/Pass/Pass.h"
+
+#include "libspu/compiler/passes/cost_model.h"
+#include "libspu/compiler/passes/pass_details.h"
+#include "libspu/compiler/passes/passes.h"
+#include "libspu/dialect/pphlo_ops.h"
+#include "libspu/dialect/pphlo_types.h"
+
+namespace mlir::pphlo {
+
+namespace {
+
+std::optional<int64_t> getIntConstant(Value v) {
+  auto c = v.getDefiningOp<ConstantOp>();
+  if (!c) {
+    return std::nullopt;
+  }
+  auto attr = c.getValue().dyn_cast<DenseIntElementsAttr>();
+  if (!attr || !attr.isSplat() || attr.getElementType().isInteger(1)) {
+    return std::nullopt;
+  }
+  return attr.getSplatValue<APInt>().getSExtValue();
+}
+
+// Idea here:
+//   %r = while(%i = 0, %n = 3, %x) {
+//     cond: less(%i, %n)
+//     body: %i + 1, %n, f(%i, %x)
+//   }
+// into
+//   %x1 = f(0, %x)
+//   %x2 = f(1, %x1)
+//   %r  = f(2, %x2)
+// Rational:
+// hlo::While runs the cond and body regions one iteration after another, every
+// iteration pays the full protocol rounds of its body. Once a loop with a
+// public, static trip count is unrolled, iterations that do not depend on each
+// other (per-row processing, accumulators) sit at the same depth of the
+// dataflow graph, and BatchSecretOps merges them into single kernel calls, so
+// rounds drop from O(iterations * depth) to O(depth).
+// Loops where an interactive secret op consumes a secret value carried from
+// the previous iteration gain nothing, every iteration still waits for the
+// rounds of the previous one, so they are kept as is.
+struct UnrollWhileLoops : public UnrollWhileLoopsBase<UnrollWhileLoops> {
+  void runOnOperation() override {
+    llvm::SmallVector<WhileOp> loops;
+    // Post order, inner loops are unrolled first.
+    getOperation().walk([&](WhileOp op) { loops.push_back(op); });
+
+    for (auto op : loops) {
+      auto trip_count = getTripCount(op);
+      if (!trip_count.has_value() || *trip_count > max_trip_count_) {
+        continue;
+      }
+      int64_t body_ops = 0;
+      op.getBody().walk([&](Operation *) { ++body_ops; });
+      if (body_ops * *trip_count > max_unrolled_ops_ ||
+          hasCarriedSecretDependency(op)) {
+        continue;
+      }
+      unroll(op, *trip_count);
+    }
+  }
+
+private:
+  // True if an op with communication rounds depends on a secret argument
+  // updated by the body, i.e. iteration i + 1 waits for the rounds of
+  // iteration i. Local ops on carried values, e.g. accumulators and updating
+  // slices at public indices, are fine.
+  static bool hasCarriedSecretDependency(WhileOp op) {
+    TypeTools tools;
+    auto &body = op.getBody().front();
+    auto *ret = body.getTerminator();
+
+    llvm::DenseSet<Value> carried;
+    for (auto arg : body.getArguments()) {
+      if (tools.getTypeVisibility(arg.getType()) == Visibility::VIS_SECRET &&
+          ret->getOperand(arg.getArgNumber()) != arg) {
+        carried.insert(arg);
+      }
+    }
+
+    const auto &model = CostModel::getDefault();
+    for (auto &nested : body.without_terminator()) {
+      bool depends = false;
+      bool interactive = false;
+      // Ops of nested regions may capture carried values as well.
+      nested.walk([&](Operation *inner) {
+        depends |= llvm::any_of(inner->getOperands(), [&](Value v) {
+          return carried.contains(v);
+        });
+        interactive |= model.estimate(inner).rounds > 0;
+      });
+      if (!depends) {
+        continue;
+      }
+      if (interactive) {
+        return true;
+      }
+      carried.insert(nested.getResults().begin(), nested.getResults().end());
+    }
+    return false;
+  }
+
+  // Trip count of `while (i < n) { i += step }` where i, n, step are integer
+  // constants, n may be a loop invariant argument.
+  static std::optional<int64_t> getTripCount(WhileOp op) {
+    auto &cond = op.getCond().front();
+    auto &body = op.getBody().front();
+
+    for (auto &nested : cond.without_terminator()) {
+      if (!isa<ConstantOp, LessOp>(nested)) {
+        return std::nullopt;
+      }
+    }
+    auto *cond_ret = cond.getTerminator();
+    if (cond_ret->getNumOperands() != 1) {
+      return std::nullopt;
+    }
+    auto less = cond_ret->getOperand(0).getDefiningOp<LessOp>();
+    if (!less) {
+      return std::nullopt;
+    }
+
+    // Initial value of a cond argument, which is never changed by the body if
+    // `invariant` is set.
+    auto initOf = [&](Value v, bool invariant) -> std::optional<int64_t> {
+      auto arg = v.dyn_cast<BlockArgument>();
+      if (!arg || arg.getOwner() != &cond) {
+        return std::nullopt;
+      }
+      const auto idx = arg.getArgNumber();
+      if (invariant &&
+          body.getTerminator()->getOperand(idx) != body.getArgument(idx)) {
+        return std::nullopt;
+      }
+      return getIntConstant(op->getOperand(idx));
+    };
+
+    auto limit = getIntConstant(less.getRhs());
+    if (!limit.has_value()) {
+      limit = initOf(less.getRhs(), /*invariant*/ true);
+    }
+    auto init = initOf(less.getLhs(), /*invariant*/ false);
+    if (!limit.has_value() || !init.has_value()) {
+      return std::nullopt;
+    }
+
+    // i = i + step
+    const auto idx = less.getLhs().cast<BlockArgument>().getArgNumber();
+    auto add = body.getTerminator()->getOperand(idx).getDefiningOp<AddOp>();
+    if (!add || add->getBlock() != &body) {
+      return std::nullopt;
+    }
+    std::optional<int64_t> step;
+    if (add.getLhs() == body.getArgument(idx)) {
+      step = getIntConstant(add.getRhs());
+    } else if (add.getRhs() == body.getArgument(idx)) {
+      step = getIntConstant(add.getLhs());
+    }
+    if (!step.has_value() || *step <= 0) {
+      return std::nullopt;
+    }
+
+    if (*limit <= *init) {
+      return 0;
+    }
+    return (*limit - *init + *step - 1) / *step;
+  }
+
+  static void unroll(WhileOp op, int64_t trip_count) {
+    auto &body = op.getBody().front();
+    llvm::SmallVector<Value> carried(op->getOperands().begin(),
+                                     op->getOperands().end());
+
+    OpBuilder builder(op);
+    for (int64_t iter = 0; iter < trip_count; ++iter) {
+      llvm::DenseMap<Value, Value> mapping;
+      for (auto arg : body.getArguments()) {
+        mapping[arg] = carried[arg.getArgNumber()];
+      }
+
+      for (auto &nested : body.without_terminator()) {
+        auto *cloned = builder.clone(nested);
+        // Values captured by nested regions are remapped as well.
+        cloned->walk([&](Operation *inner) {
+          for (auto &operand : inner->getOpOperands()) {
+            auto mapped = mapping.find(operand.get());
+            if (mapped != mapping.end()) {
+              operand.set(mapped->second);
+            }
+          }
+        });
+        for (unsigned idx = 0; idx < nested.getNumResults(); ++idx) {
+          mapping[nested.getResult(idx)] = cloned->getResult(idx);
+        }
+      }
+
+      auto *ret = body.getTerminator();
+      for (unsigned idx = 0; idx < ret->getNumOperands(); ++idx) {
+        auto mapped = mapping.find(ret->getOperand(idx));
+        carried[idx] =
+            mapped == mapping.end() ? ret->getOperand(idx) : mapped->second;
+      }
+    }
+
+    op->replaceAllUsesWith(carried);
+    op->erase();
+  }
+};
+
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> createUnrollWhileLoopsPass() {
+  return std::make_unique<UnrollWhileLoops>();
+}
+
+} // namespace mlir::pphlo
@@ -0,0 +1,38 @@
+// RUN: mlir-pphlo-opt --batch-secret-ops --split-input-file %s | FileCheck %s
+
+func.func @main(%arg0: tensor<2x2x!pphlo.sec<f32>>, %arg1: tensor<2x2x!pphlo.sec<f32>>, %arg2: tensor<3x!pphlo.sec<f32>>, %arg3: tensor<3x!pphlo.pub<f32>>) -> (tensor<2x2x!pphlo.sec<i1>>, tensor<3x!pphlo.sec<i1>>) {
+    //CHECK: %[[LHS:.*]] = "pphlo.concatenate"
+    //CHECK-SAME: -> tensor<7x!pphlo.sec<f32>>
+    //CHECK: %[[RHS:.*]] = "pphlo.concatenate"
+    //CHECK-SAME: -> tensor<7x!pphlo.sec<f32>>
+    //CHECK: %[[LESS:.*]] = "pphlo.less"(%[[LHS]], %[[RHS]])
+    //CHECK-NOT: "pphlo.less"
+    //CHECK: "pphlo.slice"(%[[LESS]])
+    //CHECK: "pphlo.slice"(%[[LESS]])
+    %0 = "pphlo.less"(%arg0, %arg1) : (tensor<2x2x!pphlo.sec<f32>>, tensor<2x2x!pphlo.sec<f32>>) -> tensor<2x2x!pphlo.sec<i1>>
+    %1 = "pphlo.convert"(%arg3) : (tensor<3x!pphlo.pub<f32>>) -> tensor<3x!pphlo.sec<f32>>
+    %2 = "pphlo.less"(%arg2, %1) : (tensor<3x!pphlo.sec<f32>>, tensor<3x!pphlo.sec<f32>>) -> tensor<3x!pphlo.sec<i1>>
+    return %0, %2 : tensor<2x2x!pphlo.sec<i1>>, tensor<3x!pphlo.sec<i1>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<3x!pphlo.sec<f32>>, %arg1: tensor<3x!pphlo.sec<f32>>) -> (tensor<3x!pphlo.sec<f32>>) {
+    // Dependent multiplies must not be merged
+    //CHECK-NOT: pphlo.concatenate
+    //CHECK: "pphlo.multiply"(%arg0, %arg1)
+    //CHECK: "pphlo.multiply"
+    %0 = "pphlo.multiply"(%arg0, %arg1) : (tensor<3x!pphlo.sec<f32>>, tensor<3x!pphlo.sec<f32>>) -> tensor<3x!pphlo.sec<f32>>
+    %1 = "pphlo.multiply"(%0, %arg1) : (tensor<3x!pphlo.sec<f32>>, tensor<3x!pphlo.sec<f32>>) -> tensor<3x!pphlo.sec<f32>>
+    return %1 : tensor<3x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<3x!pphlo.pub<f32>>, %arg1: tensor<3x!pphlo.pub<f32>>) -> (tensor<3x!pphlo.pub<i1>>, tensor<3x!pphlo.pub<i1>>) {
+    // Public comparisons are local, nothing to batch
+    //CHECK-NOT: pphlo.concatenate
+    %0 = "pphlo.less"(%arg0, %arg1) : (tensor<3x!pphlo.pub<f32>>, tensor<3x!pphlo.pub<f32>>) -> tensor<3x!pphlo.pub<i1>>
+    %1 = "pphlo.less"(%arg1, %arg0) : (tensor<3x!pphlo.pub<f32>>, tensor<3x!pphlo.pub<f32>>) -> tensor<3x!pphlo.pub<i1>>
+    return %0, %1 : tensor<3x!pphlo.pub<i1>>, tensor<3x!pphlo.pub<i1>>
+}
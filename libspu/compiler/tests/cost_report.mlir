@@ -0,0 +1,19 @@
+// RUN: mlir-pphlo-opt --cost-report %s | FileCheck %s
+// RUN: mlir-pphlo-opt --cost-report="protocol=ABY3" %s | FileCheck %s --check-prefix=ABY3
+
+func.func @main(%arg0: tensor<4x!pphlo.sec<f32>>, %arg1: tensor<4x!pphlo.sec<f32>>, %arg2: tensor<4x!pphlo.pub<f32>>) -> (tensor<4x!pphlo.sec<f32>>) {
+    // CHECK: cost report of @main (SEMI2K, K=64, N=2)
+    // CHECK-NOT: pphlo.add
+    // CHECK: pphlo.multiply{{ +}}3{{ +}}5{{ +}}224{{ +}}24
+    // CHECK: total{{ +}}5{{ +}}224{{ +}}32
+    // CHECK: critical path rounds: 2
+    // ABY3: cost report of @main (ABY3, K=64, N=2)
+    // ABY3: pphlo.multiply{{ +}}3{{ +}}11{{ +}}448{{ +}}24
+    // ABY3: critical path rounds: 4
+    %0 = "pphlo.multiply"(%arg0, %arg1) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    %1 = "pphlo.multiply"(%arg1, %arg0) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    %2 = "pphlo.multiply"(%arg0, %arg2) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.pub<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    %3 = "pphlo.add"(%0, %1) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    %4 = "pphlo.add"(%3, %2) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    return %4 : tensor<4x!pphlo.sec<f32>>
+}
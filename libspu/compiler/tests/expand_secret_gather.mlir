@@ -12,3 +12,15 @@ func.func @main(%arg0: tensor<3x3x!pphlo.pub<i32>>, %arg1: tensor<2x!pphlo.sec<i
     %0 = "pphlo.gather"(%arg0, %arg1) {dimension_numbers = #pphlo.gather<offset_dims = [1], collapsed_slice_dims = [0], start_index_map = [0], index_vector_dim = 1>, indices_are_sorted = false, slice_sizes = dense<[1, 3]> : tensor<2xi64>} : (tensor<3x3x!pphlo.pub<i32>>, tensor<2x!pphlo.sec<i32>>) -> tensor<2x3x!pphlo.sec<i32>>
     return %0 : tensor<2x3x!pphlo.sec<i32>>
 }
+
+// -----
+func.func @main(%arg0: tensor<4x3x!pphlo.sec<f32>>, %arg1: tensor<2x1x!pphlo.sec<i32>>) -> (tensor<2x3x!pphlo.sec<f32>>) {
+    //CHECK-NOT: pphlo.gather
+    //CHECK-NOT: pphlo.while
+    //CHECK: pphlo.clamp
+    //CHECK: pphlo.iota
+    //CHECK: pphlo.equal
+    //CHECK: pphlo.dot
+    %0 = "pphlo.gather"(%arg0, %arg1) {dimension_numbers = #pphlo.gather<offset_dims = [1], collapsed_slice_dims = [0], start_index_map = [0], index_vector_dim = 1>, indices_are_sorted = false, slice_sizes = dense<[1, 3]> : tensor<2xi64>} : (tensor<4x3x!pphlo.sec<f32>>, tensor<2x1x!pphlo.sec<i32>>) -> tensor<2x3x!pphlo.sec<f32>>
+    return %0 : tensor<2x3x!pphlo.sec<f32>>
+}
@@ -0,0 +1,92 @@
+// RUN: mlir-pphlo-opt --fuse-nn-patterns --split-input-file %s | FileCheck %s
+
+func.func @main(%arg0: tensor<2x5x!pphlo.sec<f32>>) -> (tensor<2x5x!pphlo.sec<f32>>) {
+    %0 = "pphlo.constant"() {value = dense<0xFF800000> : tensor<f32>} : () -> tensor<!pphlo.pub<f32>>
+    %1 = "pphlo.constant"() {value = dense<0.000000e+00> : tensor<f32>} : () -> tensor<!pphlo.pub<f32>>
+    %2 = "pphlo.reduce"(%arg0, %0) ({
+    ^bb0(%arg1: tensor<!pphlo.sec<f32>>, %arg2: tensor<!pphlo.sec<f32>>):
+      %10 = "pphlo.maximum"(%arg1, %arg2) : (tensor<!pphlo.sec<f32>>, tensor<!pphlo.sec<f32>>) -> tensor<!pphlo.sec<f32>>
+      "pphlo.return"(%10) : (tensor<!pphlo.sec<f32>>) -> ()
+    }) {dimensions = dense<1> : tensor<1xi64>} : (tensor<2x5x!pphlo.sec<f32>>, tensor<!pphlo.pub<f32>>) -> tensor<2x!pphlo.sec<f32>>
+    %3 = "pphlo.broadcast"(%2) {broadcast_dimensions = dense<0> : tensor<1xi64>} : (tensor<2x!pphlo.sec<f32>>) -> tensor<2x5x!pphlo.sec<f32>>
+    %4 = "pphlo.subtract"(%arg0, %3) : (tensor<2x5x!pphlo.sec<f32>>, tensor<2x5x!pphlo.sec<f32>>) -> tensor<2x5x!pphlo.sec<f32>>
+    %5 = "pphlo.exponential"(%4) : (tensor<2x5x!pphlo.sec<f32>>) -> tensor<2x5x!pphlo.sec<f32>>
+    %6 = "pphlo.reduce"(%5, %1) ({
+    ^bb0(%arg1: tensor<!pphlo.sec<f32>>, %arg2: tensor<!pphlo.sec<f32>>):
+      %10 = "pphlo.add"(%arg1, %arg2) : (tensor<!pphlo.sec<f32>>, tensor<!pphlo.sec<f32>>) -> tensor<!pphlo.sec<f32>>
+      "pphlo.return"(%10) : (tensor<!pphlo.sec<f32>>) -> ()
+    }) {dimensions = dense<1> : tensor<1xi64>} : (tensor<2x5x!pphlo.sec<f32>>, tensor<!pphlo.pub<f32>>) -> tensor<2x!pphlo.sec<f32>>
+    %7 = "pphlo.reshape"(%6) : (tensor<2x!pphlo.sec<f32>>) -> tensor<2x1x!pphlo.sec<f32>>
+    %8 = "pphlo.broadcast"(%7) {broadcast_dimensions = dense<[0, 1]> : tensor<2xi64>} : (tensor<2x1x!pphlo.sec<f32>>) -> tensor<2x5x!pphlo.sec<f32>>
+    //CHECK: "pphlo.softmax"(%arg0) {axis = 1 : i64} : (tensor<2x5x!pphlo.sec<f32>>) -> tensor<2x5x!pphlo.sec<f32>>
+    //CHECK-NOT: pphlo.divide
+    %9 = "pphlo.divide"(%5, %8) : (tensor<2x5x!pphlo.sec<f32>>, tensor<2x5x!pphlo.sec<f32>>) -> tensor<2x5x!pphlo.sec<f32>>
+    return %9 : tensor<2x5x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<2x5x!pphlo.sec<f32>>) -> (tensor<2x5x!pphlo.sec<f32>>) {
+    %0 = "pphlo.constant"() {value = dense<0.000000e+00> : tensor<f32>} : () -> tensor<!pphlo.pub<f32>>
+    %1 = "pphlo.constant"() {value = dense<5.000000e+00> : tensor<2xf32>} : () -> tensor<2x!pphlo.pub<f32>>
+    %2 = "pphlo.constant"() {value = dense<9.99999974E-6> : tensor<2xf32>} : () -> tensor<2x!pphlo.pub<f32>>
+    %3 = "pphlo.reduce"(%arg0, %0) ({
+    ^bb0(%arg1: tensor<!pphlo.sec<f32>>, %arg2: tensor<!pphlo.sec<f32>>):
+      %20 = "pphlo.add"(%arg1, %arg2) : (tensor<!pphlo.sec<f32>>, tensor<!pphlo.sec<f32>>) -> tensor<!pphlo.sec<f32>>
+      "pphlo.return"(%20) : (tensor<!pphlo.sec<f32>>) -> ()
+    }) {dimensions = dense<1> : tensor<1xi64>} : (tensor<2x5x!pphlo.sec<f32>>, tensor<!pphlo.pub<f32>>) -> tensor<2x!pphlo.sec<f32>>
+    %4 = "pphlo.divide"(%3, %1) : (tensor<2x!pphlo.sec<f32>>, tensor<2x!pphlo.pub<f32>>) -> tensor<2x!pphlo.sec<f32>>
+    %5 = "pphlo.broadcast"(%4) {broadcast_dimensions = dense<0> : tensor<1xi64>} : (tensor<2x!pphlo.sec<f32>>) -> tensor<2x5x!pphlo.sec<f32>>
+    %6 = "pphlo.subtract"(%arg0, %5) : (tensor<2x5x!pphlo.sec<f32>>, tensor<2x5x!pphlo.sec<f32>>) -> tensor<2x5x!pphlo.sec<f32>>
+    %7 = "pphlo.multiply"(%6, %6) : (tensor<2x5x!pphlo.sec<f32>>, tensor<2x5x!pphlo.sec<f32>>) -> tensor<2x5x!pphlo.sec<f32>>
+    %8 = "pphlo.reduce"(%7, %0) ({
+    ^bb0(%arg1: tensor<!pphlo.sec<f32>>, %arg2: tensor<!pphlo.sec<f32>>):
+      %20 = "pphlo.add"(%arg1, %arg2) : (tensor<!pphlo.sec<f32>>, tensor<!pphlo.sec<f32>>) -> tensor<!pphlo.sec<f32>>
+      "pphlo.return"(%20) : (tensor<!pphlo.sec<f32>>) -> ()
+    }) {dimensions = dense<1> : tensor<1xi64>} : (tensor<2x5x!pphlo.sec<f32>>, tensor<!pphlo.pub<f32>>) -> tensor<2x!pphlo.sec<f32>>
+    %9 = "pphlo.divide"(%8, %1) : (tensor<2x!pphlo.sec<f32>>, tensor<2x!pphlo.pub<f32>>) -> tensor<2x!pphlo.sec<f32>>
+    %10 = "pphlo.add"(%9, %2) : (tensor<2x!pphlo.sec<f32>>, tensor<2x!pphlo.pub<f32>>) -> tensor<2x!pphlo.sec<f32>>
+    %11 = "pphlo.rsqrt"(%10) : (tensor<2x!pphlo.sec<f32>>) -> tensor<2x!pphlo.sec<f32>>
+    %12 = "pphlo.broadcast"(%11) {broadcast_dimensions = dense<0> : tensor<1xi64>} : (tensor<2x!pphlo.sec<f32>>) -> tensor<2x5x!pphlo.sec<f32>>
+    //CHECK: "pphlo.layer_norm"(%arg0) {axis = 1 : i64, epsilon = 9.99{{.*}}E-6 : f64} : (tensor<2x5x!pphlo.sec<f32>>) -> tensor<2x5x!pphlo.sec<f32>>
+    //CHECK-NOT: pphlo.rsqrt
+    %13 = "pphlo.multiply"(%6, %12) : (tensor<2x5x!pphlo.sec<f32>>, tensor<2x5x!pphlo.sec<f32>>) -> tensor<2x5x!pphlo.sec<f32>>
+    return %13 : tensor<2x5x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<4x!pphlo.sec<f32>>) -> (tensor<4x!pphlo.sec<f32>>) {
+    %0 = "pphlo.constant"() {value = dense<4.471500e-02> : tensor<4xf32>} : () -> tensor<4x!pphlo.pub<f32>>
+    %1 = "pphlo.constant"() {value = dense<0.797884583> : tensor<4xf32>} : () -> tensor<4x!pphlo.pub<f32>>
+    %2 = "pphlo.constant"() {value = dense<1.000000e+00> : tensor<4xf32>} : () -> tensor<4x!pphlo.pub<f32>>
+    %3 = "pphlo.constant"() {value = dense<5.000000e-01> : tensor<4xf32>} : () -> tensor<4x!pphlo.pub<f32>>
+    %4 = "pphlo.multiply"(%arg0, %arg0) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    %5 = "pphlo.multiply"(%4, %arg0) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    %6 = "pphlo.multiply"(%0, %5) : (tensor<4x!pphlo.pub<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    %7 = "pphlo.add"(%arg0, %6) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    %8 = "pphlo.multiply"(%1, %7) : (tensor<4x!pphlo.pub<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    %9 = "pphlo.tanh"(%8) : (tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    %10 = "pphlo.add"(%2, %9) : (tensor<4x!pphlo.pub<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    %11 = "pphlo.multiply"(%3, %10) : (tensor<4x!pphlo.pub<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    //CHECK: "pphlo.gelu"(%arg0) : (tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    //CHECK-NOT: pphlo.tanh
+    %12 = "pphlo.multiply"(%arg0, %11) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    return %12 : tensor<4x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<4x!pphlo.sec<f32>>) -> (tensor<4x!pphlo.sec<f32>>) {
+    %0 = "pphlo.constant"() {value = dense<2.000000e-01> : tensor<4xf32>} : () -> tensor<4x!pphlo.pub<f32>>
+    %1 = "pphlo.constant"() {value = dense<1.000000e+00> : tensor<4xf32>} : () -> tensor<4x!pphlo.pub<f32>>
+    %2 = "pphlo.constant"() {value = dense<5.000000e-01> : tensor<4xf32>} : () -> tensor<4x!pphlo.pub<f32>>
+    %3 = "pphlo.multiply"(%0, %arg0) : (tensor<4x!pphlo.pub<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    %4 = "pphlo.tanh"(%3) : (tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    %5 = "pphlo.add"(%1, %4) : (tensor<4x!pphlo.pub<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    %6 = "pphlo.multiply"(%2, %5) : (tensor<4x!pphlo.pub<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    //CHECK: pphlo.tanh
+    //CHECK-NOT: pphlo.gelu
+    %7 = "pphlo.multiply"(%arg0, %6) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    return %7 : tensor<4x!pphlo.sec<f32>>
+}
@@ -0,0 +1,24 @@
+// RUN: mlir-pphlo-opt --infer-valid-bits --split-input-file %s | FileCheck %s
+
+func.func @main(%arg0: tensor<4x!pphlo.sec<i8>>, %arg1: tensor<4x!pphlo.sec<i8>>, %arg2: tensor<4x!pphlo.sec<i32>>) -> (tensor<4x!pphlo.sec<i1>>, tensor<4x!pphlo.sec<i1>>) {
+    %0 = "pphlo.convert"(%arg0) : (tensor<4x!pphlo.sec<i8>>) -> tensor<4x!pphlo.sec<i32>>
+    %1 = "pphlo.convert"(%arg1) : (tensor<4x!pphlo.sec<i8>>) -> tensor<4x!pphlo.sec<i32>>
+    %2 = "pphlo.add"(%0, %1) : (tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.sec<i32>>) -> tensor<4x!pphlo.sec<i32>>
+    //CHECK: "pphlo.less"(%2, %1) {pphlo.valid_bits = 10 : i64}
+    %3 = "pphlo.less"(%2, %1) : (tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.sec<i32>>) -> tensor<4x!pphlo.sec<i1>>
+    //CHECK: "pphlo.greater"(%2, %arg2)
+    //CHECK-NOT: valid_bits
+    %4 = "pphlo.greater"(%2, %arg2) : (tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.sec<i32>>) -> tensor<4x!pphlo.sec<i1>>
+    return %3, %4 : tensor<4x!pphlo.sec<i1>>, tensor<4x!pphlo.sec<i1>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<4x!pphlo.sec<i1>>, %arg1: tensor<4x!pphlo.sec<i32>>) -> (tensor<4x!pphlo.sec<i1>>) {
+    %0 = "pphlo.constant"() {value = dense<100> : tensor<4xi32>} : () -> tensor<4x!pphlo.pub<i32>>
+    %1 = "pphlo.constant"() {value = dense<0> : tensor<4xi32>} : () -> tensor<4x!pphlo.pub<i32>>
+    %2 = "pphlo.select"(%arg0, %0, %1) : (tensor<4x!pphlo.sec<i1>>, tensor<4x!pphlo.pub<i32>>, tensor<4x!pphlo.pub<i32>>) -> tensor<4x!pphlo.sec<i32>>
+    //CHECK: "pphlo.less_equal"(%2, %0) {pphlo.valid_bits = 9 : i64}
+    %3 = "pphlo.less_equal"(%2, %0) : (tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.pub<i32>>) -> tensor<4x!pphlo.sec<i1>>
+    return %3 : tensor<4x!pphlo.sec<i1>>
+}
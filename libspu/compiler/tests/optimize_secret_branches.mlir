@@ -0,0 +1,143 @@
+// RUN: mlir-pphlo-opt --optimize-secret-branches --split-input-file %s | FileCheck %s
+
+func.func @main(%arg0: tensor<!pphlo.sec<i1>>, %arg1: tensor<4x!pphlo.sec<f32>>) -> (tensor<4x!pphlo.sec<f32>>) {
+    // One select and a secret mul instead of two exponentials.
+    //CHECK-NOT: pphlo.if
+    //CHECK: %[[PRED:.*]] = "pphlo.broadcast"(%arg0)
+    //CHECK: %[[C:.*]] = "pphlo.select"(%[[PRED]]
+    //CHECK: %[[M:.*]] = "pphlo.multiply"(%arg1, %[[C]])
+    //CHECK: "pphlo.exponential"(%[[M]])
+    %0 = "pphlo.if"(%arg0) ({
+      %1 = "pphlo.constant"() {value = dense<5.000000e-01> : tensor<4xf32>} : () -> tensor<4x!pphlo.pub<f32>>
+      %2 = "pphlo.multiply"(%arg1, %1) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.pub<f32>>) -> tensor<4x!pphlo.sec<f32>>
+      %3 = "pphlo.exponential"(%2) : (tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+      "pphlo.return"(%3) : (tensor<4x!pphlo.sec<f32>>) -> ()
+    }, {
+      %1 = "pphlo.constant"() {value = dense<2.000000e+00> : tensor<4xf32>} : () -> tensor<4x!pphlo.pub<f32>>
+      %2 = "pphlo.multiply"(%arg1, %1) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.pub<f32>>) -> tensor<4x!pphlo.sec<f32>>
+      %3 = "pphlo.exponential"(%2) : (tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+      "pphlo.return"(%3) : (tensor<4x!pphlo.sec<f32>>) -> ()
+    }) : (tensor<!pphlo.sec<i1>>) -> tensor<4x!pphlo.sec<f32>>
+    return %0 : tensor<4x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<!pphlo.sec<i32>>, %arg1: tensor<!pphlo.sec<f32>>) -> (tensor<!pphlo.sec<f32>>) {
+    //CHECK-NOT: pphlo.case
+    //CHECK-COUNT-2: pphlo.equal
+    //CHECK: "pphlo.add"(%arg1
+    //CHECK: pphlo.logistic
+    %0 = "pphlo.case"(%arg0) ({
+      %1 = "pphlo.constant"() {value = dense<1.000000e+00> : tensor<f32>} : () -> tensor<!pphlo.pub<f32>>
+      %2 = "pphlo.add"(%arg1, %1) : (tensor<!pphlo.sec<f32>>, tensor<!pphlo.pub<f32>>) -> tensor<!pphlo.sec<f32>>
+      %3 = "pphlo.logistic"(%2) : (tensor<!pphlo.sec<f32>>) -> tensor<!pphlo.sec<f32>>
+      "pphlo.return"(%3) : (tensor<!pphlo.sec<f32>>) -> ()
+    }, {
+      %1 = "pphlo.constant"() {value = dense<2.000000e+00> : tensor<f32>} : () -> tensor<!pphlo.pub<f32>>
+      %2 = "pphlo.add"(%arg1, %1) : (tensor<!pphlo.sec<f32>>, tensor<!pphlo.pub<f32>>) -> tensor<!pphlo.sec<f32>>
+      %3 = "pphlo.logistic"(%2) : (tensor<!pphlo.sec<f32>>) -> tensor<!pphlo.sec<f32>>
+      "pphlo.return"(%3) : (tensor<!pphlo.sec<f32>>) -> ()
+    }, {
+      %1 = "pphlo.constant"() {value = dense<3.000000e+00> : tensor<f32>} : () -> tensor<!pphlo.pub<f32>>
+      %2 = "pphlo.add"(%arg1, %1) : (tensor<!pphlo.sec<f32>>, tensor<!pphlo.pub<f32>>) -> tensor<!pphlo.sec<f32>>
+      %3 = "pphlo.logistic"(%2) : (tensor<!pphlo.sec<f32>>) -> tensor<!pphlo.sec<f32>>
+      "pphlo.return"(%3) : (tensor<!pphlo.sec<f32>>) -> ()
+    }) : (tensor<!pphlo.sec<i32>>) -> tensor<!pphlo.sec<f32>>
+    return %0 : tensor<!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<!pphlo.sec<i1>>, %arg1: tensor<4x!pphlo.sec<f32>>) -> (tensor<4x!pphlo.sec<f32>>) {
+    // Branches differ, the shared exponential is hoisted.
+    //CHECK: %[[E:.*]] = "pphlo.exponential"(%arg1)
+    //CHECK: "pphlo.if"(%arg0)
+    //CHECK: "pphlo.negate"(%[[E]])
+    %0 = "pphlo.if"(%arg0) ({
+      %1 = "pphlo.exponential"(%arg1) : (tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+      %2 = "pphlo.negate"(%1) : (tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+      "pphlo.return"(%2) : (tensor<4x!pphlo.sec<f32>>) -> ()
+    }, {
+      %1 = "pphlo.exponential"(%arg1) : (tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+      "pphlo.return"(%1) : (tensor<4x!pphlo.sec<f32>>) -> ()
+    }) : (tensor<!pphlo.sec<i1>>) -> tensor<4x!pphlo.sec<f32>>
+    return %0 : tensor<4x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<!pphlo.pub<i1>>, %arg1: tensor<4x!pphlo.sec<f32>>) -> (tensor<4x!pphlo.sec<f32>>) {
+    // Public predicate, only one branch runs.
+    //CHECK: "pphlo.if"(%arg0)
+    //CHECK-NEXT: pphlo.exponential
+    %0 = "pphlo.if"(%arg0) ({
+      %1 = "pphlo.exponential"(%arg1) : (tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+      %2 = "pphlo.negate"(%1) : (tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+      "pphlo.return"(%2) : (tensor<4x!pphlo.sec<f32>>) -> ()
+    }, {
+      %1 = "pphlo.exponential"(%arg1) : (tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+      "pphlo.return"(%1) : (tensor<4x!pphlo.sec<f32>>) -> ()
+    }) : (tensor<!pphlo.pub<i1>>) -> tensor<4x!pphlo.sec<f32>>
+    return %0 : tensor<4x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<!pphlo.sec<i1>>, %arg1: tensor<4x!pphlo.sec<f32>>) -> (tensor<4x!pphlo.sec<f32>>) {
+    // Cheap branches, a secret x secret mul costs more than running both.
+    //CHECK-NOT: pphlo.select
+    //CHECK: "pphlo.if"(%arg0)
+    %0 = "pphlo.if"(%arg0) ({
+      %1 = "pphlo.constant"() {value = dense<5.000000e-01> : tensor<4xf32>} : () -> tensor<4x!pphlo.pub<f32>>
+      %2 = "pphlo.multiply"(%arg1, %1) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.pub<f32>>) -> tensor<4x!pphlo.sec<f32>>
+      "pphlo.return"(%2) : (tensor<4x!pphlo.sec<f32>>) -> ()
+    }, {
+      %1 = "pphlo.constant"() {value = dense<2.000000e+00> : tensor<4xf32>} : () -> tensor<4x!pphlo.pub<f32>>
+      %2 = "pphlo.multiply"(%arg1, %1) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.pub<f32>>) -> tensor<4x!pphlo.sec<f32>>
+      "pphlo.return"(%2) : (tensor<4x!pphlo.sec<f32>>) -> ()
+    }) : (tensor<!pphlo.sec<i1>>) -> tensor<4x!pphlo.sec<f32>>
+    return %0 : tensor<4x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<!pphlo.sec<i1>>, %arg1: tensor<4x!pphlo.sec<i32>>) -> (tensor<4x!pphlo.sec<i32>>) {
+    // Public shift amounts are never muxed into secrets.
+    //CHECK-NOT: pphlo.select
+    //CHECK: "pphlo.if"(%arg0)
+    //CHECK: pphlo.shift_left
+    %0 = "pphlo.if"(%arg0) ({
+      %1 = "pphlo.constant"() {value = dense<1> : tensor<4xi32>} : () -> tensor<4x!pphlo.pub<i32>>
+      %2 = "pphlo.shift_left"(%arg1, %1) : (tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.pub<i32>>) -> tensor<4x!pphlo.sec<i32>>
+      %3 = "pphlo.multiply"(%2, %2) : (tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.sec<i32>>) -> tensor<4x!pphlo.sec<i32>>
+      "pphlo.return"(%3) : (tensor<4x!pphlo.sec<i32>>) -> ()
+    }, {
+      %1 = "pphlo.constant"() {value = dense<3> : tensor<4xi32>} : () -> tensor<4x!pphlo.pub<i32>>
+      %2 = "pphlo.shift_left"(%arg1, %1) : (tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.pub<i32>>) -> tensor<4x!pphlo.sec<i32>>
+      %3 = "pphlo.multiply"(%2, %2) : (tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.sec<i32>>) -> tensor<4x!pphlo.sec<i32>>
+      "pphlo.return"(%3) : (tensor<4x!pphlo.sec<i32>>) -> ()
+    }) : (tensor<!pphlo.sec<i1>>) -> tensor<4x!pphlo.sec<i32>>
+    return %0 : tensor<4x!pphlo.sec<i32>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<!pphlo.sec<i1>>, %arg1: tensor<4x!pphlo.sec<f32>>) -> (tensor<4x!pphlo.sec<f32>>) {
+    // Public divisors are never muxed into secrets.
+    //CHECK-NOT: pphlo.select
+    //CHECK: "pphlo.if"(%arg0)
+    //CHECK: pphlo.divide
+    %0 = "pphlo.if"(%arg0) ({
+      %1 = "pphlo.constant"() {value = dense<3.000000e+00> : tensor<4xf32>} : () -> tensor<4x!pphlo.pub<f32>>
+      %2 = "pphlo.divide"(%arg1, %1) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.pub<f32>>) -> tensor<4x!pphlo.sec<f32>>
+      %3 = "pphlo.exponential"(%2) : (tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+      "pphlo.return"(%3) : (tensor<4x!pphlo.sec<f32>>) -> ()
+    }, {
+      %1 = "pphlo.constant"() {value = dense<7.000000e+00> : tensor<4xf32>} : () -> tensor<4x!pphlo.pub<f32>>
+      %2 = "pphlo.divide"(%arg1, %1) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.pub<f32>>) -> tensor<4x!pphlo.sec<f32>>
+      %3 = "pphlo.exponential"(%2) : (tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+      "pphlo.return"(%3) : (tensor<4x!pphlo.sec<f32>>) -> ()
+    }) : (tensor<!pphlo.sec<i1>>) -> tensor<4x!pphlo.sec<f32>>
+    return %0 : tensor<4x!pphlo.sec<f32>>
+}
@@ -0,0 +1,28 @@
+// RUN: mlir-pphlo-opt --plan-memory --split-input-file %s | FileCheck %s
+
+// CHECK: func.func @main{{.*}} attributes {pphlo.naive_peak_bytes = 128 : i64, pphlo.planned_peak_bytes = 64 : i64}
+func.func @main(%arg0: tensor<4x!pphlo.sec<f32>>) -> (tensor<4x!pphlo.sec<f32>>) {
+    // CHECK: "pphlo.negate"(%arg0) {pphlo.slots = [0 : i64]}
+    %0 = "pphlo.negate"(%arg0) : (tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    // CHECK: "pphlo.negate"(%0) {pphlo.slots = [1 : i64]}
+    %1 = "pphlo.negate"(%0) : (tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    // CHECK: "pphlo.negate"(%1) {pphlo.slots = [0 : i64]}
+    %2 = "pphlo.negate"(%1) : (tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    // CHECK: "pphlo.negate"(%2) {pphlo.slots = [1 : i64]}
+    %3 = "pphlo.negate"(%2) : (tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    return %3 : tensor<4x!pphlo.sec<f32>>
+}
+
+// -----
+
+// CHECK: func.func @main{{.*}} attributes {pphlo.naive_peak_bytes = 96 : i64, pphlo.planned_peak_bytes = 96 : i64}
+func.func @main(%arg0: tensor<4x!pphlo.sec<f32>>) -> (tensor<4x!pphlo.sec<f32>>) {
+    // CHECK: "pphlo.negate"(%arg0) {pphlo.slots = [0 : i64]}
+    %0 = "pphlo.negate"(%arg0) : (tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    // CHECK: "pphlo.negate"(%0) {pphlo.slots = [1 : i64]}
+    %1 = "pphlo.negate"(%0) : (tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    // %0 is still alive, a new slot is required.
+    // CHECK: "pphlo.add"(%0, %1) {pphlo.slots = [2 : i64]}
+    %2 = "pphlo.add"(%0, %1) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    return %2 : tensor<4x!pphlo.sec<f32>>
+}
@@ -0,0 +1,53 @@
+// RUN: mlir-pphlo-opt --rebalance-chains --split-input-file %s | FileCheck %s
+
+func.func @main(%arg0: tensor<4x!pphlo.sec<f32>>, %arg1: tensor<4x!pphlo.sec<f32>>, %arg2: tensor<4x!pphlo.sec<f32>>, %arg3: tensor<4x!pphlo.sec<f32>>) -> (tensor<4x!pphlo.sec<f32>>) {
+    //CHECK: %[[L:.*]] = "pphlo.multiply"(%arg0, %arg1)
+    //CHECK: %[[R:.*]] = "pphlo.multiply"(%arg2, %arg3)
+    //CHECK: %[[RET:.*]] = "pphlo.multiply"(%[[L]], %[[R]])
+    //CHECK: return %[[RET]]
+    %0 = "pphlo.multiply"(%arg0, %arg1) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    %1 = "pphlo.multiply"(%0, %arg2) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    %2 = "pphlo.multiply"(%1, %arg3) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+    return %2 : tensor<4x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<4x!pphlo.sec<i1>>, %arg1: tensor<4x!pphlo.sec<i1>>, %arg2: tensor<4x!pphlo.sec<i1>>, %arg3: tensor<4x!pphlo.sec<i1>>) -> (tensor<4x!pphlo.sec<i1>>) {
+    //CHECK: %[[L:.*]] = "pphlo.and"(%arg0, %arg1)
+    //CHECK: %[[R:.*]] = "pphlo.and"(%arg2, %arg3)
+    //CHECK: "pphlo.and"(%[[L]], %[[R]])
+    %0 = "pphlo.and"(%arg0, %arg1) : (tensor<4x!pphlo.sec<i1>>, tensor<4x!pphlo.sec<i1>>) -> tensor<4x!pphlo.sec<i1>>
+    %1 = "pphlo.and"(%0, %arg2) : (tensor<4x!pphlo.sec<i1>>, tensor<4x!pphlo.sec<i1>>) -> tensor<4x!pphlo.sec<i1>>
+    %2 = "pphlo.and"(%1, %arg3) : (tensor<4x!pphlo.sec<i1>>, tensor<4x!pphlo.sec<i1>>) -> tensor<4x!pphlo.sec<i1>>
+    return %2 : tensor<4x!pphlo.sec<i1>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<4x!pphlo.sec<i32>>, %arg1: tensor<4x!pphlo.pub<i32>>, %arg2: tensor<4x!pphlo.sec<i32>>, %arg3: tensor<4x!pphlo.pub<i32>>) -> (tensor<4x!pphlo.sec<i32>>) {
+    // Public operands are combined first.
+    //CHECK: %[[P:.*]] = "pphlo.multiply"(%arg1, %arg3) : (tensor<4x!pphlo.pub<i32>>, tensor<4x!pphlo.pub<i32>>) -> tensor<4x!pphlo.pub<i32>>
+    //CHECK: %[[L:.*]] = "pphlo.multiply"(%[[P]], %arg0)
+    //CHECK: "pphlo.multiply"(%[[L]], %arg2)
+    %0 = "pphlo.multiply"(%arg0, %arg1) : (tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.pub<i32>>) -> tensor<4x!pphlo.sec<i32>>
+    %1 = "pphlo.multiply"(%0, %arg2) : (tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.sec<i32>>) -> tensor<4x!pphlo.sec<i32>>
+    %2 = "pphlo.multiply"(%1, %arg3) : (tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.pub<i32>>) -> tensor<4x!pphlo.sec<i32>>
+    return %2 : tensor<4x!pphlo.sec<i32>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<4x!pphlo.sec<i32>>, %arg1: tensor<4x!pphlo.pub<i32>>, %arg2: tensor<4x!pphlo.sec<i32>>, %arg3: tensor<4x!pphlo.sec<i32>>, %arg4: tensor<4x!pphlo.sec<i32>>) -> (tensor<4x!pphlo.sec<i32>>) {
+    // Public operands are combined first.
+    //CHECK: %[[A:.*]] = "pphlo.multiply"(%arg1, %arg0)
+    //CHECK: %[[B:.*]] = "pphlo.multiply"(%arg2, %arg3)
+    //CHECK: %[[C:.*]] = "pphlo.multiply"(%arg4, %[[A]])
+    //CHECK: "pphlo.multiply"(%[[B]], %[[C]])
+    %0 = "pphlo.multiply"(%arg0, %arg1) : (tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.pub<i32>>) -> tensor<4x!pphlo.sec<i32>>
+    %1 = "pphlo.multiply"(%0, %arg2) : (tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.sec<i32>>) -> tensor<4x!pphlo.sec<i32>>
+    %2 = "pphlo.multiply"(%1, %arg3) : (tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.sec<i32>>) -> tensor<4x!pphlo.sec<i32>>
+    %3 = "pphlo.multiply"(%2, %arg4) : (tensor<4x!pphlo.sec<i32>>, tensor<4x!pphlo.sec<i32>>) -> tensor<4x!pphlo.sec<i32>>
+    return %3 : tensor<4x!pphlo.sec<i32>>
+}
+
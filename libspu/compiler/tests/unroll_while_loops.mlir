@@ -0,0 +1,99 @@
+// RUN: mlir-pphlo-opt --unroll-while-loops --split-input-file %s | FileCheck %s
+
+func.func @main(%arg0: tensor<3x4x!pphlo.sec<f32>>) -> (tensor<3x4x!pphlo.sec<f32>>) {
+    %0 = "pphlo.constant"() {value = dense<0> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+    %1 = "pphlo.constant"() {value = dense<3> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+    // y[i] = x[i] * x[i], the muls only read the invariant x and end up side
+    // by side after unrolling.
+    //CHECK-NOT: pphlo.while
+    //CHECK: %[[S0:.*]] = "pphlo.dynamic-slice"(%arg0
+    //CHECK: %[[M0:.*]] = "pphlo.multiply"(%[[S0]], %[[S0]])
+    //CHECK: pphlo.dynamic-update-slice
+    //CHECK: %[[S1:.*]] = "pphlo.dynamic-slice"(%arg0
+    //CHECK: %[[M1:.*]] = "pphlo.multiply"(%[[S1]], %[[S1]])
+    //CHECK: pphlo.dynamic-update-slice
+    //CHECK: %[[S2:.*]] = "pphlo.dynamic-slice"(%arg0
+    //CHECK: %[[M2:.*]] = "pphlo.multiply"(%[[S2]], %[[S2]])
+    //CHECK: pphlo.dynamic-update-slice
+    %2:4 = "pphlo.while"(%0, %1, %arg0, %arg0) ({
+    ^bb0(%arg1: tensor<!pphlo.pub<i32>>, %arg2: tensor<!pphlo.pub<i32>>, %arg3: tensor<3x4x!pphlo.sec<f32>>, %arg4: tensor<3x4x!pphlo.sec<f32>>):
+      %3 = "pphlo.less"(%arg1, %arg2) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<i1>>
+      "pphlo.return"(%3) : (tensor<!pphlo.pub<i1>>) -> ()
+    },  {
+    ^bb0(%arg1: tensor<!pphlo.pub<i32>>, %arg2: tensor<!pphlo.pub<i32>>, %arg3: tensor<3x4x!pphlo.sec<f32>>, %arg4: tensor<3x4x!pphlo.sec<f32>>):
+      %3 = "pphlo.constant"() {value = dense<1> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+      %4 = "pphlo.constant"() {value = dense<0> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+      %5 = "pphlo.dynamic-slice"(%arg3, %arg1, %4) {slice_sizes = dense<[1, 4]> : tensor<2xi64>} : (tensor<3x4x!pphlo.sec<f32>>, tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<1x4x!pphlo.sec<f32>>
+      %6 = "pphlo.multiply"(%5, %5) : (tensor<1x4x!pphlo.sec<f32>>, tensor<1x4x!pphlo.sec<f32>>) -> tensor<1x4x!pphlo.sec<f32>>
+      %7 = "pphlo.dynamic-update-slice"(%arg4, %6, %arg1, %4) : (tensor<3x4x!pphlo.sec<f32>>, tensor<1x4x!pphlo.sec<f32>>, tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<3x4x!pphlo.sec<f32>>
+      %8 = "pphlo.add"(%arg1, %3) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<i32>>
+      "pphlo.return"(%8, %arg2, %arg3, %7) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>, tensor<3x4x!pphlo.sec<f32>>, tensor<3x4x!pphlo.sec<f32>>) -> ()
+    }) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>, tensor<3x4x!pphlo.sec<f32>>, tensor<3x4x!pphlo.sec<f32>>) -> (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>, tensor<3x4x!pphlo.sec<f32>>, tensor<3x4x!pphlo.sec<f32>>)
+    return %2#3 : tensor<3x4x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<3x4x!pphlo.sec<f32>>, %arg1: tensor<1x4x!pphlo.sec<f32>>) -> (tensor<1x4x!pphlo.sec<f32>>) {
+    %0 = "pphlo.constant"() {value = dense<0> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+    %1 = "pphlo.constant"() {value = dense<3> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+    // acc += x[i] * x[i], the carried accumulator is only added to.
+    //CHECK-NOT: pphlo.while
+    //CHECK-COUNT-3: pphlo.multiply
+    %2:4 = "pphlo.while"(%0, %1, %arg0, %arg1) ({
+    ^bb0(%arg2: tensor<!pphlo.pub<i32>>, %arg3: tensor<!pphlo.pub<i32>>, %arg4: tensor<3x4x!pphlo.sec<f32>>, %arg5: tensor<1x4x!pphlo.sec<f32>>):
+      %3 = "pphlo.less"(%arg2, %arg3) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<i1>>
+      "pphlo.return"(%3) : (tensor<!pphlo.pub<i1>>) -> ()
+    },  {
+    ^bb0(%arg2: tensor<!pphlo.pub<i32>>, %arg3: tensor<!pphlo.pub<i32>>, %arg4: tensor<3x4x!pphlo.sec<f32>>, %arg5: tensor<1x4x!pphlo.sec<f32>>):
+      %3 = "pphlo.constant"() {value = dense<1> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+      %4 = "pphlo.constant"() {value = dense<0> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+      %5 = "pphlo.dynamic-slice"(%arg4, %arg2, %4) {slice_sizes = dense<[1, 4]> : tensor<2xi64>} : (tensor<3x4x!pphlo.sec<f32>>, tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<1x4x!pphlo.sec<f32>>
+      %6 = "pphlo.multiply"(%5, %5) : (tensor<1x4x!pphlo.sec<f32>>, tensor<1x4x!pphlo.sec<f32>>) -> tensor<1x4x!pphlo.sec<f32>>
+      %7 = "pphlo.add"(%arg5, %6) : (tensor<1x4x!pphlo.sec<f32>>, tensor<1x4x!pphlo.sec<f32>>) -> tensor<1x4x!pphlo.sec<f32>>
+      %8 = "pphlo.add"(%arg2, %3) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<i32>>
+      "pphlo.return"(%8, %arg3, %arg4, %7) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>, tensor<3x4x!pphlo.sec<f32>>, tensor<1x4x!pphlo.sec<f32>>) -> ()
+    }) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>, tensor<3x4x!pphlo.sec<f32>>, tensor<1x4x!pphlo.sec<f32>>) -> (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>, tensor<3x4x!pphlo.sec<f32>>, tensor<1x4x!pphlo.sec<f32>>)
+    return %2#3 : tensor<1x4x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<4x!pphlo.sec<f32>>) -> (tensor<4x!pphlo.sec<f32>>) {
+    %0 = "pphlo.constant"() {value = dense<0> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+    %1 = "pphlo.constant"() {value = dense<3> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+    // x = x * x, every iteration waits for the previous one.
+    //CHECK: pphlo.while
+    %2:3 = "pphlo.while"(%0, %1, %arg0) ({
+    ^bb0(%arg1: tensor<!pphlo.pub<i32>>, %arg2: tensor<!pphlo.pub<i32>>, %arg3: tensor<4x!pphlo.sec<f32>>):
+      %3 = "pphlo.less"(%arg1, %arg2) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<i1>>
+      "pphlo.return"(%3) : (tensor<!pphlo.pub<i1>>) -> ()
+    },  {
+    ^bb0(%arg1: tensor<!pphlo.pub<i32>>, %arg2: tensor<!pphlo.pub<i32>>, %arg3: tensor<4x!pphlo.sec<f32>>):
+      %3 = "pphlo.constant"() {value = dense<1> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+      %4 = "pphlo.multiply"(%arg3, %arg3) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+      %5 = "pphlo.add"(%arg1, %3) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<i32>>
+      "pphlo.return"(%5, %arg2, %4) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>, tensor<4x!pphlo.sec<f32>>) -> ()
+    }) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>, tensor<4x!pphlo.sec<f32>>) -> (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>, tensor<4x!pphlo.sec<f32>>)
+    return %2#2 : tensor<4x!pphlo.sec<f32>>
+}
+
+// -----
+
+func.func @main(%arg0: tensor<!pphlo.pub<i32>>, %arg1: tensor<4x!pphlo.sec<f32>>) -> (tensor<4x!pphlo.sec<f32>>) {
+    %0 = "pphlo.constant"() {value = dense<0> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+    // Trip count is unknown.
+    //CHECK: pphlo.while
+    %1:3 = "pphlo.while"(%0, %arg0, %arg1) ({
+    ^bb0(%arg2: tensor<!pphlo.pub<i32>>, %arg3: tensor<!pphlo.pub<i32>>, %arg4: tensor<4x!pphlo.sec<f32>>):
+      %2 = "pphlo.less"(%arg2, %arg3) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<i1>>
+      "pphlo.return"(%2) : (tensor<!pphlo.pub<i1>>) -> ()
+    },  {
+    ^bb0(%arg2: tensor<!pphlo.pub<i32>>, %arg3: tensor<!pphlo.pub<i32>>, %arg4: tensor<4x!pphlo.sec<f32>>):
+      %2 = "pphlo.constant"() {value = dense<1> : tensor<i32>} : () -> tensor<!pphlo.pub<i32>>
+      %3 = "pphlo.multiply"(%arg4, %arg4) : (tensor<4x!pphlo.sec<f32>>, tensor<4x!pphlo.sec<f32>>) -> tensor<4x!pphlo.sec<f32>>
+      %4 = "pphlo.add"(%arg2, %2) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<i32>>
+      "pphlo.return"(%4, %arg3, %3) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>, tensor<4x!pphlo.sec<f32>>) -> ()
+    }) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>, tensor<4x!pphlo.sec<f32>>) -> (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>, tensor<4x!pphlo.sec<f32>>)
+    return %1#2 : tensor<4x!pphlo.sec<f32>>
+}
@@ -17,11 +17,21 @@
 #include "llvm/Support/Threading.h"
 
 namespace spu {
+namespace {
+
+thread_local int tlsNumberOfProc = 0;
+
+}  // namespace
 
 int getNumberOfProc() {
+  if (tlsNumberOfProc > 0) {
+    return tlsNumberOfProc;
+  }
   static int nProc =
       llvm::heavyweight_hardware_concurrency().compute_thread_count() - 1;
   return nProc;
 }
 
+void setThreadNumberOfProc(int nproc) { tlsNumberOfProc = nproc; }
+
 }  // namespace spu
@@ -25,6 +25,10 @@ constexpr int64_t kMinTaskSize = 50000;
 
 int getNumberOfProc();
 
+// Overrides getNumberOfProc() on the calling thread, 0 restores the hardware
+// value. Lets tests simulate parties running on different hardware.
+void setThreadNumberOfProc(int nproc);
+
 inline int64_t computeTaskSize(int64_t numel) {
   auto grain_size = static_cast<int64_t>(
       std::ceil(static_cast<float>(numel) / getNumberOfProc()));
@@ -266,6 +266,8 @@ void executeImpl(OpExecutor *executor, spu::HalContext *hctx,
     auto entry_function = moduleOpRef->lookupSymbol<mlir::func::FuncOp>("main");
     SPU_ENFORCE(entry_function, "main module not found");
 
+    executor->prepare(entry_function.getOperation());
+
     ExecutionOptions opts;
     opts.do_type_check = rt_config.enable_type_checker();
     opts.do_log_execution = rt_config.enable_pphlo_trace();
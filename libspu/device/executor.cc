@@ -97,6 +97,11 @@ void SymbolScope::addValue(mlir::Value key, spu::Value &&val) {
   symbols_[key] = std::move(val);
 }
 
+void SymbolScope::removeValue(mlir::Value key) {
+  std::lock_guard<std::shared_mutex> lk(mu_);
+  symbols_.erase(key);
+}
+
 std::vector<spu::Value> runRegion(OpExecutor *executor,                 //
                                   HalContext *hctx,                     //
                                   SymbolScope *parent_scope,            //
@@ -128,7 +133,24 @@ std::vector<spu::Value> runBlock(OpExecutor *executor, HalContext *hctx,
                                  SymbolScope *symbols, mlir::Block &block,
                                  absl::Span<spu::Value const> params,
                                  const ExecutionOptions &opts) {
+  // Current value of each memory slot planned by the compiler, the previous
+  // occupant of a slot is dead once the slot is reused.
+  llvm::SmallVector<mlir::Value> slot_owners;
+
   for (auto &op : block.without_terminator()) {
+    if (auto slots = op.getAttrOfType<mlir::ArrayAttr>("pphlo.slots")) {
+      for (size_t idx = 0; idx < slots.size(); ++idx) {
+        const auto s = slots[idx].cast<mlir::IntegerAttr>().getInt();
+        if (s >= static_cast<int64_t>(slot_owners.size())) {
+          slot_owners.resize(s + 1);
+        }
+        if (slot_owners[s]) {
+          symbols->removeValue(slot_owners[s]);
+        }
+        slot_owners[s] = op.getResult(idx);
+      }
+    }
+
     executor->runKernel(hctx, symbols, op, opts);
   }
 
@@ -153,7 +175,8 @@ struct SymbolTableEvent {
 
 class OpExecTask final {
   std::unique_ptr<HalContext> hctx_ = nullptr;
-  // here we assume executor is thread-safe (stateless)
+  // Shared by concurrent tasks: executors only mutate their state in
+  // prepare(), which runs before any kernel, runKernel() is read-only.
   OpExecutor *executor_ = nullptr;
   SymbolScope *sscope_ = nullptr;
   mlir::Operation *op_ = nullptr;
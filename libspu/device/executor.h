@@ -48,6 +48,8 @@ class SymbolScope final {
   spu::Value lookupValue(mlir::Value key) const;
   void addValue(::mlir::Value key, const spu::Value &val);
   void addValue(::mlir::Value key, spu::Value &&val);
+  // release a local symbol, only symbols of this scope are removed.
+  void removeValue(::mlir::Value key);
 
  protected:
   bool hasValueUnsafe(mlir::Value key) const;
@@ -70,7 +72,13 @@ class OpExecutor {
   // return true if the operation has a corresponding kernel.
   virtual bool hasKernel(mlir::Operation &op) const = 0;
 
-  // run a kernel in a given region.
+  // resolve kernels of all ops under root ahead of execution, called once a
+  // module is loaded and before any kernel runs. It is the only place an
+  // executor may mutate its state.
+  virtual void prepare(mlir::Operation *root) {}
+
+  // run a kernel in a given region, must not mutate the executor, since
+  // parallel regions run kernels of one executor concurrently.
   virtual void runKernelImpl(HalContext *hctx, SymbolScope *sscope,
                              mlir::Operation &op,
                              const ExecutionOptions &opts) = 0;
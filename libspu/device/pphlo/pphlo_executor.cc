@@ -27,6 +27,7 @@
 #include "libspu/kernel/hlo/const.h"
 #include "libspu/kernel/hlo/control_flow.h"
 #include "libspu/kernel/hlo/convolution.h"
+#include "libspu/kernel/hlo/fused.h"
 #include "libspu/kernel/hlo/geometrical.h"
 #include "libspu/kernel/hlo/indexing.h"
 #include "libspu/kernel/hlo/rand.h"
@@ -206,6 +207,7 @@ STANDARD_UNARY_OP_EXEC_IMPL(CeilOp, Ceil)
 STANDARD_UNARY_OP_EXEC_IMPL(AbsOp, Abs)
 STANDARD_UNARY_OP_EXEC_IMPL(LogisticOp, Logistic)
 STANDARD_UNARY_OP_EXEC_IMPL(TanhOp, Tanh)
+STANDARD_UNARY_OP_EXEC_IMPL(GeluOp, Gelu)
 STANDARD_UNARY_OP_EXEC_IMPL(NotOp, Not)
 STANDARD_UNARY_OP_EXEC_IMPL(RsqrtOp, Rsqrt)
 STANDARD_UNARY_OP_EXEC_IMPL(SqrtOp, Sqrt)
@@ -226,11 +228,7 @@ STANDARD_UNARY_OP_EXEC_IMPL(RoundOp, Round_AFZ)
 STANDARD_BINARY_OP_EXEC_IMPL(AddOp, Add)
 STANDARD_BINARY_OP_EXEC_IMPL(EqualOp, Equal)
 STANDARD_BINARY_OP_EXEC_IMPL(NotEqualOp, NotEqual)
-STANDARD_BINARY_OP_EXEC_IMPL(LessEqualOp, LessEqual)
-STANDARD_BINARY_OP_EXEC_IMPL(GreaterEqualOp, GreaterEqual)
 STANDARD_BINARY_OP_EXEC_IMPL(SubtractOp, Sub)
-STANDARD_BINARY_OP_EXEC_IMPL(LessOp, Less)
-STANDARD_BINARY_OP_EXEC_IMPL(GreaterOp, Greater)
 STANDARD_BINARY_OP_EXEC_IMPL(MulOp, Mul)
 STANDARD_BINARY_OP_EXEC_IMPL(PowOp, Power)
 STANDARD_BINARY_OP_EXEC_IMPL(MaxOp, Max)
@@ -245,6 +243,38 @@ STANDARD_BINARY_OP_EXEC_IMPL(ShiftRightLogicalOp, Rshift)
 
 #undef STANDARD_BINARY_OP_EXEC_IMPL
 
+// Attached by the infer-valid-bits pass. The bound relies on parties feeding
+// inputs of their declared types, so it is not trusted under malicious
+// protocols.
+size_t getValidBits(HalContext *hctx, mlir::Operation *op) {
+  if (hctx->rt_config().protocol() == ProtocolKind::SPDZ2K) {
+    return 0;
+  }
+  if (auto attr = op->getAttrOfType<mlir::IntegerAttr>("pphlo.valid_bits")) {
+    return attr.getInt();
+  }
+  return 0;
+}
+
+#define COMPARE_OP_EXEC_IMPL(OpName, KernelName)                              \
+  void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,   \
+               mlir::pphlo::OpName &op, const ExecutionOptions &opts) {       \
+    const size_t valid_bits = getValidBits(hctx, op);                         \
+    addValue(sscope, op.getResult(),                                          \
+             kernel::hlo::KernelName(hctx,                                    \
+                                     lookupValue(sscope, op.getLhs(), opts),  \
+                                     lookupValue(sscope, op.getRhs(), opts),  \
+                                     valid_bits),                             \
+             opts);                                                           \
+  }
+
+COMPARE_OP_EXEC_IMPL(LessOp, Less)
+COMPARE_OP_EXEC_IMPL(GreaterOp, Greater)
+COMPARE_OP_EXEC_IMPL(LessEqualOp, LessEqual)
+COMPARE_OP_EXEC_IMPL(GreaterEqualOp, GreaterEqual)
+
+#undef COMPARE_OP_EXEC_IMPL
+
 void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
              mlir::pphlo::DotOp &op, const ExecutionOptions &opts) {
   auto ret = kernel::hlo::Dot(hctx, lookupValue(sscope, op.getLhs(), opts),
@@ -275,39 +305,10 @@ void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
   auto lhs = lookupValue(sscope, op.getLhs(), opts);
   auto rhs = lookupValue(sscope, op.getRhs(), opts);
   SPU_ENFORCE(lhs.shape()[0] == rhs.shape()[0], "Batch dim should equal");
-  int64_t num_batch = lhs.shape()[0];
-
-  std::vector<spu::Value> results(num_batch);
-  std::vector<int64_t> lhs_slice_begin(3, 0);
-  std::vector<int64_t> lhs_slice_end = lhs.shape();
-  std::vector<int64_t> rhs_slice_begin(3, 0);
-  std::vector<int64_t> rhs_slice_end = rhs.shape();
-  std::vector<int64_t> strides(lhs.shape().size(), 1);
-
-  std::vector<int64_t> lhs_slice_shape{lhs.shape()[1], lhs.shape()[2]};
-  std::vector<int64_t> rhs_slice_shape{rhs.shape()[1], rhs.shape()[2]};
-  std::vector<int64_t> ret_slice_shape{1, lhs.shape()[1], rhs.shape()[2]};
-
-  for (int64_t batch_idx = 0; batch_idx < num_batch; ++batch_idx) {
-    lhs_slice_begin[0] = batch_idx;
-    lhs_slice_end[0] = batch_idx + 1;
-    rhs_slice_begin[0] = batch_idx;
-    rhs_slice_end[0] = batch_idx + 1;
-    auto lhs_slice = kernel::hlo::Reshape(
-        hctx,
-        kernel::hlo::Slice(hctx, lhs, lhs_slice_begin, lhs_slice_end, strides),
-        lhs_slice_shape);
-    auto rhs_slice = kernel::hlo::Reshape(
-        hctx,
-        kernel::hlo::Slice(hctx, rhs, rhs_slice_begin, rhs_slice_end, strides),
-        rhs_slice_shape);
-    results[batch_idx] = kernel::hlo::Reshape(
-        hctx, kernel::hlo::Dot(hctx, lhs_slice, rhs_slice), ret_slice_shape);
-  }
 
   auto ret_type = op.getResult().getType().dyn_cast<mlir::RankedTensorType>();
-  auto ret = kernel::hlo::Reshape(
-      hctx, kernel::hlo::Concatenate(hctx, results, 0), ret_type.getShape());
+  auto ret = kernel::hlo::Reshape(hctx, kernel::hlo::BatchDot(hctx, lhs, rhs),
+                                  ret_type.getShape());
 
   addValue(sscope, op.getResult(), std::move(ret), opts);
 }
@@ -900,6 +901,21 @@ void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
   addValue(sscope, op.getResult(1), ret.second, opts);
 }
 
+void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
+             mlir::pphlo::SoftmaxOp &op, const ExecutionOptions &opts) {
+  auto ret = kernel::hlo::Softmax(
+      hctx, lookupValue(sscope, op.getOperand(), opts), op.getAxis());
+  addValue(sscope, op.getResult(), std::move(ret), opts);
+}
+
+void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
+             mlir::pphlo::LayerNormOp &op, const ExecutionOptions &opts) {
+  auto ret = kernel::hlo::LayerNorm(
+      hctx, lookupValue(sscope, op.getOperand(), opts), op.getAxis(),
+      op.getEpsilon().convertToDouble());
+  addValue(sscope, op.getResult(), std::move(ret), opts);
+}
+
 void execute(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
              mlir::pphlo::SelectOp &op, const ExecutionOptions &opts) {
   auto pred = lookupValue(sscope, op.getPred(), opts);
@@ -1049,85 +1065,178 @@ DEFINE_UNIMPLEMENTED_OP(ReturnOp)
 
 }  // namespace
 
-template <typename OpT, typename... MoreOpT>
-static bool hasKernelImpl(mlir::Operation &op) {
-  if (auto casted = llvm::dyn_cast<OpT>(op)) {
-    return true;
+namespace {
+
+// currently we only support config verifier statically.
+constexpr bool kEnableXlaVerifier = false;
+
+template <typename OpT>
+void verifyOp(HalContext *hctx, SymbolScope *sscope, OpT &casted,
+              mlir::Operation &op) {
+  PPHloVerifier verifier(hctx);
+  // handle mixed (int, fxp) multiplication
+  if constexpr (std::is_same_v<OpT, mlir::pphlo::MulOp> or
+                std::is_same_v<OpT, mlir::pphlo::DotOp> or
+                std::is_same_v<OpT, mlir::pphlo::DotGeneralOp>) {
+    spu::Value lhs = sscope->lookupValue(casted.getLhs());
+    spu::Value rhs = sscope->lookupValue(casted.getRhs());
+    spu::Value ret = sscope->lookupValue(casted.getResult());
+    mlir::pphlo::TypeTools type_tool;
+    auto lhs_type = type_tool.getExpressedType(casted.getLhs().getType());
+    auto rhs_type = type_tool.getExpressedType(casted.getRhs().getType());
+    auto ret_type = type_tool.getExpressedType(casted.getResult().getType());
+
+    if (lhs_type != ret_type) {
+      lhs = kernel::hlo::Cast(hctx, lhs, lhs.vtype(), ret.dtype());
+    }
+    if (rhs_type != ret_type) {
+      rhs = kernel::hlo::Cast(hctx, rhs, rhs.vtype(), ret.dtype());
+    }
+
+    verifier.verify(casted, {lhs, rhs}, {ret});
   } else {
-    if constexpr (!sizeof...(MoreOpT)) {
-      return false;
-    } else {
-      return hasKernelImpl<MoreOpT...>(op);
+    // Collect inputs
+    std::vector<spu::Value> ins;
+    for (auto operand : op.getOperands()) {
+      ins.emplace_back(sscope->lookupValue(operand));
     }
+    std::vector<spu::Value> outs;
+    for (auto operand : op.getResults()) {
+      outs.emplace_back(sscope->lookupValue(operand));
+    }
+
+    verifier.verify(casted, ins, outs);
   }
 }
 
-bool PPHloExecutor::hasKernel(mlir::Operation &op) const {
-  return hasKernelImpl<
+template <typename OpT>
+void executeOp(OpExecutor *executor, HalContext *hctx, SymbolScope *sscope,
+               mlir::Operation &op, const ExecutionOptions &opts) {
+  auto casted = llvm::cast<OpT>(op);
+  // Execute op
+  {
+    const auto fn_name = op.getName().getStringRef().str();
+    SPU_TRACE_ACTION(GET_TRACER(hctx), (TR_HLO | TR_LAR), ~TR_HLO, fn_name);
+    execute(executor, hctx, sscope, casted, opts);
+  }
+
+  if (kEnableXlaVerifier) {
+    verifyOp(hctx, sscope, casted, op);
+  }
+}
+
+using BinaryKernel = spu::Value (*)(HalContext *, const spu::Value &,
+                                    const spu::Value &);
+
+// Binary ops bound to a kernel specialized for the static operand dtypes.
+template <typename OpT, BinaryKernel Kernel>
+void executeSpecializedBinaryOp(OpExecutor *, HalContext *hctx,
+                                SymbolScope *sscope, mlir::Operation &op,
+                                const ExecutionOptions &opts) {
+  auto casted = llvm::cast<OpT>(op);
+  {
+    const auto fn_name = op.getName().getStringRef().str();
+    SPU_TRACE_ACTION(GET_TRACER(hctx), (TR_HLO | TR_LAR), ~TR_HLO, fn_name);
+    addValue(sscope, casted.getResult(),
+             Kernel(hctx, lookupValue(sscope, casted.getLhs(), opts),
+                    lookupValue(sscope, casted.getRhs(), opts)),
+             opts);
+  }
+
+  if (kEnableXlaVerifier) {
+    verifyOp(hctx, sscope, casted, op);
+  }
+}
+
+template <typename... OpT>
+llvm::DenseMap<mlir::TypeID, PPHloExecutor::KernelFn> buildKernelTable() {
+  llvm::DenseMap<mlir::TypeID, PPHloExecutor::KernelFn> table;
+  (table.try_emplace(mlir::TypeID::get<OpT>(), &executeOp<OpT>), ...);
+  return table;
+}
+
+// Generic kernels, indexed by op type.
+const llvm::DenseMap<mlir::TypeID, PPHloExecutor::KernelFn> &kernelTable() {
+  static const auto table = buildKernelTable<
 #define GET_OP_LIST
 #include "libspu/dialect/pphlo_ops.cc.inc"
-      >(op);
+      >();
+  return table;
 }
 
-template <typename OpT, typename... MoreOpT>
-static void dispatchOp(OpExecutor *executor, HalContext *hctx,
-                       SymbolScope *sscope, mlir::Operation &op,
-                       const ExecutionOptions &opts) {
-  if (auto casted = llvm::dyn_cast<OpT>(op)) {
-    // Execute op
-    {
-      const auto fn_name = op.getName().getStringRef().str();
-      SPU_TRACE_ACTION(GET_TRACER(hctx), (TR_HLO | TR_LAR), ~TR_HLO, fn_name);
-      execute(executor, hctx, sscope, casted, opts);
-    }
+// Kernel specialized for the static (visibility, dtype) types of op, the
+// runtime values are guaranteed to match them by the type checker. Returns
+// nullptr if there is no specialization.
+PPHloExecutor::KernelFn specializeKernel(mlir::Operation &op) {
+  if (!llvm::isa<mlir::pphlo::AddOp, mlir::pphlo::SubtractOp,
+                 mlir::pphlo::MulOp>(op)) {
+    return nullptr;
+  }
 
-    // currently we only support config verifier statically.
-    constexpr bool kEnableXlaVerifier = false;
-    if (kEnableXlaVerifier) {
-      PPHloVerifier verifier(hctx);
-      // handle mixed (int, fxp) multiplication
-      if constexpr (std::is_same_v<OpT, mlir::pphlo::MulOp> or
-                    std::is_same_v<OpT, mlir::pphlo::DotOp> or
-                    std::is_same_v<OpT, mlir::pphlo::DotGeneralOp>) {
-        spu::Value lhs = sscope->lookupValue(casted.getLhs());
-        spu::Value rhs = sscope->lookupValue(casted.getRhs());
-        spu::Value ret = sscope->lookupValue(casted.getResult());
-        mlir::pphlo::TypeTools type_tool;
-        auto lhs_type = type_tool.getExpressedType(casted.getLhs().getType());
-        auto rhs_type = type_tool.getExpressedType(casted.getRhs().getType());
-        auto ret_type =
-            type_tool.getExpressedType(casted.getResult().getType());
-
-        if (lhs_type != ret_type) {
-          lhs = kernel::hlo::Cast(hctx, lhs, lhs.vtype(), ret.dtype());
-        }
-        if (rhs_type != ret_type) {
-          rhs = kernel::hlo::Cast(hctx, rhs, rhs.vtype(), ret.dtype());
-        }
-
-        verifier.verify(casted, {lhs, rhs}, {ret});
-      } else {
-        // Collect inputs
-        std::vector<spu::Value> ins;
-        for (auto operand : op.getOperands()) {
-          ins.emplace_back(sscope->lookupValue(operand));
-        }
-        std::vector<spu::Value> outs;
-        for (auto operand : op.getResults()) {
-          outs.emplace_back(sscope->lookupValue(operand));
-        }
-
-        verifier.verify(casted, ins, outs);
-      }
+  const auto lhs = getDtypeFromMlirType(op.getOperand(0).getType());
+  const auto rhs = getDtypeFromMlirType(op.getOperand(1).getType());
+  const bool fxp = lhs == DT_FXP && rhs == DT_FXP;
+  const bool same_int = lhs == rhs && lhs != DT_FXP;
+  const bool mixed = (lhs == DT_FXP) != (rhs == DT_FXP);
+
+  using mlir::pphlo::AddOp;
+  using mlir::pphlo::MulOp;
+  using mlir::pphlo::SubtractOp;
+  if (llvm::isa<AddOp>(op)) {
+    if (fxp) {
+      return &executeSpecializedBinaryOp<AddOp, kernel::hlo::AddFxp>;
+    }
+    if (same_int) {
+      return &executeSpecializedBinaryOp<AddOp, kernel::hlo::AddInt>;
+    }
+  } else if (llvm::isa<SubtractOp>(op)) {
+    if (fxp) {
+      return &executeSpecializedBinaryOp<SubtractOp, kernel::hlo::SubFxp>;
+    }
+    if (same_int) {
+      return &executeSpecializedBinaryOp<SubtractOp, kernel::hlo::SubInt>;
     }
   } else {
-    if constexpr (!sizeof...(MoreOpT)) {
-      SPU_THROW("Unhandled mlir op {} at {}", mlirObjectToString(op),
-                mlirObjectToString(op.getLoc()));
-    } else {
-      dispatchOp<MoreOpT...>(executor, hctx, sscope, op, opts);
+    if (fxp) {
+      return &executeSpecializedBinaryOp<MulOp, kernel::hlo::MulFxp>;
     }
+    if (same_int) {
+      return &executeSpecializedBinaryOp<MulOp, kernel::hlo::MulInt>;
+    }
+    if (mixed) {
+      return &executeSpecializedBinaryOp<MulOp, kernel::hlo::MulMixed>;
+    }
+  }
+  return nullptr;
+}
+
+PPHloExecutor::KernelFn resolveKernel(mlir::Operation &op) {
+  if (auto fn = specializeKernel(op)) {
+    return fn;
+  }
+  const auto &table = kernelTable();
+  auto iter = table.find(op.getName().getTypeID());
+  if (iter == table.end()) {
+    SPU_THROW("Unhandled mlir op {} at {}", mlirObjectToString(op),
+              mlirObjectToString(op.getLoc()));
   }
+  return iter->second;
+}
+
+}  // namespace
+
+bool PPHloExecutor::hasKernel(mlir::Operation &op) const {
+  return kernelTable().count(op.getName().getTypeID()) != 0;
+}
+
+void PPHloExecutor::prepare(mlir::Operation *root) {
+  // Ops of a previous module may share addresses with ops of this one.
+  kernels_.clear();
+  root->walk([&](mlir::Operation *op) {
+    if (hasKernel(*op)) {
+      kernels_[op] = resolveKernel(*op);
+    }
+  });
 }
 
 void PPHloExecutor::runKernelImpl(HalContext *hctx, SymbolScope *sscope,
@@ -1136,10 +1245,11 @@ void PPHloExecutor::runKernelImpl(HalContext *hctx, SymbolScope *sscope,
   if (opts.do_log_execution) {
     SPDLOG_INFO("PPHLO {}", mlirObjectToString(op));
   }
-  dispatchOp<
-#define GET_OP_LIST
-#include "libspu/dialect/pphlo_ops.cc.inc"
-      >(this, hctx, sscope, op, opts);
+  // Ops not seen by prepare, e.g. kernels run standalone, are resolved on
+  // the fly.
+  auto iter = kernels_.find(&op);
+  auto fn = iter != kernels_.end() ? iter->second : resolveKernel(op);
+  fn(this, hctx, sscope, op, opts);
 }
 
 void PPHloExecutor::checkType(mlir::Type mlir_type, const spu::Value &v) const {
@@ -27,14 +27,24 @@ namespace spu::device::pphlo {
 
 class PPHloExecutor : public OpExecutor {
  public:
+  using KernelFn = void (*)(OpExecutor *, HalContext *, SymbolScope *,
+                            mlir::Operation &, const ExecutionOptions &);
+
   void checkType(mlir::Type mlir_type, const spu::Value &v) const override;
 
   // return true if the operation has a corresponding kernel.
   bool hasKernel(mlir::Operation &op) const override;
 
+  // resolve the kernel of every op under root from its static types.
+  void prepare(mlir::Operation *root) override;
+
   // run a kernel in a given region.
   void runKernelImpl(HalContext *hctx, SymbolScope *sscope, mlir::Operation &op,
                      const ExecutionOptions &opts) override;
+
+ private:
+  // Resolved kernels, immutable once execution starts.
+  llvm::DenseMap<mlir::Operation *, KernelFn> kernels_;
 };
 
 }  // namespace spu::device::pphlo
@@ -135,6 +135,44 @@ func.func @main(%arg0: tensor<!pphlo.pub<i32>>, %arg1: tensor<!pphlo.pub<i32>>)
   r.verifyScalarOutput(3);
 }
 
+TEST_P(ExecutorTest, MemoryPlanSlots) {
+  Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
+           std::get<2>(GetParam()));
+  r.addInput(1);
+
+  // %0 is released when %2 reuses its slot.
+  r.run(R"(
+func.func @main(%arg0: tensor<!pphlo.pub<i32>>) -> (tensor<!pphlo.pub<i32>>) {
+  %0 = "pphlo.negate"(%arg0) {pphlo.slots = [0]} : (tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<i32>>
+  %1 = "pphlo.add"(%0, %0) {pphlo.slots = [1]} : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<i32>>
+  %2 = "pphlo.add"(%1, %arg0) {pphlo.slots = [0]} : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<i32>>
+  %3 = "pphlo.add"(%2, %1) {pphlo.slots = [2]} : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<i32>>
+  return %3 : tensor<!pphlo.pub<i32>>
+})");
+
+  r.verifyScalarOutput(-3);
+}
+
+TEST_P(ExecutorTest, SpecializedBinaryKernels) {
+  Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
+           std::get<2>(GetParam()));
+  r.addInput(1.5F, VIS_SECRET);
+  r.addInput(3);
+
+  // fxp * int, fxp + fxp, int * int, fxp - fxp
+  r.run(R"(
+func.func @main(%arg0: tensor<!pphlo.sec<f32>>, %arg1: tensor<!pphlo.pub<i32>>) -> (tensor<!pphlo.sec<f32>>) {
+  %0 = "pphlo.multiply"(%arg0, %arg1) : (tensor<!pphlo.sec<f32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.sec<f32>>
+  %1 = "pphlo.add"(%0, %arg0) : (tensor<!pphlo.sec<f32>>, tensor<!pphlo.sec<f32>>) -> tensor<!pphlo.sec<f32>>
+  %2 = "pphlo.multiply"(%arg1, %arg1) : (tensor<!pphlo.pub<i32>>, tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<i32>>
+  %3 = "pphlo.convert"(%2) : (tensor<!pphlo.pub<i32>>) -> tensor<!pphlo.pub<f32>>
+  %4 = "pphlo.subtract"(%1, %3) : (tensor<!pphlo.sec<f32>>, tensor<!pphlo.pub<f32>>) -> tensor<!pphlo.sec<f32>>
+  return %4 : tensor<!pphlo.sec<f32>>
+})");
+
+  r.verifyScalarOutput(-3.0F);
+}
+
 TEST_P(ExecutorTest, BoolSplatConstant) {
   Runner r(std::get<0>(GetParam()), std::get<1>(GetParam()),
            std::get<2>(GetParam()));
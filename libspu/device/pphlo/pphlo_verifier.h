@@ -141,6 +141,9 @@ class PPHloVerifier {
   NO_VERIFY_DEFN(MaxPoolScatterOp)
   NO_VERIFY_DEFN(PreferAOp)
   NO_VERIFY_DEFN(ArgMaxOp)
+  NO_VERIFY_DEFN(SoftmaxOp)
+  NO_VERIFY_DEFN(LayerNormOp)
+  NO_VERIFY_DEFN(GeluOp)
   NO_VERIFY_DEFN(EpsilonOp)
 
 #undef NO_VERIFY_DEFN
@@ -14,8 +14,11 @@
 
 #include "libspu/kernel/hal/fxp_base.h"
 
+#include <algorithm>
 #include <cmath>
+#include <optional>
 
+#include "libspu/core/type_util.h"
 #include "libspu/kernel/hal/constants.h"
 #include "libspu/kernel/hal/fxp_cleartext.h"
 #include "libspu/kernel/hal/ring.h"
@@ -193,6 +196,153 @@ Value reciprocal_goldschmidt(HalContext* ctx, const Value& b) {
 
 }  // namespace detail
 
+namespace {
+
+// What we know about a public fxp operand.
+struct PublicOperandInfo {
+  // every element is an integer, i.e. the low fxp_bits are all zero.
+  bool integral = true;
+  // the (sign extended) ring encoding shared by all elements.
+  int128_t uniform = 0;
+};
+
+// Only scalars and splats (every element aliasing one buffer slot, e.g. a
+// broadcasted constant) are inspected, so the check costs O(1) on every f_mul
+// with a public operand.
+std::optional<PublicOperandInfo> analyzePublic(HalContext* ctx,
+                                               const Value& x) {
+  if (!x.isPublic() || !x.isFxp() || x.numel() == 0) {
+    return std::nullopt;
+  }
+
+  const auto& strides = x.data().strides();
+  const bool splat =
+      x.numel() == 1 || std::all_of(strides.begin(), strides.end(),
+                                    [](int64_t s) { return s == 0; });
+  if (!splat) {
+    return std::nullopt;
+  }
+
+  const auto field = x.storage_type().as<Ring2k>()->field();
+  const size_t fxp_bits = ctx->getFxpBits();
+
+  return DISPATCH_ALL_FIELDS(field, "analyzePublic", [&]() {
+    using S = std::make_signed_t<ring2k_t>;
+    const ring2k_t frac_mask = (static_cast<ring2k_t>(1) << fxp_bits) - 1;
+    const auto v = *reinterpret_cast<const ring2k_t*>(x.data().data());
+
+    PublicOperandInfo info;
+    info.integral = (v & frac_mask) == 0;
+    info.uniform = static_cast<int128_t>(static_cast<S>(v));
+    return std::make_optional(info);
+  });
+}
+
+// log2(|r|) if r is +/-2^k.
+std::optional<size_t> log2Abs(int128_t r) {
+  const auto abs_r = static_cast<uint128_t>(r < 0 ? -r : r);
+  if (abs_r == 0 || (abs_r & (abs_r - 1)) != 0) {
+    return std::nullopt;
+  }
+  size_t k = 0;
+  while ((abs_r >> k) != 1) {
+    ++k;
+  }
+  return k;
+}
+
+// The following fast paths are split into dedicated functions so the HAL
+// profile counts how many truncations (and MPC calls) they have avoided.
+
+// x * (+/-1.0) = +/-x, no communication at all.
+Value f_mul_by_public_unit(HalContext* ctx, const Value& x, bool negative) {
+  SPU_TRACE_HAL_LEAF(ctx, x);
+  return negative ? _negate(ctx, x).asFxp() : x;
+}
+
+// x * y where y holds integers only, the product is exact without
+// truncation: x * y = x * (y >> fxp_bits).
+Value f_mul_by_public_integer(HalContext* ctx, const Value& x,
+                              const Value& y) {
+  SPU_TRACE_HAL_LEAF(ctx, x, y);
+  return _mul(ctx, x, _arshift(ctx, y, ctx->getFxpBits())).asFxp();
+}
+
+// x * (+/-2^-bits) = +/-trunc(x, bits), saves the multiplication and a
+// truncation by fxp_bits.
+Value f_mul_by_public_pow2(HalContext* ctx, const Value& x, size_t bits,
+                           bool negative) {
+  SPU_TRACE_HAL_LEAF(ctx, x);
+  auto ret = _trunc(ctx, x, bits);
+  return negative ? _negate(ctx, ret).asFxp() : ret.asFxp();
+}
+
+// Try to evaluate x * y with cheap local ops, given y is public.
+std::optional<Value> tryMulByPublic(HalContext* ctx, const Value& x,
+                                    const Value& y) {
+  const auto info = analyzePublic(ctx, y);
+  if (!info.has_value() || !x.isFxp() || x.shape() != y.shape()) {
+    return std::nullopt;
+  }
+
+  const size_t fxp_bits = ctx->getFxpBits();
+  const int128_t r = info->uniform;
+  const int128_t one = static_cast<int128_t>(1) << fxp_bits;
+  if (r == one || r == -one) {
+    return f_mul_by_public_unit(ctx, x, r < 0);
+  }
+
+  // |r| = 2^k with k < fxp_bits, i.e. y = +/-2^-(fxp_bits-k)
+  const auto k = log2Abs(r);
+  if (k.has_value() && *k < fxp_bits) {
+    return f_mul_by_public_pow2(ctx, x, fxp_bits - *k, r < 0);
+  }
+
+  if (info->integral) {
+    return f_mul_by_public_integer(ctx, x, y);
+  }
+
+  return std::nullopt;
+}
+
+// x / (+/-2^(k - fxp_bits)) = +/-x * 2^(fxp_bits - k), a single truncation
+// when k > fxp_bits and an exact local shift otherwise.
+Value f_div_by_public_pow2(HalContext* ctx, const Value& x, size_t k,
+                           bool negative) {
+  SPU_TRACE_HAL_LEAF(ctx, x);
+  const size_t fxp_bits = ctx->getFxpBits();
+  Value ret;
+  if (k > fxp_bits) {
+    ret = _trunc(ctx, x, k - fxp_bits);
+  } else if (k < fxp_bits) {
+    ret = _lshift(ctx, x, fxp_bits - k);
+  } else {
+    ret = x;
+  }
+  return negative ? _negate(ctx, ret).asFxp() : ret.asFxp();
+}
+
+// Only +/-2^k has an exact fxp reciprocal. Any other divisor y would be
+// rounded to a reciprocal with a relative error around y / 2^fxp_bits, so
+// those take the generic path. The divisor is checked as is, any splat
+// shape included, so no reciprocal is ever materialized.
+std::optional<Value> tryDivByPublic(HalContext* ctx, const Value& x,
+                                    const Value& y) {
+  const auto info = analyzePublic(ctx, y);
+  if (!info.has_value() || !x.isFxp() || x.shape() != y.shape()) {
+    return std::nullopt;
+  }
+
+  // y is encoded as +/-2^k, i.e. y = +/-2^(k - fxp_bits).
+  const auto k = log2Abs(info->uniform);
+  if (!k.has_value() || *k > 2 * ctx->getFxpBits()) {
+    return std::nullopt;
+  }
+  return f_div_by_public_pow2(ctx, x, *k, info->uniform < 0);
+}
+
+}  // namespace
+
 Value f_negate(HalContext* ctx, const Value& x) {
   SPU_TRACE_HAL_LEAF(ctx, x);
 
@@ -238,6 +388,17 @@ Value f_sub(HalContext* ctx, const Value& x, const Value& y) {
 }
 
 Value f_mul(HalContext* ctx, const Value& x, const Value& y) {
+  // Algebraic fast paths for a public operand, checked before tracing this
+  // call so the fast paths are profiled as separate actions.
+  if (!(x.isPublic() && y.isPublic())) {
+    if (auto ret = tryMulByPublic(ctx, x, y)) {
+      return *ret;
+    }
+    if (auto ret = tryMulByPublic(ctx, y, x)) {
+      return *ret;
+    }
+  }
+
   SPU_TRACE_HAL_LEAF(ctx, x, y);
 
   SPU_ENFORCE(x.isFxp());
@@ -279,6 +440,15 @@ Value f_mmul(HalContext* ctx, const Value& x, const Value& y) {
   return _trunc(ctx, _mmul(ctx, x, y)).asFxp();
 }
 
+Value f_batch_mmul(HalContext* ctx, const Value& x, const Value& y) {
+  SPU_TRACE_HAL_LEAF(ctx, x, y);
+
+  SPU_ENFORCE(x.isFxp());
+  SPU_ENFORCE(y.isFxp());
+
+  return _trunc(ctx, _batch_mmul(ctx, x, y)).asFxp();
+}
+
 Value f_conv2d(HalContext* ctx, const Value& x, const Value& y,
                absl::Span<const int64_t> window_strides,
                absl::Span<const int64_t> result_shape) {
@@ -291,6 +461,12 @@ Value f_conv2d(HalContext* ctx, const Value& x, const Value& y,
 }
 
 Value f_div(HalContext* ctx, const Value& x, const Value& y) {
+  if (!x.isPublic()) {
+    if (auto ret = tryDivByPublic(ctx, x, y)) {
+      return *ret;
+    }
+  }
+
   SPU_TRACE_HAL_LEAF(ctx, x, y);
 
   SPU_ENFORCE(x.isFxp());
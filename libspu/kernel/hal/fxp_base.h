@@ -63,6 +63,8 @@ Value f_mul_with_sign(HalContext* ctx, const Value& x, const Value& y,
 
 Value f_mmul(HalContext* ctx, const Value& x, const Value& y);
 
+Value f_batch_mmul(HalContext* ctx, const Value& x, const Value& y);
+
 Value f_conv2d(HalContext* ctx, const Value& x, const Value& y,
                absl::Span<const int64_t> window_strides,
                absl::Span<const int64_t> result_shape);
@@ -183,6 +183,92 @@ TEST(FxpTest, Div) {
   }
 }
 
+TEST(FxpTest, MulDivByPublicConstant) {
+  // GIVEN
+  HalContext ctx = test::makeRefHalContext();
+
+  xt::xarray<float> x = {{1.0, -2.5, 700.0, -0.5, 314.0, 1.5}};
+  Value a = test::makeValue(&ctx, x, VIS_SECRET);
+
+  // unit, integer, power of two and generic public operands.
+  for (float c : {1.0F, -1.0F, 0.0F, 3.0F, -12.0F, 0.25F, -0.5F, 0.3F}) {
+    Value b = constant(&ctx, c, DT_FXP, x.shape());
+
+    Value p = f_mul(&ctx, a, b);
+    EXPECT_EQ(p.dtype(), DT_FXP);
+    auto z = dump_public_as<float>(&ctx, _s2p(&ctx, p).asFxp());
+    EXPECT_TRUE(xt::allclose(x * c, z, 0.001, 0.001))
+        << c << std::endl
+        << (x * c) << std::endl
+        << z;
+
+    Value q = f_mul(&ctx, b, a);
+    z = dump_public_as<float>(&ctx, _s2p(&ctx, q).asFxp());
+    EXPECT_TRUE(xt::allclose(x * c, z, 0.001, 0.001));
+
+    if (c != 0.0F) {
+      Value d = f_div(&ctx, a, b);
+      EXPECT_EQ(d.dtype(), DT_FXP);
+      z = dump_public_as<float>(&ctx, _s2p(&ctx, d).asFxp());
+      EXPECT_TRUE(xt::allclose(x / c, z, 0.001, 0.001))
+          << c << std::endl
+          << (x / c) << std::endl
+          << z;
+    }
+  }
+
+  // non-uniform public integers.
+  {
+    xt::xarray<float> y = {{1.0, 2.0, -3.0, 0.0, 5.0, -1.0}};
+    Value b = constant(&ctx, y, DT_FXP);
+    Value p = f_mul(&ctx, a, b);
+    auto z = dump_public_as<float>(&ctx, _s2p(&ctx, p).asFxp());
+    EXPECT_TRUE(xt::allclose(x * y, z, 0.001, 0.001)) << (x * y) << std::endl
+                                                      << z;
+  }
+}
+
+TEST(FxpTest, DivByLargePublicConstant) {
+  // GIVEN
+  HalContext ctx = test::makeRefHalContext();
+
+  xt::xarray<float> x = {{100000.0, -250000.0, 70000.0, -3000.0, 150000.0}};
+  Value a = test::makeValue(&ctx, x, VIS_SECRET);
+
+  // Rounding 1/c to fxp_bits would be off by about c / 2^fxp_bits relative
+  // for the non power of two divisors.
+  for (float c : {10000.0F, -3000.0F, 12345.0F, 777.5F, 1024.0F, -65536.0F}) {
+    Value b = constant(&ctx, c, DT_FXP, x.shape());
+
+    Value d = f_div(&ctx, a, b);
+    EXPECT_EQ(d.dtype(), DT_FXP);
+    auto z = dump_public_as<float>(&ctx, _s2p(&ctx, d).asFxp());
+    EXPECT_TRUE(xt::allclose(x / c, z, 0.002, 0.001))
+        << c << std::endl
+        << (x / c) << std::endl
+        << z;
+  }
+}
+
+TEST(FxpTest, DivByPublicPow2Tensor) {
+  // GIVEN
+  HalContext ctx = test::makeRefHalContext();
+
+  xt::xarray<float> x = {{1.0, -2.5, 700.0, -0.5}, {314.0, 1.5, -3.0, 8.0}};
+  Value a = test::makeValue(&ctx, x, VIS_SECRET);
+
+  // A broadcasted tensor divisor is shifted, not multiplied by a rounded
+  // reciprocal, so the quotients representable in fxp are exact.
+  for (float c : {4.0F, -0.25F, 1.0F, -1024.0F, 0.5F}) {
+    Value b = constant(&ctx, c, DT_FXP, x.shape());
+
+    Value d = f_div(&ctx, a, b);
+    EXPECT_EQ(d.dtype(), DT_FXP);
+    auto z = dump_public_as<float>(&ctx, _s2p(&ctx, d).asFxp());
+    EXPECT_EQ(z, x / c) << c << std::endl << (x / c) << std::endl << z;
+  }
+}
+
 TEST(FxpTest, Abs) {
   // GIVEN
   HalContext ctx = test::makeRefHalContext();
@@ -0,0 +1,206 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libspu/kernel/hal/fxp_fused.h"
+
+#include <vector>
+
+#include "libspu/kernel/hal/constants.h"
+#include "libspu/kernel/hal/fxp_approx.h"
+#include "libspu/kernel/hal/fxp_base.h"
+#include "libspu/kernel/hal/polymorphic.h"
+#include "libspu/kernel/hal/ring.h"
+#include "libspu/kernel/hal/shape_ops.h"
+
+namespace spu::kernel::hal {
+
+namespace {
+
+// simple convenient function.
+Value f_constant(HalContext* ctx, const PtBufferView& init,
+                 absl::Span<int64_t const> shape) {
+  return constant(ctx, init, DT_FXP, shape);
+}
+
+Value sliceAxis(HalContext* ctx, const Value& in, int64_t axis, int64_t start,
+                int64_t end) {
+  std::vector<int64_t> starts(in.shape().size(), 0);
+  std::vector<int64_t> ends = in.shape();
+  std::vector<int64_t> strides(in.shape().size(), 1);
+  starts[axis] = start;
+  ends[axis] = end;
+  return slice(ctx, in, starts, ends, strides);
+}
+
+// Pairwise reduce along `axis`, the reduced dimension is kept as 1. Each level
+// is a single call of `fn` over all rows, i.e. log(n) calls in total.
+template <typename Fn>
+Value treeReduce(HalContext* ctx, Value in, int64_t axis, Fn&& fn) {
+  while (in.shape()[axis] > 1) {
+    const int64_t n = in.shape()[axis];
+    const int64_t half = n / 2;
+    auto reduced = fn(sliceAxis(ctx, in, axis, 0, half),
+                      sliceAxis(ctx, in, axis, half, 2 * half));
+    if (n % 2 != 0) {
+      reduced = concatenate(
+          ctx, {reduced, sliceAxis(ctx, in, axis, n - 1, n)}, axis);
+    }
+    in = std::move(reduced);
+  }
+  return in;
+}
+
+Value reduceSum(HalContext* ctx, const Value& in, int64_t axis) {
+  return treeReduce(ctx, in, axis, [&](const Value& lhs, const Value& rhs) {
+    return f_add(ctx, lhs, rhs);
+  });
+}
+
+// Broadcast a reduced value back to `shape`.
+Value broadcastBack(HalContext* ctx, const Value& in, int64_t axis,
+                    absl::Span<const int64_t> shape) {
+  std::vector<int64_t> squeezed;
+  std::vector<int64_t> dims;
+  for (int64_t dim = 0; dim < static_cast<int64_t>(shape.size()); dim++) {
+    if (dim != axis) {
+      squeezed.push_back(shape[dim]);
+      dims.push_back(dim);
+    }
+  }
+  return broadcast_to(ctx, reshape(ctx, in, squeezed), shape, dims);
+}
+
+void checkAxis(const Value& x, int64_t axis) {
+  SPU_ENFORCE(x.isFxp(), "expect fxp, got {}", x.dtype());
+  SPU_ENFORCE(axis >= 0 && axis < static_cast<int64_t>(x.shape().size()),
+              "invalid axis {} for shape {}", axis, x.shape());
+}
+
+}  // namespace
+
+Value f_softmax(HalContext* ctx, const Value& x, int64_t axis) {
+  SPU_TRACE_HAL_LEAF(ctx, x, axis);
+  checkAxis(x, axis);
+
+  if (x.numel() == 0) {
+    return x;
+  }
+
+  // shared max subtraction, x - max(x) <= 0.
+  auto row_max = treeReduce(ctx, x, axis,
+                            [&](const Value& lhs, const Value& rhs) {
+                              return max(ctx, lhs, rhs);
+                            });
+  auto shifted = f_sub(ctx, x, broadcastBack(ctx, row_max, axis, x.shape()));
+
+  // exp(-14) is below the fxp precision, clipping keeps the exp input in the
+  // range where approximations (taylor by default) are accurate.
+  auto lower = f_constant(ctx, -14.0F, x.shape());
+  shifted = select(ctx, f_less(ctx, shifted, lower), lower, shifted);
+  auto e = f_exp(ctx, shifted);
+
+  // sum is in [1, n], so the reciprocal is positive and only computed once per
+  // row, then merged into the row scaling.
+  auto sum = reduceSum(ctx, e, axis);
+  auto inv = sum.isPublic() ? f_reciprocal(ctx, sum)
+                            : detail::reciprocal_goldschmidt_positive(ctx, sum);
+  return f_mul(ctx, e, broadcastBack(ctx, inv, axis, x.shape()));
+}
+
+Value f_layer_norm(HalContext* ctx, const Value& x, int64_t axis,
+                   double epsilon) {
+  SPU_TRACE_HAL_LEAF(ctx, x, axis, epsilon);
+  checkAxis(x, axis);
+
+  if (x.numel() == 0) {
+    return x;
+  }
+
+  const int64_t n = x.shape()[axis];
+  auto mean = reduceSum(ctx, x, axis);
+  const auto inv_n = f_constant(ctx, 1.0 / n, mean.shape());
+  mean = f_mul(ctx, mean, inv_n);
+
+  auto centered = f_sub(ctx, x, broadcastBack(ctx, mean, axis, x.shape()));
+  auto var = f_mul(ctx, reduceSum(ctx, f_square(ctx, centered), axis), inv_n);
+
+  // rsqrt is only computed once per row.
+  auto rstd =
+      f_rsqrt(ctx, f_add(ctx, var, f_constant(ctx, epsilon, var.shape())));
+  return f_mul(ctx, centered, broadcastBack(ctx, rstd, axis, x.shape()));
+}
+
+Value f_gelu(HalContext* ctx, const Value& x) {
+  SPU_TRACE_HAL_LEAF(ctx, x);
+  SPU_ENFORCE(x.isFxp(), "expect fxp, got {}", x.dtype());
+
+  if (x.numel() == 0) {
+    return x;
+  }
+
+  // Piecewise approximation:
+  //   gelu(x) = 0,                    x < -4
+  //           = p3(x),         -4  <= x < -1.95
+  //           = 0.5x + p8(x),  -1.95 <= x <= 3
+  //           = x,                    x > 3
+  // where p8 is even, since gelu(x) - 0.5x = 0.5x * tanh(...) is even.
+  // The max absolute error is about 0.005.
+  //
+  // The three comparisons are batched into one call.
+  const int64_t numel = x.numel();
+  auto flat = reshape(ctx, x, {numel});
+  auto lhs =
+      concatenate(ctx, {flat, flat, f_constant(ctx, 3.0F, {numel})}, 0);
+  auto rhs = concatenate(ctx,
+                         {f_constant(ctx, -4.0F, {numel}),
+                          f_constant(ctx, -1.95F, {numel}), flat},
+                         0);
+  auto cmp = f_less(ctx, lhs, rhs);
+  auto part = [&](int64_t idx) {
+    auto bits = slice(ctx, cmp, {idx * numel}, {(idx + 1) * numel}, {1});
+    return reshape(ctx, bits, x.shape());
+  };
+  const auto lt_m4 = part(0);
+  const auto lt_m195 = part(1);
+  const auto gt_3 = part(2);
+
+  // clip to [-4, 3] with the bits above, so polynomials never overflow.
+  auto xc = select(ctx, lt_m4, f_constant(ctx, -4.0F, x.shape()), x);
+  xc = select(ctx, gt_3, f_constant(ctx, 3.0F, x.shape()), xc);
+
+  std::vector<Value> c3 = {
+      f_constant(ctx, -0.4282004734898563, x.shape()),
+      f_constant(ctx, -0.12000597304278915, x.shape()),
+      f_constant(ctx, -0.011239762515820033, x.shape()),
+  };
+  auto p3 = f_add(ctx, detail::f_polynomial(ctx, xc, c3),
+                  f_constant(ctx, -0.5113738144632282, x.shape()));
+
+  auto x2 = f_square(ctx, xc);
+  std::vector<Value> c8 = {
+      f_constant(ctx, 0.38756072609304, x.shape()),
+      f_constant(ctx, -0.05430146236796429, x.shape()),
+      f_constant(ctx, 0.005000971121318197, x.shape()),
+      f_constant(ctx, -0.00018981449845941847, x.shape()),
+  };
+  auto p8 = f_add(ctx, detail::f_polynomial(ctx, x2, c8),
+                  f_constant(ctx, 0.0017060968566221357, x.shape()));
+  p8 = f_add(ctx, p8, f_mul(ctx, xc, f_constant(ctx, 0.5F, x.shape())));
+
+  auto ret = select(ctx, lt_m195, p3, p8);
+  ret = select(ctx, lt_m4, f_constant(ctx, 0.0F, x.shape()), ret);
+  return select(ctx, gt_3, x, ret);
+}
+
+}  // namespace spu::kernel::hal
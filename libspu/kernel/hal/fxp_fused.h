@@ -0,0 +1,41 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "libspu/kernel/context.h"
+#include "libspu/kernel/value.h"
+
+// !!please read [README.md] for api naming conventions.
+namespace spu::kernel::hal {
+
+/// softmax along `axis`, i.e. exp(x - max(x)) / sum(exp(x - max(x)))
+// @param x, the fxp input
+// @param axis, the normalized axis
+Value f_softmax(HalContext* ctx, const Value& x, int64_t axis);
+
+/// layer normalization along `axis` without the affine part, i.e.
+/// (x - mean(x)) / sqrt(var(x) + epsilon)
+// @param x, the fxp input
+// @param axis, the normalized axis
+// @param epsilon, added to the variance
+Value f_layer_norm(HalContext* ctx, const Value& x, int64_t axis,
+                   double epsilon);
+
+/// gelu with tanh approximation,
+/// 0.5 * x * (1 + tanh(sqrt(2/pi) * (x + 0.044715 * x^3)))
+// @param x, the fxp input
+Value f_gelu(HalContext* ctx, const Value& x);
+
+}  // namespace spu::kernel::hal
@@ -0,0 +1,92 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libspu/kernel/hal/fxp_fused.h"
+
+#include "gtest/gtest.h"
+#include "xtensor/xio.hpp"
+#include "xtensor/xmath.hpp"
+
+#include "libspu/kernel/hal/test_util.h"
+
+namespace spu::kernel::hal {
+
+TEST(FxpFusedTest, Softmax) {
+  // GIVEN
+  HalContext ctx = test::makeRefHalContext();
+
+  xt::xarray<float> x = {{0.1, -0.2, 1.5, 2.7, -3.9},
+                         {12.0, 0.0, -10.0, 11.5, 3.3},
+                         {-1.0, -1.0, -1.0, -1.0, -1.0}};
+
+  for (int64_t axis : {0, 1}) {
+    auto e = xt::eval(xt::exp(x - xt::amax(x, {axis}, xt::keep_dims)));
+    xt::xarray<float> expected = e / xt::sum(e, {axis}, xt::keep_dims);
+
+    Value a = test::makeValue(&ctx, x, VIS_SECRET);
+    Value c = f_softmax(&ctx, a, axis);
+    EXPECT_EQ(c.dtype(), DT_FXP);
+    EXPECT_EQ(c.shape(), a.shape());
+
+    auto y = dump_public_as<float>(&ctx, _s2p(&ctx, c).asFxp());
+    EXPECT_TRUE(xt::allclose(expected, y, 0.01, 0.001))
+        << expected << std::endl
+        << y;
+  }
+}
+
+TEST(FxpFusedTest, LayerNorm) {
+  // GIVEN
+  HalContext ctx = test::makeRefHalContext();
+
+  xt::xarray<float> x = {{0.1, -0.2, 1.5, 2.7, -3.9, 0.6},
+                         {12.0, 0.0, -10.0, 11.5, 3.3, 4.2}};
+  const double epsilon = 1e-5;
+
+  auto centered = xt::eval(x - xt::mean(x, {1}, xt::keep_dims));
+  xt::xarray<float> expected =
+      centered / xt::sqrt(xt::mean(centered * centered, {1}, xt::keep_dims) +
+                          epsilon);
+
+  Value a = test::makeValue(&ctx, x, VIS_SECRET);
+  Value c = f_layer_norm(&ctx, a, 1, epsilon);
+  EXPECT_EQ(c.dtype(), DT_FXP);
+
+  auto y = dump_public_as<float>(&ctx, _s2p(&ctx, c).asFxp());
+  EXPECT_TRUE(xt::allclose(expected, y, 0.01, 0.01))
+      << expected << std::endl
+      << y;
+}
+
+TEST(FxpFusedTest, Gelu) {
+  // GIVEN
+  HalContext ctx = test::makeRefHalContext();
+
+  xt::xarray<float> x = {-10.0, -4.5, -3.0, -2.0, -1.5, -0.7, -0.1, 0.0,
+                         0.1,   0.5,  1.0,  1.9,  2.5,  3.0,  3.5,  8.0};
+  xt::xarray<float> expected =
+      0.5 * x *
+      (1 + xt::tanh(std::sqrt(2 / M_PI) * (x + 0.044715 * x * x * x)));
+
+  Value a = test::makeValue(&ctx, x, VIS_SECRET);
+  Value c = f_gelu(&ctx, a);
+  EXPECT_EQ(c.dtype(), DT_FXP);
+
+  auto y = dump_public_as<float>(&ctx, _s2p(&ctx, c).asFxp());
+  EXPECT_TRUE(xt::allclose(expected, y, 0.01, 0.01))
+      << expected << std::endl
+      << y;
+}
+
+}  // namespace spu::kernel::hal
@@ -47,6 +47,7 @@ DEF_UNARY_OP(i_negate, _negate)
 DEF_BINARY_OP(i_add, _add)
 DEF_BINARY_OP(i_mul, _mul)
 DEF_BINARY_OP(i_mmul, _mmul)
+DEF_BINARY_OP(i_batch_mmul, _batch_mmul)
 
 Value i_less(HalContext* ctx, const Value& x, const Value& y) {
   SPU_TRACE_HAL_LEAF(ctx, x, y);
@@ -55,6 +56,14 @@ Value i_less(HalContext* ctx, const Value& x, const Value& y) {
   return _less(ctx, x, y).setDtype(DT_I1);
 }
 
+Value i_less(HalContext* ctx, const Value& x, const Value& y,
+             size_t valid_bits) {
+  SPU_TRACE_HAL_LEAF(ctx, x, y, valid_bits);
+  ENSURE_INT_AND_DTYPE_MATCH(x, y);
+
+  return _less(ctx, x, y, valid_bits).setDtype(DT_I1);
+}
+
 #undef DEF_BINARY_OP
 
 Value i_abs(HalContext* ctx, const Value& x) {
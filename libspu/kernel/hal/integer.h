@@ -37,6 +37,8 @@ Value i_mul(HalContext* ctx, const Value& x, const Value& y);
 
 Value i_mmul(HalContext* ctx, const Value& x, const Value& y);
 
+Value i_batch_mmul(HalContext* ctx, const Value& x, const Value& y);
+
 Value i_conv2d(HalContext* ctx, const Value& x, const Value& y,
                absl::Span<const int64_t> window_strides,
                absl::Span<const int64_t> result_shape);
@@ -45,4 +47,8 @@ Value i_equal(HalContext* ctx, const Value& x, const Value& y);
 
 Value i_less(HalContext* ctx, const Value& x, const Value& y);
 
+// (x - y) is known to fit in valid_bits signed bits.
+Value i_less(HalContext* ctx, const Value& x, const Value& y,
+             size_t valid_bits);
+
 }  // namespace spu::kernel::hal
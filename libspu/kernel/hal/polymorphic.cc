@@ -155,6 +155,42 @@ Value matmul(HalContext* ctx, const Value& x, const Value& y) {
   return dtypeBinaryDispatch<f_mmul, i_mmul>("mmul", ctx, x, y);
 }
 
+Value batch_matmul(HalContext* ctx, const Value& x, const Value& y) {
+  SPU_TRACE_HAL_DISP(ctx, x, y);
+  SPU_ENFORCE(x.shape().size() == 3 && y.shape().size() == 3 &&
+                  x.shape()[0] == y.shape()[0] && x.shape()[2] == y.shape()[1],
+              "invalid batch matmul shapes, x={}, y={}", x, y);
+
+  // Only protocols with a native batch kernel run all products at once, the
+  // others keep the tiled `_mmul` per product.
+  if (x.isSecret() && y.isSecret() && ctx->prot()->hasKernel("batch_mmul_aa")) {
+    if (isCrossIntFxp(x, y)) {
+      return _batch_mmul(ctx, x, y).asFxp();
+    }
+    return dtypeBinaryDispatch<f_batch_mmul, i_batch_mmul>("batch_mmul", ctx,
+                                                           x, y);
+  }
+
+  const int64_t batch = x.shape()[0];
+  std::vector<Value> results(batch);
+  std::vector<int64_t> strides(3, 1);
+  for (int64_t idx = 0; idx < batch; ++idx) {
+    auto x_slice =
+        reshape(ctx,
+                slice(ctx, x, {idx, 0, 0},
+                      {idx + 1, x.shape()[1], x.shape()[2]}, strides),
+                {x.shape()[1], x.shape()[2]});
+    auto y_slice =
+        reshape(ctx,
+                slice(ctx, y, {idx, 0, 0},
+                      {idx + 1, y.shape()[1], y.shape()[2]}, strides),
+                {y.shape()[1], y.shape()[2]});
+    results[idx] = reshape(ctx, matmul(ctx, x_slice, y_slice),
+                           {1, x.shape()[1], y.shape()[2]});
+  }
+  return concatenate(ctx, results, 0);
+}
+
 Value logical_not(HalContext* ctx, const Value& in) {
   SPU_TRACE_HAL_LEAF(ctx, in);
 
@@ -224,6 +260,43 @@ Value greater_equal(HalContext* ctx, const Value& x, const Value& y) {
   return logical_not(ctx, less(ctx, x, y));
 }
 
+Value less(HalContext* ctx, const Value& x, const Value& y,
+           size_t valid_bits) {
+  SPU_TRACE_HAL_DISP(ctx, x, y, valid_bits);
+  SPU_ENFORCE(x.shape() == y.shape());
+
+  if (valid_bits != 0 && x.isInt() && y.isInt() && x.dtype() == y.dtype()) {
+    return i_less(ctx, x, y, valid_bits);
+  }
+  return less(ctx, x, y);
+}
+
+Value less_equal(HalContext* ctx, const Value& x, const Value& y,
+                 size_t valid_bits) {
+  SPU_TRACE_HAL_DISP(ctx, x, y, valid_bits);
+  SPU_ENFORCE(x.shape() == y.shape());
+
+  // not (y < x), y - x has the same width as x - y.
+  return logical_not(ctx, less(ctx, y, x, valid_bits));
+}
+
+Value greater(HalContext* ctx, const Value& x, const Value& y,
+              size_t valid_bits) {
+  SPU_TRACE_HAL_DISP(ctx, x, y, valid_bits);
+  SPU_ENFORCE(x.shape() == y.shape());
+
+  return less(ctx, y, x, valid_bits);
+}
+
+Value greater_equal(HalContext* ctx, const Value& x, const Value& y,
+                    size_t valid_bits) {
+  SPU_TRACE_HAL_DISP(ctx, x, y, valid_bits);
+  SPU_ENFORCE(x.shape() == y.shape());
+
+  // not (x < y)
+  return logical_not(ctx, less(ctx, x, y, valid_bits));
+}
+
 Value negate(HalContext* ctx, const Value& x) {
   SPU_TRACE_HAL_DISP(ctx, x);
 
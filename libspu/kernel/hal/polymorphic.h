@@ -47,11 +47,23 @@ Value bitwise_or(HalContext* ctx, const Value& x, const Value& y);
 // @param in, the input parameter
 Value bitwise_not(HalContext* ctx, const Value& in);
 
+/// multiplication of an integer and a fixed point value, the integer is not
+/// encoded so no truncation is needed
+// @param x, the first parameter
+// @param y, the second parameter
+Value mixed_mul(HalContext* ctx, const Value& x, const Value& y);
+
 /// matrix production operator
 // @param x, the first parameter
 // @param y, the second parameter
 Value matmul(HalContext* ctx, const Value& x, const Value& y);
 
+/// batched matrix production operator
+// @param x, the first parameter, of shape [B, M, K]
+// @param y, the second parameter, of shape [B, K, N]
+// @returns, of shape [B, M, N]
+Value batch_matmul(HalContext* ctx, const Value& x, const Value& y);
+
 /// 2-dimensional convolution operator
 // @param x, the input tensor
 // @param y, the kernel weight
@@ -98,6 +110,20 @@ Value less(HalContext* ctx, const Value& x, const Value& y);
 // @param y, the second parameter
 Value less_equal(HalContext* ctx, const Value& x, const Value& y);
 
+/// comparisons of integers whose difference is known to be narrow
+// @param x, the first parameter
+// @param y, the second parameter
+// @param valid_bits, (x - y) fits in valid_bits signed bits, 0 if unknown.
+//        Ignored for fixed-point values.
+Value greater(HalContext* ctx, const Value& x, const Value& y,
+              size_t valid_bits);
+Value greater_equal(HalContext* ctx, const Value& x, const Value& y,
+                    size_t valid_bits);
+Value less(HalContext* ctx, const Value& x, const Value& y,
+           size_t valid_bits);
+Value less_equal(HalContext* ctx, const Value& x, const Value& y,
+                 size_t valid_bits);
+
 /// the element-wise natural logarithm
 // @param in, the param
 Value log(HalContext* ctx, const Value& in);
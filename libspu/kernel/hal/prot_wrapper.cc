@@ -103,6 +103,20 @@ std::tuple<int64_t, int64_t, int64_t> deduceMmulArgs(
     return unflattenValue(ret, {m, n});                                    \
   }
 
+Value _batch_mmul_ss(HalContext* ctx, const Value& x, const Value& y) {
+  SPU_TRACE_HAL_DISP(ctx, x, y);
+  SPU_ENFORCE(x.shape().size() == 3 && y.shape().size() == 3 &&
+                  x.shape()[0] == y.shape()[0] && x.shape()[2] == y.shape()[1],
+              "invalid batch mmul shapes, x={}, y={}", x, y);
+  const int64_t batch = x.shape()[0];
+  const int64_t m = x.shape()[1];
+  const int64_t k = x.shape()[2];
+  const int64_t n = y.shape()[2];
+  auto ret = mpc::batch_mmul_ss(ctx->prot(), flattenValue(x), flattenValue(y),
+                                batch, m, n, k);
+  return unflattenValue(ret, {batch, m, n});
+}
+
 Type _common_type_s(HalContext* ctx, const Type& a, const Type& b) {
   SPU_TRACE_HAL_DISP(ctx, a, b);
   return mpc::common_type_s(ctx->prot(), a, b);
@@ -133,6 +147,11 @@ Value _rand_s(HalContext* ctx, absl::Span<const int64_t> shape) {
   return unflattenValue(rnd, shape);
 }
 
+void _checkpoint(HalContext* ctx) {
+  SPU_TRACE_HAL_DISP(ctx);
+  mpc::checkpoint(ctx->prot());
+}
+
 Value _conv2d_ss(HalContext* ctx, Value input, const Value& kernel,
                  absl::Span<const int64_t> window_strides,
                  absl::Span<const int64_t> result_shape) {
@@ -194,6 +213,17 @@ Value _trunc_s_with_sign(HalContext* ctx, const Value& in, size_t bits,
   }
 }
 
+Value _msb_s_with_bits(HalContext* ctx, const Value& in, size_t bits) {
+  SPU_TRACE_HAL_DISP(ctx, in, bits);
+  if (bits == 0 || bits >= SizeOf(ctx->getField()) * 8 ||
+      !ctx->prot()->hasKernel("msb_s_with_bits")) {
+    return _msb_s(ctx, in);
+  }
+  return unflattenValue(
+      ctx->prot()->call("msb_s_with_bits", flattenValue(in), bits),
+      in.shape());
+}
+
 MAP_UNARY_OP(p2s)
 MAP_UNARY_OP(s2p)
 MAP_UNARY_OP(not_p)
@@ -51,6 +51,9 @@ Value _trunc_p_with_sign(HalContext* ctx, const Value& in, size_t bits,
 Value _trunc_s_with_sign(HalContext* ctx, const Value& in, size_t bits,
                          bool is_positive);
 
+// msb of a secret which is known to fit in `bits` signed bits.
+Value _msb_s_with_bits(HalContext* ctx, const Value& in, size_t bits);
+
 Value _add_pp(HalContext* ctx, const Value& x, const Value& y);
 Value _add_sp(HalContext* ctx, const Value& x, const Value& y);
 Value _add_ss(HalContext* ctx, const Value& x, const Value& y);
@@ -63,6 +66,9 @@ Value _mmul_pp(HalContext* ctx, const Value& x, const Value& y);
 Value _mmul_sp(HalContext* ctx, const Value& x, const Value& y);
 Value _mmul_ss(HalContext* ctx, const Value& x, const Value& y);
 
+// x: [B, M, K], y: [B, K, N] -> [B, M, N]
+Value _batch_mmul_ss(HalContext* ctx, const Value& x, const Value& y);
+
 Value _conv2d_ss(HalContext* ctx, Value x, const Value& y,
                  absl::Span<const int64_t> window_strides,
                  absl::Span<const int64_t> result_shape);
@@ -83,4 +89,7 @@ Value _make_p(HalContext* ctx, uint128_t init, absl::Span<const int64_t> shape);
 Value _rand_p(HalContext* ctx, absl::Span<const int64_t> shape);
 Value _rand_s(HalContext* ctx, absl::Span<const int64_t> shape);
 
+// See mpc::checkpoint.
+void _checkpoint(HalContext* ctx);
+
 }  // namespace spu::kernel::hal
@@ -16,6 +16,7 @@
 
 #include <array>
 #include <cmath>
+#include <future>
 
 #include "libspu/core/bit_utils.h"
 #include "libspu/core/prelude.h"
@@ -202,6 +203,12 @@ Value _conv2d(HalContext* ctx, const Value& x, const Value& y,
   return _conv2d_ss(ctx, x, y, window_strides, result_shape);
 }
 
+Value _batch_mmul(HalContext* ctx, const Value& x, const Value& y) {
+  // Other visibilities go through `_mmul` one product after the other.
+  SPU_ENFORCE(x.isSecret() && y.isSecret());
+  return _batch_mmul_ss(ctx, x, y);
+}
+
 static Value _mmul_impl(HalContext* ctx, const Value& x, const Value& y) {
   if (x.isPublic() && y.isPublic()) {
     return _mmul_pp(ctx, x, y);
@@ -216,10 +223,39 @@ static Value _mmul_impl(HalContext* ctx, const Value& x, const Value& y) {
   }
 };
 
+// Default memory budget of a single tiled matmul.
+constexpr size_t kDefaultMmulMemLimit = 256UL * 1024 * 1024;
+
+// Upper bound of tiles in flight. It is a constant rather than the number of
+// cores since all parties must agree on the tiling and the forked links.
+constexpr int64_t kMmulMaxWorkers = 8;
+
 Value _mmul(HalContext* ctx, const Value& x, const Value& y) {
-  auto [m, n, k] = deduceMmulArgs(x.shape(), y.shape());
-  auto [m_step, n_step, k_step] =
-      calcMmulTilingSize(m, n, k, x.elsize(), 256UL * 1024 * 1024);
+  // Note: structured bindings can not be captured by lambdas in c++17.
+  int64_t m;
+  int64_t n;
+  int64_t k;
+  std::tie(m, n, k) = deduceMmulArgs(x.shape(), y.shape());
+
+  const size_t mem_limit = ctx->rt_config().experimental_mmul_mem_limit() == 0
+                               ? kDefaultMmulMemLimit
+                               : ctx->rt_config().experimental_mmul_mem_limit();
+
+  // When intra op parallel is enabled, the memory budget is shared by up to
+  // `kMmulMaxWorkers` concurrent tiles, each gets a proportional slice of it.
+  const bool enable_par = ctx->rt_config().experimental_enable_intra_op_par() &&
+                          ctx->prot()->hasLowCostFork();
+  const size_t tile_mem_limit =
+      enable_par
+          ? std::max(mem_limit / static_cast<size_t>(kMmulMaxWorkers),
+                     x.elsize())
+          : mem_limit;
+
+  int64_t m_step;
+  int64_t n_step;
+  int64_t k_step;
+  std::tie(m_step, n_step, k_step) =
+      calcMmulTilingSize(m, n, k, x.elsize(), tile_mem_limit);
 
   if (ctx->rt_config().experimental_disable_mmul_split() ||
       (m_step == m && n_step == n && k_step == k)) {
@@ -234,40 +270,74 @@ Value _mmul(HalContext* ctx, const Value& x, const Value& y) {
   std::vector<std::vector<Value>> ret_blocks(m_blocks,
                                              std::vector<Value>(n_blocks));
 
-  for (int64_t r = 0; r < m_blocks; r++) {
-    for (int64_t c = 0; c < n_blocks; c++) {
-      for (int64_t i = 0; i < k_blocks; i++) {
-        auto m_start = r * m_step;
-        auto n_start = c * n_step;
-        auto k_start = i * k_step;
-        auto m_end = std::min(m, m_start + m_step);
-        auto n_end = std::min(n, n_start + n_step);
-        auto k_end = std::min(k, k_start + k_step);
-
-        Value x_block;
-        if (x.shape().size() == 1) {
-          SPU_ENFORCE(m_start == 0 && m_end == 1);
-          x_block = slice(ctx, x, {k_start}, {k_end}, {});
-        } else {
-          x_block = slice(ctx, x, {m_start, k_start}, {m_end, k_end}, {});
-        }
+  // Evaluate output tile (r, c), accumulating over all k blocks.
+  auto mmul_tile = [&](HalContext* sub_ctx, int64_t r, int64_t c) {
+    for (int64_t i = 0; i < k_blocks; i++) {
+      auto m_start = r * m_step;
+      auto n_start = c * n_step;
+      auto k_start = i * k_step;
+      auto m_end = std::min(m, m_start + m_step);
+      auto n_end = std::min(n, n_start + n_step);
+      auto k_end = std::min(k, k_start + k_step);
+
+      Value x_block;
+      if (x.shape().size() == 1) {
+        SPU_ENFORCE(m_start == 0 && m_end == 1);
+        x_block = slice(sub_ctx, x, {k_start}, {k_end}, {});
+      } else {
+        x_block = slice(sub_ctx, x, {m_start, k_start}, {m_end, k_end}, {});
+      }
 
-        Value y_block;
-        if (y.shape().size() == 1) {
-          SPU_ENFORCE(n_start == 0 && n_end == 1);
-          y_block = slice(ctx, y, {k_start}, {k_end}, {});
-        } else {
-          y_block = slice(ctx, y, {k_start, n_start}, {k_end, n_end}, {});
-        }
+      Value y_block;
+      if (y.shape().size() == 1) {
+        SPU_ENFORCE(n_start == 0 && n_end == 1);
+        y_block = slice(sub_ctx, y, {k_start}, {k_end}, {});
+      } else {
+        y_block = slice(sub_ctx, y, {k_start, n_start}, {k_end, n_end}, {});
+      }
 
-        auto mmul_ret = _mmul_impl(ctx, x_block, y_block);
-        if (i == 0) {
-          ret_blocks[r][c] = std::move(mmul_ret);
-        } else {
-          ret_blocks[r][c] = _add(ctx, ret_blocks[r][c], mmul_ret);
-        }
+      auto mmul_ret = _mmul_impl(sub_ctx, x_block, y_block);
+      if (i == 0) {
+        ret_blocks[r][c] = std::move(mmul_ret);
+      } else {
+        ret_blocks[r][c] = _add(sub_ctx, ret_blocks[r][c], mmul_ret);
+      }
+    }
+  };
+
+  const int64_t num_tiles = m_blocks * n_blocks;
+  // Number of tiles in flight, at most `kMmulMaxWorkers` tiles of
+  // `tile_mem_limit` each so the whole matmul stays within the memory budget.
+  const int64_t num_workers =
+      enable_par ? std::min(num_tiles, kMmulMaxWorkers) : 1;
+
+  if (num_workers <= 1) {
+    for (int64_t r = 0; r < m_blocks; r++) {
+      for (int64_t c = 0; c < n_blocks; c++) {
+        mmul_tile(ctx, r, c);
       }
     }
+  } else {
+    // Each worker owns a forked context and evaluates tiles with a static
+    // stride, so all parties run the same tiles over the same sub-link in the
+    // same order. The communication of one worker overlaps with the local
+    // computation of the others.
+    std::vector<std::unique_ptr<HalContext>> sub_ctxs;
+    for (int64_t w = 0; w < num_workers; w++) {
+      sub_ctxs.push_back(ctx->fork());
+    }
+
+    std::vector<std::future<void>> futures;
+    for (int64_t w = 0; w < num_workers; w++) {
+      futures.push_back(std::async(std::launch::async, [&, w] {
+        for (int64_t t = w; t < num_tiles; t += num_workers) {
+          mmul_tile(sub_ctxs[w].get(), t / n_blocks, t % n_blocks);
+        }
+      }));
+    }
+    for (auto& f : futures) {
+      f.get();
+    }
   }
 
   // merge blocks.
@@ -358,11 +428,16 @@ Value _sign(HalContext* ctx, const Value& x) {
   return _sub(ctx, one, _mul(ctx, two, is_negative));
 }
 
-Value _less(HalContext* ctx, const Value& x, const Value& y) {
-  SPU_TRACE_HAL_LEAF(ctx, x, y);
+Value _less(HalContext* ctx, const Value& x, const Value& y,
+            size_t valid_bits) {
+  SPU_TRACE_HAL_LEAF(ctx, x, y, valid_bits);
 
   // test msb(x-y) == 1
-  return _msb(ctx, _sub(ctx, x, y));
+  auto diff = _sub(ctx, x, y);
+  if (valid_bits != 0 && diff.isSecret()) {
+    return _msb_s_with_bits(ctx, diff, valid_bits);
+  }
+  return _msb(ctx, diff);
 }
 
 // swap bits of [start, end)
@@ -46,6 +46,9 @@ Value _mul(HalContext* ctx, const Value& x, const Value& y);
 
 Value _mmul(HalContext* ctx, const Value& x, const Value& y);
 
+// x: [B, M, K], y: [B, K, N] -> [B, M, N], both secret.
+Value _batch_mmul(HalContext* ctx, const Value& x, const Value& y);
+
 Value _conv2d(HalContext* ctx, const Value& x, const Value& y,
               absl::Span<const int64_t> window_strides,
               absl::Span<const int64_t> result_shape);
@@ -63,7 +66,10 @@ Value _msb(HalContext* ctx, const Value& in);
 // Return 1{x == y}
 Value _equal(HalContext* ctx, const Value& x, const Value& y);
 
-Value _less(HalContext* ctx, const Value& x, const Value& y);
+// Return 1{x < y}, valid_bits is the number of signed bits (x - y) is known
+// to fit in, 0 if unknown.
+Value _less(HalContext* ctx, const Value& x, const Value& y,
+            size_t valid_bits = 0);
 
 Value _lshift(HalContext* ctx, const Value& in, size_t bits);
 
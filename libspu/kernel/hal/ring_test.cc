@@ -17,7 +17,9 @@
 #include "gtest/gtest.h"
 #include "xtensor/xarray.hpp"
 
+#include "libspu/core/parallel_utils.h"
 #include "libspu/kernel/hal/test_util.h"
+#include "libspu/mpc/utils/simulate.h"
 
 namespace spu::kernel::hal {
 
@@ -60,4 +62,64 @@ TEST(RingTest, _popcount) {
     EXPECT_EQ(p_ret, expected);
   }
 }
+
+TEST(RingTest, _mmul_tiled) {
+  xt::xarray<int64_t> x = test::xt_random<int64_t>({17, 29});
+  xt::xarray<int64_t> y = test::xt_random<int64_t>({29, 13});
+
+  auto eval = [&](bool par, size_t mem_limit) {
+    RuntimeConfig config;
+    config.set_protocol(ProtocolKind::REF2K);
+    config.set_field(FieldType::FM64);
+    config.set_experimental_enable_intra_op_par(par);
+    config.set_experimental_mmul_mem_limit(mem_limit);
+    auto ctx = test::makeRefHalContext(config);
+
+    auto a = test::makeValue(&ctx, x, VIS_SECRET);
+    auto b = test::makeValue(&ctx, y, VIS_PUBLIC);
+    auto c = _mmul(&ctx, a, b).setDtype(DT_I64);
+    return hal::dump_public_as<int64_t>(&ctx, _s2p(&ctx, c).setDtype(DT_I64));
+  };
+
+  auto expected = eval(false, 0);
+  // force split into tiles, evaluated serially and concurrently.
+  EXPECT_EQ(eval(false, 64 * sizeof(int64_t)), expected);
+  EXPECT_EQ(eval(true, 64 * sizeof(int64_t)), expected);
+}
+
+TEST(RingTest, _mmul_tiled_mixed_hardware) {
+  xt::xarray<int64_t> x = test::xt_random<int64_t>({17, 29});
+  xt::xarray<int64_t> y = test::xt_random<int64_t>({29, 13});
+
+  xt::xarray<int64_t> expected;
+  {
+    auto ctx = test::makeRefHalContext();
+    auto a = test::makeValue(&ctx, x, VIS_PUBLIC);
+    auto b = test::makeValue(&ctx, y, VIS_PUBLIC);
+    expected = hal::dump_public_as<int64_t>(
+        &ctx, _mmul(&ctx, a, b).setDtype(DT_I64));
+  }
+
+  RuntimeConfig config;
+  config.set_protocol(ProtocolKind::SEMI2K);
+  config.set_field(FieldType::FM64);
+  config.set_experimental_enable_intra_op_par(true);
+  config.set_experimental_mmul_mem_limit(64 * sizeof(int64_t));
+
+  mpc::utils::simulate(
+      2, [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+        // the parties must agree on the tiling whatever their core count.
+        setThreadNumberOfProc(lctx->Rank() == 0 ? 1 : 7);
+        HalContext ctx(config, lctx);
+
+        auto a = test::makeValue(&ctx, x, VIS_SECRET);
+        auto b = test::makeValue(&ctx, y, VIS_SECRET);
+        auto c = _mmul(&ctx, a, b).setDtype(DT_I64);
+        auto ret = hal::dump_public_as<int64_t>(
+            &ctx, _s2p(&ctx, c).setDtype(DT_I64));
+        EXPECT_EQ(ret, expected);
+        setThreadNumberOfProc(0);
+      });
+}
+
 }  // namespace spu::kernel::hal
@@ -15,6 +15,8 @@
 #include "libspu/kernel/hlo/basic_binary.h"
 
 #include "libspu/kernel/hal/constants.h"
+#include "libspu/kernel/hal/fxp_base.h"
+#include "libspu/kernel/hal/integer.h"
 #include "libspu/kernel/hal/polymorphic.h"
 #include "libspu/kernel/hal/type_cast.h"
 
@@ -43,8 +45,29 @@ SIMPLE_BINARY_KERNEL_DEFN(NotEqual, hal::not_equal)
 SIMPLE_BINARY_KERNEL_DEFN(LessEqual, hal::less_equal)
 SIMPLE_BINARY_KERNEL_DEFN(GreaterEqual, hal::greater_equal)
 
+SIMPLE_BINARY_KERNEL_DEFN(AddFxp, hal::f_add)
+SIMPLE_BINARY_KERNEL_DEFN(AddInt, hal::i_add)
+SIMPLE_BINARY_KERNEL_DEFN(SubFxp, hal::f_sub)
+SIMPLE_BINARY_KERNEL_DEFN(SubInt, hal::i_sub)
+SIMPLE_BINARY_KERNEL_DEFN(MulFxp, hal::f_mul)
+SIMPLE_BINARY_KERNEL_DEFN(MulInt, hal::i_mul)
+SIMPLE_BINARY_KERNEL_DEFN(MulMixed, hal::mixed_mul)
+
 #undef SIMPLE_BINARY_KERNEL_DEFN
 
+#define COMPARE_KERNEL_DEFN(NAME, HalFcn)                     \
+  spu::Value NAME(HalContext *ctx, const spu::Value &lhs,     \
+                  const spu::Value &rhs, size_t valid_bits) { \
+    return HalFcn(ctx, lhs, rhs, valid_bits);                 \
+  }
+
+COMPARE_KERNEL_DEFN(Less, hal::less)
+COMPARE_KERNEL_DEFN(Greater, hal::greater)
+COMPARE_KERNEL_DEFN(LessEqual, hal::less_equal)
+COMPARE_KERNEL_DEFN(GreaterEqual, hal::greater_equal)
+
+#undef COMPARE_KERNEL_DEFN
+
 spu::Value Remainder(HalContext *ctx, const spu::Value &lhs,
                      const spu::Value &rhs) {
   SPU_ENFORCE(lhs.dtype() == rhs.dtype(), "dtype mismatch {} != {}",
@@ -71,4 +94,12 @@ spu::Value Dot(HalContext *ctx, const spu::Value &lhs, const spu::Value &rhs) {
   return hal::matmul(ctx, lhs, rhs);
 }
 
+spu::Value BatchDot(HalContext *ctx, const spu::Value &lhs,
+                    const spu::Value &rhs) {
+  SPU_ENFORCE(lhs.shape().size() == 3);
+  SPU_ENFORCE(rhs.shape().size() == 3);
+
+  return hal::batch_matmul(ctx, lhs, rhs);
+}
+
 }  // namespace spu::kernel::hlo
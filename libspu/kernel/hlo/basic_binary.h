@@ -44,7 +44,35 @@ SIMPLE_BINARY_KERNEL_DECL(Xor)
 SIMPLE_BINARY_KERNEL_DECL(Div)
 SIMPLE_BINARY_KERNEL_DECL(Remainder)
 SIMPLE_BINARY_KERNEL_DECL(Dot)
+// [B, M, K] x [B, K, N] -> [B, M, N]
+SIMPLE_BINARY_KERNEL_DECL(BatchDot)
+
+// Kernels specialized for statically known operand dtypes, they skip the
+// dtype dispatch and casts of the generic kernels above.
+//   *Fxp:   fxp op fxp
+//   *Int:   int op int of the same dtype
+//   MulMixed: int * fxp or fxp * int, without truncation
+SIMPLE_BINARY_KERNEL_DECL(AddFxp)
+SIMPLE_BINARY_KERNEL_DECL(AddInt)
+SIMPLE_BINARY_KERNEL_DECL(SubFxp)
+SIMPLE_BINARY_KERNEL_DECL(SubInt)
+SIMPLE_BINARY_KERNEL_DECL(MulFxp)
+SIMPLE_BINARY_KERNEL_DECL(MulInt)
+SIMPLE_BINARY_KERNEL_DECL(MulMixed)
 
 #undef SIMPLE_BINARY_KERNEL_DECL
 
+// Integer comparisons with (lhs - rhs) known to fit in valid_bits signed
+// bits, 0 if unknown.
+#define COMPARE_KERNEL_DECL(NAME)                         \
+  spu::Value NAME(HalContext *ctx, const spu::Value &lhs, \
+                  const spu::Value &rhs, size_t valid_bits);
+
+COMPARE_KERNEL_DECL(Less)
+COMPARE_KERNEL_DECL(Greater)
+COMPARE_KERNEL_DECL(LessEqual)
+COMPARE_KERNEL_DECL(GreaterEqual)
+
+#undef COMPARE_KERNEL_DECL
+
 }  // namespace spu::kernel::hlo
@@ -14,9 +14,12 @@
 
 #include "libspu/kernel/hlo/control_flow.h"
 
+#include <map>
+
 #include "libspu/kernel/hal/constants.h"
 #include "libspu/kernel/hal/debug.h"
 #include "libspu/kernel/hal/polymorphic.h"
+#include "libspu/kernel/hal/prot_wrapper.h"
 #include "libspu/kernel/hal/shape_ops.h"
 #include "libspu/kernel/hal/type_cast.h"
 #include "libspu/kernel/hlo/const.h"
@@ -28,6 +31,52 @@
 
 namespace spu::kernel::hlo {
 
+namespace {
+
+// Indices of non-empty values grouped by dtype, values of a group are packed
+// into one flat vector so a single mux covers all of them.
+std::vector<std::vector<size_t>> groupByDtype(
+    absl::Span<const spu::Value> values) {
+  std::vector<std::vector<size_t>> groups;
+  std::map<DataType, size_t> group_index;
+  for (size_t idx = 0; idx < values.size(); ++idx) {
+    if (values[idx].numel() == 0) {
+      continue;
+    }
+    auto [iter, inserted] =
+        group_index.emplace(values[idx].dtype(), groups.size());
+    if (inserted) {
+      groups.emplace_back();
+    }
+    groups[iter->second].push_back(idx);
+  }
+  return groups;
+}
+
+spu::Value pack(HalContext *ctx, absl::Span<const spu::Value> values,
+                const std::vector<size_t> &group) {
+  std::vector<spu::Value> flat;
+  for (auto idx : group) {
+    flat.emplace_back(hal::reshape(ctx, values[idx], {values[idx].numel()}));
+  }
+  return hal::concatenate(ctx, flat, 0);
+}
+
+void unpack(HalContext *ctx, const spu::Value &packed,
+            absl::Span<const spu::Value> like,
+            const std::vector<size_t> &group,
+            std::vector<spu::Value> *results) {
+  int64_t offset = 0;
+  for (auto idx : group) {
+    const int64_t numel = like[idx].numel();
+    auto piece = hal::slice(ctx, packed, {offset}, {offset + numel}, {});
+    (*results)[idx] = hal::reshape(ctx, piece, like[idx].shape());
+    offset += numel;
+  }
+}
+
+}  // namespace
+
 std::vector<spu::Value> IfElse(HalContext *ctx, const spu::Value &condition,
                                const BranchFcnT &on_true,
                                const BranchFcnT &on_false) {
@@ -37,10 +86,14 @@ std::vector<spu::Value> IfElse(HalContext *ctx, const spu::Value &condition,
 
     SPU_ENFORCE(true_ret.size() == false_ret.size());
 
-    std::vector<spu::Value> selected(true_ret.size());
-    for (size_t idx = 0; idx < true_ret.size(); ++idx) {
-      selected[idx] =
-          hal::select(ctx, condition, true_ret[idx], false_ret[idx]);
+    // Outputs of the same dtype are muxed with one select.
+    std::vector<spu::Value> selected(true_ret);
+    for (const auto &group : groupByDtype(true_ret)) {
+      auto t = pack(ctx, true_ret, group);
+      auto f = pack(ctx, false_ret, group);
+      auto pred = hal::broadcast_to(
+          ctx, hal::reshape(ctx, condition, {}), t.shape(), {});
+      unpack(ctx, hal::select(ctx, pred, t, f), true_ret, group, &selected);
     }
 
     return selected;
@@ -70,43 +123,41 @@ std::vector<spu::Value> Case(HalContext *ctx, const spu::Value &index,
     auto normalized_index = hal::select(ctx, p, upper_bound, index);
 
     // create 0,...,N-1
-    auto indices = hlo::Iota(ctx, DT_I32, branches.size());
+    const auto num_branches = static_cast<int64_t>(branches.size());
+    auto indices = hlo::Iota(ctx, DT_I32, num_branches);
     // Build mask
     auto masks =
         hal::equal(ctx, indices,
                    hal::broadcast_to(ctx, normalized_index, indices.shape()));
 
     std::vector<std::vector<spu::Value>> values;
-    for (int64_t branch_id = 0;
-         branch_id < static_cast<int64_t>(branches.size()); ++branch_id) {
-      auto r = branches[branch_id]();
-      // Slice mask
-      auto mask_i = hal::slice(ctx, masks, {branch_id}, {branch_id + 1}, {});
-
-      for (auto &ret : r) {
-        Value mask_i_b;
-        if (ret.numel() == mask_i.numel()) {
-          mask_i_b = hal::reshape(ctx, mask_i, ret.shape());
-        } else {
-          mask_i_b = hal::broadcast_to(ctx, mask_i, ret.shape(), {});
-        }
-
-        ret = hal::mul(ctx, ret, mask_i_b);
-      }
-      values.emplace_back(std::move(r));
+    for (int64_t branch_id = 0; branch_id < num_branches; ++branch_id) {
+      values.emplace_back(branches[branch_id]());
     }
 
-    // Collect results
-    std::vector<spu::Value> results(values.front().size());
-
-    for (int64_t result_id = 0;
-         result_id < static_cast<int64_t>(values.front().size()); ++result_id) {
-      auto r = values.front()[result_id];
-      for (int64_t branch_id = 1;
-           branch_id < static_cast<int64_t>(branches.size()); ++branch_id) {
-        r = hal::add(ctx, r, values[branch_id][result_id]);
+    // Outputs of the same dtype of all branches are masked with one mul, then
+    // summed up locally.
+    std::vector<spu::Value> results(values.front());
+    for (const auto &group : groupByDtype(values.front())) {
+      std::vector<spu::Value> packed;
+      for (const auto &r : values) {
+        packed.emplace_back(pack(ctx, r, group));
+      }
+      const int64_t numel = packed.front().numel();
+
+      auto stacked = hal::concatenate(ctx, packed, 0);
+      auto mask = hal::reshape(
+          ctx, hal::broadcast_to(ctx, masks, {num_branches, numel}, {0}),
+          {num_branches * numel});
+      auto masked = hal::mul(ctx, stacked, mask);
+
+      auto r = hal::slice(ctx, masked, {0}, {numel}, {});
+      for (int64_t branch_id = 1; branch_id < num_branches; ++branch_id) {
+        r = hal::add(ctx, r,
+                     hal::slice(ctx, masked, {branch_id * numel},
+                                {(branch_id + 1) * numel}, {}));
       }
-      results[result_id] = r;
+      unpack(ctx, r, values.front(), group, &results);
     }
     return results;
   }
@@ -140,6 +191,7 @@ std::vector<spu::Value> While(HalContext *ctx,
   while (eval_cond(ret)) {
     // dispatch body
     ret = body(ret);
+    hal::_checkpoint(ctx);
   }
 
   return ret;
@@ -0,0 +1,34 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libspu/kernel/hlo/fused.h"
+
+#include "libspu/kernel/hal/fxp_fused.h"
+
+namespace spu::kernel::hlo {
+
+spu::Value Softmax(HalContext *ctx, const spu::Value &in, int64_t axis) {
+  return hal::f_softmax(ctx, in, axis);
+}
+
+spu::Value LayerNorm(HalContext *ctx, const spu::Value &in, int64_t axis,
+                     double epsilon) {
+  return hal::f_layer_norm(ctx, in, axis, epsilon);
+}
+
+spu::Value Gelu(HalContext *ctx, const spu::Value &in) {
+  return hal::f_gelu(ctx, in);
+}
+
+}  // namespace spu::kernel::hlo
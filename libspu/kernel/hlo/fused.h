@@ -0,0 +1,30 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "libspu/kernel/context.h"
+#include "libspu/kernel/value.h"
+
+namespace spu::kernel::hlo {
+
+// Fused neural-network kernels, see hal/fxp_fused.h for details.
+spu::Value Softmax(HalContext *ctx, const spu::Value &in, int64_t axis);
+
+spu::Value LayerNorm(HalContext *ctx, const spu::Value &in, int64_t axis,
+                     double epsilon);
+
+spu::Value Gelu(HalContext *ctx, const spu::Value &in);
+
+}  // namespace spu::kernel::hlo
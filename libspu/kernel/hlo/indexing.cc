@@ -26,7 +26,6 @@
 #include "libspu/kernel/hlo/basic_unary.h"
 #include "libspu/kernel/hlo/const.h"
 #include "libspu/kernel/hlo/geometrical.h"
-#include "libspu/kernel/hlo/reduce.h"
 #include "libspu/kernel/hlo/utils.h"
 #include "libspu/kernel/value.h"
 
@@ -306,37 +305,9 @@ spu::Value reshapedGatherIndices(spu::HalContext *ctx, int64_t index_vector_dim,
   return spu::kernel::hal::reshape(ctx, start_indices, new_shape);
 }
 
-spu::Value SecretLinearUpdateIndexing(spu::HalContext *ctx,
-                                      const spu::Value &operand,
-                                      const spu::Value &update,
-                                      const spu::Value &linear_idx) {
-  // TODO: Consider utilizing DLP to improve performance
-  SPU_ENFORCE(operand.shape().size() == 1, "operand must be a 1D tensor");
-  SPU_ENFORCE(linear_idx.numel() == 1, "index must be a 1D indexing");
-  SPU_ENFORCE(update.numel() == 1, "update must be a scalar");
-
-  // Basic idea here:
-  // eq(iota, idx) * update + !eq(iota, idx) * operand
-  auto linear_idx_broadcasted =
-      spu::kernel::hlo::Broadcast(ctx, linear_idx, {operand.numel()}, {});
-  spu::Value idx_iota =
-      spu::kernel::hlo::Iota(ctx, spu::DT_I64, operand.numel());
-  auto mask = spu::kernel::hlo::Equal(ctx, linear_idx_broadcasted, idx_iota);
-
-  auto c0 = spu::kernel::hlo::Constant(ctx, static_cast<int64_t>(0), {});
-  auto i0 = spu::kernel::hlo::Cast(ctx, c0, c0.vtype(), operand.dtype());
-
-  auto reverse_mask = spu::kernel::hlo::Not(ctx, mask);
-
-  auto broadcast_update =
-      spu::kernel::hlo::Broadcast(ctx, update, operand.shape(), {0});
-
-  return spu::kernel::hlo::Add(
-      ctx, spu::kernel::hlo::Mul(ctx, operand, reverse_mask),
-      spu::kernel::hlo::Mul(ctx, broadcast_update, mask));
-}
-
-std::vector<spu::Value> ClampAndFlattenIndex(
+// Returns the clamped and flattened start index, and the public offsets of each
+// element of `iterate_shape` relative to the start index.
+std::pair<spu::Value, std::vector<int64_t>> ClampAndFlattenIndex(
     spu::HalContext *ctx, absl::Span<const spu::Value> start_indices,
     absl::Span<const int64_t> iterate_shape,
     absl::Span<const int64_t> limit_shape) {
@@ -400,20 +371,69 @@ std::vector<spu::Value> ClampAndFlattenIndex(
         flatten_idx.emplace_back(spu::flattenIndex(idx, limit_shape));
       });
 
-  auto num_index = spu::calcNumel(iterate_shape);
-  std::vector<spu::Value> linear_indices;
-  linear_indices.reserve(num_index);
-  auto added = spu::kernel::hlo::Add(
-      ctx,
-      spu::kernel::hlo::Broadcast(
-          ctx, spu::kernel::hlo::Reshape(ctx, linear_idx, {1}), {num_index},
-          {0}),
-      spu::kernel::hlo::Constant(ctx, flatten_idx, {num_index}));
-  for (int64_t idx = 0; idx < num_index; ++idx) {
-    linear_indices.emplace_back(spu::kernel::hlo::Reshape(
-        ctx, spu::kernel::hlo::Slice(ctx, added, {idx}, {idx + 1}, {1}), {}));
+  return {linear_idx, flatten_idx};
+}
+
+// Updates the 1D `operand` at secret positions `linear_idx + offsets[j]` with
+// `update[j]`, offsets are distinct.
+//
+// Basic idea here:
+// - mask = eq(iota, linear_idx), the only equality test of the whole update.
+// - mask_j = mask shifted by offsets[j], which is a slice of the zero padded
+//   mask, stacked into an (m x n) matrix.
+// - since all positions are distinct, the masks are disjoint, so
+//   ret = operand - operand * sum_j(mask_j) + update . masks
+//   which costs one mul and one matmul for all updates.
+spu::Value SecretBatchedUpdateIndexing(spu::HalContext *ctx,
+                                       const spu::Value &operand,
+                                       const spu::Value &update,
+                                       const spu::Value &linear_idx,
+                                       absl::Span<const int64_t> offsets) {
+  SPU_ENFORCE(operand.shape().size() == 1, "operand must be a 1D tensor");
+  SPU_ENFORCE(linear_idx.numel() == 1, "index must be a 1D indexing");
+  SPU_ENFORCE(update.numel() == static_cast<int64_t>(offsets.size()),
+              "update and offsets size mismatch");
+
+  const int64_t n = operand.numel();
+  const int64_t m = update.numel();
+
+  auto linear_idx_broadcasted =
+      spu::kernel::hlo::Broadcast(ctx, linear_idx, {n}, {});
+  spu::Value idx_iota = spu::kernel::hlo::Iota(ctx, spu::DT_I64, n);
+  auto mask = spu::kernel::hlo::Equal(ctx, linear_idx_broadcasted, idx_iota);
+  mask = spu::kernel::hal::pad(
+      ctx, mask,
+      spu::kernel::hal::seal(
+          ctx, spu::kernel::hal::constant(ctx, false, mask.dtype())),
+      {n}, {0}, {0});
+
+  std::vector<spu::Value> mask_rows(m);
+  for (int64_t j = 0; j < m; ++j) {
+    SPU_ENFORCE(offsets[j] >= 0 && offsets[j] < n);
+    mask_rows[j] = spu::kernel::hal::reshape(
+        ctx,
+        spu::kernel::hal::slice(ctx, mask, {n - offsets[j]},
+                                {2 * n - offsets[j]}, {1}),
+        {1, n});
   }
-  return linear_indices;
+  auto masks = spu::kernel::hal::concatenate(ctx, mask_rows, 0);
+
+  // written[p] = 1 iff p is updated, a local sum of the disjoint masks.
+  auto ones = spu::kernel::hlo::Constant(ctx, static_cast<int64_t>(1), {1, m});
+  auto written = spu::kernel::hal::reshape(
+      ctx, spu::kernel::hal::matmul(ctx, ones, masks), {n});
+
+  auto scattered = spu::kernel::hal::reshape(
+      ctx,
+      spu::kernel::hal::matmul(
+          ctx, spu::kernel::hal::reshape(ctx, update, {1, m}), masks),
+      {n});
+
+  return spu::kernel::hlo::Add(
+      ctx,
+      spu::kernel::hlo::Sub(ctx, operand,
+                            spu::kernel::hlo::Mul(ctx, operand, written)),
+      scattered);
 }
 
 }  // namespace
@@ -532,17 +552,12 @@ spu::Value DynamicUpdateSlice(HalContext *ctx, const spu::Value &operand,
 
     spu::Value flattened_update = Reshape(ctx, update, {update.numel()});
 
-    auto flattened_indices = ClampAndFlattenIndex(
+    auto [linear_idx, offsets] = ClampAndFlattenIndex(
         ctx, start_indices, update.shape(), operand.shape());
 
-    spu::Value ret = flattened_operand;
-
-    for (int64_t n = 0; n < static_cast<int64_t>(flattened_indices.size());
-         ++n) {
-      auto update_slice = Slice(ctx, flattened_update, {n}, {n + 1}, {1});
-      ret = SecretLinearUpdateIndexing(ctx, ret, update_slice,
-                                       flattened_indices[n]);
-    }
+    auto ret = SecretBatchedUpdateIndexing(ctx, flattened_operand,
+                                           flattened_update, linear_idx,
+                                           offsets);
 
     return Reshape(ctx, ret, operand.shape());
 
@@ -640,38 +655,49 @@ spu::Value SecretDynamicSlice(
     mask = **index_cache_mask;  // NOLINT
   }
 
+  // Stack the shifted masks of all `slice_size[0]` rows into a one-hot matrix,
+  // and fetch all rows with a single matmul instead of a mul and reduce per
+  // row.
+  const int64_t n = operand.shape()[0];
+  std::vector<spu::Value> mask_rows(slice_size[0]);
+  for (int64_t idx = 0; idx < slice_size[0]; ++idx) {
+    auto mask_slice = hal::slice(ctx, mask, {mask.numel() - idx - n},
+                                 {mask.numel() - idx}, {1});
+    mask_rows[idx] = hal::reshape(ctx, mask_slice, {1, n});
+  }
+  auto onehot = hal::concatenate(ctx, mask_rows, 0);
+
+  auto flattened_operand =
+      hal::reshape(ctx, operand, {n, operand.numel() / n});
+  auto gathered = hal::matmul(ctx, onehot, flattened_operand);
+
+  std::vector<int64_t> gathered_shape = operand.shape();
+  gathered_shape[0] = slice_size[0];
+  gathered = hal::reshape(ctx, gathered, gathered_shape);
+
+  if (slice_size.size() == 1) {
+    return gathered;
+  }
+
   // foreach
   std::vector<spu::Value> results(slice_size[0]);
   std::vector<int64_t> reduced_size(slice_size.begin(), slice_size.end());
   reduced_size[0] = 1;
+  std::vector<int64_t> start(gathered_shape.size(), 0);
+  std::vector<int64_t> end = gathered_shape;
+  std::vector<int64_t> strides(gathered_shape.size(), 1);
   for (int64_t idx = 0; idx < slice_size[0]; ++idx) {
-    auto mask_slice =
-        hal::slice(ctx, mask, {mask.numel() - idx - operand.shape()[0]},
-                   {mask.numel() - idx}, {1});
-    mask_slice = hal::reshape(ctx, mask_slice, {mask_slice.numel(), 1});
-    mask_slice = hal::broadcast_to(ctx, mask_slice, operand.shape(), {0});
-
-    auto mul_mask = hal::mul(ctx, operand, mask_slice);
-
-    auto reduced = spu::kernel::hlo::Reduce(
-        ctx, {mul_mask}, {}, {0},
-        [&](absl::Span<const spu::Value> lhs,
-            absl::Span<const spu::Value> rhs) {
-          return std::vector<spu::Value>{
-              spu::kernel::hlo::Add(ctx, lhs[0], rhs[0])};
-        },
-        true)[0];
-    if (slice_size.size() > 1) {
-      reduced = hal::reshape(ctx, reduced,
-                             absl::Span<const int64_t>(reduced.shape().data(),
-                                                       reduced.shape().size())
-                                 .subspan(1));
-      reduced =
-          SecretDynamicSlice(ctx, reduced, slice_size.subspan(1),
-                             start_indices.subspan(1), index_cache_mask + 1);
-      reduced = hal::reshape(ctx, reduced, reduced_size);
-    }
-    results[idx] = reduced;
+    start[0] = idx;
+    end[0] = idx + 1;
+    auto reduced = hal::slice(ctx, gathered, start, end, strides);
+    reduced = hal::reshape(
+        ctx, reduced,
+        absl::Span<const int64_t>(gathered_shape.data(), gathered_shape.size())
+            .subspan(1));
+    reduced =
+        SecretDynamicSlice(ctx, reduced, slice_size.subspan(1),
+                           start_indices.subspan(1), index_cache_mask + 1);
+    results[idx] = hal::reshape(ctx, reduced, reduced_size);
   }
 
   return hal::concatenate(ctx, results, 0);
@@ -129,6 +129,24 @@ TEST(IndexingTest, DynamicUpdateSliceMultiValuesWithSecretIndices) {
   EXPECT_EQ(p_ret, expected);
 }
 
+TEST(IndexingTest, DynamicUpdateSlice2DWithSecretIndices) {
+  HalContext hctx = hal::test::makeRefHalContext();
+  xt::xarray<int64_t> x = {{1, 2, 3}, {4, 5, 6}, {7, 8, 9}};
+  xt::xarray<int64_t> u = {{10, 11}, {12, 13}};
+  auto input = hal::test::makeValue(&hctx, x, VIS_SECRET);
+  auto update = hal::test::makeValue(&hctx, u, VIS_PUBLIC);
+  std::vector<spu::Value> start_indices{
+      Seal(&hctx, Constant(&hctx, static_cast<int64_t>(1), {})),
+      Seal(&hctx, Constant(&hctx, static_cast<int64_t>(5), {}))};
+
+  auto output = DynamicUpdateSlice(&hctx, input, update, start_indices);
+
+  auto p_ret = hal::dump_public_as<int64_t>(&hctx, Reveal(&hctx, output));
+  // second index is clamped to 1.
+  xt::xarray<int64_t> expected = {{1, 2, 3}, {4, 10, 11}, {7, 12, 13}};
+  EXPECT_EQ(p_ret, expected);
+}
+
 TEST(DynamicSliceTest, DynamicSliceWithPublicIndices) {
   HalContext hctx = hal::test::makeRefHalContext();
   xt::xarray<float> x = {{0.05, 0.24, 0.5}, {2, 5, 50}};
@@ -165,6 +183,21 @@ TEST(DynamicSliceTest, DynamicSliceWithSecretIndices) {
       << expected << std::endl;
 }
 
+TEST(DynamicSliceTest, DynamicSliceWithSecretIndices1D) {
+  HalContext hctx = hal::test::makeRefHalContext();
+  xt::xarray<int64_t> x = {1, 2, 3, 4, 5, 6};
+  auto input = hal::test::makeValue(&hctx, x, VIS_PUBLIC);
+
+  auto start_indices = std::vector<spu::Value>{
+      Seal(&hctx, Constant(&hctx, static_cast<int64_t>(2), {}))};
+
+  auto output = DynamicSlice(&hctx, input, {3}, start_indices);
+
+  auto p_ret = hal::dump_public_as<int64_t>(&hctx, Reveal(&hctx, output));
+  xt::xarray<int64_t> expected{3, 4, 5};
+  EXPECT_EQ(p_ret, expected);
+}
+
 TEST(DynamicSliceTest, DynamicSliceWithSecretIndicesFull) {
   HalContext hctx = hal::test::makeRefHalContext();
   xt::xarray<float> x = {{0.05, 0.24, 0.5}, {2, 5, 50}, {7, 9, 10.1}};
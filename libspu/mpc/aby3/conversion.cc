@@ -14,8 +14,11 @@
 
 #include "libspu/mpc/aby3/conversion.h"
 
+#include <algorithm>
 #include <functional>
 
+#include "absl/numeric/bits.h"
+
 #include "libspu/core/parallel_utils.h"
 #include "libspu/core/platform_utils.h"
 #include "libspu/core/trace.h"
@@ -604,4 +607,76 @@ ArrayRef MsbA2B::proc(KernelEvalContext* ctx, const ArrayRef& in) const {
   return xor_bb(obj, rshift_b(obj, xor_bb(obj, m, n), nbits), carry);
 }
 
+ArrayRef MsbA2BWithBits::proc(KernelEvalContext* ctx, const ArrayRef& in,
+                              size_t bits) const {
+  SPU_TRACE_MPC_LEAF(ctx, in, bits);
+
+  const auto field = in.eltype().as<AShrTy>()->field();
+  const auto numel = in.numel();
+  auto* comm = ctx->getState<Communicator>();
+  auto* prg_state = ctx->getState<PrgState>();
+  auto* obj = ctx->caller();
+
+  // carry_out halves the width on each level, round it up to power of 2.
+  const size_t width = std::max<size_t>(absl::bit_ceil(bits), 8);
+  if (width >= SizeOf(field) * 8 || numel == 0) {
+    return msb_a2b(obj, in);
+  }
+
+  // Construct M, N as in MsbA2B, since X = M + N fits in `width` signed
+  // bits, only the lowest `width` bits of M are needed, and
+  //   msb(X) = M[width-1] ^ N[width-1] ^ carry_out(M, N, width-1)
+  // The lowest (width-1) bits are shifted left by one, so the carry out of
+  // the whole `width` bits is the carry we want.
+  const auto lo_backtype = calcBShareBacktype(width);
+  ArrayRef m_lo(makeType<BShrTy>(lo_backtype, width), numel);
+  ArrayRef n_lo(makeType<BShrTy>(lo_backtype, width), numel);
+  ArrayRef m_hi(makeType<BShrTy>(PT_U8, 1), numel);
+  ArrayRef n_hi(makeType<BShrTy>(PT_U8, 1), numel);
+  DISPATCH_ALL_FIELDS(field, "aby3.msb.split", [&]() {
+    using U = ring2k_t;
+    auto _in = ArrayView<std::array<U, 2>>(in);
+
+    DISPATCH_UINT_PT_TYPES(lo_backtype, "_", [&]() {
+      using V = ScalarT;
+      const V mask = static_cast<V>((static_cast<U>(1) << width) - 1);
+
+      std::vector<V> r0(numel);
+      std::vector<V> r1(numel);
+      prg_state->fillPrssPair(absl::MakeSpan(r0), absl::MakeSpan(r1));
+
+      pforeach(0, numel, [&](int64_t idx) {
+        r0[idx] = r0[idx] ^ r1[idx];
+        if (comm->getRank() == 0) {
+          r0[idx] ^= static_cast<V>(_in[idx][0] + _in[idx][1]);
+        }
+        r0[idx] &= mask;
+      });
+
+      r1 = comm->rotate<V>(r0, "m");
+
+      auto _m_lo = ArrayView<std::array<V, 2>>(m_lo);
+      auto _n_lo = ArrayView<std::array<V, 2>>(n_lo);
+      auto _m_hi = ArrayView<std::array<uint8_t, 2>>(m_hi);
+      auto _n_hi = ArrayView<std::array<uint8_t, 2>>(n_hi);
+      auto lo = [&](V v) { return static_cast<V>((v << 1) & mask); };
+      auto hi = [&](V v) {
+        return static_cast<uint8_t>((v >> (width - 1)) & 1);
+      };
+
+      pforeach(0, numel, [&](int64_t idx) {
+        const V n0 = comm->getRank() == 2 ? static_cast<V>(_in[idx][0]) : 0;
+        const V n1 = comm->getRank() == 1 ? static_cast<V>(_in[idx][1]) : 0;
+        _m_lo[idx] = {lo(r0[idx]), lo(r1[idx])};
+        _n_lo[idx] = {lo(n0), lo(n1)};
+        _m_hi[idx] = {hi(r0[idx]), hi(r1[idx])};
+        _n_hi[idx] = {hi(n0), hi(n1)};
+      });
+    });
+  });
+
+  auto carry = carry_out(obj, m_lo, n_lo, width);
+  return xor_bb(obj, xor_bb(obj, m_hi, n_hi), carry);
+}
+
 }  // namespace spu::mpc::aby3
@@ -121,4 +121,23 @@ class MsbA2B : public UnaryKernel {
   ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in) const override;
 };
 
+// Msb of an AShare which is known to fit in `bits` signed bits, both the
+// reshare and the carry circuit only run over the lowest bits.
+class MsbA2BWithBits : public ShiftKernel {
+ public:
+  static constexpr char kBindName[] = "msb_a2b_with_bits";
+
+  Kind kind() const override { return Kind::Dynamic; }
+
+  ce::CExpr latency() const override {
+    // upper bound, same as msb_a2b
+    return Log(ce::K()) + 1 + 1;
+  }
+
+  ce::CExpr comm() const override { return ce::K() * 4; }
+
+  ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in,
+                size_t bits) const override;
+};
+
 }  // namespace spu::mpc::aby3
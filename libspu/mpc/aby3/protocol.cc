@@ -70,6 +70,7 @@ std::unique_ptr<Object> makeAby3Protocol(
 #endif
 
   obj->regKernel<aby3::MsbA2B>();
+  obj->regKernel<aby3::MsbA2BWithBits>();
 
   obj->regKernel<aby3::CommonTypeB>();
   obj->regKernel<aby3::CastTypeB>();
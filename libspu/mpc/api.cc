@@ -71,4 +71,15 @@ SPU_MPC_DEF_MMUL(mmul_pp)
 SPU_MPC_DEF_MMUL(mmul_sp)
 SPU_MPC_DEF_MMUL(mmul_ss)
 
+ArrayRef batch_mmul_ss(Object* ctx, const ArrayRef& x, const ArrayRef& y,
+                       size_t batch, size_t m, size_t n, size_t k) {
+  return ctx->call("batch_mmul_ss", x, y, batch, m, n, k);
+}
+
+void checkpoint(Object* ctx) {
+  if (ctx->hasKernel("checkpoint")) {
+    ctx->call<bool>("checkpoint");
+  }
+}
+
 }  // namespace spu::mpc
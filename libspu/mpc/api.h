@@ -121,6 +121,15 @@ ArrayRef mmul_sp(Object* ctx, const ArrayRef&, const ArrayRef&, size_t, size_t,
 ArrayRef mmul_ss(Object* ctx, const ArrayRef&, const ArrayRef&, size_t, size_t,
                  size_t);
 
+// `batch` independent (m, k) x (k, n) matmuls.
+ArrayRef batch_mmul_ss(Object* ctx, const ArrayRef&, const ArrayRef&,
+                       size_t batch, size_t m, size_t n, size_t k);
+
+// A synchronization point of the program, i.e. loop boundaries. Protocols may
+// finish deferred work here, e.g. malicious protocols verify the macs of the
+// values opened so far. No-op for protocols which do not care.
+void checkpoint(Object* ctx);
+
 }  // namespace spu::mpc
 
 #define SPU_MPC_DEF_UNARY_OP(NAME)                 \
@@ -13,10 +13,18 @@
 // limitations under the License.
 #include "libspu/mpc/cheetah/arith/cheetah_dot.h"
 
+#include <algorithm>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string_view>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
 
 #include "absl/types/span.h"
+#include "fmt/format.h"
 #include "seal/batchencoder.h"
 #include "seal/context.h"
 #include "seal/decryptor.h"
@@ -41,19 +49,245 @@
 
 namespace spu::mpc::cheetah {
 
+namespace {
+
+// Encoded operands in NTT form, keyed by the buffer they are encoded from.
+//
+// The buffer may be modified in place or freed and reallocated at the same
+// address, so an entry also keeps a weak reference to the buffer and a
+// fingerprint of its content (the version of the buffer). Only operands seen
+// twice are cached, the fresh buffers of activations never take room.
+class OperandCache {
+ public:
+  using Polys = std::shared_ptr<const std::vector<RLWEPt>>;
+
+  explicit OperandCache(size_t capacity) : capacity_(capacity) {}
+
+  // `tag` tells apart the encodings of the same buffer, e.g. as lhs or rhs.
+  Polys GetOrEncode(const ArrayRef &operand, const std::string &tag,
+                    const std::function<std::vector<RLWEPt>()> &encode) {
+    if (capacity_ == 0 || !operand.isCompact() || operand.buf() == nullptr) {
+      return std::make_shared<const std::vector<RLWEPt>>(encode());
+    }
+
+    Key key{operand.buf().get(), operand.offset(), operand.numel(), tag};
+    const size_t version = Fingerprint(operand);
+    {
+      std::lock_guard<std::mutex> guard(lock_);
+      auto itr = entries_.find(key);
+      if (itr != entries_.end()) {
+        if (itr->second.buf.lock() == operand.buf() &&
+            itr->second.version == version) {
+          ++stats_.hits;
+          lru_.splice(lru_.end(), lru_, itr->second.lru_pos);
+          return itr->second.polys;
+        }
+        Erase(itr);
+      }
+      ++stats_.misses;
+    }
+
+    auto polys = std::make_shared<const std::vector<RLWEPt>>(encode());
+
+    std::lock_guard<std::mutex> guard(lock_);
+    auto seen = seen_.find(key);
+    if (seen == seen_.end() || seen->second != version) {
+      // Forget old sightings from time to time.
+      if (seen_.size() >= kMaxSeen) {
+        seen_.clear();
+      }
+      seen_[key] = version;
+      return polys;
+    }
+    seen_.erase(seen);
+
+    const int64_t bytes = NumBytes(*polys);
+    if (static_cast<size_t>(bytes) > capacity_ ||
+        entries_.find(key) != entries_.end()) {
+      return polys;
+    }
+    while (stats_.bytes + bytes > static_cast<int64_t>(capacity_)) {
+      Erase(entries_.find(lru_.front()));
+    }
+    lru_.push_back(key);
+    entries_.emplace(key, Entry{operand.buf(), version, polys,
+                                std::prev(lru_.end()), bytes});
+    stats_.bytes += bytes;
+    return polys;
+  }
+
+  CheetahDot::CacheStats GetStats() const {
+    std::lock_guard<std::mutex> guard(lock_);
+    return stats_;
+  }
+
+ private:
+  static constexpr size_t kMaxSeen = 1024;
+
+  struct Key {
+    const void *buf;
+    int64_t offset;
+    int64_t numel;
+    std::string tag;
+
+    bool operator<(const Key &other) const {
+      return std::tie(buf, offset, numel, tag) <
+             std::tie(other.buf, other.offset, other.numel, other.tag);
+    }
+  };
+
+  struct Entry {
+    std::weak_ptr<yacl::Buffer> buf;
+    size_t version;
+    Polys polys;
+    std::list<Key>::iterator lru_pos;
+    int64_t bytes;
+  };
+
+  static size_t Fingerprint(const ArrayRef &operand) {
+    return std::hash<std::string_view>()(
+        std::string_view(static_cast<const char *>(operand.data()),
+                         operand.numel() * operand.elsize()));
+  }
+
+  static int64_t NumBytes(const std::vector<RLWEPt> &polys) {
+    int64_t bytes = 0;
+    for (const auto &pt : polys) {
+      bytes += pt.coeff_count() * sizeof(uint64_t);
+    }
+    return bytes;
+  }
+
+  void Erase(std::map<Key, Entry>::iterator itr) {
+    stats_.bytes -= itr->second.bytes;
+    lru_.erase(itr->second.lru_pos);
+    entries_.erase(itr);
+  }
+
+  const size_t capacity_;
+
+  mutable std::mutex lock_;
+  std::map<Key, Entry> entries_;
+  // Least recently used first.
+  std::list<Key> lru_;
+  std::map<Key, size_t> seen_;
+  CheetahDot::CacheStats stats_;
+};
+
+// Number of products of a batch computed as one packed product. Cheetah
+// spends whole polynomials on a product however small it is, so `g` small
+// products are packed as one (g*m, k, g*n) product whose diagonal blocks are
+// the wanted results. The g^2 - g off diagonal blocks are wasted, thus only
+// packs with g^2*m*k*n <= N are considered, and the one with the fewest
+// ciphertexts wins. Depends on public sizes only, the same on both sides.
+int64_t DotPackSize(const MatMatProtocol &matmat, const Shape3D &dim3,
+                    int64_t batch, size_t poly_degree) {
+  auto num_ct = [&](int64_t g) {
+    MatMatProtocol::Meta meta;
+    meta.dims = {g * dim3[0], dim3[1], g * dim3[2]};
+    auto subshape = matmat.GetSubMatShape(meta);
+    const size_t lhs_n = matmat.GetLeftSize(meta, subshape);
+    const size_t rhs_n = matmat.GetRightSize(meta, subshape);
+    const size_t out_n = matmat.GetOutSize(meta, subshape);
+    // The smaller side is encrypted and sent, the results come back.
+    return CeilDiv<size_t>(batch, g) * (std::min(lhs_n, rhs_n) + out_n);
+  };
+
+  const int64_t mkn = dim3[0] * dim3[1] * dim3[2];
+  int64_t best = 1;
+  size_t best_ct = num_ct(1);
+  for (int64_t g = 2;
+       g <= batch && g * g * mkn <= static_cast<int64_t>(poly_degree); ++g) {
+    const size_t ct = num_ct(g);
+    if (ct < best_ct) {
+      best = g;
+      best_ct = ct;
+    }
+  }
+  return best;
+}
+
+// Operand of the `pack`-th packed product, lhs of `group` products are
+// stacked vertically (g*m x k), rhs horizontally (k x g*n). Products past
+// the batch are zero.
+ArrayRef PackDotOperand(const ArrayRef &mats, const Shape3D &dim3,
+                        int64_t batch, int64_t group, int64_t pack,
+                        bool is_lhs) {
+  const int64_t rows = is_lhs ? dim3[0] : dim3[1];
+  const int64_t cols = is_lhs ? dim3[1] : dim3[2];
+  const int64_t numel = rows * cols;
+  const int64_t first = pack * group;
+  const int64_t count = std::min(group, batch - first);
+  if (group == 1 || (is_lhs && count == group)) {
+    // Row major matrices one after the other are stacked already.
+    return mats.slice(first * numel, (first + group) * numel);
+  }
+
+  const auto field = mats.eltype().as<Ring2k>()->field();
+  ArrayRef packed = ring_zeros(field, group * numel);
+  DISPATCH_ALL_FIELDS(field, "PackDotOperand", [&]() {
+    ArrayView<const ring2k_t> src(mats);
+    ArrayView<ring2k_t> dst(packed);
+    pforeach(0, count * rows, [&](int64_t gr) {
+      const int64_t g = gr / rows;
+      const int64_t r = gr % rows;
+      const int64_t src_row = (first + g) * numel + r * cols;
+      const int64_t dst_row =
+          is_lhs ? (g * rows + r) * cols : r * group * cols + g * cols;
+      for (int64_t c = 0; c < cols; ++c) {
+        dst[dst_row + c] = src[src_row + c];
+      }
+    });
+  });
+  return packed;
+}
+
+// Diagonal blocks of the packed (g*m x g*n) results.
+ArrayRef UnpackDotResult(const ArrayRef &packed, const Shape3D &dim3,
+                         int64_t batch, int64_t group) {
+  if (group == 1) {
+    return packed;
+  }
+  const int64_t m = dim3[0];
+  const int64_t n = dim3[2];
+  const int64_t pack_numel = group * m * group * n;
+  const auto field = packed.eltype().as<Ring2k>()->field();
+  ArrayRef ret = ring_zeros(field, batch * m * n);
+  DISPATCH_ALL_FIELDS(field, "UnpackDotResult", [&]() {
+    ArrayView<const ring2k_t> src(packed);
+    ArrayView<ring2k_t> dst(ret);
+    pforeach(0, batch * m, [&](int64_t bi) {
+      const int64_t b = bi / m;
+      const int64_t i = bi % m;
+      const int64_t g = b % group;
+      const int64_t src_row =
+          (b / group) * pack_numel + (g * m + i) * group * n + g * n;
+      for (int64_t l = 0; l < n; ++l) {
+        dst[bi * n + l] = src[src_row + l];
+      }
+    });
+  });
+  return ret;
+}
+
+}  // namespace
+
 struct CheetahDot::Impl : public EnableCPRNG {
  public:
   const bool kUseModDownOptimization = true;
   static constexpr size_t kParallelStride = 1;
   static constexpr size_t kCtAsyncParallel = 8;
 
-  explicit Impl(std::shared_ptr<yacl::link::Context> lctx)
-      : lctx_(std::move(lctx)) {}
+  Impl(std::shared_ptr<yacl::link::Context> lctx,
+       std::shared_ptr<OperandCache> operand_cache)
+      : lctx_(std::move(lctx)), operand_cache_(std::move(operand_cache)) {}
 
   ~Impl() = default;
 
   std::unique_ptr<Impl> Fork();
 
+  CacheStats GetCacheStats() const { return operand_cache_->GetStats(); }
+
   struct Conv2DMeta {
     Conv2DProtocol::Meta prot_meta;
     bool is_tensor;
@@ -62,9 +296,16 @@ struct CheetahDot::Impl : public EnableCPRNG {
     size_t n_output_poly;
   };
 
-  // Compute C = A*B where |A|=dims[0]xdims[1], |B|=dims[1]xdims[2
-  ArrayRef DotOLE(const ArrayRef &prv, yacl::link::Context *conn,
-                  const Shape3D &dim3, bool is_lhs);
+  // Compute C[i] = A[i]*B[i] for i in [0, batch) where
+  // |A[i]|=dims[0]xdims[1], |B[i]|=dims[1]xdims[2]
+  ArrayRef BatchDotOLE(const ArrayRef &prv, yacl::link::Context *conn,
+                       const Shape3D &dim3, int64_t batch, bool is_lhs);
+
+  ArrayRef parseBatchedDotResult(FieldType field,
+                                 const MatMatProtocol::Meta &meta,
+                                 const MatMatProtocol &matmat, int64_t batch,
+                                 absl::Span<const RLWEPt> polys,
+                                 const ModulusSwitchHelper &ms_helper);
 
   ArrayRef Conv2dOLE(const ArrayRef &inp, yacl::link::Context *conn,
                      int64_t input_batch, const Shape3D &tensor_shape,
@@ -237,6 +478,8 @@ struct CheetahDot::Impl : public EnableCPRNG {
  private:
   std::shared_ptr<yacl::link::Context> lctx_;
 
+  std::shared_ptr<OperandCache> operand_cache_;
+
   mutable std::shared_mutex context_lock_;
   // field_bitlen -> functor mapping
   std::unordered_map<size_t, std::shared_ptr<seal::SEALContext>> seal_cntxts_;
@@ -251,7 +494,7 @@ struct CheetahDot::Impl : public EnableCPRNG {
 };
 
 std::unique_ptr<CheetahDot::Impl> CheetahDot::Impl::Fork() {
-  auto f = std::make_unique<Impl>(lctx_->Spawn());
+  auto f = std::make_unique<Impl>(lctx_->Spawn(), operand_cache_);
   if (seal_cntxts_.size() == 0) return f;
   std::unique_lock<std::shared_mutex> guard(context_lock_);
 
@@ -330,9 +573,10 @@ void CheetahDot::Impl::LazyInit(size_t field_bitlen) {
               field_bitlen);
 }
 
-ArrayRef CheetahDot::Impl::DotOLE(const ArrayRef &prv_mat,
-                                  yacl::link::Context *conn,
-                                  const Shape3D &dim3, bool is_lhs) {
+ArrayRef CheetahDot::Impl::BatchDotOLE(const ArrayRef &prv_mat,
+                                       yacl::link::Context *conn,
+                                       const Shape3D &dim3, int64_t batch,
+                                       bool is_lhs) {
   if (conn == nullptr) {
     conn = lctx_.get();
   }
@@ -340,12 +584,10 @@ ArrayRef CheetahDot::Impl::DotOLE(const ArrayRef &prv_mat,
   auto eltype = prv_mat.eltype();
   SPU_ENFORCE(eltype.isa<RingTy>(), "must be ring_type, got={}", eltype);
   SPU_ENFORCE(prv_mat.numel() > 0);
+  SPU_ENFORCE(batch > 0);
 
-  if (is_lhs) {
-    SPU_ENFORCE_EQ(prv_mat.numel(), dim3[0] * dim3[1]);
-  } else {
-    SPU_ENFORCE_EQ(prv_mat.numel(), dim3[1] * dim3[2]);
-  }
+  const int64_t mat_numel = is_lhs ? dim3[0] * dim3[1] : dim3[1] * dim3[2];
+  SPU_ENFORCE_EQ(prv_mat.numel(), batch * mat_numel);
 
   auto field = eltype.as<Ring2k>()->field();
   const size_t field_bitlen = FieldBitLen(field);
@@ -359,8 +601,13 @@ ArrayRef CheetahDot::Impl::DotOLE(const ArrayRef &prv_mat,
   seal::Evaluator evaluator(this_context);
 
   MatMatProtocol matmat(this_context, *this_ecd_ms, /*mont*/ true);
+  const int64_t group = DotPackSize(
+      matmat, dim3, batch,
+      this_context.key_context_data()->parms().poly_modulus_degree());
+  // Number of packed products.
+  const int64_t num_packs = CeilDiv<int64_t>(batch, group);
   MatMatProtocol::Meta meta;
-  meta.dims = dim3;
+  meta.dims = {group * dim3[0], dim3[1], group * dim3[2]};
   auto subshape = matmat.GetSubMatShape(meta);
   size_t lhs_n = matmat.GetLeftSize(meta, subshape);
   size_t rhs_n = matmat.GetRightSize(meta, subshape);
@@ -368,37 +615,68 @@ ArrayRef CheetahDot::Impl::DotOLE(const ArrayRef &prv_mat,
   bool to_encrypt_lhs = lhs_n < rhs_n;
   bool need_encrypt = (is_lhs ^ to_encrypt_lhs) == 0;
 
-  std::vector<RLWEPt> encoded_mat(is_lhs ? lhs_n : rhs_n);
-  if (is_lhs) {
-    matmat.EncodeLHS(prv_mat, meta, need_encrypt, absl::MakeSpan(encoded_mat));
-  } else {
-    matmat.EncodeRHS(prv_mat, meta, need_encrypt, absl::MakeSpan(encoded_mat));
-  }
+  // Polynomials of the packed products are laid out one after the other,
+  // all of them go in one exchange.
+  const size_t prv_n = is_lhs ? lhs_n : rhs_n;
+  const size_t peer_n = is_lhs ? rhs_n : lhs_n;
+  auto encode = [&]() {
+    std::vector<RLWEPt> encoded(num_packs * prv_n);
+    yacl::parallel_for(
+        0, num_packs, kParallelStride, [&](size_t bgn, size_t end) {
+          for (size_t b = bgn; b < end; ++b) {
+            auto mat = PackDotOperand(prv_mat, dim3, batch, group, b, is_lhs);
+            absl::Span<RLWEPt> out(encoded.data() + b * prv_n, prv_n);
+            if (is_lhs) {
+              matmat.EncodeLHS(mat, meta, need_encrypt, out);
+            } else {
+              matmat.EncodeRHS(mat, meta, need_encrypt, out);
+            }
+          }
+        });
 
-  // convert local poly to NTT form to perform encryption / multiplication.
-  yacl::parallel_for(0, encoded_mat.size(), kParallelStride,
-                     [&](size_t bgn, size_t end) {
-                       for (size_t i = bgn; i < end; ++i) {
-                         NttInplace(encoded_mat[i], this_context);
-                         if (not need_encrypt) {
-                           matmat.Montgomerize({&encoded_mat[i], 1});
+    // convert local poly to NTT form to perform encryption / multiplication.
+    yacl::parallel_for(0, encoded.size(), kParallelStride,
+                       [&](size_t bgn, size_t end) {
+                         for (size_t i = bgn; i < end; ++i) {
+                           NttInplace(encoded[i], this_context);
+                           if (not need_encrypt) {
+                             matmat.Montgomerize({&encoded[i], 1});
+                           }
                          }
-                       }
-                     });
-
+                       });
+    return encoded;
+  };
+  const auto encoded_ptr = operand_cache_->GetOrEncode(
+      prv_mat,
+      fmt::format("dot:{}:{}:{}:{}:{}:{}", field_bitlen, dim3[0], dim3[1],
+                  dim3[2], batch, is_lhs),
+      encode);
+  const auto &encoded_mat = *encoded_ptr;
+
+  const size_t total_out_n = num_packs * out_n;
   if (need_encrypt) {
     // send ct
-    for (size_t i = 0; i < encoded_mat.size(); ++i) {
-      auto ct = this_encryptor->encrypt_symmetric(encoded_mat[i]).obj();
-      auto ct_s = EncodeSEALObject(ct);
-      conn->SendAsync(nxt_rank, ct_s, "send encrypted mat");
+    std::vector<yacl::Buffer> ct_to_send(kCtAsyncParallel);
+    for (size_t i = 0; i < encoded_mat.size(); i += kCtAsyncParallel) {
+      size_t this_batch = std::min(encoded_mat.size() - i, kCtAsyncParallel);
+      yacl::parallel_for(
+          0, this_batch, kParallelStride, [&](size_t bgn, size_t end) {
+            for (size_t k = bgn; k < end; ++k) {
+              auto ct =
+                  this_encryptor->encrypt_symmetric(encoded_mat[i + k]).obj();
+              ct_to_send[k] = EncodeSEALObject(ct);
+            }
+          });
+      for (size_t k = 0; k < this_batch; ++k) {
+        conn->SendAsync(nxt_rank, ct_to_send[k], "send encrypted mat");
+      }
     }
 
     // wait for result
     std::vector<RLWECt> recv_ct(kCtAsyncParallel);
-    std::vector<RLWEPt> result_poly(out_n);
-    for (size_t i = 0; i < out_n; i += kCtAsyncParallel) {
-      size_t this_batch = std::min(out_n - i, kCtAsyncParallel);
+    std::vector<RLWEPt> result_poly(total_out_n);
+    for (size_t i = 0; i < total_out_n; i += kCtAsyncParallel) {
+      size_t this_batch = std::min(total_out_n - i, kCtAsyncParallel);
       for (size_t j = 0; j < this_batch; ++j) {
         auto ct_s = conn->Recv(nxt_rank, "recv result mat");
         DecodeSEALObject(ct_s, this_context, &recv_ct[j]);
@@ -416,41 +694,50 @@ ArrayRef CheetahDot::Impl::DotOLE(const ArrayRef &prv_mat,
     }
 
     // non-ntt form for ParseResult
-    yacl::parallel_for(0, out_n, kParallelStride, [&](size_t bgn, size_t end) {
-      for (size_t i = bgn; i < end; ++i) {
-        InvNttInplace(result_poly[i], this_context);
-      }
-    });
+    yacl::parallel_for(0, total_out_n, kParallelStride,
+                       [&](size_t bgn, size_t end) {
+                         for (size_t i = bgn; i < end; ++i) {
+                           InvNttInplace(result_poly[i], this_context);
+                         }
+                       });
 
-    auto ret = matmat.ParseResult(field, meta, absl::MakeSpan(result_poly),
-                                  *this_dcd_ms);
-    return ret;
+    return UnpackDotResult(
+        parseBatchedDotResult(field, meta, matmat, num_packs,
+                              absl::MakeSpan(result_poly), *this_dcd_ms),
+        dim3, batch, group);
   }
 
   // recv ct from peer
-  std::vector<RLWECt> encrypted_mat(is_lhs ? rhs_n : lhs_n);
+  std::vector<RLWECt> encrypted_mat(num_packs * peer_n);
   for (size_t i = 0; i < encrypted_mat.size(); ++i) {
     auto ct_s = conn->Recv(nxt_rank, "recv encrypted mat");
     DecodeSEALObject(ct_s, this_context, &encrypted_mat[i]);
   }
 
-  std::vector<RLWECt> result_ct(out_n);
-  if (is_lhs) {
-    matmat.Compute(encoded_mat, encrypted_mat, meta, absl::MakeSpan(result_ct));
-  } else {
-    matmat.Compute(encrypted_mat, encoded_mat, meta, absl::MakeSpan(result_ct));
+  std::vector<RLWECt> result_ct(total_out_n);
+  for (int64_t b = 0; b < num_packs; ++b) {
+    absl::Span<const RLWEPt> pt(encoded_mat.data() + b * prv_n, prv_n);
+    absl::Span<const RLWECt> ct(encrypted_mat.data() + b * peer_n, peer_n);
+    absl::Span<RLWECt> out(result_ct.data() + b * out_n, out_n);
+    if (is_lhs) {
+      matmat.Compute(pt, ct, meta, out);
+    } else {
+      matmat.Compute(ct, pt, meta, out);
+    }
   }
 
   const auto &this_pk = peer_pub_keys_.find(field_bitlen)->second;
 
-  std::vector<RLWEPt> mask_mat(out_n);
+  std::vector<RLWEPt> mask_mat(total_out_n);
   H2A(absl::MakeSpan(result_ct), absl::MakeSpan(mask_mat),
       this_dcd_ms->coeff_modulus_size(), *this_pk, this_context);
-  matmat.ExtractLWEsInplace(meta, absl::MakeSpan(result_ct));
+  for (int64_t b = 0; b < num_packs; ++b) {
+    matmat.ExtractLWEsInplace(meta, {result_ct.data() + b * out_n, out_n});
+  }
 
-  for (size_t i = 0; i < out_n; i += kCtAsyncParallel) {
+  for (size_t i = 0; i < total_out_n; i += kCtAsyncParallel) {
     // NOTE(juhou): we do not send too much ct with Async
-    size_t this_batch = std::min(out_n - i, kCtAsyncParallel);
+    size_t this_batch = std::min(total_out_n - i, kCtAsyncParallel);
     auto ct_s = EncodeSEALObject(result_ct[i]);
     conn->Send(nxt_rank, ct_s, "send result mat");
 
@@ -460,8 +747,32 @@ ArrayRef CheetahDot::Impl::DotOLE(const ArrayRef &prv_mat,
     }
   }
 
-  return matmat.ParseResult(field, meta, absl::MakeSpan(mask_mat),
-                            *this_dcd_ms);
+  return UnpackDotResult(
+      parseBatchedDotResult(field, meta, matmat, num_packs,
+                            absl::MakeSpan(mask_mat), *this_dcd_ms),
+      dim3, batch, group);
+}
+
+ArrayRef CheetahDot::Impl::parseBatchedDotResult(
+    FieldType field, const MatMatProtocol::Meta &meta,
+    const MatMatProtocol &matmat, int64_t batch,
+    absl::Span<const RLWEPt> polys, const ModulusSwitchHelper &ms_helper) {
+  const size_t out_n = polys.size() / batch;
+  if (batch == 1) {
+    return matmat.ParseResult(field, meta, polys, ms_helper);
+  }
+
+  const int64_t out_numel = meta.dims[0] * meta.dims[2];
+  ArrayRef ret = ring_zeros(field, batch * out_numel);
+  yacl::parallel_for(0, batch, kParallelStride, [&](size_t bgn, size_t end) {
+    for (size_t b = bgn; b < end; ++b) {
+      auto slice = matmat.ParseResult(
+          field, meta, polys.subspan(b * out_n, out_n), ms_helper);
+      std::memcpy(&ret.at(b * out_numel), &slice.at(0),
+                  slice.numel() * slice.elsize());
+    }
+  });
+  return ret;
 }
 
 void CheetahDot::Impl::encodeBatchInput(const ArrayRef &batch_inp,
@@ -586,7 +897,7 @@ ArrayRef CheetahDot::Impl::doConv2dOLEForEncryptor(
             for (size_t k = bgn; k < end; ++k) {
               auto ct =
                   this_encryptor->encrypt_symmetric(poly_ntt[i + k]).obj();
-              ct_to_send[bgn] = EncodeSEALObject(ct);
+              ct_to_send[k] = EncodeSEALObject(ct);
             }
           });
 
@@ -671,24 +982,36 @@ ArrayRef CheetahDot::Impl::Conv2dOLE(
 
   bool to_encrypt_tensor = meta.n_tensor_poly < meta.n_kernel_poly;
   bool need_encrypt = !(is_tensor ^ to_encrypt_tensor);
-  std::vector<RLWEPt> encoded_poly;
-  if (is_tensor) {
-    encoded_poly.resize(meta.n_tensor_poly);
-    encodeBatchInput(inp, meta, conv2d, need_encrypt,
-                     absl::MakeSpan(encoded_poly));
-  } else {
-    encoded_poly.resize(meta.n_kernel_poly);
-    conv2d.EncodeKernels(inp, meta.prot_meta, need_encrypt,
-                         absl::MakeSpan(encoded_poly));
-  }
+  auto encode = [&]() {
+    std::vector<RLWEPt> encoded;
+    if (is_tensor) {
+      encoded.resize(meta.n_tensor_poly);
+      encodeBatchInput(inp, meta, conv2d, need_encrypt,
+                       absl::MakeSpan(encoded));
+    } else {
+      encoded.resize(meta.n_kernel_poly);
+      conv2d.EncodeKernels(inp, meta.prot_meta, need_encrypt,
+                           absl::MakeSpan(encoded));
+    }
 
-  // convert local poly to NTT form to perform multiplication.
-  yacl::parallel_for(0, encoded_poly.size(), kParallelStride,
-                     [&](size_t bgn, size_t end) {
-                       for (size_t i = bgn; i < end; ++i) {
-                         NttInplace(encoded_poly[i], this_context);
-                       }
-                     });
+    // convert local poly to NTT form to perform multiplication.
+    yacl::parallel_for(0, encoded.size(), kParallelStride,
+                       [&](size_t bgn, size_t end) {
+                         for (size_t i = bgn; i < end; ++i) {
+                           NttInplace(encoded[i], this_context);
+                         }
+                       });
+    return encoded;
+  };
+  const auto encoded_ptr = operand_cache_->GetOrEncode(
+      inp,
+      fmt::format("conv2d:{}:{}:{}:{}:{}:{}:{}:{}:{}:{}:{}:{}", field_bitlen,
+                  input_batch, tensor_shape[0], tensor_shape[1],
+                  tensor_shape[2], num_kernels, kernel_shape[0],
+                  kernel_shape[1], kernel_shape[2], window_strides[0],
+                  window_strides[1], is_tensor),
+      encode);
+  const auto &encoded_poly = *encoded_ptr;
   if (need_encrypt) {
     return doConv2dOLEForEncryptor(field, encoded_poly, meta, conv2d, conn);
   }
@@ -732,14 +1055,21 @@ ArrayRef CheetahDot::Impl::parseBatchedConv2dResult(
   return ret;
 }
 
-CheetahDot::CheetahDot(std::shared_ptr<yacl::link::Context> lctx) {
-  impl_ = std::make_unique<Impl>(lctx);
+CheetahDot::CheetahDot(std::shared_ptr<yacl::link::Context> lctx,
+                       size_t cache_size) {
+  impl_ = std::make_unique<Impl>(lctx,
+                                 std::make_shared<OperandCache>(cache_size));
 }
 
 CheetahDot::~CheetahDot() = default;
 
 CheetahDot::CheetahDot(std::unique_ptr<Impl> impl) : impl_(std::move(impl)) {}
 
+CheetahDot::CacheStats CheetahDot::GetCacheStats() const {
+  SPU_ENFORCE(impl_ != nullptr);
+  return impl_->GetCacheStats();
+}
+
 std::unique_ptr<CheetahDot> CheetahDot::Fork() {
   auto ptr = new CheetahDot(impl_->Fork());
   return std::unique_ptr<CheetahDot>(ptr);
@@ -749,13 +1079,28 @@ ArrayRef CheetahDot::DotOLE(const ArrayRef &inp, yacl::link::Context *conn,
                             const Shape3D &dim3, bool is_lhs) {
   SPU_ENFORCE(impl_ != nullptr);
   SPU_ENFORCE(conn != nullptr);
-  return impl_->DotOLE(inp, conn, dim3, is_lhs);
+  return impl_->BatchDotOLE(inp, conn, dim3, 1, is_lhs);
 }
 
 ArrayRef CheetahDot::DotOLE(const ArrayRef &inp, const Shape3D &dim3,
                             bool is_lhs) {
   SPU_ENFORCE(impl_ != nullptr);
-  return impl_->DotOLE(inp, nullptr, dim3, is_lhs);
+  return impl_->BatchDotOLE(inp, nullptr, dim3, 1, is_lhs);
+}
+
+ArrayRef CheetahDot::BatchDotOLE(const ArrayRef &inp,
+                                 yacl::link::Context *conn,
+                                 const Shape3D &dim3, int64_t batch,
+                                 bool is_lhs) {
+  SPU_ENFORCE(impl_ != nullptr);
+  SPU_ENFORCE(conn != nullptr);
+  return impl_->BatchDotOLE(inp, conn, dim3, batch, is_lhs);
+}
+
+ArrayRef CheetahDot::BatchDotOLE(const ArrayRef &inp, const Shape3D &dim3,
+                                 int64_t batch, bool is_lhs) {
+  SPU_ENFORCE(impl_ != nullptr);
+  return impl_->BatchDotOLE(inp, nullptr, dim3, batch, is_lhs);
 }
 
 ArrayRef CheetahDot::Conv2dOLE(const ArrayRef &inp, yacl::link::Context *conn,
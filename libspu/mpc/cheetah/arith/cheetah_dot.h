@@ -29,7 +29,11 @@ namespace spu::mpc::cheetah {
 //  https://eprint.iacr.org/2022/207.pdf
 class CheetahDot {
  public:
-  explicit CheetahDot(std::shared_ptr<yacl::link::Context> lctx);
+  // Encoded operands are cached up to `cache_size` bytes and reused when the
+  // same unmodified buffer is multiplied again, e.g. the shares of model
+  // weights. 0 disables the cache.
+  explicit CheetahDot(std::shared_ptr<yacl::link::Context> lctx,
+                      size_t cache_size = 0);
 
   ~CheetahDot();
 
@@ -47,6 +51,15 @@ class CheetahDot {
   ArrayRef DotOLE(const ArrayRef& inp, const Shape3D& dim3,
                   bool is_left_hand_side);
 
+  // `batch` independent products of the same shape in one exchange, `inp`
+  // holds the matrices one after the other.
+  ArrayRef BatchDotOLE(const ArrayRef& inp, yacl::link::Context* conn,
+                       const Shape3D& dim3, int64_t batch,
+                       bool is_left_hand_side);
+
+  ArrayRef BatchDotOLE(const ArrayRef& inp, const Shape3D& dim3,
+                       int64_t batch, bool is_left_hand_side);
+
   ArrayRef Conv2dOLE(const ArrayRef& inp, yacl::link::Context* conn,
                      int64_t num_input, const Shape3D& tensor_shape,
                      int64_t num_kernels, const Shape3D& kernel_shape,
@@ -59,6 +72,16 @@ class CheetahDot {
 
   std::shared_ptr<yacl::link::Context> GetLink() const { return lctx_; }
 
+  struct CacheStats {
+    int64_t hits = 0;
+    int64_t misses = 0;
+    // Bytes of the cached polynomials.
+    int64_t bytes = 0;
+  };
+
+  // Shared with the forks.
+  CacheStats GetCacheStats() const;
+
  private:
   struct Impl;
 
@@ -76,6 +76,119 @@ TEST_P(CheetahDotTest, Basic) {
   }
 }
 
+TEST_P(CheetahDotTest, Batch) {
+  size_t kWorldSize = 2;
+  auto field = std::get<0>(GetParam());
+  auto dim3 = std::get<1>(GetParam());
+  if (dim3[0] * dim3[1] * dim3[2] > 100000) {
+    // keep the test fast
+    return;
+  }
+  const int64_t batch = 3;
+
+  std::vector<ArrayRef> mat(kWorldSize);
+  mat[0] = ring_rand(field, batch * dim3[0] * dim3[1]);
+  mat[1] = ring_rand(field, batch * dim3[1] * dim3[2]);
+
+  std::vector<ArrayRef> result(kWorldSize);
+  utils::simulate(kWorldSize, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    int rank = lctx->Rank();
+    auto dot = std::make_shared<CheetahDot>(lctx);
+    result[rank] = dot->BatchDotOLE(mat[rank], dim3, batch, rank == 0);
+  });
+
+  auto computed = ring_add(result[0], result[1]);
+  const int64_t lhs_numel = dim3[0] * dim3[1];
+  const int64_t rhs_numel = dim3[1] * dim3[2];
+  const int64_t out_numel = dim3[0] * dim3[2];
+  ASSERT_EQ(computed.numel(), batch * out_numel);
+
+  const int64_t kMaxDiff = 1;
+  for (int64_t b = 0; b < batch; ++b) {
+    auto expected = ring_mmul(
+        mat[0].slice(b * lhs_numel, (b + 1) * lhs_numel),
+        mat[1].slice(b * rhs_numel, (b + 1) * rhs_numel), dim3[0], dim3[2],
+        dim3[1]);
+    auto slice = computed.slice(b * out_numel, (b + 1) * out_numel);
+    DISPATCH_ALL_FIELDS(field, "_", [&]() {
+      auto e = ArrayView<ring2k_t>(expected);
+      auto c = ArrayView<ring2k_t>(slice);
+      for (auto idx = 0; idx < expected.numel(); idx++) {
+        EXPECT_NEAR(e[idx], c[idx], kMaxDiff);
+      }
+    });
+  }
+}
+
+class CheetahDotPackTest : public ::testing::TestWithParam<FieldType> {};
+
+INSTANTIATE_TEST_SUITE_P(
+    Cheetah, CheetahDotPackTest,
+    testing::Values(FieldType::FM32, FieldType::FM64, FieldType::FM128),
+    [](const testing::TestParamInfo<CheetahDotPackTest::ParamType>& p) {
+      return fmt::format("{}", p.param);
+    });
+
+// Small products of a batch share polynomials.
+TEST_P(CheetahDotPackTest, Batch) {
+  size_t kWorldSize = 2;
+  auto field = GetParam();
+  const Shape3D dim3 = {4, 5, 3};
+  // Not a multiple of any pack size but itself, the last pack is padded
+  // whenever smaller packs are picked.
+  const int64_t batch = 7;
+  const int64_t lhs_numel = dim3[0] * dim3[1];
+  const int64_t rhs_numel = dim3[1] * dim3[2];
+  const int64_t out_numel = dim3[0] * dim3[2];
+
+  std::vector<ArrayRef> mat(kWorldSize);
+  mat[0] = ring_rand(field, batch * lhs_numel);
+  mat[1] = ring_rand(field, batch * rhs_numel);
+
+  std::vector<ArrayRef> result(kWorldSize);
+  std::vector<size_t> single_bytes(kWorldSize);
+  std::vector<size_t> batch_bytes(kWorldSize);
+  utils::simulate(kWorldSize, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    int rank = lctx->Rank();
+    const int64_t numel = rank == 0 ? lhs_numel : rhs_numel;
+    auto dot = std::make_shared<CheetahDot>(lctx);
+    // Sets up the keys as well.
+    dot->DotOLE(mat[rank].slice(0, numel), dim3, rank == 0);
+
+    size_t sent = lctx->GetStats()->sent_bytes;
+    dot->DotOLE(mat[rank].slice(0, numel), dim3, rank == 0);
+    single_bytes[rank] = lctx->GetStats()->sent_bytes - sent;
+
+    sent = lctx->GetStats()->sent_bytes;
+    result[rank] = dot->BatchDotOLE(mat[rank], dim3, batch, rank == 0);
+    batch_bytes[rank] = lctx->GetStats()->sent_bytes - sent;
+  });
+
+  // One product at a time would send `batch` times the ciphertexts, the
+  // packed results keep more coefficients than a single one though.
+  for (size_t rank = 0; rank < kWorldSize; ++rank) {
+    EXPECT_LT(2 * batch_bytes[rank], batch * single_bytes[rank]);
+  }
+
+  auto computed = ring_add(result[0], result[1]);
+  ASSERT_EQ(computed.numel(), batch * out_numel);
+  const int64_t kMaxDiff = 1;
+  for (int64_t b = 0; b < batch; ++b) {
+    auto expected = ring_mmul(
+        mat[0].slice(b * lhs_numel, (b + 1) * lhs_numel),
+        mat[1].slice(b * rhs_numel, (b + 1) * rhs_numel), dim3[0], dim3[2],
+        dim3[1]);
+    auto slice = computed.slice(b * out_numel, (b + 1) * out_numel);
+    DISPATCH_ALL_FIELDS(field, "_", [&]() {
+      auto e = ArrayView<ring2k_t>(expected);
+      auto c = ArrayView<ring2k_t>(slice);
+      for (auto idx = 0; idx < expected.numel(); idx++) {
+        EXPECT_NEAR(e[idx], c[idx], kMaxDiff);
+      }
+    });
+  }
+}
+
 TEST_P(CheetahDotTest, Fork) {
   size_t kWorldSize = 2;
   auto field = std::get<0>(GetParam());
@@ -124,4 +237,62 @@ TEST_P(CheetahDotTest, Fork) {
   });
 }
 
+TEST_P(CheetahDotTest, Cache) {
+  size_t kWorldSize = 2;
+  auto field = std::get<0>(GetParam());
+  auto dim3 = std::get<1>(GetParam());
+  if (dim3[0] * dim3[1] * dim3[2] > 100000) {
+    // keep the test fast
+    return;
+  }
+
+  // The rhs plays the fixed weights, the lhs is fresh in every round. The
+  // rhs is modified in place before the last round.
+  const int kRounds = 4;
+  auto rhs = ring_rand(field, dim3[1] * dim3[2]);
+  std::vector<ArrayRef> rhs_used = {rhs.clone(),
+                                    ring_rand(field, dim3[1] * dim3[2])};
+  std::vector<ArrayRef> lhs(kRounds + 1);
+  for (auto& l : lhs) {
+    l = ring_rand(field, dim3[0] * dim3[1]);
+  }
+
+  std::vector<std::vector<ArrayRef>> result(kRounds + 1,
+                                            std::vector<ArrayRef>(kWorldSize));
+  std::vector<CheetahDot::CacheStats> stats(kWorldSize);
+  utils::simulate(kWorldSize, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    int rank = lctx->Rank();
+    auto dot = std::make_shared<CheetahDot>(lctx, 1UL << 30);
+    for (int round = 0; round <= kRounds; ++round) {
+      if (round == kRounds && rank == 1) {
+        std::memcpy(rhs.data(), rhs_used[1].data(),
+                    rhs.numel() * rhs.elsize());
+      }
+      result[round][rank] =
+          dot->DotOLE(rank == 0 ? lhs[round] : rhs, dim3, rank == 0);
+    }
+    stats[rank] = dot->GetCacheStats();
+  });
+
+  const int64_t kMaxDiff = 1;
+  for (int round = 0; round <= kRounds; ++round) {
+    const auto& weights = rhs_used[round == kRounds ? 1 : 0];
+    auto expected = ring_mmul(lhs[round], weights, dim3[0], dim3[2], dim3[1]);
+    auto computed = ring_add(result[round][0], result[round][1]);
+    DISPATCH_ALL_FIELDS(field, "_", [&]() {
+      auto e = ArrayView<ring2k_t>(expected);
+      auto c = ArrayView<ring2k_t>(computed);
+      for (auto idx = 0; idx < expected.numel(); idx++) {
+        EXPECT_NEAR(e[idx], c[idx], kMaxDiff);
+      }
+    });
+  }
+
+  // Cached after the second round, the modified rhs is encoded again.
+  EXPECT_EQ(stats[1].hits, kRounds - 2);
+  EXPECT_EQ(stats[1].misses, 3);
+  // Fresh operands never hit.
+  EXPECT_EQ(stats[0].hits, 0);
+}
+
 }  // namespace spu::mpc::cheetah
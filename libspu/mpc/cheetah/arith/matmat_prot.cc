@@ -22,6 +22,7 @@
 #include "spdlog/spdlog.h"
 #include "yacl/utils/parallel.h"
 
+#include "libspu/core/parallel_utils.h"
 #include "libspu/core/shape_util.h"  //calcNumel
 #include "libspu/mpc/cheetah/arith/vector_encoder.h"
 #include "libspu/mpc/cheetah/rlwe/utils.h"
@@ -260,28 +261,31 @@ void MatMatProtocol::EncodeMatrix(const ArrayRef& mat, const Meta& meta,
   Shape2D submat_shape = {subshape[R], subshape[C]};
 
   Indexer indexer(subshape);
-  std::array<int64_t, 2> extents;
-  for (int64_t rb = 0; rb < num_row_blocks; ++rb) {
-    int64_t row_start = rb * subshape[R];
-    int64_t row_end = std::min(meta.dims[R], row_start + subshape[R]);
-    extents[0] = row_end - row_start;
-    for (int64_t cb = 0; cb < num_col_blocks; ++cb) {
-      int64_t col_start = cb * subshape[C];
-      int64_t col_end = std::min(meta.dims[C], col_start + subshape[C]);
-      extents[1] = col_end - col_start;
-
-      auto flatten =
-          ConcatSubMatrix<Indexer>(mat, mat_shape, {row_start, col_start},
-                                   extents, submat_shape, poly_deg_, indexer);
-
-      vencoder_->Forward(flatten, &out[rb * num_col_blocks + cb], need_encrypt);
-    }
-  }
+  yacl::parallel_for(
+      0, num_row_blocks * num_col_blocks, 1, [&](int64_t bgn, int64_t end) {
+        std::array<int64_t, 2> extents;
+        for (int64_t blk = bgn; blk < end; ++blk) {
+          int64_t rb = blk / num_col_blocks;
+          int64_t cb = blk % num_col_blocks;
+          int64_t row_start = rb * subshape[R];
+          int64_t row_end = std::min(meta.dims[R], row_start + subshape[R]);
+          extents[0] = row_end - row_start;
+          int64_t col_start = cb * subshape[C];
+          int64_t col_end = std::min(meta.dims[C], col_start + subshape[C]);
+          extents[1] = col_end - col_start;
+
+          auto flatten = ConcatSubMatrix<Indexer>(
+              mat, mat_shape, {row_start, col_start}, extents, submat_shape,
+              poly_deg_, indexer);
+
+          vencoder_->Forward(flatten, &out[blk], need_encrypt);
+        }
+      });
 }
 
 template <>
-void MatMatProtocol::FusedMulAddInplace(RLWECt& acc, const RLWECt& lhs,
-                                        const RLWEPt& rhs) const {
+size_t MatMatProtocol::InitAccum(RLWECt& acc, const RLWECt& lhs,
+                                 const RLWEPt& rhs) const {
   SPU_ENFORCE(lhs.parms_id() == rhs.parms_id());
   auto cntxt_data = context_.get_context_data(lhs.parms_id());
   SPU_ENFORCE(cntxt_data != nullptr);
@@ -294,50 +298,18 @@ void MatMatProtocol::FusedMulAddInplace(RLWECt& acc, const RLWECt& lhs,
     SPU_ENFORCE(acc.parms_id() == lhs.parms_id());
     SPU_ENFORCE(acc.is_ntt_form() && lhs.is_ntt_form());
   }
-
-  auto parms = cntxt_data->parms();
-  size_t coeff_count = parms.poly_modulus_degree();
-  const auto& modulus = parms.coeff_modulus();
-
-  for (size_t k = 0; k < lhs.size(); ++k) {
-    using namespace seal::util;
-    const auto* op0 = lhs.data(k);
-    const auto* op1 = rhs.data();
-    auto* dst = acc.data(k);
-    for (size_t j = 0; j < modulus.size(); ++j) {
-      if (use_montgomery_fma_) {
-        const uint64_t prime = modulus[j].value();
-        const uint64_t prime_inv = montgomery_precond_.at(j);
-        const uint64_t tbl[2]{prime, 0};
-
-        unsigned long long wide[2], H;
-        for (size_t i = 0; i < coeff_count; ++i) {
-          multiply_uint64(*op0++, *op1++, wide);
-          uint64_t R = wide[0] * prime_inv;
-          multiply_uint64_hw64(R, prime, &H);
-          uint64_t r = static_cast<uint64_t>(wide[1] - H) + prime;
-          r -= tbl[r < prime];
-          r += *dst;
-          *dst++ = (r - tbl[r < prime]);
-        }
-      } else {
-        for (size_t i = 0; i < coeff_count; ++i, ++dst) {
-          *dst = multiply_add_uint_mod(*op0++, *op1++, *dst, modulus[j]);
-        }
-      }
-    }
-  }
+  return lhs.size() * cntxt_data->parms().coeff_modulus().size();
 }
 
 template <>
-void MatMatProtocol::FusedMulAddInplace(RLWECt& acc, const RLWEPt& lhs,
-                                        const RLWECt& rhs) const {
-  FusedMulAddInplace<RLWECt, RLWECt, RLWEPt>(acc, rhs, lhs);
+size_t MatMatProtocol::InitAccum(RLWECt& acc, const RLWEPt& lhs,
+                                 const RLWECt& rhs) const {
+  return InitAccum<RLWECt, RLWECt, RLWEPt>(acc, rhs, lhs);
 }
 
 template <>
-void MatMatProtocol::FusedMulAddInplace(RLWEPt& acc, const RLWEPt& lhs,
-                                        const RLWEPt& rhs) const {
+size_t MatMatProtocol::InitAccum(RLWEPt& acc, const RLWEPt& lhs,
+                                 const RLWEPt& rhs) const {
   SPU_ENFORCE(lhs.parms_id() == rhs.parms_id());
   SPU_ENFORCE(lhs.coeff_count() == rhs.coeff_count());
   auto cntxt = context_.get_context_data(lhs.parms_id());
@@ -349,16 +321,71 @@ void MatMatProtocol::FusedMulAddInplace(RLWEPt& acc, const RLWEPt& lhs,
     acc.resize(lhs.coeff_count());
     acc.parms_id() = lhs.parms_id();
   }
+  return cntxt->parms().coeff_modulus().size();
+}
+
+template <>
+void MatMatProtocol::FusedMulAddInplace(RLWECt& acc, const RLWECt& lhs,
+                                        const RLWEPt& rhs, size_t limb_bgn,
+                                        size_t limb_end) const {
+  auto cntxt_data = context_.get_context_data(lhs.parms_id());
+  auto parms = cntxt_data->parms();
+  size_t coeff_count = parms.poly_modulus_degree();
+  const auto& modulus = parms.coeff_modulus();
+
+  // The limbs of the k-th polynomial are [k * L, (k + 1) * L).
+  for (size_t limb = limb_bgn; limb < limb_end; ++limb) {
+    using namespace seal::util;
+    const size_t k = limb / modulus.size();
+    const size_t j = limb % modulus.size();
+    const auto* op0 = lhs.data(k) + j * coeff_count;
+    const auto* op1 = rhs.data() + j * coeff_count;
+    auto* dst = acc.data(k) + j * coeff_count;
+    if (use_montgomery_fma_) {
+      const uint64_t prime = modulus[j].value();
+      const uint64_t prime_inv = montgomery_precond_.at(j);
+      const uint64_t tbl[2]{prime, 0};
+
+      unsigned long long wide[2], H;
+      for (size_t i = 0; i < coeff_count; ++i) {
+        multiply_uint64(*op0++, *op1++, wide);
+        uint64_t R = wide[0] * prime_inv;
+        multiply_uint64_hw64(R, prime, &H);
+        uint64_t r = static_cast<uint64_t>(wide[1] - H) + prime;
+        r -= tbl[r < prime];
+        r += *dst;
+        *dst++ = (r - tbl[r < prime]);
+      }
+    } else {
+      for (size_t i = 0; i < coeff_count; ++i, ++dst) {
+        *dst = multiply_add_uint_mod(*op0++, *op1++, *dst, modulus[j]);
+      }
+    }
+  }
+}
 
+template <>
+void MatMatProtocol::FusedMulAddInplace(RLWECt& acc, const RLWEPt& lhs,
+                                        const RLWECt& rhs, size_t limb_bgn,
+                                        size_t limb_end) const {
+  FusedMulAddInplace<RLWECt, RLWECt, RLWEPt>(acc, rhs, lhs, limb_bgn,
+                                             limb_end);
+}
+
+template <>
+void MatMatProtocol::FusedMulAddInplace(RLWEPt& acc, const RLWEPt& lhs,
+                                        const RLWEPt& rhs, size_t limb_bgn,
+                                        size_t limb_end) const {
+  auto cntxt = context_.get_context_data(lhs.parms_id());
   size_t coeff_count = cntxt->parms().poly_modulus_degree();
   const auto& modulus = cntxt->parms().coeff_modulus();
-  const auto* op0 = lhs.data();
-  const auto* op1 = rhs.data();
-  auto* dst = acc.data();
-  for (const auto& prime : modulus) {
+  for (size_t j = limb_bgn; j < limb_end; ++j) {
     using namespace seal::util;
+    const auto* op0 = lhs.data() + j * coeff_count;
+    const auto* op1 = rhs.data() + j * coeff_count;
+    auto* dst = acc.data() + j * coeff_count;
     for (size_t i = 0; i < coeff_count; ++i, ++dst) {
-      *dst = multiply_add_uint_mod(*op0++, *op1++, *dst, prime);
+      *dst = multiply_add_uint_mod(*op0++, *op1++, *dst, modulus[j]);
     }
   }
 }
@@ -399,37 +426,40 @@ ArrayRef MatMatProtocol::ParseResult(
 
   ArrayRef matmat = ring_zeros(field, meta.dims[0] * meta.dims[2]);
 
-  for (int64_t rb = 0; rb < out_blks[0]; ++rb) {
-    const auto* this_ans = ans_poly.data() + rb * out_blks[1];
-    int64_t row_start = rb * subdims[0];
-    int64_t row_end = std::min(row_start + subdims[0], meta.dims[0]);
-    int64_t row_ext = row_end - row_start;
-
-    for (int64_t cb = 0; cb < out_blks[1]; ++cb) {
-      int64_t col_start = cb * subdims[2];
-      int64_t col_end = std::min(col_start + subdims[2], meta.dims[2]);
-      int64_t col_ext = col_end - col_start;
-
-      size_t num_modulus = this_ans[cb].coeff_count() / poly_deg_;
-      std::vector<uint64_t> subset(target_coeffs.size() * num_modulus);
-      TakeCoefficientsFromPoly(this_ans[cb], poly_deg_, num_modulus,
-                               absl::MakeSpan(target_coeffs),
-                               absl::MakeSpan(subset));
-
-      auto result_poly =
-          ms_helper.ModulusDownRNS(field, absl::MakeSpan(subset));
-
-      for (int64_t r = 0; r < row_ext; ++r) {
-        for (int64_t c = 0; c < col_ext; ++c) {
-          int64_t dst_idx = (r + row_start) * meta.dims[2] + col_start + c;
+  // Output blocks write to disjoint parts of the result.
+  yacl::parallel_for(
+      0, out_blks[0] * out_blks[1], 1, [&](int64_t bgn, int64_t end) {
+        for (int64_t blk = bgn; blk < end; ++blk) {
+          int64_t rb = blk / out_blks[1];
+          int64_t cb = blk % out_blks[1];
+          int64_t row_start = rb * subdims[0];
+          int64_t row_end = std::min(row_start + subdims[0], meta.dims[0]);
+          int64_t row_ext = row_end - row_start;
+          int64_t col_start = cb * subdims[2];
+          int64_t col_end = std::min(col_start + subdims[2], meta.dims[2]);
+          int64_t col_ext = col_end - col_start;
+
+          size_t num_modulus = ans_poly[blk].coeff_count() / poly_deg_;
+          std::vector<uint64_t> subset(target_coeffs.size() * num_modulus);
+          TakeCoefficientsFromPoly(ans_poly[blk], poly_deg_, num_modulus,
+                                   absl::MakeSpan(target_coeffs),
+                                   absl::MakeSpan(subset));
+
+          auto result_poly =
+              ms_helper.ModulusDownRNS(field, absl::MakeSpan(subset));
+
           DISPATCH_ALL_FIELDS(field, "", [&]() {
-            matmat.at<ring2k_t>(dst_idx) =
-                result_poly.at<ring2k_t>(r * subdims[2] + c);
+            for (int64_t r = 0; r < row_ext; ++r) {
+              for (int64_t c = 0; c < col_ext; ++c) {
+                int64_t dst_idx =
+                    (r + row_start) * meta.dims[2] + col_start + c;
+                matmat.at<ring2k_t>(dst_idx) =
+                    result_poly.at<ring2k_t>(r * subdims[2] + c);
+              }
+            }
           });
         }
-      }
-    }
-  }
+      });
 
   return matmat;
 }
@@ -455,35 +485,36 @@ void MatMatProtocol::ExtractLWEsInplace(const Meta& meta,
   }
 
   seal::Evaluator evaluator(context_);
-  for (int64_t rb = 0; rb < out_blks[0]; ++rb) {
-    auto* this_ans = out.data() + rb * out_blks[1];
-    int64_t row_start = rb * subdims[0];
-    int64_t row_end = std::min(row_start + subdims[0], meta.dims[0]);
-    int64_t row_ext = row_end - row_start;
-
-    for (int64_t cb = 0; cb < out_blks[1]; ++cb) {
-      int64_t col_start = cb * subdims[2];
-      int64_t col_end = std::min(col_start + subdims[2], meta.dims[2]);
-      int64_t col_ext = col_end - col_start;
-
-      if (this_ans[cb].is_ntt_form()) {
-        evaluator.transform_from_ntt_inplace(this_ans[cb]);
-      }
+  yacl::parallel_for(
+      0, out_blks[0] * out_blks[1], 1, [&](int64_t bgn, int64_t end) {
+        for (int64_t blk = bgn; blk < end; ++blk) {
+          int64_t rb = blk / out_blks[1];
+          int64_t cb = blk % out_blks[1];
+          int64_t row_start = rb * subdims[0];
+          int64_t row_end = std::min(row_start + subdims[0], meta.dims[0]);
+          int64_t row_ext = row_end - row_start;
+          int64_t col_start = cb * subdims[2];
+          int64_t col_end = std::min(col_start + subdims[2], meta.dims[2]);
+          int64_t col_ext = col_end - col_start;
+
+          if (out[blk].is_ntt_form()) {
+            evaluator.transform_from_ntt_inplace(out[blk]);
+          }
 
-      if (row_ext == subdims[0] && col_ext == subdims[2]) {
-        KeepCoefficientsInplace(this_ans[cb], to_keep);
-      } else {
-        // margin cases
-        std::set<size_t> to_keep_on_margin;
-        for (int64_t r = 0; r < row_ext; ++r) {
-          for (int64_t c = 0; c < col_ext; ++c) {
-            to_keep_on_margin.insert(ans_indexer(r, c));
+          if (row_ext == subdims[0] && col_ext == subdims[2]) {
+            KeepCoefficientsInplace(out[blk], to_keep);
+          } else {
+            // margin cases
+            std::set<size_t> to_keep_on_margin;
+            for (int64_t r = 0; r < row_ext; ++r) {
+              for (int64_t c = 0; c < col_ext; ++c) {
+                to_keep_on_margin.insert(ans_indexer(r, c));
+              }
+            }
+            KeepCoefficientsInplace(out[blk], to_keep_on_margin);
           }
         }
-        KeepCoefficientsInplace(this_ans[cb], to_keep_on_margin);
-      }
-    }
-  }
+      });
 }
 
 template <typename LHS, typename RHS, typename O>
@@ -503,38 +534,41 @@ void MatMatProtocol::DoCompute(absl::Span<const LHS> lhs,
     dims[d] = CeilDiv(meta.dims[d], subshape[d]);
   }
 
-  constexpr int kMinLoopDim2 = 4;
-  if (dims[2] < kMinLoopDim2) {
-    // k, i, j
-    for (int64_t k = 0; k < dims[2]; ++k) {
-      yacl::parallel_for(0, dims[0], 1, [&](size_t bgn, size_t end) {
-        for (size_t i = bgn; i < end; ++i) {
-          auto lhs_row = lhs.data() + i * dims[1];
-          auto out_row = out.data() + i * dims[2];
-          yacl::parallel_for(0, dims[1], 1, [&](size_t bgn, size_t end) {
-            for (size_t j = bgn; j < end; ++j) {
-              auto rhs_row = rhs.data() + j * dims[2];
-              FusedMulAddInplace<O, LHS, RHS>(out_row[k], lhs_row[j],
-                                              rhs_row[k]);
-            }
-          });
-        }
-      });
-    }
-  } else {
-    // i, k, j
-    for (int64_t i = 0; i < dims[0]; ++i) {
-      auto lhs_row = lhs.data() + i * dims[1];
-      auto out_row = out.data() + i * dims[2];
-      yacl::parallel_for(0, dims[2], 1, [&](size_t bgn, size_t end) {
-        for (size_t k = bgn; k < end; ++k) {
-          for (int64_t j = 0; j < dims[1]; ++j) {
-            auto rhs_row = rhs.data() + j * dims[2];
-            FusedMulAddInplace<O, LHS, RHS>(out_row[k], lhs_row[j], rhs_row[k]);
-          }
+  // Output tiles are independent, each one accumulates over dims[1].
+  const int64_t num_out = dims[0] * dims[2];
+  const int64_t nproc = std::max(getNumberOfProc(), 1);
+  if (num_out >= nproc) {
+    yacl::parallel_for(0, num_out, 1, [&](int64_t bgn, int64_t end) {
+      for (int64_t t = bgn; t < end; ++t) {
+        const int64_t i = t / dims[2];
+        const int64_t k = t % dims[2];
+        for (int64_t j = 0; j < dims[1]; ++j) {
+          const auto& x = lhs[i * dims[1] + j];
+          const auto& y = rhs[j * dims[2] + k];
+          size_t num_limbs = InitAccum<O, LHS, RHS>(out[t], x, y);
+          FusedMulAddInplace<O, LHS, RHS>(out[t], x, y, 0, num_limbs);
         }
-      });
+      }
+    });
+    return;
+  }
+
+  // Too few tiles to keep the threads busy, the RNS limbs of a tile are
+  // independent as well.
+  for (int64_t t = 0; t < num_out; ++t) {
+    const int64_t i = t / dims[2];
+    const int64_t k = t % dims[2];
+    size_t num_limbs = 0;
+    for (int64_t j = 0; j < dims[1]; ++j) {
+      num_limbs = InitAccum<O, LHS, RHS>(out[t], lhs[i * dims[1] + j],
+                                         rhs[j * dims[2] + k]);
     }
+    yacl::parallel_for(0, num_limbs, 1, [&](size_t bgn, size_t end) {
+      for (int64_t j = 0; j < dims[1]; ++j) {
+        FusedMulAddInplace<O, LHS, RHS>(out[t], lhs[i * dims[1] + j],
+                                        rhs[j * dims[2] + k], bgn, end);
+      }
+    });
   }
 }
 
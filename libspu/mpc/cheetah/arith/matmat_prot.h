@@ -96,9 +96,15 @@ class MatMatProtocol {
   void DoCompute(absl::Span<const LHS> lhs, absl::Span<const RHS> rhs,
                  const Meta& meta, absl::Span<O> out) const;
 
-  // accum += x * y
+  // Allocates `accum` for x * y if it is empty. Returns the number of RNS
+  // limbs of `accum`, over all polynomials of a ciphertext.
   template <class T0, class T1, class T2>
-  void FusedMulAddInplace(T0& accum, const T1& x, const T2& y) const;
+  size_t InitAccum(T0& accum, const T1& x, const T2& y) const;
+
+  // accum += x * y on the RNS limbs [limb_bgn, limb_end) of `accum`.
+  template <class T0, class T1, class T2>
+  void FusedMulAddInplace(T0& accum, const T1& x, const T2& y,
+                          size_t limb_bgn, size_t limb_end) const;
 
   bool IsValidSubShape(const Shape3D& shape) const;
 
@@ -37,12 +37,8 @@ ArrayRef TruncAWithSign::proc(KernelEvalContext* ctx, const ArrayRef& x,
   auto* comm = ctx->getState<Communicator>();
   auto* ot_state = ctx->getState<CheetahOTState>();
   size_t n = x.numel();
-  size_t nworker =
-      std::min(ot_state->parallel_size(), CeilDiv(n, kMinWorkSize));
+  size_t nworker = ot_state->LazyInitWorkers(comm, n, kMinWorkSize);
   size_t work_load = nworker == 0 ? 0 : CeilDiv(n, nworker);
-  for (size_t w = 0; w < nworker; ++w) {
-    ot_state->LazyInit(comm, w);
-  }
 
   ArrayRef out(x.eltype(), n);
   TruncateProtocol::Meta meta;
@@ -73,12 +69,8 @@ ArrayRef TruncA::proc(KernelEvalContext* ctx, const ArrayRef& x,
   auto* comm = ctx->getState<Communicator>();
   auto* ot_state = ctx->getState<CheetahOTState>();
   size_t n = x.numel();
-  size_t nworker =
-      std::min(ot_state->parallel_size(), CeilDiv(n, kMinWorkSize));
+  size_t nworker = ot_state->LazyInitWorkers(comm, n, kMinWorkSize);
   size_t work_load = nworker == 0 ? 0 : CeilDiv(n, nworker);
-  for (size_t w = 0; w < nworker; ++w) {
-    ot_state->LazyInit(comm, w);
-  }
 
   ArrayRef out(x.eltype(), n);
   TruncateProtocol::Meta meta;
@@ -108,12 +100,8 @@ ArrayRef MsbA2B::proc(KernelEvalContext* ctx, const ArrayRef& x) const {
   auto* comm = ctx->getState<Communicator>();
   auto* ot_state = ctx->getState<CheetahOTState>();
   size_t n = x.numel();
-  size_t nworker =
-      std::min(ot_state->parallel_size(), CeilDiv(n, kMinWorkSize));
+  size_t nworker = ot_state->LazyInitWorkers(comm, n, kMinWorkSize);
   size_t work_load = nworker == 0 ? 0 : CeilDiv(n, nworker);
-  for (size_t w = 0; w < nworker; ++w) {
-    ot_state->LazyInit(comm, w);
-  }
 
   // Math:
   //  msb(x0 + x1 mod 2^k) = msb(x0) ^ msb(x1) ^ 1{(x0 + x1) > 2^{k-1} - 1}
@@ -186,12 +174,8 @@ ArrayRef EqualAA::proc(KernelEvalContext* ctx, const ArrayRef& x,
   auto* comm = ctx->getState<Communicator>();
   auto* ot_state = ctx->getState<CheetahOTState>();
   size_t n = x.numel();
-  size_t nworker =
-      std::min(ot_state->parallel_size(), CeilDiv(n, kMinWorkSize));
+  size_t nworker = ot_state->LazyInitWorkers(comm, n, kMinWorkSize);
   size_t work_load = nworker == 0 ? 0 : CeilDiv(n, nworker);
-  for (size_t w = 0; w < nworker; ++w) {
-    ot_state->LazyInit(comm, w);
-  }
 
   const auto field = ctx->getState<Z2kState>()->getDefaultField();
   const int rank = comm->getRank();
@@ -233,14 +217,9 @@ ArrayRef MulA1B::proc(KernelEvalContext* ctx, const ArrayRef& x,
   auto* comm = ctx->getState<Communicator>();
   auto* ot_state = ctx->getState<CheetahOTState>();
   size_t n = x.numel();
-  size_t nworker =
-      std::min(ot_state->parallel_size(), CeilDiv(n, kMinWorkSize));
+  size_t nworker = ot_state->LazyInitWorkers(comm, n, kMinWorkSize);
   size_t work_load = nworker == 0 ? 0 : CeilDiv(n, nworker);
 
-  for (size_t w = 0; w < nworker; ++w) {
-    ot_state->LazyInit(comm, w);
-  }
-
   ArrayRef out(x.eltype(), n);
   yacl::parallel_for(0, nworker, 1, [&](size_t bgn, size_t end) {
     for (size_t job = bgn; job < end; ++job) {
@@ -373,6 +352,58 @@ ArrayRef MatMulAA::proc(KernelEvalContext* ctx, const ArrayRef& x,
   return ring_add(ret, task.get()).as(x.eltype());
 }
 
+ArrayRef BatchMatMulAA::proc(KernelEvalContext* ctx, const ArrayRef& x,
+                             const ArrayRef& y, size_t batch, size_t m,
+                             size_t n, size_t k) const {
+  SPU_TRACE_MPC_LEAF(ctx, x, y);
+  if (0 == x.numel() || 0 == y.numel()) {
+    return ArrayRef(x.eltype(), 0);
+  }
+  SPU_ENFORCE_EQ(x.numel(), static_cast<int64_t>(batch * m * k));
+  SPU_ENFORCE_EQ(y.numel(), static_cast<int64_t>(batch * k * n));
+
+  auto* comm = ctx->getState<Communicator>();
+  auto* dot_prot = ctx->getState<CheetahDotState>()->get();
+  const int rank = comm->getRank();
+
+  // Same as MatMulAA, but the cross terms of all products share one exchange.
+  const Shape3D dim3 = {static_cast<int64_t>(m), static_cast<int64_t>(k),
+                        static_cast<int64_t>(n)};
+  const auto nbatch = static_cast<int64_t>(batch);
+
+  auto* conn = comm->lctx().get();
+  auto dupx = conn->Spawn();
+  std::future<ArrayRef> task = std::async(std::launch::async, [&] {
+    if (rank == 0) {
+      return dot_prot->BatchDotOLE(x, dupx.get(), dim3, nbatch, true);
+    } else {
+      return dot_prot->BatchDotOLE(y, dupx.get(), dim3, nbatch, false);
+    }
+  });
+
+  ArrayRef x1y0;
+  if (rank == 0) {
+    x1y0 = dot_prot->BatchDotOLE(y, conn, dim3, nbatch, false);
+  } else {
+    x1y0 = dot_prot->BatchDotOLE(x, conn, dim3, nbatch, true);
+  }
+
+  const int64_t lhs_numel = m * k;
+  const int64_t rhs_numel = k * n;
+  const int64_t out_numel = m * n;
+  ArrayRef ret = ring_zeros(x.eltype().as<Ring2k>()->field(), batch * m * n);
+  for (int64_t i = 0; i < nbatch; ++i) {
+    auto local = ring_mmul(x.slice(i * lhs_numel, (i + 1) * lhs_numel),
+                           y.slice(i * rhs_numel, (i + 1) * rhs_numel), m, n,
+                           k);
+    std::memcpy(&ret.at(i * out_numel), &local.at(0),
+                local.numel() * local.elsize());
+  }
+  ring_add_(ret, x1y0);
+  ring_add_(ret, task.get());
+  return ret.as(x.eltype());
+}
+
 ArrayRef Conv2DAA::proc(KernelEvalContext* ctx, const ArrayRef& tensor,
                         const ArrayRef& filter, size_t N, size_t H, size_t W,
                         size_t C, size_t O, size_t h, size_t w, size_t stride_h,
@@ -136,6 +136,16 @@ class MatMulAA : public MatmulKernel {
                 size_t m, size_t n, size_t k) const override;
 };
 
+class BatchMatMulAA : public BatchMatmulKernel {
+ public:
+  static constexpr char kBindName[] = "batch_mmul_aa";
+
+  Kind kind() const override { return Kind::Dynamic; }
+
+  ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& x, const ArrayRef& y,
+                size_t batch, size_t m, size_t n, size_t k) const override;
+};
+
 class Conv2DAA : public Conv2DKernel {
  public:
   static constexpr char kBindName[] = "conv2d_aa";
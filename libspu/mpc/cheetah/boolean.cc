@@ -30,12 +30,8 @@ ArrayRef AndBB::proc(KernelEvalContext* ctx, const ArrayRef& lhs,
   auto* comm = ctx->getState<Communicator>();
   auto* ot_state = ctx->getState<CheetahOTState>();
   size_t n = lhs.numel();
-  size_t nworker =
-      std::min(ot_state->parallel_size(), CeilDiv(n, kMinWorkSize));
+  size_t nworker = ot_state->LazyInitWorkers(comm, n, kMinWorkSize);
   size_t work_load = nworker == 0 ? 0 : CeilDiv(n, nworker);
-  for (size_t w = 0; w < nworker; ++w) {
-    ot_state->LazyInit(comm, w);
-  }
 
   ArrayRef z(lhs.eltype(), n);
   yacl::parallel_for(0, nworker, 1, [&](size_t bgn, size_t end) {
@@ -27,12 +27,8 @@ ArrayRef B2A::proc(KernelEvalContext* ctx, const ArrayRef& x) const {
   auto* comm = ctx->getState<Communicator>();
   auto* ot_state = ctx->getState<CheetahOTState>();
   size_t n = x.numel();
-  size_t nworker =
-      std::min(ot_state->parallel_size(), CeilDiv(n, kMinWorkSize));
+  size_t nworker = ot_state->LazyInitWorkers(comm, n, kMinWorkSize);
   size_t work_load = nworker == 0 ? 0 : CeilDiv(n, nworker);
-  for (size_t w = 0; w < nworker; ++w) {
-    ot_state->LazyInit(comm, w);
-  }
 
   const auto field = ctx->getState<Z2kState>()->getDefaultField();
   ArrayRef out(x.eltype(), n);
@@ -23,15 +23,16 @@ namespace spu::mpc::cheetah {
 
 using BShrTy = semi2k::BShrTy;
 
-BasicOTProtocols::BasicOTProtocols(std::shared_ptr<Communicator> conn)
+BasicOTProtocols::BasicOTProtocols(std::shared_ptr<Communicator> conn,
+                                   const FerretOT::PersistOptions &persist)
     : conn_(std::move(conn)) {
   SPU_ENFORCE(conn_ != nullptr);
   if (conn_->getRank() == 0) {
-    ferret_sender_ = std::make_shared<FerretOT>(conn_, true);
-    ferret_receiver_ = std::make_shared<FerretOT>(conn_, false);
+    ferret_sender_ = std::make_shared<FerretOT>(conn_, true, persist);
+    ferret_receiver_ = std::make_shared<FerretOT>(conn_, false, persist);
   } else {
-    ferret_receiver_ = std::make_shared<FerretOT>(conn_, false);
-    ferret_sender_ = std::make_shared<FerretOT>(conn_, true);
+    ferret_receiver_ = std::make_shared<FerretOT>(conn_, false, persist);
+    ferret_sender_ = std::make_shared<FerretOT>(conn_, true, persist);
   }
 }
 
@@ -49,6 +50,18 @@ void BasicOTProtocols::Flush() {
   }
 }
 
+void BasicOTProtocols::PreExpand(size_t num_cot) {
+  // Same order as the setup, the sender of one party pairs with the
+  // receiver of the other.
+  if (conn_->getRank() == 0) {
+    ferret_sender_->PreExpand(num_cot);
+    ferret_receiver_->PreExpand(num_cot);
+  } else {
+    ferret_receiver_->PreExpand(num_cot);
+    ferret_sender_->PreExpand(num_cot);
+  }
+}
+
 ArrayRef BasicOTProtocols::B2A(const ArrayRef &inp) {
   const auto *share_t = inp.eltype().as<BShrTy>();
   if (share_t->nbits() == 1) {
@@ -21,7 +21,8 @@ namespace spu::mpc::cheetah {
 
 class BasicOTProtocols {
  public:
-  explicit BasicOTProtocols(std::shared_ptr<Communicator> conn);
+  explicit BasicOTProtocols(std::shared_ptr<Communicator> conn,
+                            const FerretOT::PersistOptions &persist = {});
 
   ~BasicOTProtocols();
 
@@ -57,6 +58,9 @@ class BasicOTProtocols {
 
   void Flush();
 
+  // Pre-expand `num_cot` COTs in each direction.
+  void PreExpand(size_t num_cot);
+
  protected:
   ArrayRef Compare(const ArrayRef &inp, bool greater_than, bool equality,
                    int radix_base);
@@ -14,6 +14,16 @@
 
 #include "libspu/mpc/cheetah/ot/ferret.h"
 
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string_view>
 #include <utility>
 
 #include "emp-ot/cot.h"
@@ -21,20 +31,153 @@
 #include "emp-tool/io/io_channel.h"
 #include "spdlog/spdlog.h"
 #include "yacl/base/buffer.h"
+#include "yacl/crypto/base/hash/hash_utils.h"
+#include "yacl/crypto/base/symmetric_crypto.h"
+#include "yacl/crypto/utils/rand.h"
 #include "yacl/link/link.h"
 
 #include "libspu/mpc/cheetah/ot/mitccrh_exp.h"
 #include "libspu/mpc/cheetah/ot/util.h"
 
-#define PRE_OT_DATA_REG_SEND_FILE_ALICE "pre_ferret_data_reg_send_alice"
-#define PRE_OT_DATA_REG_SEND_FILE_BOB "pre_ferret_data_reg_send_bob"
-#define PRE_OT_DATA_REG_RECV_FILE_ALICE "pre_ferret_data_reg_recv_alice"
-#define PRE_OT_DATA_REG_RECV_FILE_BOB "pre_ferret_data_reg_recv_bob"
-
 namespace spu::mpc::cheetah {
 constexpr size_t kOTBatchSize = emp::ot_bsize;  // emp-ot/cot.h
 using OtBaseTyp = emp::block;
 
+namespace {
+
+namespace fs = std::filesystem;
+
+// magic || iv || AES-CTR(epoch || pre ot data) || HMAC(magic || iv || ...)
+// Encryption and mac keys are derived from the user key.
+constexpr char kPersistMagic[] = "SPU-FERRET-V2";
+constexpr size_t kPersistMagicSize = sizeof(kPersistMagic) - 1;
+constexpr size_t kDigestSize = 32;
+
+using Digest = std::array<uint8_t, kDigestSize>;
+
+// HMAC-SHA256, RFC 2104.
+Digest HmacSha256(yacl::ByteContainerView key, yacl::ByteContainerView msg) {
+  constexpr size_t kBlockSize = 64;
+  SPU_ENFORCE(key.size() <= kBlockSize);
+  std::string inner(kBlockSize, '\x36');
+  std::string outer(kBlockSize, '\x5c');
+  for (size_t i = 0; i < key.size(); ++i) {
+    inner[i] ^= static_cast<char>(key[i]);
+    outer[i] ^= static_cast<char>(key[i]);
+  }
+  inner.append(reinterpret_cast<const char*>(msg.data()), msg.size());
+  auto inner_digest = yacl::crypto::Sha256(inner);
+  outer.append(reinterpret_cast<const char*>(inner_digest.data()),
+               inner_digest.size());
+  auto outer_digest = yacl::crypto::Sha256(outer);
+
+  Digest ret;
+  std::memcpy(ret.data(), outer_digest.data(), kDigestSize);
+  return ret;
+}
+
+Digest DeriveKey(uint128_t key, std::string_view purpose) {
+  return HmacSha256(yacl::ByteContainerView(&key, sizeof(key)), purpose);
+}
+
+uint128_t EncryptionKey(uint128_t key) {
+  uint128_t ret;
+  std::memcpy(&ret, DeriveKey(key, "SPU-FERRET enc").data(), sizeof(ret));
+  return ret;
+}
+
+// Timing independent comparison of macs.
+bool DigestEqual(const uint8_t* a, const uint8_t* b) {
+  uint8_t diff = 0;
+  for (size_t i = 0; i < kDigestSize; ++i) {
+    diff |= a[i] ^ b[i];
+  }
+  return diff == 0;
+}
+
+std::optional<std::string> ReadFile(const fs::path& path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return std::nullopt;
+  }
+  std::stringstream ss;
+  ss << in.rdbuf();
+  if (in.bad()) {
+    return std::nullopt;
+  }
+  return ss.str();
+}
+
+bool WriteFile(const fs::path& path, std::string_view content) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(content.data(), static_cast<std::streamsize>(content.size()));
+  return static_cast<bool>(out);
+}
+
+// A file name emp-ot never finds, for the pre ot data it reads on setup and
+// writes on destruction.
+fs::path UniquePreOTFile(const fs::path& dir) {
+  static std::atomic<int64_t> counter{0};
+  return dir / fmt::format("pre_ferret_data.{}.{}.{}", ::getpid(),
+                           static_cast<uint64_t>(yacl::crypto::RandSeed()),
+                           counter++);
+}
+
+std::string Encrypt(uint128_t key, uint128_t epoch, const std::string& data) {
+  std::string plain(sizeof(epoch), '\0');
+  std::memcpy(plain.data(), &epoch, sizeof(epoch));
+  plain += data;
+
+  const uint128_t iv = yacl::crypto::RandSeed();
+  yacl::crypto::SymmetricCrypto crypto(
+      yacl::crypto::SymmetricCrypto::CryptoType::AES128_CTR,
+      EncryptionKey(key), iv);
+  auto cipher = crypto.Encrypt(plain);
+
+  std::string out(kPersistMagic, kPersistMagicSize);
+  out.append(reinterpret_cast<const char*>(&iv), sizeof(iv));
+  out.append(reinterpret_cast<const char*>(cipher.data()), cipher.size());
+  const auto mac = HmacSha256(DeriveKey(key, "SPU-FERRET mac"), out);
+  out.append(reinterpret_cast<const char*>(mac.data()), mac.size());
+  return out;
+}
+
+// Returns the epoch and the pre ot data, nothing on a corrupted or forged
+// file or a wrong key.
+std::optional<std::pair<uint128_t, std::string>> Decrypt(
+    uint128_t key, const std::string& content) {
+  const size_t header = kPersistMagicSize + sizeof(uint128_t);
+  if (content.size() < header + sizeof(uint128_t) + kDigestSize ||
+      content.compare(0, kPersistMagicSize, kPersistMagic) != 0) {
+    return std::nullopt;
+  }
+  // Verify the mac before touching the cipher text.
+  const size_t body = content.size() - kDigestSize;
+  const auto mac = HmacSha256(DeriveKey(key, "SPU-FERRET mac"),
+                              yacl::ByteContainerView(content.data(), body));
+  if (!DigestEqual(mac.data(),
+                   reinterpret_cast<const uint8_t*>(content.data()) + body)) {
+    return std::nullopt;
+  }
+
+  uint128_t iv;
+  std::memcpy(&iv, content.data() + kPersistMagicSize, sizeof(iv));
+  yacl::crypto::SymmetricCrypto crypto(
+      yacl::crypto::SymmetricCrypto::CryptoType::AES128_CTR,
+      EncryptionKey(key), iv);
+  auto plain = crypto.Decrypt(
+      yacl::ByteContainerView(content.data() + header, body - header));
+
+  uint128_t epoch;
+  std::memcpy(&epoch, plain.data(), sizeof(epoch));
+  return std::make_pair(
+      epoch, std::string(reinterpret_cast<const char*>(plain.data()) +
+                             sizeof(epoch),
+                         plain.size() - sizeof(epoch)));
+}
+
+}  // namespace
+
 // A concrete class for emp::IOChannel
 // Because emp::FerretCOT needs a uniform API of emp::IOChannel
 class CheetahIO : public emp::IOChannel<CheetahIO> {
@@ -169,33 +312,125 @@ class CheetahIO : public emp::IOChannel<CheetahIO> {
 struct FerretOT::Impl {
  private:
   const bool is_sender_;
+  const PersistOptions persist_;
 
   std::shared_ptr<CheetahIO> io_{nullptr};
   std::array<CheetahIO*, 1> io_holder_;
   std::shared_ptr<emp::FerretCOT<CheetahIO>> ferret_{nullptr};
 
+  // The file emp-ot reads the pre ot data from on setup, and writes the
+  // unused pre ot data to on destruction.
+  fs::path pre_ot_file_;
+  // Encrypted state of this instance, empty if not persisted.
+  fs::path persist_file_;
+  // Tags the state saved by this session, the same on both sides.
+  uint128_t epoch_ = 0;
+
+  // Pre-expanded random COTs, cot_buf_[cot_used_:] are not consumed yet.
+  std::vector<OtBaseTyp> cot_buf_;
+  size_t cot_used_ = 0;
+
   MITCCRHExp<8> mitccrh_exp_{};
 
   void RandCOT(absl::Span<OtBaseTyp> output) {
-    ferret_->rcot(output.data(), output.size());
+    const size_t n = output.size();
+    const size_t from_buf = std::min(n, cot_buf_.size() - cot_used_);
+    if (from_buf > 0) {
+      std::memcpy(output.data(), cot_buf_.data() + cot_used_,
+                  from_buf * sizeof(OtBaseTyp));
+      cot_used_ += from_buf;
+      if (cot_used_ == cot_buf_.size()) {
+        cot_buf_ = {};
+        cot_used_ = 0;
+      }
+    }
+    if (from_buf < n) {
+      ferret_->rcot(output.data() + from_buf, n - from_buf);
+    }
   }
 
+  // Chosen choice COTs are derandomized from random COTs (whose choice is
+  // the lsb of the receiver's block) as emp-ot does, so that pre-expanded
+  // COTs serve them too.
   void SendCOT(OtBaseTyp* output, size_t n) {
     SPU_ENFORCE(is_sender_);
-    ferret_->send_cot(output, n);
+    RandCOT({output, n});
+    std::unique_ptr<bool[]> flips(new bool[n]);
+    io_->recv_bool(flips.get(), n);
+    for (size_t i = 0; i < n; ++i) {
+      if (flips[i]) {
+        output[i] ^= ferret_->Delta;
+      }
+    }
   }
 
   void RecvCOT(absl::Span<const uint8_t> choices,
                absl::Span<OtBaseTyp> output) {
     SPU_ENFORCE(not is_sender_);
-    ferret_->recv_cot(output.data(),
-                      reinterpret_cast<const bool*>(choices.data()),
-                      output.size());
+    const size_t n = output.size();
+    RandCOT(output);
+    std::unique_ptr<bool[]> flips(new bool[n]);
+    for (size_t i = 0; i < n; ++i) {
+      flips[i] = static_cast<bool>(choices[i] & 1) ^ emp::getLSB(output[i]);
+    }
+    io_->send_bool(flips.get(), n);
+  }
+
+  // Both sides resume only if they hold the state of the same session, the
+  // state file is consumed either way.
+  void LoadPersisted() {
+    uint128_t epoch = 0;
+    std::string data;
+    if (auto content = ReadFile(persist_file_)) {
+      if (auto state = Decrypt(persist_.key, *content)) {
+        std::tie(epoch, data) = std::move(*state);
+      } else {
+        SPDLOG_WARN("drop corrupted ferret state {}", persist_file_.string());
+      }
+    }
+    std::error_code ec;
+    fs::remove(persist_file_, ec);
+
+    uint128_t peer_epoch = 0;
+    if (is_sender_) {
+      io_->send_data(&epoch, sizeof(epoch));
+      io_->flush();
+      io_->recv_data(&peer_epoch, sizeof(peer_epoch));
+    } else {
+      io_->recv_data(&peer_epoch, sizeof(peer_epoch));
+      io_->send_data(&epoch, sizeof(epoch));
+      io_->flush();
+    }
+
+    // emp-ot runs the base OTs unless both sides find their file.
+    if (epoch != 0 && epoch == peer_epoch &&
+        !WriteFile(pre_ot_file_, data)) {
+      SPDLOG_WARN("failed to stage ferret state {}", pre_ot_file_.string());
+    }
+  }
+
+  void SavePersisted() {
+    auto data = ReadFile(pre_ot_file_);
+    if (!data.has_value()) {
+      return;
+    }
+    auto tmp = persist_file_;
+    tmp += ".tmp";
+    std::error_code ec;
+    if (WriteFile(tmp, Encrypt(persist_.key, epoch_, *data))) {
+      fs::rename(tmp, persist_file_, ec);
+    }
+    if (ec) {
+      SPDLOG_WARN("failed to save ferret state {}, {}",
+                  persist_file_.string(), ec.message());
+      fs::remove(tmp, ec);
+    }
   }
 
  public:
-  Impl(std::shared_ptr<Communicator> conn, bool is_sender)
-      : is_sender_(is_sender) {
+  Impl(std::shared_ptr<Communicator> conn, bool is_sender,
+       PersistOptions persist)
+      : is_sender_(is_sender), persist_(std::move(persist)) {
     SPU_ENFORCE(conn != nullptr);
     constexpr int thread = 1;
     constexpr bool malicious = false;
@@ -203,23 +438,29 @@ struct FerretOT::Impl {
     int role = is_sender ? emp::ALICE : emp::BOB;
     io_ = std::make_shared<CheetahIO>(conn);
     io_holder_[0] = io_.get();
-    std::string save_file;
-    if (conn->getRank() == 0) {
-      if (is_sender) {
-        save_file = PRE_OT_DATA_REG_SEND_FILE_ALICE;
-      } else {
-        save_file = PRE_OT_DATA_REG_RECV_FILE_ALICE;
-      }
+
+    if (!persist_.dir.empty()) {
+      SPU_ENFORCE(persist_.key != 0,
+                  "an all zero key is not allowed for the ferret state");
+      std::error_code ec;
+      fs::create_directories(persist_.dir, ec);
+      SPU_ENFORCE(!ec, "failed to create ferret state dir {}, {}",
+                  persist_.dir, ec.message());
+      persist_file_ = fs::path(persist_.dir) /
+                      fmt::format("ferret_{}_{}_{}.bin", persist_.tag,
+                                  conn->getRank(), is_sender ? "send" : "recv");
+      pre_ot_file_ = UniquePreOTFile(persist_.dir);
+      LoadPersisted();
     } else {
-      if (is_sender) {
-        save_file = PRE_OT_DATA_REG_SEND_FILE_BOB;
-      } else {
-        save_file = PRE_OT_DATA_REG_RECV_FILE_BOB;
-      }
+      pre_ot_file_ = UniquePreOTFile(fs::temp_directory_path());
     }
 
     ferret_ = std::make_shared<emp::FerretCOT<CheetahIO>>(
-        role, thread, io_holder_.data(), malicious, run_setup, save_file);
+        role, thread, io_holder_.data(), malicious, run_setup,
+        pre_ot_file_.string());
+    // The pre ot data is in memory now, never leave it in plain.
+    std::error_code ec;
+    fs::remove(pre_ot_file_, ec);
 
     OtBaseTyp seed;
     if (is_sender_) {
@@ -231,9 +472,28 @@ struct FerretOT::Impl {
       io_->recv_block(&seed, 1);
       ferret_->mitccrh.setS(seed);
     }
+
+    if (!persist_file_.empty()) {
+      // Both sides tag the state saved by this session with the same epoch.
+      if (is_sender_) {
+        epoch_ = yacl::crypto::RandSeed();
+        io_->send_data(&epoch_, sizeof(epoch_));
+        io_->flush();
+      } else {
+        io_->recv_data(&epoch_, sizeof(epoch_));
+      }
+    }
   }
 
-  ~Impl() = default;
+  ~Impl() {
+    // emp-ot writes the unused pre ot data on destruction.
+    ferret_.reset();
+    if (!persist_file_.empty()) {
+      SavePersisted();
+    }
+    std::error_code ec;
+    fs::remove(pre_ot_file_, ec);
+  }
 
   int Rank() const { return io_->conn_->getRank(); }
 
@@ -243,6 +503,19 @@ struct FerretOT::Impl {
     }
   }
 
+  void PreExpand(size_t num_cot) {
+    if (num_cot == 0) {
+      return;
+    }
+    cot_buf_.erase(cot_buf_.begin(), cot_buf_.begin() + cot_used_);
+    cot_used_ = 0;
+    const size_t offset = cot_buf_.size();
+    cot_buf_.resize(offset + num_cot);
+    ferret_->rcot(cot_buf_.data() + offset, num_cot);
+  }
+
+  size_t NumPreExpanded() const { return cot_buf_.size() - cot_used_; }
+
   void SendRandCorrelatedMsgChosenChoice(OtBaseTyp* output, size_t n) {
     SPU_ENFORCE(n > 0 && output != nullptr);
     SendCOT(output, n);
@@ -638,14 +911,19 @@ struct FerretOT::Impl {
   }
 };
 
-FerretOT::FerretOT(std::shared_ptr<Communicator> conn, bool is_sender) {
-  impl_ = std::make_shared<Impl>(conn, is_sender);
+FerretOT::FerretOT(std::shared_ptr<Communicator> conn, bool is_sender,
+                   const PersistOptions& persist) {
+  impl_ = std::make_shared<Impl>(conn, is_sender, persist);
 }
 
 int FerretOT::Rank() const { return impl_->Rank(); }
 
 void FerretOT::Flush() { impl_->Flush(); }
 
+void FerretOT::PreExpand(size_t num_cot) { impl_->PreExpand(num_cot); }
+
+size_t FerretOT::NumPreExpanded() const { return impl_->NumPreExpanded(); }
+
 FerretOT::~FerretOT() { impl_->Flush(); }
 
 template <typename T>
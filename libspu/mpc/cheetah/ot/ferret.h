@@ -16,6 +16,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 
 #include "absl/types/span.h"
 #include "yacl/base/int128.h"
@@ -30,7 +31,22 @@ class FerretOT {
   std::shared_ptr<Impl> impl_;
 
  public:
-  FerretOT(std::shared_ptr<Communicator> conn, bool is_sender);
+  // Resume the Ferret state of a previous session instead of running the
+  // base OTs again. The state is kept in an encrypted and authenticated file
+  // per instance, and is consumed on load so that no correlation is ever
+  // used twice.
+  struct PersistOptions {
+    // Directory of the state files, empty to disable persistence.
+    std::string dir;
+    // Tells apart the instances sharing a directory, must be the same on
+    // both parties, e.g. link id and instance index.
+    std::string tag;
+    // Secret key of the state files, must not be zero when `dir` is set.
+    uint128_t key = 0;
+  };
+
+  FerretOT(std::shared_ptr<Communicator> conn, bool is_sender,
+           const PersistOptions& persist = {});
 
   ~FerretOT();
 
@@ -38,6 +54,14 @@ class FerretOT {
 
   void Flush();
 
+  // Expand `num_cot` random COTs ahead of time, later OTs consume them
+  // before running new LPN expansions. Both parties call it with the same
+  // size.
+  void PreExpand(size_t num_cot);
+
+  // Number of pre-expanded COTs not consumed yet.
+  size_t NumPreExpanded() const;
+
   // One-of-N OT where msg_array is a Nxn array.
   // choice \in [0, N-1]
   void SendCMCC(absl::Span<const uint8_t> msg_array, size_t N,
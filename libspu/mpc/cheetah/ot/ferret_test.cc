@@ -14,6 +14,9 @@
 
 #include "libspu/mpc/cheetah/ot/ferret.h"
 
+#include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <random>
 
 #include "gtest/gtest.h"
@@ -156,4 +159,144 @@ TEST_P(FerretCOTTest, ChosenMsgChosenChoice) {
   });
 }
 
+TEST_P(FerretCOTTest, PreExpand) {
+  size_t kWorldSize = 2;
+  size_t n = 1000;
+  auto field = GetParam();
+
+  auto _correlation = ring_rand(field, n);
+  std::vector<uint8_t> choices(n);
+  std::default_random_engine rdv;
+  std::uniform_int_distribution<uint64_t> uniform(0, -1);
+  std::generate_n(choices.begin(), n, [&]() -> uint8_t {
+    return static_cast<uint8_t>(uniform(rdv) & 1);
+  });
+
+  DISPATCH_ALL_FIELDS(field, "", [&]() {
+    auto correlation = xt_adapt<ring2k_t>(_correlation);
+    std::vector<ring2k_t> computed[2];
+    size_t left[2];
+    utils::simulate(kWorldSize, [&](std::shared_ptr<yacl::link::Context> ctx) {
+      auto conn = std::make_shared<Communicator>(ctx);
+      int rank = ctx->Rank();
+      computed[rank].resize(n);
+      FerretOT ferret(conn, rank == 0);
+      // Partially served from the pre-expanded COTs.
+      ferret.PreExpand(n / 2);
+      if (rank == 0) {
+        ferret.SendCAMCC({correlation.data(), correlation.size()},
+                         absl::MakeSpan(computed[0]));
+        ferret.Flush();
+      } else {
+        ferret.RecvCAMCC(absl::MakeSpan(choices), absl::MakeSpan(computed[1]));
+      }
+      left[rank] = ferret.NumPreExpanded();
+    });
+
+    EXPECT_EQ(left[0], 0);
+    EXPECT_EQ(left[1], 0);
+    for (size_t i = 0; i < n; ++i) {
+      ring2k_t c = -computed[0][i] + computed[1][i];
+      ring2k_t e = choices[i] ? correlation[i] : 0;
+      EXPECT_EQ(e, c);
+    }
+  });
+}
+
+TEST_P(FerretCOTTest, Persist) {
+  size_t kWorldSize = 2;
+  size_t n = 10;
+  auto field = GetParam();
+
+  FerretOT::PersistOptions persist;
+  persist.dir = (std::filesystem::temp_directory_path() /
+                 fmt::format("spu_ferret_test_{}_{}", field,
+                             std::chrono::steady_clock::now()
+                                 .time_since_epoch()
+                                 .count()))
+                    .string();
+  persist.tag = "test";
+  persist.key = 0x1234;
+
+  auto _correlation = ring_rand(field, n);
+  std::vector<uint8_t> choices(n, 1);
+
+  DISPATCH_ALL_FIELDS(field, "", [&]() {
+    auto correlation = xt_adapt<ring2k_t>(_correlation);
+    // Bytes sent by each party during the Ferret setup of each session.
+    std::vector<size_t> setup_bytes[3];
+    // The second session resumes from the state saved by the first one, the
+    // third one finds a tampered state and runs the base OTs again.
+    for (int session : {0, 1, 2}) {
+      if (session == 2) {
+        for (const auto &entry :
+             std::filesystem::directory_iterator(persist.dir)) {
+          std::fstream f(entry.path(),
+                         std::ios::binary | std::ios::in | std::ios::out);
+          f.seekg(-1, std::ios::end);
+          const char c = static_cast<char>(f.get());
+          f.seekp(-1, std::ios::end);
+          f.put(static_cast<char>(~c));
+        }
+      }
+
+      std::vector<ring2k_t> computed[2];
+      setup_bytes[session].resize(kWorldSize);
+      utils::simulate(kWorldSize,
+                      [&](std::shared_ptr<yacl::link::Context> ctx) {
+                        auto conn = std::make_shared<Communicator>(ctx);
+                        int rank = ctx->Rank();
+                        computed[rank].resize(n);
+                        FerretOT ferret(conn, rank == 0, persist);
+                        setup_bytes[session][rank] =
+                            ctx->GetStats()->sent_bytes;
+                        if (rank == 0) {
+                          ferret.SendCAMCC(
+                              {correlation.data(), correlation.size()},
+                              absl::MakeSpan(computed[0]));
+                          ferret.Flush();
+                        } else {
+                          ferret.RecvCAMCC(absl::MakeSpan(choices),
+                                           absl::MakeSpan(computed[1]));
+                        }
+                      });
+
+      for (size_t i = 0; i < n; ++i) {
+        ring2k_t c = -computed[0][i] + computed[1][i];
+        EXPECT_EQ(correlation[i], c) << "session " << session;
+      }
+
+      // Only the encrypted states are left behind.
+      size_t files = 0;
+      for (const auto &entry :
+           std::filesystem::directory_iterator(persist.dir)) {
+        EXPECT_EQ(entry.path().extension(), ".bin");
+        ++files;
+      }
+      EXPECT_EQ(files, 2);
+    }
+
+    for (size_t rank = 0; rank < kWorldSize; ++rank) {
+      // The resumed setup skips the base OTs and the IKNP extension which
+      // dominate the fresh one.
+      EXPECT_LT(setup_bytes[1][rank] * 4, setup_bytes[0][rank]);
+      // A tampered state is dropped, the setup runs from scratch.
+      EXPECT_LT(setup_bytes[1][rank] * 4, setup_bytes[2][rank]);
+    }
+  });
+
+  std::filesystem::remove_all(persist.dir);
+}
+
+TEST_P(FerretCOTTest, PersistZeroKey) {
+  FerretOT::PersistOptions persist;
+  persist.dir = std::filesystem::temp_directory_path().string();
+  persist.tag = "zero_key";
+
+  utils::simulate(2, [&](std::shared_ptr<yacl::link::Context> ctx) {
+    auto conn = std::make_shared<Communicator>(ctx);
+    EXPECT_THROW(FerretOT(conn, ctx->Rank() == 0, persist), RuntimeError);
+  });
+}
+
 }  // namespace spu::mpc::cheetah::test
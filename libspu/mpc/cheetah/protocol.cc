@@ -18,6 +18,8 @@
 #include "libspu/mpc/common/prg_state.h"
 //
 
+#include <cstring>
+
 #include "libspu/mpc/cheetah/arithmetic.h"
 #include "libspu/mpc/cheetah/boolean.h"
 #include "libspu/mpc/cheetah/conversion.h"
@@ -50,9 +52,23 @@ std::unique_ptr<Object> makeCheetahProtocol(
   obj->addState<Z2kState>(conf.field());
 
   // add Cheetah states
-  obj->addState<cheetah::CheetahMulState>(lctx);
-  obj->addState<cheetah::CheetahDotState>(lctx);
-  obj->addState<cheetah::CheetahOTState>();
+  obj->addState<cheetah::CheetahMulState>(
+      lctx, conf.cheetah_beaver_low_watermark(),
+      conf.cheetah_beaver_high_watermark());
+  obj->addState<cheetah::CheetahDotState>(lctx,
+                                          conf.cheetah_dot_cache_size());
+  cheetah::FerretOT::PersistOptions persist;
+  if (!conf.cheetah_ot_persist_dir().empty()) {
+    const auto& key = conf.cheetah_ot_persist_key();
+    SPU_ENFORCE(key.size() == sizeof(persist.key),
+                "cheetah_ot_persist_key should be {} bytes, got {}",
+                sizeof(persist.key), key.size());
+    persist.dir = conf.cheetah_ot_persist_dir();
+    std::memcpy(&persist.key, key.data(), sizeof(persist.key));
+  }
+  obj->addState<cheetah::CheetahOTState>(
+      lctx, conf.cheetah_ot_parallel(), conf.cheetah_ot_prewarm(),
+      std::move(persist), conf.cheetah_ot_pre_expand());
 
   // register public kernels.
   regPub2kKernels(obj.get());
@@ -74,6 +90,7 @@ std::unique_ptr<Object> makeCheetahProtocol(
   obj->regKernel<cheetah::EqualAP>();
   obj->regKernel<cheetah::MatMulAP>();
   obj->regKernel<cheetah::MatMulAA>();
+  obj->regKernel<cheetah::BatchMatMulAA>();
   obj->regKernel<cheetah::Conv2DAA>();
   obj->regKernel<cheetah::LShiftA>();
   obj->regKernel<cheetah::TruncA>();
@@ -26,6 +26,13 @@ RuntimeConfig makeConfig(FieldType field) {
   return conf;
 }
 
+RuntimeConfig makeRefillConfig(FieldType field) {
+  RuntimeConfig conf = makeConfig(field);
+  conf.set_cheetah_beaver_low_watermark(1024);
+  conf.set_cheetah_beaver_high_watermark(4096);
+  return conf;
+}
+
 }  // namespace
 
 INSTANTIATE_TEST_SUITE_P(
@@ -51,6 +58,18 @@ INSTANTIATE_TEST_SUITE_P(
                          std::get<2>(p.param));
     });
 
+// Cached beavers are refilled in background.
+INSTANTIATE_TEST_SUITE_P(
+    CheetahRefill, ArithmeticTest,
+    testing::Combine(testing::Values(makeCheetahProtocol),                //
+                     testing::Values(makeRefillConfig(FieldType::FM32),   //
+                                     makeRefillConfig(FieldType::FM64)),  //
+                     testing::Values(2)),                                 //
+    [](const testing::TestParamInfo<ArithmeticTest::ParamType>& p) {
+      return fmt::format("{}x{}", std::get<1>(p.param).field(),
+                         std::get<2>(p.param));
+    });
+
 INSTANTIATE_TEST_SUITE_P(
     Cheetah, BooleanTest,
     testing::Combine(testing::Values(makeCheetahProtocol),           //
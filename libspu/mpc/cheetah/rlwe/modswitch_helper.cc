@@ -14,13 +14,17 @@
 
 #include "libspu/mpc/cheetah/rlwe/modswitch_helper.h"
 
+#include <algorithm>
+#include <array>
 #include <utility>
+#include <vector>
 
 #include "seal/util/iterator.h"
 #include "seal/util/numth.h"
 #include "seal/util/polyarithsmallmod.h"
 #include "seal/util/uintarith.h"
 #include "yacl/base/int128.h"
+#include "yacl/utils/parallel.h"
 
 #include "libspu/mpc/cheetah/rlwe/utils.h"  // BarrettReduce
 #include "libspu/mpc/utils/ring_ops.h"
@@ -104,16 +108,18 @@ struct ModulusSwitchHelper::Impl {
     const auto &modulus = context_.key_context_data()->parms().coeff_modulus();
     // round(Q/t*x) = k*x + round(r*x/t) where k = floor(Q/t), r = Q mod t
     // round(Q/t*x) mod qi = ((k mod qi)*x + round(r*x/t)) mod qi
-    for (size_t i = 0; i < n; ++i) {
-      // u = (Q mod t)*x mod qi
-      Scalar x = src[i];
-      uint64_t x64 = BarrettReduce(x, modulus[mod_idx]);
-      uint64_t u = seal::util::multiply_uint_mod(x64, Q_div_t_mod_qi_[mod_idx],
-                                                 modulus[mod_idx]);
-      // uint128_t can conver uint32_t/uint64_t mult here
-      Scalar v = ((Q_mod_t_ * x + t_half_) >> base_mod_bitlen_);
-      out[i] = BarrettReduce(u + v, modulus[mod_idx]);
-    }
+    yacl::parallel_for(0, n, kParallelGrain, [&](int64_t bgn, int64_t end) {
+      for (int64_t i = bgn; i < end; ++i) {
+        // u = (Q mod t)*x mod qi
+        Scalar x = src[i];
+        uint64_t x64 = BarrettReduce(x, modulus[mod_idx]);
+        uint64_t u = seal::util::multiply_uint_mod(
+            x64, Q_div_t_mod_qi_[mod_idx], modulus[mod_idx]);
+        // uint128_t can conver uint32_t/uint64_t mult here
+        Scalar v = ((Q_mod_t_ * x + t_half_) >> base_mod_bitlen_);
+        out[i] = BarrettReduce(u + v, modulus[mod_idx]);
+      }
+    });
   }
 
   // NOTE(juhou): we need 256-bit to store the product `x * (Q mod t)` for x, t
@@ -131,33 +137,34 @@ struct ModulusSwitchHelper::Impl {
                 fmt::format("ModulusUpAt: invalid mod_idx ({} >= {})", mod_idx,
                             num_modulus));
     const auto &modulus = context_.key_context_data()->parms().coeff_modulus();
-    for (size_t i = 0; i < n; ++i) {
-      uint128_t x = src[i];
-      uint64_t x64 = BarrettReduce(x, modulus[mod_idx]);
-      uint64_t u = seal::util::multiply_uint_mod(x64, Q_div_t_mod_qi_[mod_idx],
-                                                 modulus[mod_idx]);
-      using namespace seal::util;
-      const auto *Q_mod_t = reinterpret_cast<const uint64_t *>(&Q_mod_t_);
-      const auto *xlimbs = reinterpret_cast<const uint64_t *>(&x);
-      const auto *t_half = reinterpret_cast<const uint64_t *>(&t_half_);
-      constexpr size_t kU128Limbs = 2;
-
-      // Compute round(x * Q_mod_t / t) for 2^64 < x, t <= 2^128
-      // round(x * Q_mod_t / t) = floor((x * Q_mod_t + t_half) / t)
+    const auto *Q_mod_t = reinterpret_cast<const uint64_t *>(&Q_mod_t_);
+    const auto *t_half = reinterpret_cast<const uint64_t *>(&t_half_);
+    constexpr size_t kU128Limbs = 2;
+    yacl::parallel_for(0, n, kParallelGrain, [&](int64_t bgn, int64_t end) {
       // We need 4 limbs to store the product x * Q_mod_t
-      std::vector<uint64_t> mul_limbs(2 * kU128Limbs);
-      std::vector<uint64_t> add_limbs(2 * kU128Limbs);
-      std::vector<uint64_t> rs_limbs(kU128Limbs + 1);
-      multiply_uint(Q_mod_t, kU128Limbs, xlimbs, kU128Limbs, 2 * kU128Limbs,
-                    mul_limbs.data());
-      add_uint(mul_limbs.data(), 2 * kU128Limbs, t_half, kU128Limbs,
-               /*carry*/ 0, 2 * kU128Limbs, add_limbs.data());
-      // NOTE(juhou) base_mod_bitlen_ > 64, we can direct drop the LSB here.
-      right_shift_uint192(add_limbs.data() + 1, base_mod_bitlen_ - 64,
-                          rs_limbs.data());
-      out[i] = BarrettReduce(u + AssignU128(rs_limbs[0], rs_limbs[1]),
-                             modulus[mod_idx]);
-    }
+      std::array<uint64_t, 2 * kU128Limbs> mul_limbs;
+      std::array<uint64_t, 2 * kU128Limbs> add_limbs;
+      std::array<uint64_t, kU128Limbs + 1> rs_limbs;
+      for (int64_t i = bgn; i < end; ++i) {
+        uint128_t x = src[i];
+        uint64_t x64 = BarrettReduce(x, modulus[mod_idx]);
+        uint64_t u = seal::util::multiply_uint_mod(
+            x64, Q_div_t_mod_qi_[mod_idx], modulus[mod_idx]);
+        const auto *xlimbs = reinterpret_cast<const uint64_t *>(&x);
+
+        // Compute round(x * Q_mod_t / t) for 2^64 < x, t <= 2^128
+        // round(x * Q_mod_t / t) = floor((x * Q_mod_t + t_half) / t)
+        multiply_uint(Q_mod_t, kU128Limbs, xlimbs, kU128Limbs, 2 * kU128Limbs,
+                      mul_limbs.data());
+        add_uint(mul_limbs.data(), 2 * kU128Limbs, t_half, kU128Limbs,
+                 /*carry*/ 0, 2 * kU128Limbs, add_limbs.data());
+        // NOTE(juhou) base_mod_bitlen_ > 64, we can direct drop the LSB here.
+        right_shift_uint192(add_limbs.data() + 1, base_mod_bitlen_ - 64,
+                            rs_limbs.data());
+        out[i] = BarrettReduce(u + AssignU128(rs_limbs[0], rs_limbs[1]),
+                               modulus[mod_idx]);
+      }
+    });
   }
 
   template <typename Scalar>
@@ -175,20 +182,47 @@ struct ModulusSwitchHelper::Impl {
 
     const auto &mod_qj = modulus[mod_idx];
     // view x \in [0, 2^k) as [-2^{k-1}, 2^{k-1})
-    for (size_t i = 0; i < n; ++i) {
-      auto x128 = static_cast<uint128_t>(src[i]);
-      if (x128 > t_half_) {
-        uint64_t u = BarrettReduce(-x128 & mod_t_mask_, mod_qj);
-        out[i] = negate_uint_mod(u, mod_qj);
-      } else {
-        out[i] = BarrettReduce(src[i], mod_qj);
+    yacl::parallel_for(0, n, kParallelGrain, [&](int64_t bgn, int64_t end) {
+      for (int64_t i = bgn; i < end; ++i) {
+        auto x128 = static_cast<uint128_t>(src[i]);
+        if (x128 > t_half_) {
+          uint64_t u = BarrettReduce(-x128 & mod_t_mask_, mod_qj);
+          out[i] = negate_uint_mod(u, mod_qj);
+        } else {
+          out[i] = BarrettReduce(src[i], mod_qj);
+        }
       }
-    }
+    });
   }
 
   template <typename Scalar>
   void ModulusDownRNS(absl::Span<const uint64_t> src,
                       absl::Span<Scalar> out) const {
+    size_t num_modulus = coeff_modulus_size();
+    size_t coeff_count = out.size();
+    SPU_ENFORCE_EQ(src.size(), num_modulus * coeff_count);
+    if (coeff_count <= kParallelGrain) {
+      DoModulusDownRNS(src, out);
+      return;
+    }
+
+    // Coefficients are converted independently. `src` is stored limb by limb,
+    // so the limbs of a chunk are gathered first.
+    yacl::parallel_for(
+        0, coeff_count, kParallelGrain, [&](int64_t bgn, int64_t end) {
+          const size_t n = end - bgn;
+          std::vector<uint64_t> chunk(num_modulus * n);
+          for (size_t l = 0; l < num_modulus; ++l) {
+            std::copy_n(src.data() + l * coeff_count + bgn, n,
+                        chunk.data() + l * n);
+          }
+          DoModulusDownRNS(absl::MakeConstSpan(chunk), out.subspan(bgn, n));
+        });
+  }
+
+  template <typename Scalar>
+  void DoModulusDownRNS(absl::Span<const uint64_t> src,
+                        absl::Span<Scalar> out) const {
     // Ref: Bajard et al. "A Full RNS Variant of FV like Somewhat Homomorphic
     // Encryption Schemes" (Section 3.2 & 3.3)
     // NOTE(juhou): Basically the same code in seal/util/rns.cpp instead we
@@ -279,6 +313,9 @@ struct ModulusSwitchHelper::Impl {
   }
 
  private:
+  // Elements per task of the element-wise loops.
+  static constexpr size_t kParallelGrain = 2048;
+
   void Init();
 
   uint32_t base_mod_bitlen_;
@@ -14,24 +14,55 @@
 
 #include "libspu/mpc/cheetah/state.h"
 
+#include <algorithm>
+#include <chrono>
+
 #include "spdlog/spdlog.h"
+#include "yacl/utils/parallel.h"
+#include "yacl/utils/serialize.h"
 
 #include "libspu/mpc/utils/ring_ops.h"
 
 namespace spu::mpc::cheetah {
 
-void CheetahMulState::makeSureCacheSize(FieldType field, int64_t numel) {
-  // NOTE(juhou): make sure the lock is obtained
-  SPU_ENFORCE(numel > 0);
-  if (field_ != field) {
-    // drop all previous cache
-    cached_sze_ = 0;
+CheetahMulState::CheetahMulState(std::unique_ptr<CheetahMul> mul_prot,
+                                 int64_t low_watermark, int64_t high_watermark)
+    : mul_prot_(std::move(mul_prot)),
+      low_watermark_(low_watermark),
+      high_watermark_(high_watermark) {
+  SPU_ENFORCE(low_watermark_ >= 0 && high_watermark_ >= 0,
+              "invalid beaver watermarks low={}, high={}", low_watermark_,
+              high_watermark_);
+  if (high_watermark_ == 0) {
+    high_watermark_ = 2 * low_watermark_;
   }
+  SPU_ENFORCE(high_watermark_ >= low_watermark_,
+              "beaver high watermark {} is below low watermark {}",
+              high_watermark_, low_watermark_);
+}
 
-  if (cached_sze_ >= numel) {
-    return;
+CheetahMulState::~CheetahMulState() {
+  {
+    std::unique_lock guard(lock_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  // NOTE: the worker drains the queued jobs first, the peer runs the very
+  // same jobs and stopping in the middle would leave it blocked.
+  if (worker_.joinable()) {
+    worker_.join();
   }
+  SPDLOG_DEBUG(
+      "CheetahMul beaver cache: hits={}, misses={}, stalls={}, "
+      "stall_ms={}, refilled={}",
+      stats_.hits, stats_.misses, stats_.stalls, stats_.stall_ns / 1000000,
+      stats_.refilled);
+}
 
+std::array<ArrayRef, 3> CheetahMulState::GenerateBeaver(CheetahMul* prot,
+                                                        FieldType field,
+                                                        int64_t numel) {
+  SPU_ENFORCE(numel > 0);
   //  create one batch OLE which then converted to Beavers
   //  Math:
   //   Alice samples rand0 and views it as rand0 = a0||b0
@@ -40,15 +71,14 @@ void CheetahMulState::makeSureCacheSize(FieldType field, int64_t numel) {
   //   Then the beaver (a0, b0, c0) and (a1, b1, c1)
   //   where c0 = a0*b0 + <a0*b1> + <a1*b0>
   //         c1 = a1*b1 + <a0*b1> + <a1*b0>
-  const int rank = mul_prot_->Rank();
-  const size_t ole_sze = mul_prot_->OLEBatchSize();
+  const int rank = prot->Rank();
+  const size_t ole_sze = prot->OLEBatchSize();
   const size_t num_ole = CeilDiv<size_t>(2 * numel, ole_sze);
   const size_t num_beaver = (num_ole * ole_sze) / 2;
   auto rand = ring_rand(field, num_ole * ole_sze);
-  auto cross = mul_prot_->MulOLE(rand, rank == 0);
+  auto cross = prot->MulOLE(rand, rank == 0);
 
-  ArrayRef beaver[3];
-  ArrayRef a0b1, a1b0;
+  std::array<ArrayRef, 3> beaver;
   if (rank == 0) {
     beaver[0] = rand.slice(0, num_beaver);
     beaver[1] = rand.slice(num_beaver, num_beaver * 2);
@@ -56,53 +86,226 @@ void CheetahMulState::makeSureCacheSize(FieldType field, int64_t numel) {
     beaver[0] = rand.slice(num_beaver, num_beaver * 2);
     beaver[1] = rand.slice(0, num_beaver);
   }
-  a0b1 = cross.slice(0, num_beaver);
-  a1b0 = cross.slice(num_beaver, num_beaver * 2);
 
   beaver[2] = ring_add(ring_add(cross.slice(0, num_beaver),
                                 cross.slice(num_beaver, 2 * num_beaver)),
                        ring_mul(beaver[0], beaver[1]));
+  return beaver;
+}
+
+void CheetahMulState::AppendToCache(BeaverCache& cache,
+                                    const std::array<ArrayRef, 3>& beaver) {
+  // NOTE(juhou): make sure the lock is obtained
+  const int64_t num_beaver = beaver[0].numel();
+  if (cache.size == 0) {
+    for (size_t i : {0, 1, 2}) {
+      cache.beaver[i] = beaver[i];
+    }
+    cache.size = num_beaver;
+    return;
+  }
 
-  DISPATCH_ALL_FIELDS(field, "makeSureCacheSize", [&]() {
+  const auto field = beaver[0].eltype().as<Ring2k>()->field();
+  DISPATCH_ALL_FIELDS(field, "AppendToCache", [&]() {
     for (size_t i : {0, 1, 2}) {
-      auto tmp = ring_zeros(field, num_beaver + cached_sze_);
-      ArrayView<const ring2k_t> old_cache(cached_beaver_[i]);
+      auto tmp = ring_zeros(field, num_beaver + cache.size);
+      ArrayView<const ring2k_t> old_cache(cache.beaver[i]);
       ArrayView<const ring2k_t> _beaver(beaver[i]);
       ArrayView<ring2k_t> new_cache(tmp);
       // concate two array
-      pforeach(0, cached_sze_, [&](int64_t j) { new_cache[j] = old_cache[j]; });
+      pforeach(0, cache.size, [&](int64_t j) { new_cache[j] = old_cache[j]; });
       pforeach(0, num_beaver,
-               [&](int64_t j) { new_cache[cached_sze_ + j] = _beaver[j]; });
-      cached_beaver_[i] = tmp;
+               [&](int64_t j) { new_cache[cache.size + j] = _beaver[j]; });
+      cache.beaver[i] = tmp;
     }
   });
 
-  field_ = field;
-  cached_sze_ += num_beaver;
+  cache.size += num_beaver;
+}
+
+void CheetahMulState::EnqueueRefill(FieldType field, int64_t numel) {
+  // NOTE(juhou): make sure the lock is obtained
+  if (!worker_.joinable()) {
+    // NOTE: forked in the same order on both parties since refills are
+    // issued deterministically.
+    refill_prot_ = mul_prot_->Fork();
+    worker_ = std::thread([this] { RefillLoop(); });
+  }
+  caches_[field].pending += numel;
+  jobs_.push_back({field, numel});
+  cv_.notify_all();
+}
+
+void CheetahMulState::RefillLoop() {
+  while (true) {
+    RefillJob job;
+    {
+      std::unique_lock guard(lock_);
+      cv_.wait(guard, [&] { return stop_ || !jobs_.empty(); });
+      if (jobs_.empty()) {
+        return;
+      }
+      job = jobs_.front();
+    }
 
-  SPU_ENFORCE(cached_sze_ >= numel);
+    // The HE OLE exchange runs without holding the lock.
+    std::array<ArrayRef, 3> beaver;
+    try {
+      beaver = GenerateBeaver(refill_prot_.get(), job.field, job.numel);
+    } catch (...) {
+      std::unique_lock guard(lock_);
+      refill_error_ = std::current_exception();
+      jobs_.clear();
+      cv_.notify_all();
+      return;
+    }
+
+    {
+      std::unique_lock guard(lock_);
+      jobs_.pop_front();
+      auto& cache = caches_[job.field];
+      AppendToCache(cache, beaver);
+      cache.pending -= job.numel;
+      stats_.refilled += beaver[0].numel();
+    }
+    cv_.notify_all();
+  }
 }
 
 std::array<ArrayRef, 3> CheetahMulState::TakeCachedBeaver(FieldType field,
                                                           int64_t numel) {
   SPU_ENFORCE(numel > 0);
   std::unique_lock guard(lock_);
-  makeSureCacheSize(field, numel);
+  auto rethrow_refill_error = [&]() {
+    if (refill_error_) {
+      std::rethrow_exception(refill_error_);
+    }
+  };
+  rethrow_refill_error();
+
+  auto& cache = caches_[field];
+  if (cache.size + cache.pending < numel) {
+    // Pending refills are not enough, generate the deficit on the caller's
+    // link after the pending ones, so triples stay in the same order on both
+    // parties.
+    cv_.wait(guard, [&] { return cache.pending == 0 || refill_error_; });
+    rethrow_refill_error();
+    const int64_t deficit = numel - cache.size;
+    if (deficit > 0) {
+      guard.unlock();
+      auto beaver = GenerateBeaver(mul_prot_.get(), field, deficit);
+      guard.lock();
+      AppendToCache(cache, beaver);
+    }
+    stats_.misses += 1;
+  } else if (cache.size < numel) {
+    const auto start = std::chrono::steady_clock::now();
+    cv_.wait(guard, [&] { return cache.size >= numel || refill_error_; });
+    rethrow_refill_error();
+    stats_.stalls += 1;
+    stats_.stall_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+  } else {
+    stats_.hits += 1;
+  }
 
   std::array<ArrayRef, 3> ret;
   for (size_t i : {0, 1, 2}) {
-    SPU_ENFORCE(cached_beaver_[i].numel() >= numel);
-    ret[i] = cached_beaver_[i].slice(0, numel);
-    if (cached_sze_ == numel) {
+    SPU_ENFORCE(cache.beaver[i].numel() >= numel);
+    ret[i] = cache.beaver[i].slice(0, numel);
+    if (cache.size == numel) {
       // empty cache now
-      cached_beaver_[i] = ArrayRef();
+      cache.beaver[i] = ArrayRef();
     } else {
-      cached_beaver_[i] = cached_beaver_[i].slice(numel, cached_sze_);
+      cache.beaver[i] = cache.beaver[i].slice(numel, cache.size);
     }
   }
+  cache.size -= numel;
 
-  cached_sze_ -= numel;
+  const int64_t available = cache.size + cache.pending;
+  if (low_watermark_ > 0 && available < low_watermark_) {
+    EnqueueRefill(field, high_watermark_ - available);
+  }
   return ret;
 }
 
+CheetahMulState::CacheStats CheetahMulState::GetCacheStats() const {
+  std::unique_lock guard(lock_);
+  return stats_;
+}
+
+CheetahOTState::CheetahOTState(
+    const std::shared_ptr<yacl::link::Context>& lctx, size_t parallel,
+    size_t prewarm, FerretOT::PersistOptions persist, size_t pre_expand)
+    : persist_(std::move(persist)), pre_expand_(pre_expand) {
+  if (parallel == 0) {
+    // Hardware differs among parties, agree on the smallest one.
+    const uint128_t local =
+        std::max<uint128_t>(1, std::thread::hardware_concurrency());
+    const auto all_buf = yacl::link::AllGather(
+        lctx, yacl::SerializeUint128(local), "CheetahOT:parallel");
+    uint128_t agreed = local;
+    for (const auto& buf : all_buf) {
+      agreed = std::min(agreed, yacl::DeserializeUint128(buf));
+    }
+    parallel = static_cast<size_t>(agreed);
+  }
+  basic_ot_prot_.resize(parallel);
+
+  if (prewarm > 0) {
+    Communicator comm(lctx);
+    LazyInitWorkers(&comm, std::min(prewarm, parallel), 1);
+  }
+}
+
+void CheetahOTState::LazyInit(Communicator* comm, size_t idx) {
+  SPU_ENFORCE(idx < parallel_size(), "idx={} out-of-bound", idx);
+  std::unique_lock guard(lock_);
+  if (basic_ot_prot_[idx]) {
+    return;
+  }
+  // NOTE: create a seperated link for OT
+  auto _comm = std::make_shared<Communicator>(comm->lctx()->Spawn());
+  basic_ot_prot_[idx] = CreateInstance(std::move(_comm), idx);
+}
+
+CheetahOTState::ProtPtr CheetahOTState::CreateInstance(
+    std::shared_ptr<Communicator> conn, size_t idx) const {
+  auto persist = persist_;
+  if (!persist.dir.empty()) {
+    // Spawned link ids differ among sessions, the index does not.
+    persist.tag = fmt::format("{}ot{}", persist.tag, idx);
+  }
+  auto prot = std::make_shared<BasicOTProtocols>(std::move(conn), persist);
+  if (pre_expand_ > 0) {
+    prot->PreExpand(pre_expand_);
+  }
+  return prot;
+}
+
+size_t CheetahOTState::LazyInitWorkers(Communicator* comm, size_t n,
+                                       size_t min_work_size) {
+  SPU_ENFORCE(min_work_size > 0);
+  const size_t nworker = std::min(parallel_size(), CeilDiv(n, min_work_size));
+
+  std::unique_lock guard(lock_);
+  // Links are spawned in order on both parties, the Ferret setups of new
+  // instances then run concurrently on their own links.
+  std::vector<std::shared_ptr<Communicator>> conns(nworker);
+  for (size_t w = 0; w < nworker; ++w) {
+    if (!basic_ot_prot_[w]) {
+      conns[w] = std::make_shared<Communicator>(comm->lctx()->Spawn());
+    }
+  }
+  yacl::parallel_for(0, nworker, 1, [&](size_t bgn, size_t end) {
+    for (size_t w = bgn; w < end; ++w) {
+      if (conns[w]) {
+        basic_ot_prot_[w] = CreateInstance(conns[w], w);
+      }
+    }
+  });
+  return nworker;
+}
+
 }  // namespace spu::mpc::cheetah
@@ -14,8 +14,13 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <thread>
 
 #include "libspu/mpc/cheetah/arith/cheetah_dot.h"
 #include "libspu/mpc/cheetah/arith/cheetah_mul.h"
@@ -24,41 +29,102 @@
 
 namespace spu::mpc::cheetah {
 
+// Cached beaver triples for small multiplications.
+//
+// A batch of OLEs always produces OLEBatchSize()/2 triples, the surplus is
+// cached per field. When a low watermark is set, the cache is refilled up to
+// the high watermark by a background worker on a dedicated (forked) link, so
+// that the HE OLE exchange is off the critical path of TakeCachedBeaver.
+//
+// NOTE: both parties must issue the same refill jobs in the same order. The
+// refill decision only depends on the number of cached plus pending triples,
+// which evolves identically on both parties, never on the worker progress.
 class CheetahMulState : public State {
+ public:
+  struct CacheStats {
+    // Requests served from the cache without waiting.
+    int64_t hits = 0;
+    // Requests that generate triples synchronously.
+    int64_t misses = 0;
+    // Requests waiting for a pending refill, and the total waiting time.
+    int64_t stalls = 0;
+    int64_t stall_ns = 0;
+    // Triples generated by the background worker.
+    int64_t refilled = 0;
+  };
+
  private:
+  struct BeaverCache {
+    // a[2] = a[0] * a[1]
+    ArrayRef beaver[3];
+    int64_t size = 0;
+    // Triples enqueued to the background worker but not cached yet.
+    int64_t pending = 0;
+  };
+
+  struct RefillJob {
+    FieldType field = FT_INVALID;
+    int64_t numel = 0;
+  };
+
   mutable std::mutex lock_;
-  // a[2] = a[0] * a[1]
-  mutable int64_t cached_sze_{0};
-  FieldType field_{FT_INVALID};
-  ArrayRef cached_beaver_[3];
+  std::condition_variable cv_;
+  std::map<FieldType, BeaverCache> caches_;
+  CacheStats stats_;
 
   std::unique_ptr<CheetahMul> mul_prot_;
 
+  // Number of triples, zero low watermark disables the background refill.
+  int64_t low_watermark_ = 0;
+  int64_t high_watermark_ = 0;
+
+  // Background refill, the worker is started by the first refill job.
+  std::unique_ptr<CheetahMul> refill_prot_;
+  std::deque<RefillJob> jobs_;
+  std::thread worker_;
+  bool stop_ = false;
+  std::exception_ptr refill_error_;
+
+  static std::array<ArrayRef, 3> GenerateBeaver(CheetahMul* prot,
+                                                FieldType field,
+                                                int64_t numel);
+
+  // NOTE(juhou): make sure the lock is obtained
+  static void AppendToCache(BeaverCache& cache,
+                            const std::array<ArrayRef, 3>& beaver);
+
   // NOTE(juhou): make sure the lock is obtained
-  void makeSureCacheSize(FieldType, int64_t numel);
+  void EnqueueRefill(FieldType field, int64_t numel);
 
-  explicit CheetahMulState(std::unique_ptr<CheetahMul> mul_prot)
-      : mul_prot_(std::move(mul_prot)) {}
+  void RefillLoop();
+
+  CheetahMulState(std::unique_ptr<CheetahMul> mul_prot, int64_t low_watermark,
+                  int64_t high_watermark);
 
  public:
   static constexpr char kBindName[] = "CheetahMul";
 
-  explicit CheetahMulState(const std::shared_ptr<yacl::link::Context>& lctx) {
-    mul_prot_ = std::make_unique<CheetahMul>(lctx);
-  }
+  explicit CheetahMulState(const std::shared_ptr<yacl::link::Context>& lctx,
+                           int64_t low_watermark = 0,
+                           int64_t high_watermark = 0)
+      : CheetahMulState(std::make_unique<CheetahMul>(lctx), low_watermark,
+                        high_watermark) {}
 
-  ~CheetahMulState() override = default;
+  ~CheetahMulState() override;
 
   CheetahMul* get() { return mul_prot_.get(); }
 
   bool hasLowCostFork() const override { return true; }
 
   std::unique_ptr<State> fork() override {
-    auto ptr = new CheetahMulState(mul_prot_->Fork());
+    auto ptr = new CheetahMulState(mul_prot_->Fork(), low_watermark_,
+                                   high_watermark_);
     return std::unique_ptr<State>(ptr);
   }
 
   std::array<ArrayRef, 3> TakeCachedBeaver(FieldType field, int64_t num);
+
+  CacheStats GetCacheStats() const;
 };
 
 class CheetahDotState : public State {
@@ -71,8 +137,9 @@ class CheetahDotState : public State {
  public:
   static constexpr char kBindName[] = "CheetahDot";
 
-  explicit CheetahDotState(const std::shared_ptr<yacl::link::Context>& lctx) {
-    dot_prot_ = std::make_unique<CheetahDot>(lctx);
+  explicit CheetahDotState(const std::shared_ptr<yacl::link::Context>& lctx,
+                           size_t cache_size = 0) {
+    dot_prot_ = std::make_unique<CheetahDot>(lctx, cache_size);
   }
 
   ~CheetahDotState() override = default;
@@ -87,6 +154,17 @@ class CheetahDotState : public State {
   }
 };
 
+// A pool of OT instances, each one runs Ferret on its own spawned link.
+//
+// Instance `i` of one party talks to instance `i` of the peer, so both
+// parties must agree on the pool size and on which slice of the input is
+// handled by which instance. The pool size is taken from RuntimeConfig, or
+// the smallest hardware concurrency among the parties.
+//
+// Each instance pre-expands `pre_expand` random COTs per direction right
+// after its Ferret setup. With a persist dir, instance `i` resumes the Ferret
+// state saved by instance `i` of the previous session, so both parties must
+// use the same pool size across sessions.
 class CheetahOTState : public State {
  private:
   using ProtPtr = std::shared_ptr<BasicOTProtocols>;
@@ -94,26 +172,33 @@ class CheetahOTState : public State {
   mutable std::mutex lock_;
   std::vector<ProtPtr> basic_ot_prot_;
 
+  FerretOT::PersistOptions persist_;
+  size_t pre_expand_ = 0;
+
+  // NOTE: runs the Ferret setup on conn, call it in the same order on both
+  // parties.
+  ProtPtr CreateInstance(std::shared_ptr<Communicator> conn,
+                         size_t idx) const;
+
  public:
   static constexpr char kBindName[] = "CheetahOT";
-  static constexpr size_t kParallel = 16;
 
-  explicit CheetahOTState() : basic_ot_prot_(kParallel) {}
+  // `parallel` is the pool size, 0 to agree on the hardware concurrency.
+  // The first `prewarm` instances run their Ferret setup right now.
+  explicit CheetahOTState(const std::shared_ptr<yacl::link::Context>& lctx,
+                          size_t parallel = 0, size_t prewarm = 0,
+                          FerretOT::PersistOptions persist = {},
+                          size_t pre_expand = 0);
 
   ~CheetahOTState() override = default;
 
-  constexpr size_t parallel_size() const { return kParallel; }
+  size_t parallel_size() const { return basic_ot_prot_.size(); }
 
-  void LazyInit(Communicator* comm, size_t idx = 0) {
-    SPU_ENFORCE(idx < parallel_size(), "idx={} out-of-bound", idx);
-    if (basic_ot_prot_[idx]) {
-      return;
-    }
-    std::unique_lock guard(lock_);
-    // NOTE: create a seperated link for OT
-    auto _comm = std::make_shared<Communicator>(comm->lctx()->Spawn());
-    basic_ot_prot_[idx] = std::make_shared<BasicOTProtocols>(std::move(_comm));
-  }
+  void LazyInit(Communicator* comm, size_t idx = 0);
+
+  // Number of instances to work on `n` elements with at least
+  // `min_work_size` elements each, these instances are initialized.
+  size_t LazyInitWorkers(Communicator* comm, size_t n, size_t min_work_size);
 
   std::shared_ptr<BasicOTProtocols> get(size_t idx = 0) {
     SPU_ENFORCE(idx < parallel_size(), "idx={} out-of-bound", idx);
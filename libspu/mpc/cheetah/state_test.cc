@@ -0,0 +1,120 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libspu/mpc/cheetah/state.h"
+
+#include <chrono>
+#include <filesystem>
+
+#include "gtest/gtest.h"
+
+#include "libspu/mpc/utils/ring_ops.h"
+#include "libspu/mpc/utils/simulate.h"
+
+namespace spu::mpc::cheetah::test {
+
+TEST(CheetahMulStateTest, BackgroundRefill) {
+  constexpr size_t kWorldSize = 2;
+  constexpr FieldType kField = FieldType::FM64;
+  constexpr int64_t kRequests = 16;
+
+  std::vector<std::vector<std::array<ArrayRef, 3>>> beavers(kWorldSize);
+  std::vector<CheetahMulState::CacheStats> stats(kWorldSize);
+  int64_t ole_size = 0;
+
+  utils::simulate(kWorldSize, [&](std::shared_ptr<yacl::link::Context> lctx) {
+    const int rank = lctx->Rank();
+    // Cheap to construct, keys are set up lazily on the first OLE.
+    const auto ole = static_cast<int64_t>(CheetahMul(lctx).OLEBatchSize());
+    // One OLE batch gives ole/2 triples, the requests below consume four
+    // times that much, so most of them must come from the refills.
+    CheetahMulState state(lctx, /*low_watermark*/ ole / 4,
+                          /*high_watermark*/ ole);
+    const int64_t numel = ole / 8;
+    for (int64_t i = 0; i < kRequests; ++i) {
+      beavers[rank].push_back(state.TakeCachedBeaver(kField, numel));
+    }
+    stats[rank] = state.GetCacheStats();
+    if (rank == 0) {
+      ole_size = ole;
+    }
+  });
+
+  for (const auto& s : stats) {
+    // Only the very first request generates triples on the caller's link,
+    // later ones are covered by the cache and pending refills.
+    EXPECT_EQ(s.misses, 1);
+    EXPECT_EQ(s.hits + s.stalls, kRequests - 1);
+    EXPECT_GE(s.stall_ns, 0);
+    EXPECT_GE(s.refilled, kRequests * (ole_size / 8) - ole_size / 2);
+  }
+
+  const int64_t kMaxDiff = 1;
+  for (int64_t i = 0; i < kRequests; ++i) {
+    auto a = ring_add(beavers[0][i][0], beavers[1][i][0]);
+    auto b = ring_add(beavers[0][i][1], beavers[1][i][1]);
+    auto c = ring_add(beavers[0][i][2], beavers[1][i][2]);
+    auto expected = ring_mul(a, b);
+    DISPATCH_ALL_FIELDS(kField, "_", [&]() {
+      auto e = ArrayView<ring2k_t>(expected);
+      auto got = ArrayView<ring2k_t>(c);
+      for (int64_t idx = 0; idx < expected.numel(); ++idx) {
+        EXPECT_NEAR(e[idx], got[idx], kMaxDiff);
+      }
+    });
+  }
+}
+
+TEST(CheetahOTStateTest, PreExpandAndPersist) {
+  constexpr size_t kWorldSize = 2;
+  constexpr size_t kPreExpand = 1000;
+
+  FerretOT::PersistOptions persist;
+  persist.dir = (std::filesystem::temp_directory_path() /
+                 fmt::format("spu_cheetah_ot_state_test_{}",
+                             std::chrono::steady_clock::now()
+                                 .time_since_epoch()
+                                 .count()))
+                    .string();
+  persist.key = 0x5eed;
+
+  for (int session : {0, 1}) {
+    utils::simulate(kWorldSize,
+                    [&](std::shared_ptr<yacl::link::Context> lctx) {
+                      // One instance, set up right away.
+                      CheetahOTState state(lctx, 1, 1, persist, kPreExpand);
+                      auto prot = state.get(0);
+                      EXPECT_EQ(prot->GetSenderCOT()->NumPreExpanded(),
+                                kPreExpand);
+                      EXPECT_EQ(prot->GetReceiverCOT()->NumPreExpanded(),
+                                kPreExpand);
+                    });
+
+    // Both directions of both parties saved their state for the next
+    // session.
+    size_t files = 0;
+    for (const auto& entry :
+         std::filesystem::directory_iterator(persist.dir)) {
+      EXPECT_EQ(entry.path().extension(), ".bin") << "session " << session;
+      EXPECT_NE(entry.path().filename().string().find("ot0"),
+                std::string::npos);
+      ++files;
+    }
+    EXPECT_EQ(files, 2 * kWorldSize) << "session " << session;
+  }
+
+  std::filesystem::remove_all(persist.dir);
+}
+
+}  // namespace spu::mpc::cheetah::test
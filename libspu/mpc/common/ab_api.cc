@@ -231,6 +231,8 @@ ArrayRef _Lazy2A(KernelEvalContext* ctx, const ArrayRef& in) {
 #define _ARShiftB(in, bits) ctx->caller()->call("arshift_b", in, bits)
 #define _BitrevB(in, start, end) ctx->caller()->call("bitrev_b", in, start, end)
 #define _MsbA(in) block_par_unary(ctx, "msb_a2b", in)
+#define _MsbAWithBits(in, bits) \
+  block_par_unary_with_size(ctx, "msb_a2b_with_bits", in, bits)
 #define _RandA(size) ctx->caller()->call("rand_a", size)
 #define _RandB(size) ctx->caller()->call("rand_b", size)
 #define _EqualAP(lhs, rhs) block_par_binary(ctx, "equal_ap", lhs, rhs)
@@ -489,6 +491,40 @@ class ABProtMatMulSS : public MatmulKernel {
   }
 };
 
+class ABProtBatchMatMulSS : public BatchMatmulKernel {
+ public:
+  static constexpr char kBindName[] = "batch_mmul_ss";
+
+  Kind kind() const override { return Kind::Dynamic; }
+
+  ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& a, const ArrayRef& b,
+                size_t batch, size_t m, size_t n, size_t k) const override {
+    SPU_TRACE_MPC_DISP(ctx, a, b);
+    const auto lhs = _LAZY_AB ? _2A(a) : a;
+    const auto rhs = _LAZY_AB ? _2A(b) : b;
+    if (ctx->caller()->hasKernel("batch_mmul_aa")) {
+      return ctx->caller()->call("batch_mmul_aa", lhs, rhs, batch, m, n, k);
+    }
+
+    // One matmul after the other.
+    const int64_t lhs_numel = m * k;
+    const int64_t rhs_numel = k * n;
+    const int64_t out_numel = m * n;
+    ArrayRef out;
+    for (int64_t i = 0; i < static_cast<int64_t>(batch); ++i) {
+      auto ret =
+          _MatMulAA(lhs.slice(i * lhs_numel, (i + 1) * lhs_numel),
+                    rhs.slice(i * rhs_numel, (i + 1) * rhs_numel), m, n, k);
+      if (i == 0) {
+        out = ArrayRef(ret.eltype(), batch * out_numel);
+      }
+      std::memcpy(&out.at(i * out_numel), &ret.at(0),
+                  ret.numel() * ret.elsize());
+    }
+    return out;
+  }
+};
+
 class ABProtAndSP : public BinaryKernel {
  public:
   static constexpr char kBindName[] = "and_sp";
@@ -707,6 +743,25 @@ class ABProtMsbS : public UnaryKernel {
   }
 };
 
+// Same as msb_s, but the input is known to fit in `bits` signed bits.
+class ABProtMsbSWithBits : public ShiftKernel {
+ public:
+  static constexpr char kBindName[] = "msb_s_with_bits";
+
+  Kind kind() const override { return Kind::Dynamic; }
+
+  ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in,
+                size_t bits) const override {
+    SPU_TRACE_MPC_DISP(ctx, in, bits);
+    if (_IsA(in) && ctx->caller()->hasKernel("msb_a2b_with_bits")) {
+      auto res = _MsbAWithBits(in, bits);
+      return _LAZY_AB ? res : _B2A(res);
+    }
+    // BShare (or no narrow kernel), nothing to gain from the hint.
+    return ctx->caller()->call("msb_s", in);
+  }
+};
+
 }  // namespace
 
 Type common_type_b(Object* ctx, const Type& a, const Type& b) {
@@ -728,6 +783,7 @@ ArrayRef rand_b(Object* ctx, size_t sz) { return ctx->call("rand_b", sz); }
 SPU_MPC_DEF_UNARY_OP(a2p)
 SPU_MPC_DEF_UNARY_OP(p2a)
 SPU_MPC_DEF_UNARY_OP(msb_a2b)
+SPU_MPC_DEF_UNARY_OP_WITH_SIZE(msb_a2b_with_bits)
 SPU_MPC_DEF_UNARY_OP(not_a)
 SPU_MPC_DEF_BINARY_OP(add_ap)
 SPU_MPC_DEF_BINARY_OP(add_aa)
@@ -776,6 +832,7 @@ void regABKernels(Object* obj) {
   obj->regKernel<ABProtMulSS>();
   obj->regKernel<ABProtMatMulSP>();
   obj->regKernel<ABProtMatMulSS>();
+  obj->regKernel<ABProtBatchMatMulSS>();
   obj->regKernel<ABProtAndSP>();
   obj->regKernel<ABProtAndSS>();
   obj->regKernel<ABProtXorSP>();
@@ -788,6 +845,7 @@ void regABKernels(Object* obj) {
   obj->regKernel<ABProtTruncS>();
   obj->regKernel<ABProtBitrevS>();
   obj->regKernel<ABProtMsbS>();
+  obj->regKernel<ABProtMsbSWithBits>();
 }
 
 }  // namespace spu::mpc
@@ -23,6 +23,7 @@ namespace spu::mpc {
 ArrayRef a2p(Object* ctx, const ArrayRef&);
 ArrayRef p2a(Object* ctx, const ArrayRef&);
 ArrayRef msb_a2b(Object* ctx, const ArrayRef&);
+ArrayRef msb_a2b_with_bits(Object* ctx, const ArrayRef&, size_t);
 
 ArrayRef zero_a(Object* ctx, size_t);
 ArrayRef rand_a(Object* ctx, size_t);
@@ -258,6 +258,40 @@ TEST_P(ArithmeticTest, MatMulAA) {
   });
 }
 
+TEST_P(ArithmeticTest, BatchMatMulAA) {
+  const auto factory = std::get<0>(GetParam());
+  const RuntimeConfig& conf = std::get<1>(GetParam());
+  const size_t npc = std::get<2>(GetParam());
+
+  const int64_t B = 3;
+  const int64_t M = 3;
+  const int64_t K = 4;
+  const int64_t N = 5;
+
+  utils::simulate(npc, [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+    auto obj = factory(conf, lctx);
+
+    /* GIVEN */
+    auto p0 = rand_p(obj.get(), B * M * K);
+    auto p1 = rand_p(obj.get(), B * K * N);
+    auto a0 = p2a(obj.get(), p0);
+    auto a1 = p2a(obj.get(), p1);
+
+    /* WHEN */
+    auto tmp = batch_mmul_ss(obj.get(), a0, a1, B, M, N, K);
+    auto r_aa = a2p(obj.get(), tmp);
+
+    /* THEN */
+    ASSERT_EQ(r_aa.numel(), B * M * N);
+    for (int64_t i = 0; i < B; ++i) {
+      auto r_pp = mmul_pp(obj.get(), p0.slice(i * M * K, (i + 1) * M * K),
+                          p1.slice(i * K * N, (i + 1) * K * N), M, N, K);
+      EXPECT_TRUE(
+          ring_all_equal(r_aa.slice(i * M * N, (i + 1) * M * N), r_pp));
+    }
+  });
+}
+
 TEST_P(ArithmeticTest, NotA) {
   const auto factory = std::get<0>(GetParam());
   const RuntimeConfig& conf = std::get<1>(GetParam());
@@ -662,4 +696,42 @@ TEST_P(ConversionTest, MSB) {
   });
 }
 
+TEST_P(ConversionTest, MSBWithBits) {
+  const auto factory = std::get<0>(GetParam());
+  const RuntimeConfig& conf = std::get<1>(GetParam());
+  const size_t npc = std::get<2>(GetParam());
+  const size_t k = SizeOf(conf.field()) * 8;
+
+  utils::simulate(npc, [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+    auto obj = factory(conf, lctx);
+
+    if (!obj->hasKernel("msb_a2b_with_bits")) {
+      return;
+    }
+
+    for (size_t bits : {1, 7, 12}) {
+      /* GIVEN */
+      // random values fit in `bits` signed bits.
+      auto p0 = ring_arshift(rand_p(obj.get(), kNumel), k - bits);
+      auto a0 = p2a(obj.get(), p0);
+
+      /* WHEN */
+      auto prev = obj->getState<Communicator>()->getStats();
+      auto b1 = msb_a2b_with_bits(obj.get(), a0, bits);
+      auto cost = obj->getState<Communicator>()->getStats() - prev;
+
+      prev = obj->getState<Communicator>()->getStats();
+      auto b2 = msb_a2b(obj.get(), a0);
+      auto full_cost = obj->getState<Communicator>()->getStats() - prev;
+
+      /* THEN */
+      EXPECT_TRUE(ring_all_equal(ring_rshift(p0, k - 1), b2p(obj.get(), b1)))
+          << bits;
+      EXPECT_TRUE(ring_all_equal(b2p(obj.get(), b2), b2p(obj.get(), b1)));
+      EXPECT_LE(cost.latency, full_cost.latency);
+      EXPECT_LT(cost.comm, full_cost.comm);
+    }
+  });
+}
+
 }  // namespace spu::mpc::test
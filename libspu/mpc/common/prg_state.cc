@@ -14,11 +14,52 @@
 
 #include "libspu/mpc/common/prg_state.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "yacl/crypto/tools/prg.h"
 #include "yacl/crypto/utils/rand.h"
+#include "yacl/utils/parallel.h"
 #include "yacl/utils/serialize.h"
 
+#include "libspu/core/type_util.h"
+
 namespace spu::mpc {
+namespace {
+
+constexpr int64_t kBlockBytes = sizeof(uint128_t);
+
+// Counter blocks generated by one task. It is fixed, the chunk i of an output
+// always takes the counters [i * kChunkBlocks, (i + 1) * kChunkBlocks) from
+// the start, so all parties agree whatever their number of threads.
+constexpr int64_t kChunkBlocks = 1 << 15;
+constexpr int64_t kChunkBytes = kChunkBlocks * kBlockBytes;
+
+int64_t numBlocks(size_t nbytes) {
+  return (static_cast<int64_t>(nbytes) + kBlockBytes - 1) / kBlockBytes;
+}
+
+int64_t numChunks(size_t nbytes) {
+  return (static_cast<int64_t>(nbytes) + kChunkBytes - 1) / kChunkBytes;
+}
+
+}  // namespace
+
+uint64_t PrgState::fillAesCtr(uint128_t seed, uint64_t counter,
+                              absl::Span<char> out) {
+  const int64_t nchunks = numChunks(out.size());
+  if (nchunks <= 1) {
+    return yacl::crypto::FillPRand(kAesType, seed, 0, counter, out);
+  }
+
+  yacl::parallel_for(0, nchunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t idx = begin; idx < end; idx++) {
+      yacl::crypto::FillPRand(kAesType, seed, 0, counter + idx * kChunkBlocks,
+                              out.subspan(idx * kChunkBytes, kChunkBytes));
+    }
+  });
+  return counter + numBlocks(out.size());
+}
 
 PrgState::PrgState() {
   pub_seed_ = 0;
@@ -86,16 +127,14 @@ std::pair<ArrayRef, ArrayRef> PrgState::genPrssPair(FieldType field,
 
   uint64_t new_counter = prss_counter_;
   if (!ignore_first) {
-    new_counter = yacl::crypto::FillPRand(
-        kAesType, self_seed_, 0, prss_counter_,
-        absl::MakeSpan(static_cast<char*>(r_self.data()),
-                       r_self.buf()->size()));
+    new_counter = fillAesCtr(self_seed_, prss_counter_,
+                             absl::MakeSpan(static_cast<char*>(r_self.data()),
+                                            r_self.buf()->size()));
   }
   if (!ignore_second) {
-    new_counter = yacl::crypto::FillPRand(
-        kAesType, next_seed_, 0, prss_counter_,
-        absl::MakeSpan(static_cast<char*>(r_next.data()),
-                       r_next.buf()->size()));
+    new_counter = fillAesCtr(next_seed_, prss_counter_,
+                             absl::MakeSpan(static_cast<char*>(r_next.data()),
+                                            r_next.buf()->size()));
   }
 
   if (new_counter == prss_counter_) {
@@ -109,10 +148,47 @@ std::pair<ArrayRef, ArrayRef> PrgState::genPrssPair(FieldType field,
   return std::make_pair(r_self, r_next);
 }
 
+ArrayRef PrgState::genPrssZero(FieldType field, size_t size, bool use_xor) {
+  ArrayRef res(makeType<RingTy>(field), size);
+  auto out = absl::MakeSpan(static_cast<char*>(res.data()), res.buf()->size());
+
+  // Each chunk of r1 is generated into a task local buffer and folded into
+  // r0 while still in cache.
+  const int64_t nchunks = numChunks(out.size());
+  yacl::parallel_for(0, nchunks, 1, [&](int64_t begin, int64_t end) {
+    std::vector<uint128_t> buf(std::min(kChunkBlocks, numBlocks(out.size())));
+    for (int64_t idx = begin; idx < end; idx++) {
+      const uint64_t counter = prss_counter_ + idx * kChunkBlocks;
+      auto r0 = out.subspan(idx * kChunkBytes, kChunkBytes);
+      auto r1 = absl::MakeSpan(reinterpret_cast<char*>(buf.data()), r0.size());
+      yacl::crypto::FillPRand(kAesType, self_seed_, 0, counter, r0);
+      yacl::crypto::FillPRand(kAesType, next_seed_, 0, counter, r1);
+
+      DISPATCH_ALL_FIELDS(field, "genPrssZero", [&]() {
+        auto* x = reinterpret_cast<ring2k_t*>(r0.data());
+        const auto* y = reinterpret_cast<const ring2k_t*>(r1.data());
+        const size_t n = r0.size() / sizeof(ring2k_t);
+        if (use_xor) {
+          for (size_t i = 0; i < n; i++) {
+            x[i] ^= y[i];
+          }
+        } else {
+          for (size_t i = 0; i < n; i++) {
+            x[i] -= y[i];
+          }
+        }
+      });
+    }
+  });
+
+  prss_counter_ += numBlocks(out.size());
+  return res;
+}
+
 ArrayRef PrgState::genPriv(FieldType field, size_t numel) {
   ArrayRef res(makeType<RingTy>(field), numel);
-  priv_counter_ = yacl::crypto::FillPRand(
-      kAesType, priv_seed_, 0, priv_counter_,
+  priv_counter_ = fillAesCtr(
+      priv_seed_, priv_counter_,
       absl::MakeSpan(static_cast<char*>(res.data()), res.buf()->size()));
 
   return res;
@@ -120,8 +196,8 @@ ArrayRef PrgState::genPriv(FieldType field, size_t numel) {
 
 ArrayRef PrgState::genPubl(FieldType field, size_t numel) {
   ArrayRef res(makeType<RingTy>(field), numel);
-  pub_counter_ = yacl::crypto::FillPRand(
-      kAesType, pub_seed_, 0, pub_counter_,
+  pub_counter_ = fillAesCtr(
+      pub_seed_, pub_counter_,
       absl::MakeSpan(static_cast<char*>(res.data()), res.buf()->size()));
 
   return res;
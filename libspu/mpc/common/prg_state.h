@@ -43,6 +43,17 @@ class PrgState : public State {
   uint128_t self_seed_ = 0;
   uint64_t prss_counter_ = 0;
 
+  // AES-CTR from `counter`, returns the next counter. Large outputs are
+  // generated in parallel over fixed counter ranges, so the result does not
+  // depend on the number of threads.
+  static uint64_t fillAesCtr(uint128_t seed, uint64_t counter,
+                             absl::Span<char> out);
+
+  template <typename T>
+  static absl::Span<char> asBytes(absl::Span<T> r) {
+    return {reinterpret_cast<char*>(r.data()), r.size() * sizeof(T)};
+  }
+
  public:
   static constexpr char kBindName[] = "PrgState";
   static constexpr auto kAesType =
@@ -69,16 +80,18 @@ class PrgState : public State {
                                             bool ignore_first = false,
                                             bool ignore_second = false);
 
+  // Generate zero shares r0 - r1 of a PRSS pair, or r0 ^ r1 if `use_xor`,
+  // without materializing r1. Consumes the same counters as genPrssPair.
+  ArrayRef genPrssZero(FieldType field, size_t size, bool use_xor = false);
+
   template <typename T>
   void fillPubl(absl::Span<T> r) {
-    pub_counter_ =
-        yacl::crypto::FillPRand(kAesType, pub_seed_, 0, pub_counter_, r);
+    pub_counter_ = fillAesCtr(pub_seed_, pub_counter_, asBytes(r));
   }
 
   template <typename T>
   void fillPriv(absl::Span<T> r) {
-    priv_counter_ =
-        yacl::crypto::FillPRand(kAesType, priv_seed_, 0, priv_counter_, r);
+    priv_counter_ = fillAesCtr(priv_seed_, priv_counter_, asBytes(r));
   }
 
   template <typename T>
@@ -86,12 +99,10 @@ class PrgState : public State {
                     bool ignore_first = false, bool ignore_second = false) {
     uint64_t new_counter = prss_counter_;
     if (!ignore_first) {
-      new_counter =
-          yacl::crypto::FillPRand(kAesType, self_seed_, 0, prss_counter_, r0);
+      new_counter = fillAesCtr(self_seed_, prss_counter_, asBytes(r0));
     }
     if (!ignore_second) {
-      new_counter =
-          yacl::crypto::FillPRand(kAesType, next_seed_, 0, prss_counter_, r1);
+      new_counter = fillAesCtr(next_seed_, prss_counter_, asBytes(r1));
     }
 
     if (new_counter == prss_counter_) {
@@ -14,9 +14,13 @@
 
 #include "libspu/mpc/common/prg_state.h"
 
+#include <cstring>
+
 #include "gtest/gtest.h"
 #include "yacl/link/link.h"
 
+#include "libspu/core/type_util.h"
+#include "libspu/mpc/utils/ring_ops.h"
 #include "libspu/mpc/utils/simulate.h"
 
 namespace spu::mpc {
@@ -61,4 +65,101 @@ TEST(PrgStateTest, Fork) {
   });
 }
 
+// Large enough to be generated by several threads.
+constexpr size_t kLargeNumel = 100003;
+
+TEST(PrgStateTest, PrssPair) {
+  const size_t npc = 3;
+
+  std::vector<std::pair<ArrayRef, ArrayRef>> pairs(npc);
+  std::vector<ArrayRef> publs(npc);
+  utils::simulate(npc, [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+    PrgState prg(lctx);
+    pairs[lctx->Rank()] = prg.genPrssPair(FM128, kLargeNumel);
+    publs[lctx->Rank()] = prg.genPubl(FM128, kLargeNumel);
+  });
+
+  for (size_t idx = 0; idx < npc; idx++) {
+    const auto& r1 = pairs[idx].second;
+    const auto& next_r0 = pairs[(idx + 1) % npc].first;
+    EXPECT_EQ(std::memcmp(r1.data(), next_r0.data(), r1.buf()->size()), 0);
+    EXPECT_EQ(std::memcmp(publs[idx].data(), publs[0].data(),
+                          publs[0].buf()->size()),
+              0);
+  }
+}
+
+class PrssZeroTest : public ::testing::TestWithParam<FieldType> {};
+
+INSTANTIATE_TEST_SUITE_P(
+    PrgState, PrssZeroTest,
+    testing::Values(FieldType::FM32, FieldType::FM64, FieldType::FM128),
+    [](const testing::TestParamInfo<PrssZeroTest::ParamType>& p) {
+      return fmt::format("{}", p.param);
+    });
+
+TEST_P(PrssZeroTest, Zero) {
+  const size_t npc = 3;
+  const auto field = GetParam();
+
+  std::vector<ArrayRef> arith(npc);
+  std::vector<ArrayRef> boolean(npc);
+  std::vector<std::pair<ArrayRef, ArrayRef>> pairs(npc);
+  utils::simulate(npc, [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+    PrgState prg(lctx);
+    arith[lctx->Rank()] = prg.genPrssZero(field, kLargeNumel);
+    boolean[lctx->Rank()] = prg.genPrssZero(field, kLargeNumel, true);
+    // counters stay in sync with genPrssPair.
+    pairs[lctx->Rank()] = prg.genPrssPair(field, 7);
+  });
+
+  DISPATCH_ALL_FIELDS(field, "_", [&]() {
+    for (size_t i = 0; i < kLargeNumel; i++) {
+      ring2k_t sum = 0;
+      ring2k_t xor_sum = 0;
+      for (size_t idx = 0; idx < npc; idx++) {
+        sum += arith[idx].at<ring2k_t>(i);
+        xor_sum ^= boolean[idx].at<ring2k_t>(i);
+      }
+      EXPECT_EQ(sum, ring2k_t(0));
+      EXPECT_EQ(xor_sum, ring2k_t(0));
+    }
+  });
+
+  for (size_t idx = 0; idx < npc; idx++) {
+    const auto& r1 = pairs[idx].second;
+    const auto& next_r0 = pairs[(idx + 1) % npc].first;
+    EXPECT_EQ(std::memcmp(r1.data(), next_r0.data(), r1.buf()->size()), 0);
+  }
+}
+
+TEST_P(PrssZeroTest, SameAsPair) {
+  const auto field = GetParam();
+  // A chunk is 2^19 bytes, i.e. 2^17 elements of FM32. Cover a single
+  // element, an exact chunk and a ragged tail over several chunks.
+  const std::vector<size_t> sizes = {1, 1 << 17, (5 << 17) + 3};
+
+  utils::simulate(2, [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+    PrgState fused(lctx);
+    // identically seeded, at the same counters.
+    PrgState reference = fused;
+
+    for (size_t size : sizes) {
+      for (bool use_xor : {false, true}) {
+        auto zero = fused.genPrssZero(field, size, use_xor);
+        auto [r0, r1] = reference.genPrssPair(field, size);
+        auto expected = use_xor ? ring_xor(r0, r1) : ring_sub(r0, r1);
+        EXPECT_TRUE(ring_all_equal(zero, expected))
+            << "size " << size << " xor " << use_xor;
+      }
+    }
+
+    // both consumed the same counters.
+    auto [a0, a1] = fused.genPrssPair(field, 7);
+    auto [b0, b1] = reference.genPrssPair(field, 7);
+    EXPECT_TRUE(ring_all_equal(a0, b0));
+    EXPECT_TRUE(ring_all_equal(a1, b1));
+  });
+}
+
 }  // namespace spu::mpc
@@ -58,6 +58,20 @@ class MatmulKernel : public Kernel {
                         size_t k) const = 0;
 };
 
+// `batch` independent matmuls, operands are laid out one after the other.
+class BatchMatmulKernel : public Kernel {
+ public:
+  void evaluate(KernelEvalContext* ctx) const override {
+    ctx->setOutput(proc(ctx, ctx->getParam<ArrayRef>(0),
+                        ctx->getParam<ArrayRef>(1), ctx->getParam<size_t>(2),
+                        ctx->getParam<size_t>(3), ctx->getParam<size_t>(4),
+                        ctx->getParam<size_t>(5)));
+  }
+  virtual ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& a,
+                        const ArrayRef& b, size_t batch, size_t m, size_t n,
+                        size_t k) const = 0;
+};
+
 class Conv2DKernel : public Kernel {
  public:
   void evaluate(KernelEvalContext* ctx) const override {
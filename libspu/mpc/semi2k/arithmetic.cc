@@ -35,8 +35,7 @@ ArrayRef ZeroA::proc(KernelEvalContext* ctx, size_t size) {
   auto* prg_state = ctx->getState<PrgState>();
   const auto field = ctx->getState<Z2kState>()->getDefaultField();
 
-  auto [r0, r1] = prg_state->genPrssPair(field, size);
-  return ring_sub(r0, r1).as(makeType<AShrTy>(field));
+  return prg_state->genPrssZero(field, size).as(makeType<AShrTy>(field));
 }
 
 ArrayRef RandA::proc(KernelEvalContext* ctx, size_t size) {
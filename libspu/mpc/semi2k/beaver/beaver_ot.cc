@@ -0,0 +1,483 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libspu/mpc/semi2k/beaver/beaver_ot.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "yacl/crypto/tools/prg.h"
+
+#include "libspu/core/parallel_utils.h"
+#include "libspu/core/type_util.h"
+#include "libspu/mpc/common/communicator.h"
+#include "libspu/mpc/utils/ring_ops.h"
+
+namespace spu::mpc::semi2k {
+namespace {
+
+// Bounds the ring elements of the OT messages of one Dot exchange.
+constexpr size_t kMaxDotChunkElems = 1UL << 22;
+
+constexpr auto kAesType = yacl::crypto::SymmetricCrypto::CryptoType::AES128_CTR;
+
+size_t RingBits(FieldType field) { return SizeOf(field) * 8; }
+
+// Shares of x0 * y1 + x1 * y0 with Gilboa's multiplication. Each party sends
+// with the bits shifted x as correlations and receives with the bits of y as
+// choices, only the lower `nbits` bits of y are used.
+ArrayRef CrossMul(cheetah::BasicOTProtocols* ot, const ArrayRef& x,
+                  const ArrayRef& y, size_t nbits) {
+  SPU_ENFORCE_EQ(x.numel(), y.numel());
+  const auto field = x.eltype().as<Ring2k>()->field();
+  SPU_ENFORCE(nbits > 0 && nbits <= RingBits(field));
+  const int64_t numel = x.numel();
+
+  auto ret = ring_zeros(field, numel);
+  DISPATCH_ALL_FIELDS(field, "BeaverOt", [&]() {
+    using U = ring2k_t;
+    auto _x = ArrayView<const U>(x);
+    auto _y = ArrayView<const U>(y);
+
+    std::vector<U> corr(numel * nbits);
+    std::vector<uint8_t> choices(numel * nbits);
+    pforeach(0, numel, [&](int64_t i) {
+      for (size_t j = 0; j < nbits; ++j) {
+        corr[i * nbits + j] = _x[i] << j;
+        choices[i * nbits + j] = static_cast<uint8_t>((_y[i] >> j) & 1);
+      }
+    });
+
+    // The sender gets H0 and the receiver H0 + choice * corr.
+    std::vector<U> send_out(corr.size());
+    std::vector<U> recv_out(corr.size());
+    auto send = [&]() {
+      auto sender = ot->GetSenderCOT();
+      sender->SendCAMCC(absl::MakeConstSpan(corr), absl::MakeSpan(send_out));
+      sender->Flush();
+    };
+    auto recv = [&]() {
+      ot->GetReceiverCOT()->RecvCAMCC(absl::MakeConstSpan(choices),
+                                      absl::MakeSpan(recv_out));
+    };
+    if (ot->Rank() == 0) {
+      recv();
+      send();
+    } else {
+      send();
+      recv();
+    }
+
+    auto _ret = ArrayView<U>(ret);
+    pforeach(0, numel, [&](int64_t i) {
+      U acc = 0;
+      for (size_t j = 0; j < nbits; ++j) {
+        acc += recv_out[i * nbits + j] - send_out[i * nbits + j];
+      }
+      _ret[i] = acc;
+    });
+  });
+
+  return ret;
+}
+
+template <typename U>
+void Expand(uint128_t seed, absl::Span<U> out) {
+  yacl::crypto::FillPRand(
+      kAesType, seed, 0, 0,
+      absl::MakeSpan(reinterpret_cast<char*>(out.data()),
+                     out.size() * sizeof(U)));
+}
+
+// Shares of a0 * b1 + a1 * b0 for the M x K matrix a and the K x N matrix b.
+// Each bit j of a[m, k] chooses one COT whose correlation is the whole row
+// b[k, :] << j. The COT only gives 128 bits random seeds, the N elements
+// messages are expanded from them and the sender sends their difference
+// minus the correlation. It takes M * K * nbits COTs instead of one per
+// (m, k, n) and bit.
+ArrayRef CrossMatMul(cheetah::BasicOTProtocols* ot, Communicator* conn,
+                     const ArrayRef& a, const ArrayRef& b, size_t M, size_t N,
+                     size_t K) {
+  const auto field = a.eltype().as<Ring2k>()->field();
+  const size_t nbits = RingBits(field);
+  const size_t rows_per_chunk = std::max<size_t>(
+      1, kMaxDotChunkElems / std::max<size_t>(1, K * N * nbits));
+
+  auto ret = ring_zeros(field, M * N);
+  DISPATCH_ALL_FIELDS(field, "BeaverOt", [&]() {
+    using U = ring2k_t;
+    auto _a = ArrayView<const U>(a);
+    auto _b = ArrayView<const U>(b);
+    auto _ret = ArrayView<U>(ret);
+
+    for (size_t m0 = 0; m0 < M; m0 += rows_per_chunk) {
+      const size_t rows = std::min(rows_per_chunk, M - m0);
+      // COT (r * K + k) * nbits + j carries bit j of a[m0 + r, k].
+      const size_t num_cot = rows * K * nbits;
+      std::vector<uint8_t> choices(num_cot);
+      pforeach(0, rows * K, [&](int64_t rk) {
+        const U v = _a[m0 * K + rk];
+        for (size_t j = 0; j < nbits; ++j) {
+          choices[rk * nbits + j] = static_cast<uint8_t>((v >> j) & 1);
+        }
+      });
+
+      // Random OT: the sender gets the seeds s0 and s1 = s0 + delta, the
+      // receiver s_choice.
+      auto delta = ring_rand(FM128, num_cot);
+      std::vector<uint128_t> seeds(num_cot);
+      std::vector<uint128_t> chosen(num_cot);
+      auto send = [&]() {
+        auto sender = ot->GetSenderCOT();
+        sender->SendCAMCC(
+            absl::MakeConstSpan(static_cast<const uint128_t*>(delta.data()),
+                                num_cot),
+            absl::MakeSpan(seeds));
+        sender->Flush();
+      };
+      auto recv = [&]() {
+        ot->GetReceiverCOT()->RecvCAMCC(absl::MakeConstSpan(choices),
+                                        absl::MakeSpan(chosen));
+      };
+      if (ot->Rank() == 0) {
+        recv();
+        send();
+      } else {
+        send();
+        recv();
+      }
+
+      // The sender keeps -sum PRG(s0) and sends PRG(s1) - PRG(s0) - corr, the
+      // receiver gets PRG(s0) + choice * corr out of it.
+      auto _delta = ArrayView<const uint128_t>(delta);
+      std::vector<U> msg(num_cot * N);
+      std::vector<U> acc(rows * K * N);
+      pforeach(0, rows * K, [&](int64_t rk) {
+        const size_t k = rk % K;
+        std::vector<U> p0(N);
+        std::vector<U> p1(N);
+        U* own = &acc[rk * N];
+        for (size_t j = 0; j < nbits; ++j) {
+          const size_t i = rk * nbits + j;
+          Expand(seeds[i], absl::MakeSpan(p0));
+          Expand(seeds[i] + _delta[i], absl::MakeSpan(p1));
+          U* out = &msg[i * N];
+          for (size_t n = 0; n < N; ++n) {
+            out[n] = p1[n] - p0[n] - (_b[k * N + n] << j);
+            own[n] -= p0[n];
+          }
+        }
+      });
+
+      conn->sendAsync<U>(conn->nextRank(), absl::MakeConstSpan(msg),
+                         "BeaverOt:Dot");
+      auto peer = conn->recv<U>(conn->nextRank(), "BeaverOt:Dot");
+      SPU_ENFORCE_EQ(peer.size(), msg.size());
+
+      pforeach(0, rows * K, [&](int64_t rk) {
+        std::vector<U> q(N);
+        U* own = &acc[rk * N];
+        for (size_t j = 0; j < nbits; ++j) {
+          const size_t i = rk * nbits + j;
+          Expand(chosen[i], absl::MakeSpan(q));
+          const U* t = &peer[i * N];
+          for (size_t n = 0; n < N; ++n) {
+            own[n] += choices[i] ? q[n] - t[n] : q[n];
+          }
+        }
+      });
+
+      pforeach(0, rows * N, [&](int64_t rn) {
+        const size_t r = rn / N;
+        const size_t n = rn % N;
+        U sum = 0;
+        for (size_t k = 0; k < K; ++k) {
+          sum += acc[(r * K + k) * N + n];
+        }
+        _ret[(m0 + r) * N + n] += sum;
+      });
+    }
+  });
+
+  return ret;
+}
+
+ArrayRef Concat(const ArrayRef& lhs, const ArrayRef& rhs) {
+  if (lhs.numel() == 0) {
+    return rhs;
+  }
+  SPU_ENFORCE(lhs.eltype() == rhs.eltype());
+  SPU_ENFORCE(lhs.isCompact() && rhs.isCompact());
+
+  ArrayRef ret(lhs.eltype(), lhs.numel() + rhs.numel());
+  std::memcpy(ret.data(), lhs.data(), lhs.numel() * lhs.elsize());
+  std::memcpy(static_cast<std::byte*>(ret.data()) + lhs.numel() * lhs.elsize(),
+              rhs.data(), rhs.numel() * rhs.elsize());
+  return ret;
+}
+
+Beaver::Triple Concat(const Beaver::Triple& lhs, const Beaver::Triple& rhs) {
+  return {Concat(std::get<0>(lhs), std::get<0>(rhs)),
+          Concat(std::get<1>(lhs), std::get<1>(rhs)),
+          Concat(std::get<2>(lhs), std::get<2>(rhs))};
+}
+
+Beaver::Triple Slice(const Beaver::Triple& t, int64_t start, int64_t stop) {
+  return {std::get<0>(t).slice(start, stop), std::get<1>(t).slice(start, stop),
+          std::get<2>(t).slice(start, stop)};
+}
+
+}  // namespace
+
+BeaverOt::Channel::Channel(std::shared_ptr<yacl::link::Context> link,
+                           bool background)
+    : lctx(std::move(link)) {
+  fg_lctx = lctx->Spawn();
+  if (background) {
+    bg_lctx = lctx->Spawn();
+  }
+}
+
+BeaverOt::Channel::~Channel() {
+  if (pending.valid()) {
+    pending.wait();
+  }
+}
+
+BeaverOt::BeaverOt(std::shared_ptr<yacl::link::Context> lctx, Options ops)
+    : ops_(ops) {
+  SPU_ENFORCE(lctx->WorldSize() == 2,
+              "BeaverOt only works for 2 parties, got {}", lctx->WorldSize());
+  SPU_ENFORCE(!ops_.background || ops_.batch_size > 0,
+              "background generation requires batch_size > 0");
+
+  channel_ = std::make_unique<Channel>(std::move(lctx), ops_.background);
+}
+
+BeaverOt::BeaverOt(Options ops, std::unique_ptr<Channel> channel,
+                   std::shared_ptr<ChannelPool> home, size_t slot)
+    : ops_(ops),
+      channel_(std::move(channel)),
+      home_(std::move(home)),
+      slot_(slot) {}
+
+BeaverOt::~BeaverOt() {
+  if (home_ == nullptr) {
+    return;
+  }
+  // The pending job, if any, is waited by the next borrower.
+  std::lock_guard<std::mutex> lock(home_->mu);
+  home_->slots[slot_] = std::move(channel_);
+}
+
+cheetah::BasicOTProtocols* BeaverOt::ForegroundOt() {
+  if (!channel_->fg_ot) {
+    channel_->fg_ot = std::make_unique<cheetah::BasicOTProtocols>(
+        std::make_shared<Communicator>(channel_->fg_lctx));
+  }
+  return channel_->fg_ot.get();
+}
+
+cheetah::BasicOTProtocols* BeaverOt::BackgroundOt() {
+  if (!channel_->bg_ot) {
+    channel_->bg_ot = std::make_unique<cheetah::BasicOTProtocols>(
+        std::make_shared<Communicator>(channel_->bg_lctx));
+  }
+  return channel_->bg_ot.get();
+}
+
+BeaverOt::Triple BeaverOt::Generate(cheetah::BasicOTProtocols* ot, Kind kind,
+                                    FieldType field, size_t size) {
+  if (kind == Kind::And) {
+    auto [a, b, c] = ot->AndTriple(field, size, RingBits(field));
+    const auto ty = makeType<RingTy>(field);
+    return {a.as(ty), b.as(ty), c.as(ty)};
+  }
+
+  auto a = ring_rand(field, size);
+  auto b = ring_rand(field, size);
+  auto c = ring_mul(a, b);
+  ring_add_(c, CrossMul(ot, a, b, RingBits(field)));
+  return {a, b, c};
+}
+
+void BeaverOt::WaitBackground() {
+  auto& ch = *channel_;
+  if (!ch.pending.valid()) {
+    return;
+  }
+  ch.pending.get();
+  if (ch.produced.has_value()) {
+    auto& [key, triple] = *ch.produced;
+    ch.cache[key] = Concat(ch.cache[key], triple);
+    ch.produced.reset();
+  }
+}
+
+BeaverOt::Triple BeaverOt::Take(Kind kind, FieldType field, size_t size) {
+  WaitBackground();
+  if (ops_.batch_size == 0) {
+    return Generate(ForegroundOt(), kind, field, size);
+  }
+
+  // Both parties see the same requests, so the cache and the jobs below
+  // evolve identically on both sides.
+  const Key key{kind, field};
+  auto& cached = channel_->cache[key];
+  const size_t avail = std::get<0>(cached).numel();
+  if (avail < size) {
+    const size_t n = (size - avail + ops_.batch_size - 1) / ops_.batch_size *
+                     ops_.batch_size;
+    cached = Concat(cached, Generate(ForegroundOt(), kind, field, n));
+  }
+
+  const int64_t total = std::get<0>(cached).numel();
+  auto ret = Slice(cached, 0, size);
+  cached = Slice(cached, size, total);
+
+  if (ops_.background &&
+      static_cast<size_t>(total) - size < ops_.batch_size / 2) {
+    // Only touches the channel, which outlives the job.
+    auto* ch = channel_.get();
+    auto* ot = BackgroundOt();
+    const size_t batch_size = ops_.batch_size;
+    ch->pending = std::async(std::launch::async, [ch, ot, key, batch_size]() {
+      ch->produced.emplace(
+          key, Generate(ot, key.first, key.second, batch_size));
+    });
+  }
+
+  return ret;
+}
+
+BeaverOt::Triple BeaverOt::Mul(FieldType field, size_t size) {
+  return Take(Kind::Mul, field, size);
+}
+
+BeaverOt::Triple BeaverOt::And(FieldType field, size_t size) {
+  return Take(Kind::And, field, size);
+}
+
+BeaverOt::Triple BeaverOt::Dot(FieldType field, size_t M, size_t N,
+                               size_t K) {
+  auto a = ring_rand(field, M * K);
+  auto b = ring_rand(field, K * N);
+  auto c = ring_mmul(a, b, M, N, K);
+
+  auto* ot = ForegroundOt();
+  Communicator conn(channel_->fg_lctx);
+  ring_add_(c, CrossMatMul(ot, &conn, a, b, M, N, K));
+  return {a, b, c};
+}
+
+// r = sum_i 2^i * r_i for shared random bits r_i, any bit slice of r is then
+// a local linear combination of the bits.
+BeaverOt::Pair BeaverOt::Trunc(FieldType field, size_t size, size_t bits) {
+  const size_t k = RingBits(field);
+  SPU_ENFORCE(bits < k);
+  auto rbits = ForegroundOt()->RandBits(field, size * k);
+
+  auto r = ring_zeros(field, size);
+  auto rb = ring_zeros(field, size);
+  DISPATCH_ALL_FIELDS(field, "BeaverOt", [&]() {
+    using U = ring2k_t;
+    auto _bits = ArrayView<const U>(rbits);
+    auto _r = ArrayView<U>(r);
+    auto _rb = ArrayView<U>(rb);
+    pforeach(0, size, [&](int64_t idx) {
+      const auto* bit = &_bits[idx * k];
+      U x = 0;
+      U y = 0;
+      for (size_t i = 0; i < k; ++i) {
+        x += bit[i] << i;
+      }
+      // Arithmetic shift, the msb is extended.
+      for (size_t i = bits; i < k; ++i) {
+        y += bit[i] << (i - bits);
+      }
+      y -= (bit[k - 1] << (k - 1 - bits)) << 1;
+      _r[idx] = x;
+      _rb[idx] = y;
+    });
+  });
+
+  return {r, rb};
+}
+
+BeaverOt::Triple BeaverOt::TruncPr(FieldType field, size_t size,
+                                   size_t bits) {
+  const size_t k = RingBits(field);
+  SPU_ENFORCE(bits + 1 < k);
+  auto rbits = ForegroundOt()->RandBits(field, size * k);
+
+  auto r = ring_zeros(field, size);
+  auto rc = ring_zeros(field, size);
+  auto rb = ring_zeros(field, size);
+  DISPATCH_ALL_FIELDS(field, "BeaverOt", [&]() {
+    using U = ring2k_t;
+    auto _bits = ArrayView<const U>(rbits);
+    auto _r = ArrayView<U>(r);
+    auto _rc = ArrayView<U>(rc);
+    auto _rb = ArrayView<U>(rb);
+    pforeach(0, size, [&](int64_t idx) {
+      const auto* bit = &_bits[idx * k];
+      U x = 0;
+      U y = 0;
+      for (size_t i = 0; i < k; ++i) {
+        x += bit[i] << i;
+      }
+      for (size_t i = bits; i + 1 < k; ++i) {
+        y += bit[i] << (i - bits);
+      }
+      _r[idx] = x;
+      _rc[idx] = y;
+      _rb[idx] = bit[k - 1];
+    });
+  });
+
+  return {r, rc, rb};
+}
+
+ArrayRef BeaverOt::RandBit(FieldType field, size_t size) {
+  return ForegroundOt()->RandBits(field, size).as(makeType<RingTy>(field));
+}
+
+std::unique_ptr<Beaver> BeaverOt::Spawn() {
+  std::unique_ptr<Channel> channel;
+  size_t slot = 0;
+  {
+    std::lock_guard<std::mutex> lock(children_->mu);
+    auto& slots = children_->slots;
+    while (slot < slots.size() && slots[slot] == nullptr) {
+      ++slot;
+    }
+    if (slot < slots.size()) {
+      channel = std::move(slots[slot]);
+    } else {
+      slots.emplace_back();
+    }
+  }
+  if (channel == nullptr) {
+    channel = std::make_unique<Channel>(channel_->lctx->Spawn(),
+                                        ops_.background);
+  }
+  return std::unique_ptr<BeaverOt>(
+      new BeaverOt(ops_, std::move(channel), children_, slot));
+}
+
+}  // namespace spu::mpc::semi2k
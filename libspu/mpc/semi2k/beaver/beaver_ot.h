@@ -0,0 +1,136 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "yacl/link/context.h"
+
+#include "libspu/mpc/cheetah/ot/basic_ot_prot.h"
+#include "libspu/mpc/semi2k/beaver/beaver_interface.h"
+
+namespace spu::mpc::semi2k {
+
+// Beaver implementation without any trusted party, the two computing parties
+// generate the correlations between themselves with Ferret COT.
+//
+// Products of shares are computed with Gilboa's OT based multiplication, one
+// COT per bit of the multiplier. A dot product takes one COT per bit of each
+// lhs element, with the whole rhs row as the correlation. Truncation pairs
+// and random bits are built from shared random bits.
+//
+// Two parties only.
+class BeaverOt final : public Beaver {
+ public:
+  struct Options {
+    // Mul/And triples are generated at least `batch_size` at a time, the
+    // surplus serves later requests. 0 disables batching.
+    size_t batch_size = 0;
+    // Refill the surplus on a separate link and thread, in the shadow of the
+    // online computation. Requires batch_size > 0.
+    bool background = false;
+  };
+
+ private:
+  enum class Kind { Mul, And };
+
+  using Key = std::pair<Kind, FieldType>;
+
+  // The links of a beaver with their OT instances and triples cache. Ferret
+  // setup is interactive, deferred to the first use.
+  struct Channel {
+    // Links are spawned at construction, so both parties agree on them.
+    std::shared_ptr<yacl::link::Context> lctx;
+
+    std::shared_ptr<yacl::link::Context> fg_lctx;
+
+    std::shared_ptr<yacl::link::Context> bg_lctx;
+
+    std::unique_ptr<cheetah::BasicOTProtocols> fg_ot;
+
+    std::unique_ptr<cheetah::BasicOTProtocols> bg_ot;
+
+    std::map<Key, Triple> cache;
+
+    // At most one background job is in flight.
+    std::future<void> pending;
+
+    std::optional<std::pair<Key, Triple>> produced;
+
+    Channel(std::shared_ptr<yacl::link::Context> link, bool background);
+
+    ~Channel();
+  };
+
+  // Channels of the spawned beavers, a null slot is in use. A spawned beaver
+  // takes the lowest free slot and gives its channel back at destruction, so
+  // later forks reuse the Ferret setup instead of paying a new one. Forks are
+  // created and destroyed in program order, both parties pick the same slot.
+  struct ChannelPool {
+    std::mutex mu;
+    std::vector<std::unique_ptr<Channel>> slots;
+  };
+
+  Options ops_;
+
+  std::unique_ptr<Channel> channel_;
+
+  // Where channel_ is returned, null for a root beaver.
+  std::shared_ptr<ChannelPool> home_;
+  size_t slot_ = 0;
+
+  std::shared_ptr<ChannelPool> children_ = std::make_shared<ChannelPool>();
+
+  BeaverOt(Options ops, std::unique_ptr<Channel> channel,
+           std::shared_ptr<ChannelPool> home, size_t slot);
+
+  cheetah::BasicOTProtocols* ForegroundOt();
+
+  cheetah::BasicOTProtocols* BackgroundOt();
+
+  static Triple Generate(cheetah::BasicOTProtocols* ot, Kind kind,
+                         FieldType field, size_t size);
+
+  Triple Take(Kind kind, FieldType field, size_t size);
+
+  void WaitBackground();
+
+ public:
+  explicit BeaverOt(std::shared_ptr<yacl::link::Context> lctx,
+                    Options ops = {});
+
+  ~BeaverOt() override;
+
+  Triple Mul(FieldType field, size_t size) override;
+
+  Triple And(FieldType field, size_t size) override;
+
+  Triple Dot(FieldType field, size_t M, size_t N, size_t K) override;
+
+  Pair Trunc(FieldType field, size_t size, size_t bits) override;
+
+  Triple TruncPr(FieldType field, size_t size, size_t bits) override;
+
+  ArrayRef RandBit(FieldType field, size_t size) override;
+
+  std::unique_ptr<Beaver> Spawn() override;
+};
+
+}  // namespace spu::mpc::semi2k
@@ -19,6 +19,7 @@
 
 #include "libspu/core/type_util.h"
 #include "libspu/core/xt_helper.h"
+#include "libspu/mpc/semi2k/beaver/beaver_ot.h"
 #include "libspu/mpc/semi2k/beaver/beaver_tfp.h"
 #include "libspu/mpc/semi2k/beaver/beaver_ttp.h"
 #include "libspu/mpc/semi2k/beaver/ttp_server/beaver_server.h"
@@ -84,6 +85,33 @@ INSTANTIATE_TEST_SUITE_P(
                          std::get<1>(p.param), std::get<2>(p.param));
     });
 
+// 2PC only.
+INSTANTIATE_TEST_SUITE_P(
+    BeaverOtTest, BeaverTest,
+    testing::Combine(
+        testing::Values(std::make_pair(
+                            [](const std::shared_ptr<yacl::link::Context>& lctx,
+                               const BeaverTtp::Options&) {
+                              return std::make_unique<BeaverOt>(lctx);
+                            },
+                            "BeaverOt"),
+                        std::make_pair(
+                            [](const std::shared_ptr<yacl::link::Context>& lctx,
+                               const BeaverTtp::Options&) {
+                              BeaverOt::Options ops;
+                              ops.batch_size = 4096;
+                              ops.background = true;
+                              return std::make_unique<BeaverOt>(lctx, ops);
+                            },
+                            "BeaverOtBatched")),
+        testing::Values(2),
+        testing::Values(FieldType::FM32, FieldType::FM64, FieldType::FM128),
+        testing::Values(0)),  // max beaver diff,
+    [](const testing::TestParamInfo<BeaverTest::ParamType>& p) {
+      return fmt::format("{}x{}x{}", std::get<0>(p.param).second,
+                         std::get<1>(p.param), std::get<2>(p.param));
+    });
+
 TEST_P(BeaverTest, Mul_large) {
   const auto factory = std::get<0>(GetParam()).first;
   const size_t kWorldSize = std::get<1>(GetParam());
@@ -406,4 +434,59 @@ TEST_P(BeaverTest, Randbit) {
   });
 }
 
+TEST(BeaverOtTest, Batched) {
+  const FieldType kField = FieldType::FM64;
+  const std::vector<size_t> kSizes = {100, 3000, 1, 5000, 2048};
+
+  BeaverOt::Options ops;
+  ops.batch_size = 2048;
+  ops.background = true;
+
+  std::vector<std::vector<Beaver::Triple>> triples(2);
+  utils::simulate(2, [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+    BeaverOt beaver(lctx, ops);
+    for (size_t size : kSizes) {
+      // Interleave the kinds, each has a cache of its own.
+      triples[lctx->Rank()].push_back(beaver.Mul(kField, size));
+      (void)beaver.And(kField, size);
+    }
+    yacl::link::Barrier(lctx, "BeaverUT");
+  });
+
+  for (size_t i = 0; i < kSizes.size(); ++i) {
+    const auto& [a0, b0, c0] = triples[0][i];
+    const auto& [a1, b1, c1] = triples[1][i];
+    EXPECT_EQ(a0.numel(), kSizes[i]);
+    EXPECT_EQ(ring_mul(ring_add(a0, a1), ring_add(b0, b1)), ring_add(c0, c1));
+  }
+}
+
+TEST(BeaverOtTest, Spawn) {
+  const FieldType kField = FieldType::FM64;
+  const size_t M = 3;
+  const size_t N = 5;
+  const size_t K = 7;
+
+  std::vector<std::vector<Beaver::Triple>> triples(2);
+  utils::simulate(2, [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+    BeaverOt beaver(lctx);
+    for (int round = 0; round < 2; ++round) {
+      // The second round takes over the channels of the first one.
+      auto sub0 = beaver.Spawn();
+      auto sub1 = beaver.Spawn();
+      triples[lctx->Rank()].push_back(sub1->Dot(kField, M, N, K));
+      triples[lctx->Rank()].push_back(sub0->Dot(kField, M, N, K));
+    }
+    triples[lctx->Rank()].push_back(beaver.Dot(kField, M, N, K));
+    yacl::link::Barrier(lctx, "BeaverUT");
+  });
+
+  for (size_t i = 0; i < triples[0].size(); ++i) {
+    const auto& [a0, b0, c0] = triples[0][i];
+    const auto& [a1, b1, c1] = triples[1][i];
+    EXPECT_EQ(ring_mmul(ring_add(a0, a1), ring_add(b0, b1), M, N, K),
+              ring_add(c0, c1));
+  }
+}
+
 }  // namespace spu::mpc::semi2k
@@ -102,9 +102,8 @@ ArrayRef ZeroB::proc(KernelEvalContext* ctx, size_t size) {
   // TODO: semantically, we should not use field for boolean share.
   const auto field = ctx->getState<Z2kState>()->getDefaultField();
   auto* prg_state = ctx->getState<PrgState>();
-  auto [r0, r1] = prg_state->genPrssPair(field, size);
 
-  return makeBShare(ring_xor(r0, r1), field, 0);
+  return makeBShare(prg_state->genPrssZero(field, size, true), field, 0);
 }
 
 ArrayRef B2P::proc(KernelEvalContext* ctx, const ArrayRef& in) const {
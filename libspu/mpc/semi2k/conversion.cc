@@ -14,6 +14,10 @@
 
 #include "libspu/mpc/semi2k/conversion.h"
 
+#include <algorithm>
+
+#include "absl/numeric/bits.h"
+
 #include "libspu/core/trace.h"
 #include "libspu/core/vectorize.h"
 #include "libspu/mpc/common/ab_api.h"
@@ -161,4 +165,43 @@ ArrayRef MsbA2B::proc(KernelEvalContext* ctx, const ArrayRef& in) const {
   return xor_bb(obj, rshift_b(obj, xor_bb(obj, bshrs[0], bshrs[1]), k), carry);
 }
 
+ArrayRef MsbA2BWithBits::proc(KernelEvalContext* ctx, const ArrayRef& in,
+                              size_t bits) const {
+  SPU_TRACE_MPC_LEAF(ctx, in, bits);
+
+  const auto field = in.eltype().as<AShrTy>()->field();
+  auto* comm = ctx->getState<Communicator>();
+  auto* obj = ctx->caller();
+
+  SPU_ENFORCE(comm->getWorldSize() == 2, "only support for 2PC, got={}",
+              comm->getWorldSize());
+
+  // carry_out halves the width on each level, round it up to power of 2.
+  const size_t width = std::max<size_t>(absl::bit_ceil(bits), 8);
+  if (width >= SizeOf(field) * 8 || in.numel() == 0) {
+    return msb_a2b(obj, in);
+  }
+
+  // Since in = m + n fits in `width` signed bits, its msb is the bit
+  // (width-1) of m + n, that is
+  //   m[width-1] ^ n[width-1] ^ carry_out(m, n, width-1)
+  // The lowest (width-1) bits are shifted left by one, so the carry out of
+  // the whole `width` bits is the carry we want.
+  std::vector<ArrayRef> lo;
+  std::vector<ArrayRef> hi;
+  for (size_t idx = 0; idx < comm->getWorldSize(); idx++) {
+    auto l = ring_zeros(field, in.numel());
+    auto h = ring_zeros(field, in.numel());
+    if (idx == comm->getRank()) {
+      l = ring_bitmask(ring_lshift(in, 1), 0, width);
+      h = ring_bitmask(ring_rshift(in, width - 1), 0, 1);
+    }
+    lo.push_back(l.as(makeType<BShrTy>(field, width)));
+    hi.push_back(h.as(makeType<BShrTy>(field, 1)));
+  }
+
+  ArrayRef carry = common::carry_out(obj, lo[0], lo[1], width);
+  return xor_bb(obj, xor_bb(obj, hi[0], hi[1]), carry);
+}
+
 }  // namespace spu::mpc::semi2k
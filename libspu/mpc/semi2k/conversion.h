@@ -94,4 +94,24 @@ class MsbA2B : public UnaryKernel {
   ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in) const override;
 };
 
+// Msb of an AShare which is known to fit in `bits` signed bits, the carry
+// circuit only runs over the lowest bits instead of the whole ring.
+// Note: current only for 2PC.
+class MsbA2BWithBits : public ShiftKernel {
+ public:
+  static constexpr char kBindName[] = "msb_a2b_with_bits";
+
+  Kind kind() const override { return Kind::Dynamic; }
+
+  ce::CExpr latency() const override {
+    // upper bound, same as msb_a2b
+    return Log(ce::K()) + 1;
+  }
+
+  ce::CExpr comm() const override { return ce::K() * 5; }
+
+  ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in,
+                size_t bits) const override;
+};
+
 }  // namespace spu::mpc::semi2k
@@ -76,6 +76,7 @@ std::unique_ptr<Object> makeSemi2kProtocol(
 
   if (lctx->WorldSize() == 2) {
     obj->regKernel<semi2k::MsbA2B>();
+    obj->regKernel<semi2k::MsbA2BWithBits>();
   }
   // obj->regKernel<semi2k::B2A>();
   obj->regKernel<semi2k::B2A_Randbit>();
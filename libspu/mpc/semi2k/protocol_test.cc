@@ -53,6 +53,15 @@ std::unique_ptr<Object> makeTTPSemi2kProtocol(
   return makeSemi2kProtocol(ttp_rt, lctx);
 }
 
+std::unique_ptr<Object> makeOTSemi2kProtocol(
+    const RuntimeConfig& rt, const std::shared_ptr<yacl::link::Context>& lctx) {
+  RuntimeConfig ot_rt = rt;
+  ot_rt.set_beaver_type(RuntimeConfig_BeaverType_SilentOT);
+  ot_rt.mutable_ot_beaver_config()->set_batch_size(4096);
+
+  return makeSemi2kProtocol(ot_rt, lctx);
+}
+
 }  // namespace
 
 INSTANTIATE_TEST_SUITE_P(
@@ -69,6 +78,20 @@ INSTANTIATE_TEST_SUITE_P(
                          std::get<1>(p.param).field(), std::get<2>(p.param));
     });
 
+// SilentOT beaver works for 2PC only.
+INSTANTIATE_TEST_SUITE_P(
+    Semi2kOT, ApiTest,
+    testing::Combine(testing::Values(CreateObjectFn(makeOTSemi2kProtocol,
+                                                    "ot")),          //
+                     testing::Values(makeConfig(FieldType::FM32),    //
+                                     makeConfig(FieldType::FM64),    //
+                                     makeConfig(FieldType::FM128)),  //
+                     testing::Values(2)),                            //
+    [](const testing::TestParamInfo<ApiTest::ParamType>& p) {
+      return fmt::format("{}x{}x{}", std::get<0>(p.param).name(),
+                         std::get<1>(p.param).field(), std::get<2>(p.param));
+    });
+
 INSTANTIATE_TEST_SUITE_P(
     Semi2k, ArithmeticTest,
     testing::Combine(testing::Values(CreateObjectFn(makeSemi2kProtocol, "tfp"),
@@ -18,6 +18,7 @@
 
 #include "libspu/mpc/common/communicator.h"
 #include "libspu/mpc/semi2k/beaver/beaver_interface.h"
+#include "libspu/mpc/semi2k/beaver/beaver_ot.h"
 #include "libspu/mpc/semi2k/beaver/beaver_tfp.h"
 #include "libspu/mpc/semi2k/beaver/beaver_ttp.h"
 
@@ -46,6 +47,11 @@ class Semi2kState : public State {
       ops.session_id = sid.empty() ? lctx->Id() : sid;
       // TODO: TLS & brpc options.
       beaver_ = std::make_unique<semi2k::BeaverTtp>(lctx, std::move(ops));
+    } else if (conf.beaver_type() == RuntimeConfig_BeaverType_SilentOT) {
+      semi2k::BeaverOt::Options ops;
+      ops.batch_size = conf.ot_beaver_config().batch_size();
+      ops.background = conf.ot_beaver_config().background();
+      beaver_ = std::make_unique<semi2k::BeaverOt>(lctx, ops);
     } else {
       SPU_THROW("unsupported beaver type {}", conf.beaver_type());
     }
@@ -44,9 +44,6 @@ ArrayRef ZeroA::proc(KernelEvalContext* ctx, size_t size) {
   auto* prg_state = ctx->getState<PrgState>();
   const auto field = ctx->getState<Z2kState>()->getDefaultField();
 
-  auto [r0, r1] = prg_state->genPrssPair(field, size);
-  auto [r2, r3] = prg_state->genPrssPair(field, size);
-
   // NOTES for ring_rshift to 2 bits.
   // Refer to:
   // New Primitives for Actively-Secure MPC over Rings with Applications to
@@ -54,8 +51,8 @@ ArrayRef ZeroA::proc(KernelEvalContext* ctx, size_t size) {
   // - https://eprint.iacr.org/2019/599.pdf
   // It's safer to keep the number within [-2**(k-2), 2**(k-2)) for comparison
   // operations.
-  auto x = ring_sub(r0, r1);
-  auto x_mac = ring_sub(r2, r3);
+  auto x = prg_state->genPrssZero(field, size);
+  auto x_mac = prg_state->genPrssZero(field, size);
   return makeAShare(x, x_mac, field);
 }
 
@@ -88,24 +85,17 @@ ArrayRef A2P::proc(KernelEvalContext* ctx, const ArrayRef& in) const {
 
   const auto field = in.eltype().as<Ring2k>()->field();
   auto* comm = ctx->getState<Communicator>();
-  auto* arr_ref_v = ctx->getState<Spdz2kState>()->arr_ref_v();
-  arr_ref_v->emplace_back(in);
-
-// #define SINGLE_CHECK
-#ifdef SINGLE_CHECK
-  for (auto& x : *arr_ref_v) {
-    bool success = SingleCheck(ctx, x);
-    SPU_ENFORCE(success, "single check fail");
-  }
-#else
-  bool success = BatchCheck(ctx, *arr_ref_v);
-  arr_ref_v->clear();
-  SPU_ENFORCE(success, "batch check fail");
-#endif
+  auto* state = ctx->getState<Spdz2kState>();
 
   // in
   const auto& x = getValueShare(in);
   auto t = comm->allReduce(ReduceOp::ADD, x, kBindName);
+
+  // The revealed value is accepted only after every value opened so far,
+  // itself included, passes the mac check.
+  state->addOpened(t, getMacShare(in));
+  SPU_ENFORCE(BatchCheck(ctx), "batch check fail");
+
   auto ty = makeType<Pub2kTy>(field);
   return t.as(ty);
 }
@@ -185,145 +175,86 @@ ArrayRef AddAA::proc(KernelEvalContext* ctx, const ArrayRef& lhs,
 // multiply family
 ////////////////////////////////////////////////////////////////////
 
-// Refer to:
-// Procedure SingleCheck, 3.1 Opening Values and Checking MACs,
-// SPDZ2k: Efficient MPC mod 2k for Dishonest Majority
-// - https://eprint.iacr.org/2018/482.pdf
-bool SingleCheck(KernelEvalContext* ctx, const ArrayRef& in) {
-  static constexpr char kBindName[] = "single_check";
-
-  const auto field = in.eltype().as<Ring2k>()->field();
-  auto* comm = ctx->getState<Communicator>();
-  const auto& lctx = comm->lctx();
-  auto* beaver = ctx->getState<Spdz2kState>()->beaver();
-  const auto key = ctx->getState<Spdz2kState>()->key();
-  const size_t k = ctx->getState<Spdz2kState>()->k();
-  const size_t s = ctx->getState<Spdz2kState>()->s();
-
-  // 1. Generate a random, shared value [r]
-  auto [r, r_mac] = beaver->AuthCoinTossing(field, in.numel(), s);
-
-  // 2. Locally construct [y]
-  const auto& x = getValueShare(in);
-  const auto& x_mac = getMacShare(in);
-  auto y = ring_add(x, ring_lshift(r, k));
-  auto y_mac = ring_add(x_mac, ring_lshift(r_mac, k));
-
-  // 3. Open the value
-  auto plain_y = comm->allReduce(ReduceOp::ADD, y, kBindName);
-
-  // 4. Check the consistency of y
-  auto z = ring_sub(y_mac, ring_mul(plain_y, key));
-  std::string z_str(reinterpret_cast<char*>(z.data()), z.numel() * z.elsize());
-  std::vector<std::string> z_strs;
-  YACL_ENFORCE(commit_and_open(lctx, z_str, &z_strs));
-  YACL_ENFORCE(z_strs.size() == comm->getWorldSize());
-
-  auto plain_z = ring_zeros(field, in.numel());
-  for (size_t i = 0; i < comm->getWorldSize(); ++i) {
-    const auto& _z_str = z_strs[i];
-    auto mem = std::make_shared<yacl::Buffer>(_z_str.data(), _z_str.size());
-    ArrayRef a(mem, plain_z.eltype(), _z_str.size() / SizeOf(field), 1, 0);
-    ring_add_(plain_z, a);
-  }
-
-  auto ret = spu::mpc::ring_all_equal(plain_z, ring_zeros(field, in.numel()));
-  return ret;
-}
-
 // Refer to:
 // Procedure BatchCheck, 3.2 Batch MAC Checking with Random Linear
 // Combinations, SPDZ2k: Efficient MPC mod 2k for Dishonest Majority
 // - https://eprint.iacr.org/2018/482.pdf
 //
-// TODO: 1. maybe all shared values using one check is better
-// 2. use DISPATCH_ALL_FIELDS to improve performance
-bool BatchCheck(KernelEvalContext* ctx, const std::vector<ArrayRef>& ins) {
-  static constexpr char kBindName[] = "batch_check";
-
-  SPU_ENFORCE(!ins.empty());
-  const auto field = ins[0].eltype().as<Ring2k>()->field();
-  const auto numel = ins[0].numel();
+// All values opened since the last check are folded into one random linear
+// combination, so only a single element is committed and opened no matter
+// how many values are pending.
+bool BatchCheck(KernelEvalContext* ctx) {
   auto* comm = ctx->getState<Communicator>();
-  const auto& lctx = comm->lctx();
-  auto* beaver = ctx->getState<Spdz2kState>()->beaver();
-  const auto key = ctx->getState<Spdz2kState>()->key();
-  const size_t k = ctx->getState<Spdz2kState>()->k();
-  const size_t s = ctx->getState<Spdz2kState>()->s();
+  auto* state = ctx->getState<Spdz2kState>();
+  const auto key = state->key();
+  const size_t s = state->s();
 
-  const size_t size = ins.size();
-
-  std::vector<ArrayRef> x_hat_v;
-  std::vector<ArrayRef> mac_v;
-
-  for (const auto& in : ins) {
-    // 1. get random r and r_mac
-    auto [r, r_mac] = beaver->AuthCoinTossing(field, numel, s);
-    auto rmac = makeAShare(r, r_mac, field);
-
-    // 2. [x_hat] = [x] + 2^k * [r]
-    auto l_rmac = lshift_a(ctx->caller(), rmac, k);
-    auto _in = add_aa(ctx->caller(), in, l_rmac);
-
-    const auto& x_hat = getValueShare(_in);
-    x_hat_v.emplace_back(x_hat);
-    const auto& x_mac = getMacShare(_in);
-    mac_v.emplace_back(x_mac);
-  }
-
-  // 3. broadcast x_hat && 4. open x_hat
-  std::vector<ArrayRef> plain_x_hat_v;
-  vectorize(x_hat_v.begin(), x_hat_v.end(), std::back_inserter(plain_x_hat_v),
-            [&](const ArrayRef& s) {
-              return comm->allReduce(ReduceOp::ADD, s, kBindName);
-            });
-
-  // 5. get l public random values, compute plain y
-  auto pub_r = ctx->getState<Spdz2kState>()->genPublCoin(field, size);
-  std::vector<uint128_t> rv;
-  uint128_t mask = (static_cast<uint128_t>(1) << s) - 1;
-  for (size_t i = 0; i < size; ++i) {
-    rv.emplace_back(pub_r.at<uint128_t>(i) & mask);
-  }
-
-  auto plain_y = ring_zeros(field, numel);
-  for (size_t i = 0; i < size; ++i) {
-    ring_add_(plain_y, ring_mul(plain_x_hat_v[i], rv[i]));
+  auto [values, macs] = state->takeOpened();
+  if (values.empty()) {
+    return true;
   }
 
-  // 6. compute z, commit and open z
-  auto m = ring_zeros(field, numel);
-  for (size_t i = 0; i < size; ++i) {
-    ring_add_(m, ring_mul(mac_v[i], rv[i]));
+  const auto field = values[0].eltype().as<Ring2k>()->field();
+  int64_t total = 0;
+  for (const auto& v : values) {
+    total += v.numel();
   }
 
-  auto plain_y_mac_share = ring_mul(plain_y, key);
-  auto z = ring_sub(m, plain_y_mac_share);
+  // 1. public random coefficients, tossed after the values are opened.
+  auto coins = state->genPublCoin(field, total);
+
+  // 2. y = sum(chi_i * x_i), m = sum(chi_i * mac_i), z = m - y * key
+  auto z = ring_zeros(field, 1);
+  DISPATCH_ALL_FIELDS(field, "spdz2k.batch_check", [&]() {
+    using U = ring2k_t;
+    const U mask = s >= SizeOf(field) * 8 ? static_cast<U>(~U(0))
+                                           : (static_cast<U>(1) << s) - 1;
+    auto _coins = ArrayView<const U>(coins);
+
+    U y = 0;
+    U m = 0;
+    int64_t offset = 0;
+    for (size_t i = 0; i < values.size(); ++i) {
+      auto _x = ArrayView<const U>(values[i]);
+      auto _mac = ArrayView<const U>(macs[i]);
+      for (int64_t j = 0; j < _x.numel(); ++j) {
+        const U chi = _coins[offset + j] & mask;
+        y += chi * _x[j];
+        m += chi * _mac[j];
+      }
+      offset += _x.numel();
+    }
+    z.at<U>(0) = m - y * static_cast<U>(key);
+  });
 
+  // 3. commit and open z
   std::string z_str(reinterpret_cast<char*>(z.data()), z.numel() * z.elsize());
   std::vector<std::string> z_strs;
-  YACL_ENFORCE(commit_and_open(lctx, z_str, &z_strs));
+  YACL_ENFORCE(commit_and_open(comm->lctx(), z_str, &z_strs));
   YACL_ENFORCE(z_strs.size() == comm->getWorldSize());
 
-  // since the commit size in commit_and_open is independent with numel, we
-  // ignore it
-  comm->addCommStatsManually(1, 0);
-  // since the random string size in commit_and_open is independent with numel,
-  // we ignore it
-  comm->addCommStatsManually(1,
-                             z_str.size() / size * (comm->getWorldSize() - 1));
-
-  // 7. verify whether plain z is zero
-  auto plain_z = ring_zeros(field, numel);
-  for (size_t i = 0; i < comm->getWorldSize(); ++i) {
-    const auto& _z_str = z_strs[i];
+  // commit and open take a round each, the sizes are independent with the
+  // number of checked values, we ignore them.
+  comm->addCommStatsManually(2, 0);
+
+  // 4. verify whether plain z is zero
+  auto plain_z = ring_zeros(field, 1);
+  for (const auto& _z_str : z_strs) {
     auto mem = std::make_shared<yacl::Buffer>(_z_str.data(), _z_str.size());
     ArrayRef a(mem, plain_z.eltype(), _z_str.size() / SizeOf(field), 1, 0);
     ring_add_(plain_z, a);
   }
 
-  auto ret = spu::mpc::ring_all_equal(plain_z, ring_zeros(field, numel));
-  return ret;
+  return ring_all_equal(plain_z, ring_zeros(field, 1));
+}
+
+void MacCheckpoint::proc(KernelEvalContext* ctx) {
+  SPU_TRACE_MPC_LEAF(ctx);
+
+  auto* state = ctx->getState<Spdz2kState>();
+  if (state->checkAtLoop() || state->needCheck()) {
+    SPU_ENFORCE(BatchCheck(ctx), "batch check fail");
+  }
 }
 
 ArrayRef MulAP::proc(KernelEvalContext* ctx, const ArrayRef& lhs,
@@ -355,8 +286,8 @@ ArrayRef MulAA::proc(KernelEvalContext* ctx, const ArrayRef& lhs,
   const auto field = lhs.eltype().as<Ring2k>()->field();
   auto* comm = ctx->getState<Communicator>();
   auto* beaver = ctx->getState<Spdz2kState>()->beaver();
-  auto* arr_ref_v = ctx->getState<Spdz2kState>()->arr_ref_v();
-  const auto key = ctx->getState<Spdz2kState>()->key();
+  auto* state = ctx->getState<Spdz2kState>();
+  const auto key = state->key();
 
   // in
   const auto& x = getValueShare(lhs);
@@ -374,10 +305,6 @@ ArrayRef MulAA::proc(KernelEvalContext* ctx, const ArrayRef& lhs,
   auto f = ring_sub(y, b);
   auto f_mac = ring_sub(y_mac, b_mac);
 
-  // add to check array
-  arr_ref_v->emplace_back(makeAShare(e, e_mac, field));
-  arr_ref_v->emplace_back(makeAShare(f, f_mac, field));
-
   // open e, f
   auto res = vectorize({e, f}, [&](const ArrayRef& s) {
     return comm->allReduce(ReduceOp::ADD, s, kBindName);
@@ -385,6 +312,13 @@ ArrayRef MulAA::proc(KernelEvalContext* ctx, const ArrayRef& lhs,
 
   auto p_e = std::move(res[0]);
   auto p_f = std::move(res[1]);
+
+  // macs are checked later in batch
+  state->addOpened(p_e, e_mac);
+  state->addOpened(p_f, f_mac);
+  if (state->needCheck()) {
+    SPU_ENFORCE(BatchCheck(ctx), "batch check fail");
+  }
   auto p_ef = ring_mul(p_e, p_f);
 
   // z = p_e * b + p_f * a + c;
@@ -431,13 +365,14 @@ ArrayRef MatMulAA::proc(KernelEvalContext* ctx, const ArrayRef& lhs,
 
   const auto field = lhs.eltype().as<Ring2k>()->field();
   auto* comm = ctx->getState<Communicator>();
-  auto* beaver = ctx->getState<Spdz2kState>()->beaver();
-  const auto key = ctx->getState<Spdz2kState>()->key();
+  auto* state = ctx->getState<Spdz2kState>();
+  auto* beaver = state->beaver();
+  const auto key = state->key();
 
   const auto& x = getValueShare(lhs);
   const auto& y = getValueShare(rhs);
-  // const auto& x_mac = getMacShare(lhs);
-  // const auto& y_mac = getMacShare(rhs);
+  const auto& x_mac = getMacShare(lhs);
+  const auto& y_mac = getMacShare(rhs);
 
   // generate beaver multiple triple.
   auto [vec, mac_vec] = beaver->AuthDot(field, m, n, k);
@@ -453,6 +388,13 @@ ArrayRef MatMulAA::proc(KernelEvalContext* ctx, const ArrayRef& lhs,
   auto p_f = std::move(res[1]);
   auto p_ef = ring_mmul(p_e, p_f, m, n, k);
 
+  // macs are checked later in batch
+  state->addOpened(p_e, ring_sub(x_mac, a_mac));
+  state->addOpened(p_f, ring_sub(y_mac, b_mac));
+  if (state->needCheck()) {
+    SPU_ENFORCE(BatchCheck(ctx), "batch check fail");
+  }
+
   // z = p_e dot b + a dot p_f + c;
   auto z = ring_add(
       ring_add(ring_mmul(p_e, b, m, n, k), ring_mmul(a, p_f, m, n, k)), c);
@@ -495,12 +437,14 @@ ArrayRef TruncA::proc(KernelEvalContext* ctx, const ArrayRef& in,
                       size_t bits) const {
   SPU_TRACE_MPC_LEAF(ctx, in, bits);
 
-  const auto key = ctx->getState<Spdz2kState>()->key();
+  auto* state = ctx->getState<Spdz2kState>();
+  const auto key = state->key();
   const auto field = in.eltype().as<Ring2k>()->field();
   auto* comm = ctx->getState<Communicator>();
-  auto* beaver = ctx->getState<Spdz2kState>()->beaver();
+  auto* beaver = state->beaver();
 
   const auto& x = getValueShare(in);
+  const auto& x_mac = getMacShare(in);
   const auto& [vec, mac_vec] = beaver->AuthTrunc(field, x.numel(), bits);
   const auto& [r, rb] = vec;
   const auto& [r_mac, rb_mac] = mac_vec;
@@ -509,6 +453,12 @@ ArrayRef TruncA::proc(KernelEvalContext* ctx, const ArrayRef& in,
   auto x_r = comm->allReduce(ReduceOp::ADD, ring_sub(x, r), kBindName);
   auto tr_x_r = ring_arshift(x_r, bits);
 
+  // macs are checked later in batch
+  state->addOpened(x_r, ring_sub(x_mac, r_mac));
+  if (state->needCheck()) {
+    SPU_ENFORCE(BatchCheck(ctx), "batch check fail");
+  }
+
   // res = [x-r] + [r], which [*] is truncation operation.
   auto res = rb;
   if (comm->getRank() == 0) {
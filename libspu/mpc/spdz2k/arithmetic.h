@@ -64,9 +64,9 @@ class A2P : public UnaryKernel {
  public:
   static constexpr char kBindName[] = "a2p";
 
-  ce::CExpr latency() const override { return ce::Const(4); }
+  ce::CExpr latency() const override { return ce::Const(3); }
 
-  ce::CExpr comm() const override { return ce::K() * 3 * (ce::N() - 1); }
+  ce::CExpr comm() const override { return ce::K() * (ce::N() - 1); }
 
   ArrayRef proc(KernelEvalContext* ctx, const ArrayRef& in) const override;
 };
@@ -112,8 +112,23 @@ class AddAA : public BinaryKernel {
 ////////////////////////////////////////////////////////////////////
 // multiply family
 ////////////////////////////////////////////////////////////////////
-bool SingleCheck(KernelEvalContext* ctx, const ArrayRef& in);
-bool BatchCheck(KernelEvalContext* ctx, const std::vector<ArrayRef>& ins);
+// Verify the macs of all values opened since the last check.
+bool BatchCheck(KernelEvalContext* ctx);
+
+// Loop boundary, verifies the pending macs if configured so.
+class MacCheckpoint : public Kernel {
+ public:
+  static constexpr char kBindName[] = "checkpoint";
+
+  Kind kind() const override { return Kind::Dynamic; }
+
+  void evaluate(KernelEvalContext* ctx) const override {
+    proc(ctx);
+    ctx->setOutput(true);
+  }
+
+  static void proc(KernelEvalContext* ctx);
+};
 
 class MulAP : public BinaryKernel {
  public:
@@ -0,0 +1,459 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libspu/mpc/spdz2k/beaver/beaver_store.h"
+
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "yacl/crypto/base/hash/hash_utils.h"
+#include "yacl/crypto/utils/rand.h"
+#include "yacl/link/link.h"
+#include "yacl/utils/serialize.h"
+
+#include "libspu/core/prelude.h"
+
+namespace spu::mpc::spdz2k {
+namespace {
+
+// magic || header || correlations || sha256(magic || header || correlations)
+constexpr char kStoreMagic[] = "SPU-SPDZ2K-PRE-V1";
+constexpr size_t kStoreMagicSize = sizeof(kStoreMagic) - 1;
+constexpr size_t kDigestSize = 32;
+
+std::optional<std::string> ReadFile(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return std::nullopt;
+  }
+  std::stringstream ss;
+  ss << in.rdbuf();
+  if (in.bad()) {
+    return std::nullopt;
+  }
+  return ss.str();
+}
+
+bool WriteFile(const std::string& path, std::string_view content) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(content.data(), static_cast<std::streamsize>(content.size()));
+  return static_cast<bool>(out);
+}
+
+class Writer {
+  std::string out_;
+
+ public:
+  Writer() : out_(kStoreMagic, kStoreMagicSize) {}
+
+  template <typename T>
+  void PutPod(const T& v) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    out_.append(reinterpret_cast<const char*>(&v), sizeof(T));
+  }
+
+  void PutArray(const ArrayRef& arr) {
+    PutPod<int64_t>(arr.numel());
+    if (arr.numel() == 0) {
+      return;
+    }
+    // clone to get a compact buffer.
+    auto compact = arr.clone();
+    out_.append(static_cast<const char*>(compact.data()),
+                compact.numel() * compact.elsize());
+  }
+
+  void PutPair(const Beaver::Pair& p) {
+    PutArray(p.first);
+    PutArray(p.second);
+  }
+
+  void PutTriple(const Beaver::Triple& t) {
+    PutArray(std::get<0>(t));
+    PutArray(std::get<1>(t));
+    PutArray(std::get<2>(t));
+  }
+
+  std::string Finish() {
+    auto digest = yacl::crypto::Sha256(out_);
+    out_.append(reinterpret_cast<const char*>(digest.data()), digest.size());
+    return std::move(out_);
+  }
+};
+
+class Reader {
+  std::string_view in_;
+
+  size_t pos_ = 0;
+
+  void Take(void* dst, size_t size) {
+    SPU_ENFORCE(pos_ + size <= in_.size(),
+                "truncated spdz2k preprocessing store");
+    if (size > 0) {
+      std::memcpy(dst, in_.data() + pos_, size);
+    }
+    pos_ += size;
+  }
+
+ public:
+  explicit Reader(std::string_view in) : in_(in) {}
+
+  template <typename T>
+  T GetPod() {
+    static_assert(std::is_trivially_copyable_v<T>);
+    T v;
+    Take(&v, sizeof(T));
+    return v;
+  }
+
+  ArrayRef GetArray(FieldType field) {
+    const auto numel = GetPod<int64_t>();
+    SPU_ENFORCE(numel >= 0);
+    ArrayRef arr(makeType<RingTy>(field), numel);
+    if (numel > 0) {
+      Take(arr.data(), numel * arr.elsize());
+    }
+    return arr;
+  }
+
+  Beaver::Pair GetPair(FieldType field) {
+    auto first = GetArray(field);
+    return {first, GetArray(field)};
+  }
+
+  Beaver::Triple GetTriple(FieldType field) {
+    auto a = GetArray(field);
+    auto b = GetArray(field);
+    return {a, b, GetArray(field)};
+  }
+
+  bool Done() const { return pos_ == in_.size(); }
+};
+
+// Move the store to a name of this loader, a second loader finds nothing.
+std::string ClaimFile(const std::string& path) {
+  static std::atomic<int64_t> counter{0};
+  const auto claimed =
+      fmt::format("{}.loading.{}.{}", path, ::getpid(), counter++);
+  std::error_code ec;
+  std::filesystem::rename(path, claimed, ec);
+  SPU_ENFORCE(!ec,
+              "failed to claim spdz2k preprocessing store {}, it is missing "
+              "or was loaded already: {}",
+              path, ec.message());
+  return claimed;
+}
+
+Beaver::Pair Slice(const Beaver::Pair& p, int64_t start, int64_t stop) {
+  return {p.first.slice(start, stop), p.second.slice(start, stop)};
+}
+
+Beaver::Triple Slice(const Beaver::Triple& t, int64_t start, int64_t stop) {
+  return {std::get<0>(t).slice(start, stop), std::get<1>(t).slice(start, stop),
+          std::get<2>(t).slice(start, stop)};
+}
+
+ArrayRef Empty(FieldType field) { return {makeType<RingTy>(field), 0}; }
+
+}  // namespace
+
+void SaveRequirement(const Requirement& req, const std::string& path) {
+  std::string out = fmt::format("field {}\ncoin {}\nmul {}\n",
+                                static_cast<int32_t>(req.field), req.coin,
+                                req.mul);
+  for (const auto& [m, n, k] : req.dot) {
+    out += fmt::format("dot {} {} {}\n", m, n, k);
+  }
+  for (const auto& [bits, size] : req.trunc) {
+    out += fmt::format("trunc {} {}\n", bits, size);
+  }
+  SPU_ENFORCE(WriteFile(path, out), "failed to write spdz2k requirement {}",
+              path);
+}
+
+Requirement LoadRequirement(const std::string& path) {
+  std::ifstream in(path);
+  SPU_ENFORCE(in, "failed to read spdz2k requirement {}", path);
+
+  Requirement req;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    std::istringstream ls(line);
+    std::string kind;
+    ls >> kind;
+    if (kind == "field") {
+      int32_t field = 0;
+      ls >> field;
+      req.field = static_cast<FieldType>(field);
+    } else if (kind == "coin") {
+      ls >> req.coin;
+    } else if (kind == "mul") {
+      ls >> req.mul;
+    } else if (kind == "dot") {
+      std::array<size_t, 3> shape;
+      ls >> shape[0] >> shape[1] >> shape[2];
+      req.dot.push_back(shape);
+    } else if (kind == "trunc") {
+      size_t bits = 0;
+      size_t size = 0;
+      ls >> bits >> size;
+      req.trunc[bits] += size;
+    } else {
+      SPU_THROW("unknown entry '{}' in spdz2k requirement {}", line, path);
+    }
+    SPU_ENFORCE(!ls.fail(), "malformed entry '{}' in spdz2k requirement {}",
+                line, path);
+  }
+  return req;
+}
+
+void BeaverRecorder::Record(FieldType field) {
+  if (req_.field == FT_INVALID) {
+    req_.field = field;
+  }
+  SPU_ENFORCE(req_.field == field,
+              "a requirement covers one field, got {} and {}", req_.field,
+              field);
+}
+
+uint128_t BeaverRecorder::GetSpdzKey(FieldType field, size_t s) {
+  return beaver_->GetSpdzKey(field, s);
+}
+
+Beaver::Pair BeaverRecorder::AuthCoinTossing(FieldType field, size_t size,
+                                             size_t s) {
+  Record(field);
+  req_.coin += size;
+  return beaver_->AuthCoinTossing(field, size, s);
+}
+
+Beaver::Triple_Pair BeaverRecorder::AuthMul(FieldType field, size_t size) {
+  Record(field);
+  req_.mul += size;
+  return beaver_->AuthMul(field, size);
+}
+
+Beaver::Triple_Pair BeaverRecorder::AuthDot(FieldType field, size_t M,
+                                            size_t N, size_t K) {
+  Record(field);
+  req_.dot.push_back({M, N, K});
+  return beaver_->AuthDot(field, M, N, K);
+}
+
+Beaver::Pair_Pair BeaverRecorder::AuthTrunc(FieldType field, size_t size,
+                                            size_t bits) {
+  Record(field);
+  req_.trunc[bits] += size;
+  return beaver_->AuthTrunc(field, size, bits);
+}
+
+void Preprocess(const std::shared_ptr<yacl::link::Context>& lctx,
+                Beaver* beaver, const Requirement& req, size_t s,
+                const std::string& path) {
+  SPU_ENFORCE(req.field != FT_INVALID, "requirement without field");
+  const auto field = req.field;
+
+  // Identifies this run, every party contributes.
+  uint128_t run_id = 0;
+  auto ids = yacl::link::AllGather(
+      lctx, yacl::SerializeUint128(yacl::crypto::RandSeed(true)),
+      "SPDZ2K:PREPROCESS");
+  for (const auto& id : ids) {
+    run_id += yacl::DeserializeUint128(id);
+  }
+
+  Writer w;
+  w.PutPod<uint64_t>(lctx->Rank());
+  w.PutPod<uint64_t>(lctx->WorldSize());
+  w.PutPod<int32_t>(field);
+  w.PutPod<uint64_t>(s);
+  w.PutPod<uint128_t>(run_id);
+  // the key is 128 bits wide whatever the field of correlations.
+  w.PutPod<uint128_t>(beaver->GetSpdzKey(FM128, s));
+
+  if (req.coin > 0) {
+    w.PutPair(beaver->AuthCoinTossing(field, req.coin, s));
+  } else {
+    w.PutPair({Empty(field), Empty(field)});
+  }
+
+  if (req.mul > 0) {
+    auto [vec, mac_vec] = beaver->AuthMul(field, req.mul);
+    w.PutTriple(vec);
+    w.PutTriple(mac_vec);
+  } else {
+    w.PutTriple({Empty(field), Empty(field), Empty(field)});
+    w.PutTriple({Empty(field), Empty(field), Empty(field)});
+  }
+
+  w.PutPod<uint64_t>(req.dot.size());
+  for (const auto& [m, n, k] : req.dot) {
+    w.PutPod<uint64_t>(m);
+    w.PutPod<uint64_t>(n);
+    w.PutPod<uint64_t>(k);
+    auto [vec, mac_vec] = beaver->AuthDot(field, m, n, k);
+    w.PutTriple(vec);
+    w.PutTriple(mac_vec);
+  }
+
+  w.PutPod<uint64_t>(req.trunc.size());
+  for (const auto& [bits, size] : req.trunc) {
+    w.PutPod<uint64_t>(bits);
+    auto [vec, mac_vec] = beaver->AuthTrunc(field, size, bits);
+    w.PutPair(vec);
+    w.PutPair(mac_vec);
+  }
+
+  SPU_ENFORCE(WriteFile(path, w.Finish()),
+              "failed to write spdz2k preprocessing store {}", path);
+}
+
+BeaverStore::BeaverStore(const std::shared_ptr<yacl::link::Context>& lctx,
+                         const std::string& path) {
+  const auto claimed = ClaimFile(path);
+  auto content = ReadFile(claimed);
+  // Whatever happens next, the correlations are never served again.
+  std::error_code ec;
+  std::filesystem::remove(claimed, ec);
+  SPU_ENFORCE(content.has_value(),
+              "failed to read spdz2k preprocessing store {}", path);
+  SPU_ENFORCE(content->size() >= kStoreMagicSize + kDigestSize &&
+                  content->compare(0, kStoreMagicSize, kStoreMagic) == 0,
+              "{} is not a spdz2k preprocessing store", path);
+
+  const size_t body = content->size() - kDigestSize;
+  auto digest =
+      yacl::crypto::Sha256(yacl::ByteContainerView(content->data(), body));
+  SPU_ENFORCE(
+      std::memcmp(digest.data(), content->data() + body, kDigestSize) == 0,
+      "spdz2k preprocessing store {} is corrupted", path);
+
+  Reader r(std::string_view(content->data() + kStoreMagicSize,
+                            body - kStoreMagicSize));
+  const auto rank = r.GetPod<uint64_t>();
+  const auto world_size = r.GetPod<uint64_t>();
+  SPU_ENFORCE(rank == lctx->Rank() && world_size == lctx->WorldSize(),
+              "store {} is of party {}/{}, but loaded by party {}/{}", path,
+              rank, world_size, lctx->Rank(), lctx->WorldSize());
+  field_ = static_cast<FieldType>(r.GetPod<int32_t>());
+  s_ = r.GetPod<uint64_t>();
+  const auto run_id = r.GetPod<uint128_t>();
+  key_ = r.GetPod<uint128_t>();
+
+  coin_ = r.GetPair(field_);
+  mul_.first = r.GetTriple(field_);
+  mul_.second = r.GetTriple(field_);
+
+  const auto num_dots = r.GetPod<uint64_t>();
+  for (uint64_t i = 0; i < num_dots; ++i) {
+    std::array<size_t, 3> shape;
+    for (auto& dim : shape) {
+      dim = r.GetPod<uint64_t>();
+    }
+    auto vec = r.GetTriple(field_);
+    dot_.emplace_back(shape, Triple_Pair{vec, r.GetTriple(field_)});
+  }
+
+  const auto num_truncs = r.GetPod<uint64_t>();
+  for (uint64_t i = 0; i < num_truncs; ++i) {
+    const auto bits = r.GetPod<uint64_t>();
+    auto vec = r.GetPair(field_);
+    trunc_[bits] = {{vec, r.GetPair(field_)}, 0};
+  }
+  SPU_ENFORCE(r.Done(), "trailing bytes in spdz2k preprocessing store {}",
+              path);
+
+  // Shares of different runs do not add up, check all parties agree.
+  auto ids = yacl::link::AllGather(lctx, yacl::SerializeUint128(run_id),
+                                   "SPDZ2K:LOAD_STORE");
+  for (size_t i = 0; i < ids.size(); ++i) {
+    SPU_ENFORCE(yacl::DeserializeUint128(ids[i]) == run_id,
+                "party {} loaded a store of another preprocessing run", i);
+  }
+}
+
+uint128_t BeaverStore::GetSpdzKey(FieldType, size_t s) {
+  SPU_ENFORCE(s == s_, "store is preprocessed with s={}, got {}", s_, s);
+  return key_;
+}
+
+Beaver::Pair BeaverStore::AuthCoinTossing(FieldType field, size_t size,
+                                          size_t s) {
+  SPU_ENFORCE(field == field_ && s == s_);
+  const int64_t left = coin_.first.numel() - coin_used_;
+  SPU_ENFORCE(static_cast<int64_t>(size) <= left,
+              "preprocessed coins exhausted, {} requested, {} left", size,
+              left);
+  auto ret = Slice(coin_, coin_used_, coin_used_ + size);
+  coin_used_ += size;
+  return ret;
+}
+
+Beaver::Triple_Pair BeaverStore::AuthMul(FieldType field, size_t size) {
+  SPU_ENFORCE(field == field_, "store is preprocessed for {}, got {}", field_,
+              field);
+  const int64_t left = std::get<0>(mul_.first).numel() - mul_used_;
+  SPU_ENFORCE(static_cast<int64_t>(size) <= left,
+              "preprocessed mul triples exhausted, {} requested, {} left",
+              size, left);
+  Triple_Pair ret = {Slice(mul_.first, mul_used_, mul_used_ + size),
+                     Slice(mul_.second, mul_used_, mul_used_ + size)};
+  mul_used_ += size;
+  return ret;
+}
+
+Beaver::Triple_Pair BeaverStore::AuthDot(FieldType field, size_t M, size_t N,
+                                         size_t K) {
+  SPU_ENFORCE(field == field_, "store is preprocessed for {}, got {}", field_,
+              field);
+  // Dots are consumed in the order of the requirement.
+  SPU_ENFORCE(!dot_.empty() && dot_.front().first ==
+                                   std::array<size_t, 3>{M, N, K},
+              "dot {}x{}x{} was not preprocessed at this point", M, N, K);
+  auto ret = std::move(dot_.front().second);
+  dot_.pop_front();
+  return ret;
+}
+
+Beaver::Pair_Pair BeaverStore::AuthTrunc(FieldType field, size_t size,
+                                         size_t bits) {
+  SPU_ENFORCE(field == field_, "store is preprocessed for {}, got {}", field_,
+              field);
+  auto itr = trunc_.find(bits);
+  SPU_ENFORCE(itr != trunc_.end(), "truncation by {} bits not preprocessed",
+              bits);
+  auto& [pairs, used] = itr->second;
+  const int64_t left = pairs.first.first.numel() - used;
+  SPU_ENFORCE(static_cast<int64_t>(size) <= left,
+              "preprocessed truncation pairs exhausted, {} requested, {} left",
+              size, left);
+  Pair_Pair ret = {Slice(pairs.first, used, used + size),
+                   Slice(pairs.second, used, used + size)};
+  used += size;
+  return ret;
+}
+
+}  // namespace spu::mpc::spdz2k
@@ -0,0 +1,122 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "yacl/link/context.h"
+
+#include "libspu/mpc/spdz2k/beaver/beaver_interface.h"
+
+namespace spu::mpc::spdz2k {
+
+// Authenticated correlations consumed by a program, in numbers of elements.
+//
+// It only depends on the shapes of the inputs and on public values, never on
+// secret ones, so a dry run of the program with dummy inputs of the real
+// shapes records the same requirement as the real run.
+struct Requirement {
+  FieldType field = FT_INVALID;
+  size_t coin = 0;
+  size_t mul = 0;
+  // (M, N, K) of each dot, in the order of use.
+  std::vector<std::array<size_t, 3>> dot;
+  // bits -> number of truncation pairs.
+  std::map<size_t, size_t> trunc;
+};
+
+// Text form of a requirement, the input of an offline preprocessing run.
+void SaveRequirement(const Requirement& req, const std::string& path);
+
+Requirement LoadRequirement(const std::string& path);
+
+// Records what the wrapped beaver is asked for, i.e. a dry run of a program
+// tells the requirement to preprocess for it.
+class BeaverRecorder final : public Beaver {
+  std::unique_ptr<Beaver> beaver_;
+
+  Requirement req_;
+
+  void Record(FieldType field);
+
+ public:
+  explicit BeaverRecorder(std::unique_ptr<Beaver> beaver)
+      : beaver_(std::move(beaver)) {}
+
+  const Requirement& GetRequirement() const { return req_; }
+
+  uint128_t GetSpdzKey(FieldType field, size_t s) override;
+
+  Pair AuthCoinTossing(FieldType field, size_t size, size_t s) override;
+
+  Triple_Pair AuthMul(FieldType field, size_t size) override;
+
+  Triple_Pair AuthDot(FieldType field, size_t M, size_t N, size_t K) override;
+
+  Pair_Pair AuthTrunc(FieldType field, size_t size, size_t bits) override;
+};
+
+// Offline phase, generates the correlations of `req` with `beaver` and
+// persists this party's part to `path`. All parties run it together.
+void Preprocess(const std::shared_ptr<yacl::link::Context>& lctx,
+                Beaver* beaver, const Requirement& req, size_t s,
+                const std::string& path);
+
+// Online phase, serves the correlations persisted by Preprocess without any
+// communication. Loading fails on a corrupted file, or if the parties loaded
+// files of different preprocessing runs. Requests beyond the preprocessed
+// amount throw.
+//
+// A correlation must never be used twice, so the file is moved away
+// atomically before it is read and removed once loaded: loading the same
+// store again fails, even when another process raced for it.
+class BeaverStore final : public Beaver {
+  FieldType field_;
+
+  uint128_t key_;
+
+  size_t s_;
+
+  Pair coin_;
+  int64_t coin_used_ = 0;
+
+  Triple_Pair mul_;
+  int64_t mul_used_ = 0;
+
+  std::deque<std::pair<std::array<size_t, 3>, Triple_Pair>> dot_;
+
+  std::map<size_t, std::pair<Pair_Pair, int64_t>> trunc_;
+
+ public:
+  BeaverStore(const std::shared_ptr<yacl::link::Context>& lctx,
+              const std::string& path);
+
+  uint128_t GetSpdzKey(FieldType field, size_t s) override;
+
+  Pair AuthCoinTossing(FieldType field, size_t size, size_t s) override;
+
+  Triple_Pair AuthMul(FieldType field, size_t size) override;
+
+  Triple_Pair AuthDot(FieldType field, size_t M, size_t N, size_t K) override;
+
+  Pair_Pair AuthTrunc(FieldType field, size_t size, size_t bits) override;
+};
+
+}  // namespace spu::mpc::spdz2k
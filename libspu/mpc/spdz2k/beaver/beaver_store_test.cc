@@ -0,0 +1,232 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libspu/mpc/spdz2k/beaver/beaver_store.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+#include "gtest/gtest.h"
+#include "yacl/link/link.h"
+
+#include "libspu/mpc/spdz2k/beaver/beaver_tfp.h"
+#include "libspu/mpc/utils/ring_ops.h"
+#include "libspu/mpc/utils/simulate.h"
+
+namespace spu::mpc::spdz2k {
+
+class BeaverStoreTest : public ::testing::TestWithParam<size_t> {
+ protected:
+  static constexpr FieldType kField = FM128;
+  static constexpr size_t kS = 64;
+
+  std::filesystem::path dir_;
+
+  void SetUp() override {
+    dir_ = std::filesystem::temp_directory_path() /
+           fmt::format("spu_spdz2k_store_test_{}_{}", GetParam(),
+                       std::chrono::steady_clock::now()
+                           .time_since_epoch()
+                           .count());
+    std::filesystem::create_directories(dir_);
+  }
+
+  void TearDown() override { std::filesystem::remove_all(dir_); }
+
+  std::string Path(const std::string& name, size_t rank) const {
+    return (dir_ / fmt::format("{}.{}", name, rank)).string();
+  }
+
+  // dry run of a program, returns the requirement recorded.
+  static Requirement Record(size_t world_size) {
+    auto reqs = utils::simulate(
+        world_size, [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+          BeaverRecorder recorder(std::make_unique<BeaverTfpUnsafe>(lctx));
+          recorder.GetSpdzKey(kField, kS);
+          recorder.AuthMul(kField, 5);
+          recorder.AuthDot(kField, 2, 3, 4);
+          recorder.AuthMul(kField, 3);
+          recorder.AuthTrunc(kField, 4, 7);
+          recorder.AuthCoinTossing(kField, 6, kS);
+          return recorder.GetRequirement();
+        });
+    return reqs[0];
+  }
+
+  void Preprocess(const std::string& name, const Requirement& req) {
+    utils::simulate(GetParam(),
+                    [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+                      BeaverTfpUnsafe beaver(lctx);
+                      spdz2k::Preprocess(lctx, &beaver, req, kS,
+                                         Path(name, lctx->Rank()));
+                    });
+  }
+};
+
+INSTANTIATE_TEST_SUITE_P(
+    BeaverStore, BeaverStoreTest, testing::Values(2, 3),
+    [](const testing::TestParamInfo<BeaverStoreTest::ParamType>& p) {
+      return fmt::format("{}", p.param);
+    });
+
+TEST_P(BeaverStoreTest, Requirement) {
+  auto req = Record(GetParam());
+
+  EXPECT_EQ(req.field, kField);
+  EXPECT_EQ(req.coin, 6U);
+  EXPECT_EQ(req.mul, 8U);
+  ASSERT_EQ(req.dot.size(), 1U);
+  EXPECT_EQ(req.dot[0], (std::array<size_t, 3>{2, 3, 4}));
+  ASSERT_EQ(req.trunc.size(), 1U);
+  EXPECT_EQ(req.trunc.at(7), 4U);
+}
+
+TEST_P(BeaverStoreTest, RequirementFile) {
+  auto req = Record(GetParam());
+  const auto path = (dir_ / "requirement").string();
+  SaveRequirement(req, path);
+  auto loaded = LoadRequirement(path);
+
+  EXPECT_EQ(loaded.field, req.field);
+  EXPECT_EQ(loaded.coin, req.coin);
+  EXPECT_EQ(loaded.mul, req.mul);
+  EXPECT_EQ(loaded.dot, req.dot);
+  EXPECT_EQ(loaded.trunc, req.trunc);
+
+  {
+    std::ofstream out(path, std::ios::app);
+    out << "mul\n";
+  }
+  EXPECT_THROW(LoadRequirement(path), RuntimeError);
+}
+
+TEST_P(BeaverStoreTest, Serve) {
+  const size_t kWorldSize = GetParam();
+  Preprocess("store", Record(kWorldSize));
+
+  std::vector<uint128_t> keys(kWorldSize);
+  std::vector<Beaver::Triple_Pair> muls(kWorldSize);
+  std::vector<Beaver::Triple_Pair> dots(kWorldSize);
+  utils::simulate(kWorldSize,
+                  [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+                    BeaverStore store(lctx, Path("store", lctx->Rank()));
+                    keys[lctx->Rank()] = store.GetSpdzKey(kField, kS);
+                    // slices of the preprocessed pool, in the recorded order.
+                    auto first = store.AuthMul(kField, 5);
+                    dots[lctx->Rank()] = store.AuthDot(kField, 2, 3, 4);
+                    muls[lctx->Rank()] = store.AuthMul(kField, 3);
+                    EXPECT_EQ(std::get<0>(first.first).numel(), 5);
+                    store.AuthTrunc(kField, 4, 7);
+                    store.AuthCoinTossing(kField, 6, kS);
+
+                    EXPECT_THROW(store.AuthMul(kField, 1), RuntimeError);
+                    EXPECT_THROW(store.AuthDot(kField, 2, 3, 4),
+                                 RuntimeError);
+                    EXPECT_THROW(store.AuthTrunc(kField, 1, 7), RuntimeError);
+                    EXPECT_THROW(store.AuthTrunc(kField, 1, 8), RuntimeError);
+                  });
+
+  uint128_t key = 0;
+  for (auto k : keys) {
+    key += k;
+  }
+
+  auto check_macs = [&](const Beaver::Triple& sum, const Beaver::Triple& mac) {
+    EXPECT_TRUE(ring_all_equal(ring_mul(std::get<0>(sum), key),
+                               std::get<0>(mac)));
+    EXPECT_TRUE(ring_all_equal(ring_mul(std::get<1>(sum), key),
+                               std::get<1>(mac)));
+    EXPECT_TRUE(ring_all_equal(ring_mul(std::get<2>(sum), key),
+                               std::get<2>(mac)));
+  };
+
+  auto reconstruct = [&](const std::vector<Beaver::Triple_Pair>& shares,
+                         bool mac) {
+    auto pick = [&](size_t r) -> const Beaver::Triple& {
+      return mac ? shares[r].second : shares[r].first;
+    };
+    auto a = std::get<0>(pick(0)).clone();
+    auto b = std::get<1>(pick(0)).clone();
+    auto c = std::get<2>(pick(0)).clone();
+    for (size_t r = 1; r < kWorldSize; ++r) {
+      ring_add_(a, std::get<0>(pick(r)));
+      ring_add_(b, std::get<1>(pick(r)));
+      ring_add_(c, std::get<2>(pick(r)));
+    }
+    return Beaver::Triple{a, b, c};
+  };
+
+  auto mul = reconstruct(muls, false);
+  EXPECT_TRUE(ring_all_equal(
+      ring_mul(std::get<0>(mul), std::get<1>(mul)), std::get<2>(mul)));
+  check_macs(mul, reconstruct(muls, true));
+
+  auto dot = reconstruct(dots, false);
+  EXPECT_TRUE(ring_all_equal(
+      ring_mmul(std::get<0>(dot), std::get<1>(dot), 2, 3, 4),
+      std::get<2>(dot)));
+  check_macs(dot, reconstruct(dots, true));
+}
+
+TEST_P(BeaverStoreTest, Consumed) {
+  const size_t kWorldSize = GetParam();
+  Preprocess("store", Record(kWorldSize));
+
+  utils::simulate(kWorldSize,
+                  [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+                    const auto path = Path("store", lctx->Rank());
+                    { BeaverStore store(lctx, path); }
+                    EXPECT_FALSE(std::filesystem::exists(path));
+                    // a rerun must not get the same correlations again.
+                    EXPECT_THROW(BeaverStore(lctx, path), RuntimeError);
+                  });
+  EXPECT_TRUE(std::filesystem::is_empty(dir_));
+}
+
+TEST_P(BeaverStoreTest, Corrupted) {
+  const size_t kWorldSize = GetParam();
+  Preprocess("store", Record(kWorldSize));
+
+  for (size_t rank = 0; rank < kWorldSize; ++rank) {
+    std::fstream f(Path("store", rank),
+                   std::ios::binary | std::ios::in | std::ios::out);
+    f.seekg(64);
+    const char c = static_cast<char>(f.get());
+    f.seekp(64);
+    f.put(static_cast<char>(~c));
+  }
+
+  utils::simulate(kWorldSize,
+                  [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+                    EXPECT_THROW(BeaverStore(lctx, Path("store", lctx->Rank())),
+                                 RuntimeError);
+                  });
+}
+
+TEST_P(BeaverStoreTest, MixedRuns) {
+  const size_t kWorldSize = GetParam();
+  auto req = Record(kWorldSize);
+  Preprocess("run0", req);
+  Preprocess("run1", req);
+
+  utils::simulate(kWorldSize,
+                  [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+                    const auto* name = lctx->Rank() == 0 ? "run1" : "run0";
+                    EXPECT_THROW(BeaverStore(lctx, Path(name, lctx->Rank())),
+                                 RuntimeError);
+                  });
+}
+
+}  // namespace spu::mpc::spdz2k
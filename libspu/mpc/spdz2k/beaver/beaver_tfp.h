@@ -18,7 +18,7 @@
 
 #include "yacl/link/context.h"
 
-#include "libspu/mpc/spdz2k/beaver/beaver_tfp.h"
+#include "libspu/mpc/spdz2k/beaver/beaver_interface.h"
 #include "libspu/mpc/spdz2k/beaver/trusted_party.h"
 
 namespace spu::mpc::spdz2k {
@@ -29,7 +29,7 @@ namespace spu::mpc::spdz2k {
 // NOT BE used in production.
 //
 // Check security implications before moving on.
-class BeaverTfpUnsafe final {
+class BeaverTfpUnsafe final : public Beaver {
  protected:
   // Only for rank0 party.
   TrustedParty tp_;
@@ -42,26 +42,20 @@ class BeaverTfpUnsafe final {
 
   uint128_t global_key_;
 
- public:
-  using Triple = std::tuple<ArrayRef, ArrayRef, ArrayRef>;
-  using Pair = std::pair<ArrayRef, ArrayRef>;
-  using Pair_Pair = std::pair<Pair, Pair>;
-  using Triple_Pair = std::pair<Triple, Triple>;
-
  public:
   explicit BeaverTfpUnsafe(std::shared_ptr<yacl::link::Context> lctx);
 
   std::shared_ptr<yacl::link::Context> GetLink() const { return lctx_; }
 
-  uint128_t GetSpdzKey(FieldType field, size_t s);
+  uint128_t GetSpdzKey(FieldType field, size_t s) override;
 
-  Pair AuthCoinTossing(FieldType field, size_t size, size_t s);
+  Pair AuthCoinTossing(FieldType field, size_t size, size_t s) override;
 
-  Triple_Pair AuthMul(FieldType field, size_t size);
+  Triple_Pair AuthMul(FieldType field, size_t size) override;
 
-  Triple_Pair AuthDot(FieldType field, size_t M, size_t N, size_t K);
+  Triple_Pair AuthDot(FieldType field, size_t M, size_t N, size_t K) override;
 
-  Pair_Pair AuthTrunc(FieldType field, size_t size, size_t bits);
+  Pair_Pair AuthTrunc(FieldType field, size_t size, size_t bits) override;
 };
 
 }  // namespace spu::mpc::spdz2k
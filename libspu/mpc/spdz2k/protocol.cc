@@ -50,7 +50,7 @@ std::unique_ptr<Object> makeSpdz2kProtocol(
   regABKernels(obj.get());
 
   // register arithmetic kernels
-  obj->addState<Spdz2kState>(lctx);
+  obj->addState<Spdz2kState>(conf, lctx);
   obj->regKernel<spdz2k::ZeroA>();
   obj->regKernel<spdz2k::P2A>();
   obj->regKernel<spdz2k::A2P>();
@@ -64,6 +64,7 @@ std::unique_ptr<Object> makeSpdz2kProtocol(
   obj->regKernel<spdz2k::LShiftA>();
   obj->regKernel<spdz2k::TruncA>();
   obj->regKernel<spdz2k::RandA>();
+  obj->regKernel<spdz2k::MacCheckpoint>();
 
   return obj;
 }
@@ -14,7 +14,18 @@
 
 #include "libspu/mpc/spdz2k/protocol.h"
 
+#include <chrono>
+#include <filesystem>
+
+#include "libspu/mpc/api.h"
+#include "libspu/mpc/common/ab_api.h"
 #include "libspu/mpc/spdz2k/abprotocol_spdz2k_test.h"
+#include "libspu/mpc/spdz2k/beaver/beaver_store.h"
+#include "libspu/mpc/spdz2k/beaver/beaver_tfp.h"
+#include "libspu/mpc/spdz2k/state.h"
+#include "libspu/mpc/spdz2k/value.h"
+#include "libspu/mpc/utils/ring_ops.h"
+#include "libspu/mpc/utils/simulate.h"
 
 namespace spu::mpc::test {
 namespace {
@@ -37,4 +48,104 @@ INSTANTIATE_TEST_SUITE_P(
                          std::get<2>(p.param));
     });
 
+TEST(Spdz2kMacCheckTest, Deferred) {
+  const size_t kNumel = 10;
+  auto conf = makeConfig(FieldType::FM128);
+  // Each mul_aa opens 2 * kNumel values.
+  conf.set_spdz2k_mac_check_interval(5 * kNumel);
+
+  utils::simulate(2, [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+    auto obj = makeSpdz2kProtocol(conf, lctx);
+    auto* state = obj->getState<Spdz2kState>();
+
+    auto p0 = rand_p(obj.get(), kNumel);
+    auto a0 = p2a(obj.get(), p0);
+    auto a = a0;
+    auto p = p0;
+    for (int i = 0; i < 4; ++i) {
+      a = mul_aa(obj.get(), a, a0);
+      p = mul_pp(obj.get(), p, p0);
+      EXPECT_LT(state->numPending(), 5 * kNumel);
+    }
+    EXPECT_GT(state->numPending(), 0);
+
+    // Revealing checks everything pending.
+    EXPECT_TRUE(ring_all_equal(a2p(obj.get(), a), p));
+    EXPECT_EQ(state->numPending(), 0);
+  });
+}
+
+TEST(Spdz2kMacCheckTest, Tampered) {
+  const size_t kNumel = 10;
+  auto conf = makeConfig(FieldType::FM128);
+
+  EXPECT_ANY_THROW(utils::simulate(
+      2, [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+        auto obj = makeSpdz2kProtocol(conf, lctx);
+
+        auto a0 = p2a(obj.get(), rand_p(obj.get(), kNumel));
+        if (lctx->Rank() == 0) {
+          auto mac = spdz2k::getMacShare(a0);
+          ring_add_(mac, ring_ones(FieldType::FM128, kNumel));
+        }
+        auto a1 = mul_aa(obj.get(), a0, a0);
+        a2p(obj.get(), a1);
+      }));
+}
+
+TEST(Spdz2kPreprocessTest, Offline) {
+  const size_t kNumel = 10;
+  const size_t kWorldSize = 2;
+  auto conf = makeConfig(FieldType::FM128);
+
+  auto program = [&](Object* obj) {
+    auto p0 = rand_p(obj, kNumel);
+    auto a0 = p2a(obj, p0);
+    auto a1 = mul_aa(obj, a0, a0);
+    EXPECT_TRUE(ring_all_equal(a2p(obj, a1), mul_pp(obj, p0, p0)));
+  };
+
+  const auto dir = std::filesystem::temp_directory_path() /
+                   fmt::format("spu_spdz2k_preprocess_test_{}",
+                               std::chrono::steady_clock::now()
+                                   .time_since_epoch()
+                                   .count());
+  std::filesystem::create_directories(dir);
+  const auto req_prefix = (dir / "requirement").string();
+  const auto prefix = (dir / "store").string();
+
+  // dry run records what to preprocess, saved when the state goes away.
+  auto dry_conf = conf;
+  dry_conf.set_spdz2k_requirement_path(req_prefix);
+  utils::simulate(kWorldSize,
+                  [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+                    auto obj = makeSpdz2kProtocol(dry_conf, lctx);
+                    program(obj.get());
+                  });
+
+  utils::simulate(kWorldSize,
+                  [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+                    auto req = spdz2k::LoadRequirement(
+                        fmt::format("{}.{}", req_prefix, lctx->Rank()));
+                    EXPECT_GT(req.mul, 0U);
+                    spdz2k::BeaverTfpUnsafe beaver(lctx);
+                    spdz2k::Preprocess(
+                        lctx, &beaver, req, 64,
+                        fmt::format("{}.{}", prefix, lctx->Rank()));
+                  });
+
+  // online run consumes the store.
+  conf.set_spdz2k_preprocess_path(prefix);
+  utils::simulate(kWorldSize,
+                  [&](const std::shared_ptr<yacl::link::Context>& lctx) {
+                    auto obj = makeSpdz2kProtocol(conf, lctx);
+                    program(obj.get());
+                    // nothing left beyond the recorded program.
+                    auto a = p2a(obj.get(), rand_p(obj.get(), kNumel));
+                    EXPECT_THROW(mul_aa(obj.get(), a, a), RuntimeError);
+                  });
+
+  std::filesystem::remove_all(dir);
+}
+
 }  // namespace spu::mpc::test
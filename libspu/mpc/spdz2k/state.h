@@ -15,16 +15,21 @@
 #pragma once
 
 #include <complex>
+#include <string>
+#include <utility>
 #include <vector>
 
+#include "spdlog/spdlog.h"
 #include "yacl/crypto/utils/rand.h"
 #include "yacl/link/link.h"
 
 #include "libspu/core/array_ref.h"
 #include "libspu/mpc/common/communicator.h"
 #include "libspu/mpc/object.h"
+#include "libspu/mpc/spdz2k/beaver/beaver_store.h"
 #include "libspu/mpc/spdz2k/beaver/beaver_tfp.h"
 #include "libspu/mpc/spdz2k/commitment.h"
+#include "libspu/spu.pb.h"
 
 namespace spu::mpc {
 
@@ -41,15 +46,31 @@ template <typename T>
 using Share = std::complex<T>;
 
 class Spdz2kState : public State {
-  std::unique_ptr<spdz2k::BeaverTfpUnsafe> beaver_;
+  std::unique_ptr<spdz2k::Beaver> beaver_;
+
+  // set when `spdz2k_requirement_path` is, records the requirement.
+  spdz2k::BeaverRecorder* recorder_ = nullptr;
+
+  // where the recorded requirement is saved at exit, empty disables.
+  std::string requirement_path_;
 
   std::shared_ptr<yacl::link::Context> lctx_;
 
   // share of global key, share key has length of 128 bit
   uint128_t key_;
 
-  // shares to be checked
-  std::unique_ptr<std::vector<ArrayRef>> arr_ref_v_;
+  // opened values and their mac shares, to be checked.
+  std::vector<ArrayRef> opened_;
+  std::vector<ArrayRef> opened_macs_;
+
+  // number of opened elements not checked yet.
+  size_t num_pending_ = 0;
+
+  // check once `check_interval_` elements are pending, 0 disables.
+  size_t check_interval_ = 0;
+
+  // check at loop boundaries.
+  bool check_at_loop_ = false;
 
   // plaintext ring size
   const size_t k_ = 64;
@@ -65,14 +86,47 @@ class Spdz2kState : public State {
   static constexpr auto kAesType =
       yacl::crypto::SymmetricCrypto::CryptoType::AES128_CTR;
 
-  explicit Spdz2kState(std::shared_ptr<yacl::link::Context> lctx) {
-    beaver_ = std::make_unique<spdz2k::BeaverTfpUnsafe>(lctx);
+  explicit Spdz2kState(const RuntimeConfig& conf,
+                       std::shared_ptr<yacl::link::Context> lctx) {
+    if (!conf.spdz2k_preprocess_path().empty()) {
+      beaver_ = std::make_unique<spdz2k::BeaverStore>(
+          lctx,
+          fmt::format("{}.{}", conf.spdz2k_preprocess_path(), lctx->Rank()));
+    } else if (!conf.spdz2k_requirement_path().empty()) {
+      auto recorder = std::make_unique<spdz2k::BeaverRecorder>(
+          std::make_unique<spdz2k::BeaverTfpUnsafe>(lctx));
+      recorder_ = recorder.get();
+      beaver_ = std::move(recorder);
+      requirement_path_ = fmt::format("{}.{}", conf.spdz2k_requirement_path(),
+                                      lctx->Rank());
+    } else {
+      beaver_ = std::make_unique<spdz2k::BeaverTfpUnsafe>(lctx);
+    }
     lctx_ = lctx;
     key_ = beaver_->GetSpdzKey(field_, s_);
-    arr_ref_v_ = std::make_unique<std::vector<ArrayRef>>();
+    check_interval_ = conf.spdz2k_mac_check_interval();
+    check_at_loop_ = conf.spdz2k_mac_check_at_loop();
+  }
+
+  ~Spdz2kState() override {
+    if (requirement_path_.empty()) {
+      return;
+    }
+    try {
+      spdz2k::SaveRequirement(recorder_->GetRequirement(), requirement_path_);
+    } catch (const std::exception& e) {
+      SPDLOG_ERROR("failed to save spdz2k requirement: {}", e.what());
+    }
   }
 
-  spdz2k::BeaverTfpUnsafe* beaver() { return beaver_.get(); }
+  spdz2k::Beaver* beaver() { return beaver_.get(); }
+
+  // Correlations consumed so far, input of spdz2k::Preprocess.
+  const spdz2k::Requirement& requirement() const {
+    SPU_ENFORCE(recorder_ != nullptr,
+                "requirement is only recorded with spdz2k_requirement_path");
+    return recorder_->GetRequirement();
+  }
 
   uint128_t key() const { return key_; }
 
@@ -80,7 +134,27 @@ class Spdz2kState : public State {
 
   size_t s() const { return s_; }
 
-  std::vector<ArrayRef>* arr_ref_v() { return arr_ref_v_.get(); }
+  bool checkAtLoop() const { return check_at_loop_; }
+
+  // Record an opened value, its mac is verified later in batch.
+  void addOpened(const ArrayRef& value, const ArrayRef& mac) {
+    SPU_ENFORCE(value.numel() == mac.numel());
+    opened_.emplace_back(value);
+    opened_macs_.emplace_back(mac);
+    num_pending_ += value.numel();
+  }
+
+  size_t numPending() const { return num_pending_; }
+
+  bool needCheck() const {
+    return check_interval_ > 0 && num_pending_ >= check_interval_;
+  }
+
+  // Take the opened values and mac shares, the buffer is empty afterwards.
+  std::pair<std::vector<ArrayRef>, std::vector<ArrayRef>> takeOpened() {
+    num_pending_ = 0;
+    return {std::exchange(opened_, {}), std::exchange(opened_macs_, {})};
+  }
 
   // public coin, used in malicious model, all party generate new seed, then
   // get exactly the same random variable.
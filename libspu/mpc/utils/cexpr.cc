@@ -14,6 +14,7 @@
 
 #include "libspu/mpc/utils/cexpr.h"
 
+#include <cctype>
 #include <cmath>
 #include <functional>
 #include <sstream>
@@ -123,8 +124,110 @@ CExpr Mul(const CExpr& x, const CExpr& y) {
   return std::make_shared<MulExpr>(x, y);
 }
 
+// A recursive descent parser of:
+//   expr   := term (('+' | '-') term)*
+//   term   := factor ('*' factor)*
+//   factor := number | name | 'log' '(' expr ')' | '(' expr ')'
+class Parser {
+  std::string_view str_;
+  size_t pos_ = 0;
+
+ public:
+  explicit Parser(std::string_view str) : str_(str) {}
+
+  CExpr parse() {
+    auto ret = parseExpr();
+    skipSpaces();
+    SPU_ENFORCE(pos_ == str_.size(), "unexpected '{}' at {} of '{}'",
+                str_.substr(pos_), pos_, str_);
+    return ret;
+  }
+
+ private:
+  unsigned char cur() const { return static_cast<unsigned char>(str_[pos_]); }
+
+  void skipSpaces() {
+    while (pos_ < str_.size() && std::isspace(cur())) {
+      ++pos_;
+    }
+  }
+
+  bool consume(char c) {
+    skipSpaces();
+    if (pos_ < str_.size() && str_[pos_] == c) {
+      ++pos_;
+      return true;
+    }
+    return false;
+  }
+
+  CExpr parseExpr() {
+    auto ret = parseTerm();
+    while (true) {
+      if (consume('+')) {
+        ret = Add(ret, parseTerm());
+      } else if (consume('-')) {
+        ret = Sub(ret, parseTerm());
+      } else {
+        return ret;
+      }
+    }
+  }
+
+  CExpr parseTerm() {
+    auto ret = parseFactor();
+    while (consume('*')) {
+      ret = Mul(ret, parseFactor());
+    }
+    return ret;
+  }
+
+  CExpr parseFactor() {
+    if (consume('(')) {
+      auto ret = parseExpr();
+      SPU_ENFORCE(consume(')'), "missing ')' at {} of '{}'", pos_, str_);
+      return ret;
+    }
+
+    skipSpaces();
+    SPU_ENFORCE(pos_ < str_.size(), "unexpected end of '{}'", str_);
+
+    const size_t start = pos_;
+    if (std::isdigit(cur())) {
+      Value val = 0;
+      while (pos_ < str_.size() && std::isdigit(cur())) {
+        val = val * 10 + (str_[pos_++] - '0');
+      }
+      return Const(val);
+    }
+
+    while (pos_ < str_.size() && (std::isalnum(cur()) || str_[pos_] == '_')) {
+      ++pos_;
+    }
+    SPU_ENFORCE(pos_ > start, "unexpected '{}' at {} of '{}'", str_[start],
+                start, str_);
+
+    std::string name(str_.substr(start, pos_ - start));
+    if (name == "log") {
+      SPU_ENFORCE(consume('('), "expect '(' after log in '{}'", str_);
+      auto operand = parseExpr();
+      SPU_ENFORCE(consume(')'), "missing ')' at {} of '{}'", pos_, str_);
+      return Log(operand);
+    }
+    if (name == "K") {
+      return K();
+    }
+    if (name == "N") {
+      return N();
+    }
+    return Variable(name, "");
+  }
+};
+
 }  // namespace
 
+CExpr Parse(std::string_view str) { return Parser(str).parse(); }
+
 CExpr Const(Value v) { return std::make_unique<ConstantExpr>(v); }
 CExpr Variable(std::string name, std::string desc) {
   return std::make_shared<VariableExpr>(std::move(name), std::move(desc));
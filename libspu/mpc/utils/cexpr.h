@@ -17,6 +17,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 
 // The complexity expression library
 namespace spu::mpc::cexpr {
@@ -59,6 +60,10 @@ CExpr operator*(const CExpr& x, const CExpr& y);
 CExpr operator*(const CExpr& x, Value y);
 CExpr operator*(Value x, const CExpr& y);
 
+// Parse the human-readable format (as returned by `expr()`) back into an
+// expression, i.e. `(log(K)+1)*log(N)`. Unknown names are parsed as variables.
+CExpr Parse(std::string_view str);
+
 }  // namespace spu::mpc::cexpr
 
 namespace spu {
@@ -56,4 +56,21 @@ TEST(CExprTest, Samples) {
   EXPECT_EQ(c->eval({{"K", 32}, {"N", 2}}), 2 * (std::log2(32) - 1) + 3 * 2);
 }
 
+TEST(CExprTest, Parse) {
+  for (const auto& c : {2 * (Log(K()) - 1) + 3 * N(),
+                        (Log(K()) + 1) * Log(N()),
+                        (2 * Log(K()) + 1) * 2 * K() * (N() - 1) * (N() - 1),
+                        K() * 2 * (N() - 1) * Variable("m", "") *
+                            Variable("n", "")}) {
+    auto parsed = Parse(c->expr());
+    EXPECT_EQ(parsed->expr(), c->expr());
+    const Params params = {{"K", 64}, {"N", 3}, {"m", 5}, {"n", 7}};
+    EXPECT_EQ(parsed->eval(params), c->eval(params));
+  }
+
+  EXPECT_EQ(Parse(" 4 * K ")->eval({{"K", 32}}), 128);
+  EXPECT_ANY_THROW(Parse("TODO+"));
+  EXPECT_ANY_THROW(Parse("log(K"));
+}
+
 }  // namespace spu::mpc::cexpr
@@ -15,8 +15,12 @@
 #pragma once
 
 #include <cstddef>
+#include <type_traits>
+#include <vector>
 
 #include "spdlog/spdlog.h"
+#include "yacl/base/int128.h"
+#include "yacl/utils/parallel.h"
 
 #include "libspu/core/parallel_utils.h"
 #include "libspu/core/prelude.h"
@@ -31,6 +35,154 @@ namespace detail {
 
 void setEigenParallelLevel(int64_t expected_threads);
 
+// Block sizes of the cache blocked GEMM, an (MC x KC) panel of A and a
+// (KC x NC) panel of B fit in L2 together with the (MC x NC) accumulators.
+constexpr int64_t kGemmMC = 64;
+constexpr int64_t kGemmNC = 128;
+constexpr int64_t kGemmKC = 256;
+
+template <typename T>
+void matmulEigen(int64_t M, int64_t N, int64_t K, const T* A, int64_t LDA,
+                 int64_t IDA, const T* B, int64_t LDB, int64_t IDB, T* C,
+                 int64_t LDC, int64_t IDC) {
+  using StrideT = Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>;
+  using MapMatrixConstT = Eigen::Map<
+      const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>,
+      Eigen::Unaligned, StrideT>;
+  using MapMatrixT = Eigen::Map<
+      Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>,
+      Eigen::Unaligned, StrideT>;
+
+  MapMatrixConstT a(A, M, K, StrideT(LDA, IDA));
+  MapMatrixConstT b(B, K, N, StrideT(LDB, IDB));
+  MapMatrixT c(C, M, N, StrideT(LDC, IDC));
+
+  // If we don't limit # threads, eigen may overloading omp tasks (especially
+  // under relative small tasks, MLP for example)
+  //
+  // FIXME: Investigate what can happen once we support ILP
+  //        The performance is extremely bad when multi-process all tries to use
+  //        num_cores.
+  // auto expected_num_threads = std::max((M * K + kMinTaskSize) / kMinTaskSize,
+  //                                     (N * K + kMinTaskSize) / kMinTaskSize);
+  setEigenParallelLevel(2);
+
+  c.noalias() = a * b;
+}
+
+// Cache blocked GEMM over Z_2^k, where T is an unsigned ring element.
+//
+// Output tiles of (MC x NC) are distributed over threads. For each tile, the
+// operands are packed into contiguous panels of KC depth, so the inner loop
+// streams over unit-stride memory regardless of the input strides.
+//
+// For 128-bit rings, each element is packed as separated lo/hi 64-bit panels,
+// and a product modulo 2^128 is computed as
+//
+//   a * b = lo(a) * lo(b) + ((lo(a) * hi(b) + hi(a) * lo(b)) << 64)
+//
+// The first term is a single 64x64->128 multiply, the cross terms only need
+// the low 64 bits, so they are accumulated in a 64-bit lane which the compiler
+// could vectorize, and shifted into place once per tile.
+template <typename T>
+void matmulBlocked(int64_t M, int64_t N, int64_t K, const T* A, int64_t LDA,
+                   int64_t IDA, const T* B, int64_t LDB, int64_t IDB, T* C,
+                   int64_t LDC, int64_t IDC) {
+  constexpr bool kIsU128 = std::is_same_v<T, uint128_t>;
+  // the type of a single packed lane.
+  using LaneT = std::conditional_t<kIsU128, uint64_t, T>;
+
+  const int64_t m_tiles = (M + kGemmMC - 1) / kGemmMC;
+  const int64_t n_tiles = (N + kGemmNC - 1) / kGemmNC;
+
+  yacl::parallel_for(0, m_tiles * n_tiles, 1, [&](int64_t begin, int64_t end) {
+    std::vector<LaneT> a_lo(kGemmMC * kGemmKC);
+    std::vector<LaneT> b_lo(kGemmKC * kGemmNC);
+    std::vector<T> acc(kGemmMC * kGemmNC);
+    // only used by 128-bit rings.
+    std::vector<uint64_t> a_hi;
+    std::vector<uint64_t> b_hi;
+    std::vector<uint64_t> acc_cross;
+    if constexpr (kIsU128) {
+      a_hi.resize(kGemmMC * kGemmKC);
+      b_hi.resize(kGemmKC * kGemmNC);
+      acc_cross.resize(kGemmMC * kGemmNC);
+    }
+
+    for (int64_t tile = begin; tile < end; tile++) {
+      const int64_t i0 = (tile / n_tiles) * kGemmMC;
+      const int64_t j0 = (tile % n_tiles) * kGemmNC;
+      const int64_t mc = std::min(kGemmMC, M - i0);
+      const int64_t nc = std::min(kGemmNC, N - j0);
+
+      std::fill(acc.begin(), acc.end(), T(0));
+      if constexpr (kIsU128) {
+        std::fill(acc_cross.begin(), acc_cross.end(), 0);
+      }
+
+      for (int64_t p0 = 0; p0 < K; p0 += kGemmKC) {
+        const int64_t kc = std::min(kGemmKC, K - p0);
+
+        // pack A[i0:i0+mc, p0:p0+kc] and B[p0:p0+kc, j0:j0+nc], row major.
+        for (int64_t i = 0; i < mc; i++) {
+          const T* a_row = A + (i0 + i) * LDA + p0 * IDA;
+          for (int64_t p = 0; p < kc; p++) {
+            const T v = a_row[p * IDA];
+            a_lo[i * kc + p] = static_cast<LaneT>(v);
+            if constexpr (kIsU128) {
+              a_hi[i * kc + p] = static_cast<uint64_t>(v >> 64);
+            }
+          }
+        }
+        for (int64_t p = 0; p < kc; p++) {
+          const T* b_row = B + (p0 + p) * LDB + j0 * IDB;
+          for (int64_t j = 0; j < nc; j++) {
+            const T v = b_row[j * IDB];
+            b_lo[p * nc + j] = static_cast<LaneT>(v);
+            if constexpr (kIsU128) {
+              b_hi[p * nc + j] = static_cast<uint64_t>(v >> 64);
+            }
+          }
+        }
+
+        // micro kernel, C[i, :] += A[i, p] * B[p, :]
+        for (int64_t i = 0; i < mc; i++) {
+          T* acc_row = acc.data() + i * nc;
+          for (int64_t p = 0; p < kc; p++) {
+            const LaneT al = a_lo[i * kc + p];
+            const LaneT* bl = b_lo.data() + p * nc;
+            if constexpr (kIsU128) {
+              const uint64_t ah = a_hi[i * kc + p];
+              const uint64_t* bh = b_hi.data() + p * nc;
+              uint64_t* cross_row = acc_cross.data() + i * nc;
+              for (int64_t j = 0; j < nc; j++) {
+                acc_row[j] += static_cast<uint128_t>(al) * bl[j];
+                cross_row[j] += al * bh[j] + ah * bl[j];
+              }
+            } else {
+              for (int64_t j = 0; j < nc; j++) {
+                acc_row[j] += al * bl[j];
+              }
+            }
+          }
+        }
+      }
+
+      // write back the tile.
+      for (int64_t i = 0; i < mc; i++) {
+        T* c_row = C + (i0 + i) * LDC + j0 * IDC;
+        for (int64_t j = 0; j < nc; j++) {
+          T v = acc[i * nc + j];
+          if constexpr (kIsU128) {
+            v += static_cast<uint128_t>(acc_cross[i * nc + j]) << 64;
+          }
+          c_row[j * IDC] = v;
+        }
+      }
+    }
+  });
+}
+
 }  // namespace detail
 
 #define EIGEN_BINARY_FCN(NAME, OP)                                   \
@@ -132,51 +284,13 @@ template <typename T>
 void matmul(int64_t M, int64_t N, int64_t K, const T* A, int64_t LDA,
             int64_t IDA, const T* B, int64_t LDB, int64_t IDB, T* C,
             int64_t LDC, int64_t IDC) {
-  using StrideT = Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>;
-  using MapMatrixConstT = Eigen::Map<
-      const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>,
-      Eigen::Unaligned, StrideT>;
-  using MapMatrixT = Eigen::Map<
-      Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>,
-      Eigen::Unaligned, StrideT>;
-
-  MapMatrixConstT a(A, M, K, StrideT(LDA, IDA));
-  MapMatrixConstT b(B, K, N, StrideT(LDB, IDB));
-  MapMatrixT c(C, M, N, StrideT(LDC, IDC));
-
-  // if (M == 1) {
-  //   // GEMV case 1*K * K*N -> 1*N
-  //   auto work_load_size = computeTaskSize(N);
-  //   yacl::parallel_for(0, N, work_load_size, [&](int64_t begin, int64_t end)
-  //   {
-  //     auto block_size = end - begin;
-  //     c.block(0, begin, 1, block_size) =
-  //         a.row(0) * b.block(0, begin, K, block_size);
-  //   });
-  //   return;
-  // } else if (N == 1) {
-  //   // GEMV case M*K * K*1 -> M*1
-  //   auto work_load_size = computeTaskSize(M);
-  //   yacl::parallel_for(0, M, work_load_size, [&](int64_t begin, int64_t end)
-  //   {
-  //     auto block_size = end - begin;
-  //     c.block(begin, 0, block_size, 1) =
-  //         a.block(begin, 0, block_size, K) * b.col(0);
-  //   });
-  //   return;
-  // }
-
-  // If we don't limit # threads, eigen may overloading omp tasks (especially
-  // under relative small tasks, MLP for example)
-  //
-  // FIXME: Investigate what can happen once we support ILP
-  //        The performance is extremely bad when multi-process all tries to use
-  //        num_cores.
-  // auto expected_num_threads = std::max((M * K + kMinTaskSize) / kMinTaskSize,
-  //                                     (N * K + kMinTaskSize) / kMinTaskSize);
-  detail::setEigenParallelLevel(2);
-
-  c.noalias() = a * b;
+  // Eigen has no vectorized kernel for 128-bit integers and falls back to a
+  // generic scalar GEMM, use the hand blocked one instead.
+  if constexpr (std::is_same_v<T, uint128_t>) {
+    detail::matmulBlocked(M, N, K, A, LDA, IDA, B, LDB, IDB, C, LDC, IDC);
+  } else {
+    detail::matmulEigen(M, N, K, A, LDA, IDA, B, LDB, IDB, C, LDC, IDC);
+  }
 }
 
 }  // namespace spu::mpc::linalg
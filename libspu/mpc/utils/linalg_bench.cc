@@ -0,0 +1,72 @@
+// Copyright 2023 Ant Group Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "libspu/mpc/utils/linalg.h"
+
+namespace spu::mpc::linalg {
+
+// Shapes (M, N, K) of MatMulAA in common models, i.e. mini-batch of
+// logistic regression and dense layers of MLP/transformer.
+static void makeMatMulArgs(benchmark::internal::Benchmark* b) {
+  b->Args({1024, 1, 64})
+      ->Args({1024, 16, 64})
+      ->Args({128, 128, 128})
+      ->Args({128, 768, 768})
+      ->Args({512, 512, 512});
+}
+
+template <typename T>
+static std::vector<T> makeRandomMatrix(int64_t numel) {
+  std::mt19937_64 rng(numel);
+  std::vector<T> ret(numel);
+  for (auto& v : ret) {
+    v = static_cast<T>((static_cast<uint128_t>(rng()) << 64) | rng());
+  }
+  return ret;
+}
+
+template <typename T, bool kBlocked>
+static void BM_MatMul(benchmark::State& state) {
+  const int64_t M = state.range(0);
+  const int64_t N = state.range(1);
+  const int64_t K = state.range(2);
+
+  const auto A = makeRandomMatrix<T>(M * K);
+  const auto B = makeRandomMatrix<T>(K * N);
+  std::vector<T> C(M * N);
+
+  for (auto _ : state) {
+    if constexpr (kBlocked) {
+      detail::matmulBlocked(M, N, K, A.data(), K, 1, B.data(), N, 1, C.data(),
+                            N, 1);
+    } else {
+      detail::matmulEigen(M, N, K, A.data(), K, 1, B.data(), N, 1, C.data(),
+                          N, 1);
+    }
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_MatMul, uint64_t, false)->Apply(makeMatMulArgs);
+BENCHMARK_TEMPLATE(BM_MatMul, uint64_t, true)->Apply(makeMatMulArgs);
+BENCHMARK_TEMPLATE(BM_MatMul, uint128_t, false)->Apply(makeMatMulArgs);
+BENCHMARK_TEMPLATE(BM_MatMul, uint128_t, true)->Apply(makeMatMulArgs);
+
+}  // namespace spu::mpc::linalg
+
+BENCHMARK_MAIN();
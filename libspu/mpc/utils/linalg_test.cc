@@ -14,6 +14,7 @@
 
 #include "libspu/mpc/utils/linalg.h"
 
+#include <random>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -52,6 +53,38 @@ TEST(LinalgTest, MatMulStrides) {
   EXPECT_EQ(C, expected);
 }
 
+template <typename T>
+class LinalgBlockedTest : public ::testing::Test {};
+
+using RingTypes = ::testing::Types<uint32_t, uint64_t, uint128_t>;
+TYPED_TEST_SUITE(LinalgBlockedTest, RingTypes);
+
+TYPED_TEST(LinalgBlockedTest, MatchesEigen) {
+  using T = TypeParam;
+  // not aligned with block sizes, A and B are strided.
+  const int64_t M = 70;
+  const int64_t N = 131;
+  const int64_t K = 300;
+
+  std::mt19937_64 rng(0);
+  auto rand_ring = [&]() {
+    return static_cast<T>((static_cast<uint128_t>(rng()) << 64) | rng());
+  };
+  std::vector<T> A(M * K * 2);
+  std::vector<T> B(K * N * 3);
+  std::generate(A.begin(), A.end(), rand_ring);
+  std::generate(B.begin(), B.end(), rand_ring);
+
+  std::vector<T> expected(M * N);
+  std::vector<T> C(M * N);
+  detail::matmulEigen(M, N, K, A.data(), 2 * K, 2, B.data(), 3 * N, 3,
+                      expected.data(), N, 1);
+  detail::matmulBlocked(M, N, K, A.data(), 2 * K, 2, B.data(), 3 * N, 3,
+                        C.data(), N, 1);
+
+  EXPECT_EQ(C, expected);
+}
+
 TEST(LinalgTest, Select) {
   std::vector<float> A = {1,  2,  3,    //
                           5,  6,  7,    //
@@ -21,6 +21,7 @@
 
 from . import libspu  # type: ignore
 from . import spu_pb2
+from .version import __version__
 
 
 class Runtime(object):
@@ -133,7 +134,11 @@ def reconstruct(self, str_shares: List[bytes]) -> 'np.ndarray':
 @cached(cache=LRUCache(maxsize=128))
 def _spu_compilation(ir_text: str, ir_type: str, json_meta: str):
     pp_dir = os.getenv('SPU_IR_DUMP_DIR')
-    return libspu.compile(ir_text, ir_type, json_meta, pp_dir or "")
+    # On disk cache shared by processes, keyed by the ir, options and version.
+    cache_dir = os.getenv('SPU_COMPILE_CACHE_DIR')
+    return libspu.compile(
+        ir_text, ir_type, json_meta, pp_dir or "", cache_dir or "", __version__
+    )
 
 
 def compile(ir_text: str, ir_type: str, vis: List[spu_pb2.Visibility]) -> str:
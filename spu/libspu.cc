@@ -592,7 +592,8 @@ PYBIND11_MODULE(libspu, m) {
   m.def(
       "compile",
       [](const py::bytes& ir_text, const std::string& ir_type,
-         const std::string& input_visiblity_map, const std::string& dump_path) {
+         const std::string& input_visiblity_map, const std::string& dump_path,
+         const std::string& cache_dir, const std::string& version) {
         py::scoped_ostream_redirect stream(
             std::cout,                                 // std::ostream&
             py::module_::import("sys").attr("stdout")  // Python output
@@ -605,10 +606,15 @@ PYBIND11_MODULE(libspu, m) {
           ctx.enablePrettyPrintWithDir(dump_path);
         }
 
+        if (!cache_dir.empty()) {
+          ctx.enableCompileCacheWithDir(cache_dir, version);
+        }
+
         return py::bytes(spu::compiler::compile(&ctx, ir_text, ir_type));
       },
       "spu compile.", py::arg("ir_text"), py::arg("ir_type"),
-      py::arg("vis_map"), py::arg("dump_path"));
+      py::arg("vis_map"), py::arg("dump_path"), py::arg("cache_dir") = "",
+      py::arg("version") = "");
 
   // bind spu libs.
   py::module link_m = m.def_submodule("link");